@@ -79,6 +79,8 @@
 // Max object ocurrence
 #define ENGINE_MAX_OBJECTS 100
 #define ENGINE_MAX_LIGHTS 50
+#define ENGINE_MAX_HAIR_VOLUMES 4 // Grooms with their own density volume, slots of the hair volume atlas
+#define ENGINE_HAIR_BRICK_SIZE 8  // Voxels per side of the bricks of the sparse hair volumes
 
 // File terminations
 #define PLY "ply"
@@ -205,6 +207,22 @@ typedef enum VertexAttributeType
     UV_ATTRIBUTE       = 3,
     COLOR_ATTRIBUTE    = 4
 } VertexAttributeType;
+typedef enum VertexLayoutType
+{
+    CANONICAL_VERTEX_LAYOUT = 0, // Graphics::Vertex
+    STRAND_VERTEX_LAYOUT    = 1, // Graphics::StrandVertex, quantized layout for hair fibers
+} VertexLayoutType;
+typedef enum StrandTopology
+{
+    STRAND_LINE_LIST  = 0, // An index pair per segment
+    STRAND_LINE_STRIP = 1, // An index per point, every strand closed by STRAND_RESTART_INDEX
+} StrandTopology;
+typedef enum StrandSortKey
+{
+    STRAND_SORT_NONE     = 0, // File order
+    STRAND_SORT_ROOT     = 1, // Morton order of the first point of every strand
+    STRAND_SORT_CENTROID = 2, // Morton order of the mean of the strand points
+} StrandSortKey;
 typedef enum ShadowType
 {
     BASIC_SHADOW     = 0, // Classic shadow mapping
@@ -218,6 +236,15 @@ typedef enum VolumeType
     OBB_VOLUME    = 2,
 } VolumeType;
 
+typedef enum AssetState
+{
+    ASSET_QUEUED           = 0, // Waiting for a worker
+    ASSET_DECODING         = 1, // File being parsed on a worker
+    ASSET_READY_FOR_UPLOAD = 2, // Handed to the scene, GPU upload pending
+    ASSET_RESIDENT         = 3, // Uploaded
+    ASSET_FAILED           = 4,
+} AssetState;
+
 typedef enum RendererType
 {
     FORWARD_RENDERER  = 0,
@@ -226,15 +253,17 @@ typedef enum RendererType
 
 typedef enum WindowingSystem
 {
-    GLFW = 0,
-    SDL  = 1
+    GLFW     = 0,
+    SDL      = 1,
+    HEADLESS = 2 // No surface. Frames are rendered into offscreen images
 } WindowingSystem;
 enum QueueType
 {
-    GRAPHIC_QUEUE = 0,
-    PRESENT_QUEUE = 1,
-    COMPUTE_QUEUE = 2,
-    RT_QUEUE      = 3
+    GRAPHIC_QUEUE  = 0,
+    PRESENT_QUEUE  = 1,
+    COMPUTE_QUEUE  = 2,
+    RT_QUEUE       = 3,
+    TRANSFER_QUEUE = 4, // Dedicated transfer queue if the GPU exposes one, graphics queue otherwise
 };
 enum AttachmentType
 {
@@ -292,6 +321,10 @@ typedef enum ColorFormatTypeFlagBits
     DEPTH_32F      = VK_FORMAT_D32_SFLOAT,
     RGB10A2        = VK_FORMAT_A2B10G10R10_UNORM_PACK32,
     RG11B10_UFLOAT = 111,
+    SRGBA_BC1      = VK_FORMAT_BC1_RGBA_SRGB_BLOCK, // Block compressed, 4x4 texels in 8 bytes
+    RGBA_BC1U      = VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    SRGBA_BC3      = VK_FORMAT_BC3_SRGB_BLOCK, // Block compressed with alpha, 4x4 texels in 16 bytes
+    RGBA_BC3U      = VK_FORMAT_BC3_UNORM_BLOCK,
 } ColorFormatType;
 typedef enum MipmapModeFlagsBits
 {
@@ -368,6 +401,7 @@ typedef enum PipelineStageFlagsBits
     STAGE_VERTEX_SHADER           = 0x0000000a,
     STAGE_VERTEX_INPUT            = 0x0000000b,
     STAGE_ALL_COMMANDS            = 0x0000000c,
+    STAGE_DRAW_INDIRECT           = 0x0000000d,
 } PipelineStage;
 typedef enum AccessFlagsBits
 {
@@ -381,6 +415,7 @@ typedef enum AccessFlagsBits
     ACCESS_SHADER_READ                    = 0x00000007,
     ACCESS_SHADER_WRITE                   = 0x00000008,
     ACCESS_MEMORY_READ                    = 0x00000009,
+    ACCESS_INDIRECT_COMMAND_READ          = 0x0000000a,
     ACCESS_MAX                            = 0x00000010
 } AccessFlags;
 typedef enum AttachmentStoreOpFlagsBits
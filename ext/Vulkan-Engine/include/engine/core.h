@@ -12,11 +12,13 @@
 #pragma once
 
 #include <engine/core/geometries/geometry.h>
+#include <engine/core/geometries/strand_bvh.h>
 
 #include <engine/core/textures/texture.h>
 
 #include <engine/core/windows/window.h>
 #include <engine/core/windows/windowGLFW.h>
+#include <engine/core/windows/windowHeadless.h>
 
 #include <engine/core/materials/material.h>
 #include <engine/core/materials/phong.h>
@@ -11,8 +11,10 @@
 #define GEOMETRY_H
 
 #include <engine/common.h>
+#include <engine/core/geometries/strand_bvh.h>
 #include <engine/graphics/accel.h>
 #include <engine/graphics/vao.h>
+#include <memory>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
@@ -20,21 +22,127 @@ namespace Core {
 
 class Geometry;
 
+/*
+Read-only GPU-ready streams living in external memory (e.g. a memory mapped cache file). The owner handle keeps that memory
+alive for as long as the view is referenced.
+*/
+struct GeometricView {
+    std::shared_ptr<void>   owner;
+    const Graphics::Vertex* vertices    = nullptr;
+    size_t                  vertexCount = 0;
+    const uint32_t*         indices     = nullptr;
+    size_t                  indexCount  = 0;
+    const Vec4*             positions   = nullptr; // Optional. Already laid out as the positions SSBO expects
+
+    // Optional. Strand layout streams
+    const Graphics::StrandVertex* strandVertices = nullptr; // Same count as vertices
+    const Graphics::StrandData*   strands        = nullptr;
+    size_t                        strandCount    = 0;
+    const uint32_t*               lodIndices     = nullptr; // Simplified levels, see GeometricData::strandLODs
+    size_t                        lodIndexCount  = 0;
+};
+
+// Strand simplification levels. Errors are relative to the geometry bounding radius, level 0 is the source polylines
+#define STRAND_LOD_LEVELS 4
+#define STRAND_LOD_ERRORS {0.0f, 0.001f, 0.004f, 0.016f}
+// Strand s belongs to priority tier s % STRAND_PRIORITY_TIERS. Power of two
+#define STRAND_PRIORITY_TIERS 64
+
+/*
+Strand level of detail. Strands are laid out in priority tiers, each one an even stride of the stored strand order, visited
+in bit reversed order. Any whole tier prefix is an evenly thinned groom that keeps the storage order within every tier, and
+every level holds all of them simplified up to a growing error.
+*/
+struct StrandLOD {
+    float                 error        = 0.0f; // Max deviation of the simplified polylines, relative to the bounding radius
+    uint32_t              firstIndex   = 0;    // Level 0 lives in the index stream, the rest in the LOD index stream
+    std::vector<uint32_t> indexPrefix;         // Indices drawn by the first N priority strands, strand count + 1 entries
+    uint32_t              firstCluster = 0;    // Clusters of the level, see GeometricData::strandClusters
+    uint32_t              clusterCount = 0;
+};
+struct StrandLODSettings {
+    bool  enabled           = true;
+    float strandsPerPixel   = 1.0f;  // Strands kept per squared pixel of the projected bounding sphere diameter
+    float minStrandFraction = 0.05f; // Caps the width increase to its inverse
+    float maxPixelError     = 0.5f;  // Largest simplification error allowed on screen
+};
+/*
+What a strand draw ended up using. Thickness is scaled by the inverse of the drawn strand fraction to keep the coverage.
+*/
+struct StrandLODSelection {
+    uint32_t level       = 0;
+    uint32_t strandCount = 0;
+    uint32_t firstIndex  = 0;
+    uint32_t indexCount  = 0;
+    float    widthScale  = 1.0f;
+    float    pixels      = 0.0f; // Projected bounding sphere diameter it was selected for
+};
+
 struct GeometricData {
-    std::vector<uint32_t>         vertexIndex;
-    std::vector<Graphics::Vertex> vertexData;
-    std::vector<Graphics::Voxel>  voxelData;
+    std::vector<uint32_t>          vertexIndex;
+    std::vector<Graphics::Vertex>  vertexData;
+    std::vector<Graphics::Voxel>   voxelData;
+    std::shared_ptr<GeometricView> view; // If set, it replaces vertexData and vertexIndex
 
     // Stats
     Vec3 maxCoords;
     Vec3 minCoords;
     Vec3 center;
 
-    float avgFiberLength = 0.0f; // If fiber;
+    float                 avgFiberLength = 0.0f; // If fiber;
+    std::vector<uint32_t> strandOffsets;         // If fiber. First vertex of each strand plus a trailing end offset
+
+    // If fiber. Compressed strand layout, see Geometry::quantize_strands()
+    std::vector<Graphics::StrandVertex> strandVertexData;
+    std::vector<Graphics::StrandData>   strandData;
+
+    // If fiber. Level of detail table and the index stream of the simplified levels, see Geometry::build_strand_LODs()
+    std::vector<StrandLOD>               strandLODs;
+    std::vector<uint32_t>                lodIndexData;
+    std::vector<Graphics::StrandCluster> strandClusters; // Culling clusters of every level, one after another
+    StrandTopology                       strandTopology = STRAND_LINE_LIST; // Of both index streams
+
+    // If fiber. Set by Geometry::sort_strands(), source strand of every stored one. Empty means file order
+    std::vector<uint32_t> strandPermutation;
+    StrandSortKey         strandSort = STRAND_SORT_NONE;
 
     bool loaded{false};
 
     void compute_statistics();
+
+    inline const Graphics::Vertex* vertex_data() const {
+        return view ? view->vertices : vertexData.data();
+    }
+    inline size_t vertex_count() const {
+        return view ? view->vertexCount : vertexData.size();
+    }
+    inline const uint32_t* index_data() const {
+        return view ? view->indices : vertexIndex.data();
+    }
+    inline size_t index_count() const {
+        return view ? view->indexCount : vertexIndex.size();
+    }
+    inline const Graphics::StrandVertex* strand_vertex_data() const {
+        return view && view->strandVertices ? view->strandVertices : strandVertexData.data();
+    }
+    inline const Graphics::StrandData* strand_data() const {
+        return view && view->strands ? view->strands : strandData.data();
+    }
+    inline size_t strand_count() const {
+        return view && view->strands ? view->strandCount : strandData.size();
+    }
+    inline bool quantized() const {
+        return strand_count() > 0;
+    }
+    inline const uint32_t* lod_index_data() const {
+        return view && view->lodIndices ? view->lodIndices : lodIndexData.data();
+    }
+    inline size_t lod_index_count() const {
+        return view && view->lodIndices ? view->lodIndexCount : lodIndexData.size();
+    }
+    inline uint32_t source_strand(uint32_t strand) const {
+        return strand < strandPermutation.size() ? strandPermutation[strand] : strand;
+    }
 };
 
 /*
@@ -47,8 +155,14 @@ class Geometry
     Graphics::VAO  m_VAO  = {};
     Graphics::BLAS m_BLAS = {};
 
-    GeometricData m_properties = {};
-    size_t        m_materialID = 0;
+    GeometricData m_properties     = {};
+    size_t        m_materialID     = 0;
+    bool          m_releaseCPUData = false;
+
+    StrandLODSettings  m_lodSettings = {};
+    StrandLODSelection m_lodStats    = {};
+
+    std::shared_ptr<StrandBVH> m_strandBVH; // Built on demand
 
     friend Graphics::VertexArrays* const get_VAO(Geometry* g);
     friend Graphics::BLAS* const         get_BLAS(Geometry* g);
@@ -68,7 +182,7 @@ class Geometry
         return m_properties.loaded;
     }
     inline bool indexed() const {
-        return !m_properties.vertexIndex.empty();
+        return m_properties.index_count() > 0;
     }
 
     inline const GeometricData& get_properties() const {
@@ -77,6 +191,48 @@ class Geometry
     inline void set_avg_fiber_length(float length) {
         m_properties.avgFiberLength = length;
     };
+    inline void set_strand_offsets(std::vector<uint32_t> offsets) {
+        m_properties.strandOffsets = std::move(offsets);
+    };
+    /*
+    LOD index streams are left empty when they come within a view.
+    */
+    inline void set_strand_LODs(std::vector<StrandLOD> lods, std::vector<uint32_t> lodIndices = {}, std::vector<Graphics::StrandCluster> clusters = {}) {
+        m_properties.strandLODs     = std::move(lods);
+        m_properties.lodIndexData   = std::move(lodIndices);
+        m_properties.strandClusters = std::move(clusters);
+    };
+    inline void set_strand_topology(StrandTopology topology) {
+        m_properties.strandTopology = topology;
+    };
+    inline void set_strand_permutation(std::vector<uint32_t> permutation, StrandSortKey key) {
+        m_properties.strandPermutation = std::move(permutation);
+        m_properties.strandSort        = key;
+    };
+    inline bool has_strand_LODs() const {
+        return !m_properties.strandLODs.empty();
+    }
+    inline StrandLODSettings& get_strand_LOD_settings() {
+        return m_lodSettings;
+    }
+    inline void set_strand_LOD_settings(const StrandLODSettings& settings) {
+        m_lodSettings = settings;
+    }
+    /*
+    Selection of the last strand draw of this geometry
+    */
+    inline const StrandLODSelection& get_strand_LOD_stats() const {
+        return m_lodStats;
+    }
+    inline void set_strand_LOD_stats(const StrandLODSelection& stats) {
+        m_lodStats = stats;
+    }
+    /*
+    Segment BVH of a strand geometry, null until built
+    */
+    inline const StrandBVH* get_strand_BVH() const {
+        return m_strandBVH.get();
+    }
     /*
     Use Voxel Acceleration Structure
     */
@@ -98,13 +254,77 @@ class Geometry
     inline void dynamic_AS(bool op) {
         m_BLAS.dynamic = op;
     }
+    /*
+    Query if vertex data is dropped from CPU memory once it is resident on the GPU.
+    */
+    inline bool release_CPU_data() const {
+        return m_releaseCPUData;
+    }
+    /*
+    Set if vertex data is dropped from CPU memory once it is resident on the GPU. Bounds and fiber stats are kept, but the
+    geometry has to be filled again before it can be re-uploaded.
+    */
+    inline void release_CPU_data(bool op) {
+        m_releaseCPUData = op;
+    }
     ~Geometry() {
     }
 
+    /*
+    Vectors are sunk into the geometry. Pass them with std::move to avoid a copy.
+    */
     void             fill(std::vector<Graphics::Vertex> vertexInfo);
     void             fill(std::vector<Graphics::Vertex> vertexInfo, std::vector<uint32_t> vertexIndex);
     void             fill(Vec3* pos, Vec3* normal, Vec2* uv, Vec3* tangent, uint32_t vertNumber);
+    /*
+    Fill with externally owned streams. Bounds are given since walking the view would touch all its memory.
+    */
+    void             fill(std::shared_ptr<GeometricView> view, Vec3 minCoords, Vec3 maxCoords);
     void             fill_voxel_array(std::vector<Graphics::Voxel> voxels);
+    /*
+    Trades every CPU side stream and stat with another geometry, GPU resources and settings stay. Derived data built from
+    the previous streams (the strand BVH) is dropped on both.
+    */
+    void             swap_properties(Geometry& other);
+    /*
+    Builds the compressed strand layout streams from the vertex data, quantizing against the current bounds. Strand offsets
+    are used to group vertices, if there are none the whole geometry is taken as a single strand. Color is taken from the
+    first vertex of each strand.
+    */
+    void             quantize_strands();
+    /*
+    Reorders the strands along a Morton curve of their root or centroid within the bounds, so consecutive strands are close
+    in space. Vertices, strand offsets and per strand voxels are permuted and the indices rebuilt as a line list, derived
+    streams (quantized layout, levels of detail, BVH) are dropped and have to be built afterwards. The source strand of each
+    one is kept, see GeometricData::source_strand(). Needs owned strand vertices and offsets.
+    */
+    void             sort_strands(StrandSortKey key);
+    /*
+    Builds the strand levels of detail. Rewrites the index stream so strands follow the tiered priority order, then
+    simplifies every strand at each of the STRAND_LOD_ERRORS thresholds and splits every level into culling clusters. Needs
+    strand offsets and owned indices with one segment per consecutive pair of strand vertices. Both index streams are written
+    with the given topology, line strips take about half the memory of line lists.
+    */
+    void             build_strand_LODs(StrandTopology topology = STRAND_LINE_STRIP);
+    /*
+    Strand count and simplification level for a given projected bounding sphere diameter, in pixels. The count is rounded up
+    to whole priority tiers.
+    */
+    StrandLODSelection select_strand_LOD(float pixels) const;
+    /*
+    Builds the segment BVH used for picking and CPU side spatial queries (see StrandBVH). Needs strand indices. It keeps
+    its own copy of the segments, so it outlives release_CPU_streams(), but refilling the geometry or rebuilding its LODs
+    drops it.
+    */
+    const StrandBVH* build_strand_BVH();
+    /*
+    Updates the segment BVH bounds after the vertices moved
+    */
+    void             refit_strand_BVH();
+    /*
+    Frees every CPU side vertex stream (mapped views included). Called after upload if release_CPU_data() is set.
+    */
+    void             release_CPU_streams();
     static Geometry* create_quad();
     static Geometry* create_cube();
 };
@@ -0,0 +1,129 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+
+#ifndef STRAND_BVH_H
+#define STRAND_BVH_H
+
+#include <cfloat>
+#include <engine/common.h>
+#include <engine/graphics/vao.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Core {
+
+// Binned SAH build settings
+#define STRAND_BVH_BINS 16
+#define STRAND_BVH_MAX_LEAF_SIZE 8
+#define STRAND_BVH_TASK_SIZE 16384 // Subtrees under this many segments are built as one job
+
+/*
+Closest segment found by a query. Segments are numbered as the slots of the index stream they were built from (see
+Graphics::strand_segment_index).
+*/
+struct StrandHit {
+    uint32_t segment  = UINT32_MAX;
+    uint32_t strand   = UINT32_MAX; // Only if strand offsets were given at build
+    float    t        = 0.0f;       // Distance along the ray, zero for point queries
+    float    distance = 0.0f;       // From the segment axis
+    Vec3     point    = Vec3(0.0f); // Closest point on the segment axis
+
+    inline bool valid() const {
+        return segment != UINT32_MAX;
+    }
+};
+
+/*
+4-wide bounding volume hierarchy over the segments of a strand geometry, in object space.
+
+Nodes keep the boxes of their four children in SoA form, so a node test is a few straight loops over 4 floats, and are laid
+out in depth-first pre-order, so a refit is a single reverse sweep. Segment endpoints are copied in leaf order, queries never
+touch the source vertex streams, which can be released afterwards.
+
+Bounds are the tight segment bounds, strand thickness is a query parameter.
+*/
+class StrandBVH
+{
+  public:
+    struct alignas(64) Node {
+        float    minX[4], minY[4], minZ[4];
+        float    maxX[4], maxY[4], maxZ[4];
+        uint32_t child[4]; // Inner children: node index. Leaves: first primitive
+        uint32_t count[4]; // Primitives of a leaf, 0 for inner children. Unused slots have an empty box
+    };
+
+  private:
+    std::vector<Node>     m_nodes;
+    std::vector<Vec3>     m_p0; // Segment endpoints, in leaf order
+    std::vector<Vec3>     m_p1;
+    std::vector<uint32_t> m_segments; // Source segment of every primitive
+    std::vector<uint32_t> m_strands;  // Strand of every primitive, if known
+    Vec3                  m_min      = Vec3(0.0f);
+    Vec3                  m_max      = Vec3(0.0f);
+    StrandTopology        m_topology = STRAND_LINE_LIST;
+
+    void refit_nodes();
+
+  public:
+    /*
+    Builds over the segment slots of a line list or line strip. Strip slots touching a restart index are left out. Strand
+    offsets (first vertex of each strand plus a trailing end offset) are optional and let hits report their strand.
+    */
+    void build(const Graphics::Vertex* vertices,
+               const uint32_t*         indices,
+               size_t                  segmentCount,
+               const uint32_t*         strandOffsets = nullptr,
+               size_t                  strandCount   = 0,
+               StrandTopology          topology      = STRAND_LINE_LIST);
+    /*
+    Updates the bounds after the vertices moved. Topology must be the same the hierarchy was built with.
+    */
+    void refit(const Graphics::Vertex* vertices, const uint32_t* indices);
+    void clear();
+
+    /*
+    Closest segment along a ray whose axis passes within radius of it. Strands are taken as ribbons facing the ray, the hit
+    is their closest approach to it.
+    */
+    StrandHit intersect(const Vec3& origin, const Vec3& direction, float radius, float tMax = FLT_MAX) const;
+    /*
+    Closest segment to a point, searched up to maxDistance
+    */
+    StrandHit nearest(const Vec3& point, float maxDistance = FLT_MAX) const;
+    /*
+    Appends the segments whose bounds, grown by radius, overlap the box. Conservative, it is meant to feed exact tests (e.g.
+    voxelization).
+    */
+    void query(const Vec3& boxMin, const Vec3& boxMax, float radius, std::vector<uint32_t>& segments) const;
+
+    inline bool empty() const {
+        return m_nodes.empty();
+    }
+    inline size_t get_segment_count() const {
+        return m_segments.size();
+    }
+    inline size_t get_node_count() const {
+        return m_nodes.size();
+    }
+    inline Vec3 get_min() const {
+        return m_min;
+    }
+    inline Vec3 get_max() const {
+        return m_max;
+    }
+    inline size_t get_memory_size() const {
+        return m_nodes.size() * sizeof(Node) + m_p0.size() * sizeof(Vec3) * 2 + (m_segments.size() + m_strands.size()) * sizeof(uint32_t);
+    }
+};
+
+} // namespace Core
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
@@ -33,7 +33,8 @@ class IMaterial
     MaterialSettings        m_settings          = {};
     Graphics::DescriptorSet m_textureDescriptor = {};
 
-    bool m_isDirty = true;
+    bool     m_isDirty  = true;
+    uint32_t m_revision = 0;
 
     friend class Renderer;
 
@@ -65,6 +66,13 @@ class IMaterial
     Type get_type() const {
         return m_type;
     }
+    /*
+    Strand materials render geometry uploaded with the compressed strand layout
+    */
+    VertexLayoutType get_vertex_layout() const {
+        return m_type == HAIR_STR_TYPE || m_type == HAIR_STR_DISNEY_TYPE || m_type == HAIR_STR_EPIC_TYPE ? STRAND_VERTEX_LAYOUT
+                                                                                                          : CANONICAL_VERTEX_LAYOUT;
+    }
 
     virtual Graphics::MaterialUniforms get_uniforms() const = 0;
 
@@ -109,6 +117,17 @@ class IMaterial
     virtual void dirty(bool op) {
         m_isDirty = op;
     }
+    /*
+    Consumes the dirty flag, bumping the revision if it was set. Per frame copies of the uniforms compare against it.
+    */
+    inline uint32_t reconcile() {
+        if (m_isDirty)
+        {
+            m_isDirty = false;
+            m_revision++;
+        }
+        return m_revision;
+    }
 
   private:
     Type m_type;
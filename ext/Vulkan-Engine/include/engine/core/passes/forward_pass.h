@@ -27,6 +27,8 @@ class ForwardPass : public GraphicPass
     ColorFormatType m_depthFormat;
     MSAASamples     m_aa;
 
+    bool m_strandVertexPulling = false;
+
     /*Descriptors*/
     struct FrameDescriptors {
         Graphics::DescriptorSet globalDescritor;
@@ -35,6 +37,12 @@ class ForwardPass : public GraphicPass
     std::vector<FrameDescriptors> m_descriptors;
 
     void setup_material_descriptor(IMaterial* mat);
+    /*
+    Key of the vertex pulled variant of a strand material pass
+    */
+    inline uint32_t pulled_strand_pass(IMaterial::Type type) {
+        return hash_string("strand_pulling") + static_cast<uint32_t>(type);
+    }
 
   public:
     ForwardPass(Graphics::Device* ctx, Extent2D extent, ColorFormatType colorFormat, ColorFormatType depthFormat, MSAASamples samples, bool isDefault = true)
@@ -59,6 +67,19 @@ class ForwardPass : public GraphicPass
     void set_envmap_descriptor(Graphics::Image env, Graphics::Image irr);
 
     void set_hair_scattering_map_descriptor(Graphics::Image frontAtt, Graphics::Image backAtt);
+
+    void set_hair_volume_descriptor(Graphics::Image volume, Graphics::Image bricks);
+
+    /*
+    Strands expanded into quads in the vertex shader, reading the vertex and index streams as storage buffers, instead of in
+    a geometry shader. Both paths shade the same, it is there for A/B timing. The culling pass has to be told as well.
+    */
+    inline bool get_strand_vertex_pulling() const {
+        return m_strandVertexPulling;
+    }
+    inline void set_strand_vertex_pulling(bool op) {
+        m_strandVertexPulling = op;
+    }
 };
 
 } // namespace Core
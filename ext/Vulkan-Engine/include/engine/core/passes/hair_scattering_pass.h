@@ -16,6 +16,9 @@ class HairScatteringPass : public ComputePass
 
     Graphics::Buffer m_normBuffer;
 
+    // LUT cache entry to fill once the integration has run, empty if the LUT came from the cache
+    std::string m_pendingLUTCache;
+
 
     void create_hair_scattering_images();
 
@@ -33,6 +36,11 @@ class HairScatteringPass : public ComputePass
 
     void render(Graphics::Frame& currentFrame, Scene* const scene, uint32_t presentImageIndex = 0);
 
+    /*
+    Stores the LUT integrated by the previous frame in the volume cache
+    */
+    void update_uniforms(uint32_t frameIndex, Scene* const scene);
+
     void cleanup();
 };
 
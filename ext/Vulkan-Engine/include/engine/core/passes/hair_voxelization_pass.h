@@ -33,11 +33,76 @@ class HairVoxelizationPass final : public GraphicPass
     const uint32_t   MAX_DIRECTIONS = 32;
     Graphics::Buffer m_directionsBuffer;
 
+    /*
+    Density volumes are sparse. A brick grid holds, for every ENGINE_HAIR_BRICK_SIZE^3 cell of each groom slot, its brick of
+    the pools, which are only handed out to cells segments land in. All slots take bricks from one counter, the density of
+    the cells marked once the pool is used up is dropped. The buffer holds a BrickHeader, then the cell of every pool brick.
+    The pool is sized from the grooms in the scene, and grows to what a rebuild asked for when it runs out
+    */
+    const uint32_t   POOL_SIDE       = 32;  // Bricks per row and column of the pools, as many layers as the capacity asks for
+    const uint32_t   MAX_POOL_LAYERS = 64;  // 8 MiB a layer, half a GiB at most. Lower if the memory budget is tighter
+    uint32_t         m_volumeBricks  = 0;   // Budgeted per groom
+    uint32_t         m_brickCapacity = 0;
+    uint32_t         m_poolRevision  = 0;   // Bumped every time the pool images are created again
+    bool             m_poolCapped    = false; // The last size asked for was past the cap, warned once
+    Graphics::Buffer m_brickBuffer;
+
+    // Mirrors the head of the HairBricks block of the brick shaders
+    struct BrickHeader {
+        uint32_t first[ENGINE_MAX_HAIR_VOLUMES];         // First brick of every slot
+        uint32_t dispatches[ENGINE_MAX_HAIR_VOLUMES][3]; // Indirect dispatch over the bricks of every slot
+        uint32_t requested[ENGINE_MAX_HAIR_VOLUMES];     // Marked cells of every slot
+        uint32_t allocated;                              // Keeps counting past the capacity
+    };
+    /*
+    The header of the last rebuild recorded by every frame, read back once its fence is signaled. Bricks asked for by that
+    rebuild, past the capacity if the pool was used up
+    */
+    std::vector<Graphics::Buffer> m_brickReadback;
+    std::vector<bool>             m_brickReadbackPending;
+    uint32_t                      m_requestedBricks = 0;
+
+    // Mirrors the Bricks block of allocate_hair_bricks.glsl and opticaldensity_to_count.glsl
+    struct BrickConstants {
+        Vec4  volumeAtlas    = {}; // Same as ObjectUniforms
+        float avgFiberLength = 0.0f;
+    };
+
+    /*
+    What each atlas slot was voxelized from. Volumes are in object space, so moving the groom keeps them valid. They are
+    rebuilt when the geometry is uploaded again (deformed) or the material thickness changes. The pool is handed out again
+    from its start on every rebuild, so one stale groom voxelizes all of them again
+    */
+    struct VolumeKey {
+        const void* geometry  = nullptr;
+        uint32_t    revision  = 0;
+        float       thickness = 0.0f;
+
+        inline bool operator==(const VolumeKey& other) const {
+            return geometry == other.geometry && revision == other.revision && thickness == other.thickness;
+        }
+    };
+    VolumeKey m_volumes[ENGINE_MAX_HAIR_VOLUMES];
+    bool      m_cacheVolumes   = true;
+    uint32_t  m_rebuiltVolumes = 0; // Last frame
+    uint32_t  m_cachedVolumes  = 0;
+
     void create_voxelization_image();
+    void write_volume_descriptors();
+    // Pool layers the device memory budget can take, half of what is free plus the current pool
+    uint32_t max_pool_layers() const;
+    // Waits for the device to be idle, the volumes are voxelized again
+    void resize_brick_pool(uint32_t bricks);
 
   public:
-    HairVoxelizationPass(Graphics::Device* ctx, uint32_t resolution)
-        : BasePass(ctx, {resolution, resolution}, 1, 1, false, "HAIR VOXELIZATION") {
+    /*
+    Resolution is the voxels per side of the volume of every groom, a multiple of ENGINE_HAIR_BRICK_SIZE. Volume bricks are
+    the pool bricks set aside for every groom in the scene, each one takes ENGINE_HAIR_BRICK_SIZE^3 voxels of 16 bytes. Higher
+    resolutions touch more bricks per groom
+    */
+    HairVoxelizationPass(Graphics::Device* ctx, uint32_t resolution, uint32_t volumeBricks = 4096)
+        : BasePass(ctx, {resolution, resolution}, 1, 1, false, "HAIR VOXELIZATION")
+        , m_volumeBricks(volumeBricks) {
     }
 
     void setup_attachments(std::vector<Graphics::AttachmentInfo>& attachments, std::vector<Graphics::SubPassDependency>& dependencies) override;
@@ -50,6 +115,41 @@ class HairVoxelizationPass final : public GraphicPass
 
     void update_uniforms(uint32_t frameIndex, Scene* const scene) override;
 
+    /*
+    Off, every groom is voxelized again each frame
+    */
+    inline void cache_volumes(bool op) {
+        m_cacheVolumes = op;
+    }
+    inline bool cache_volumes() const {
+        return m_cacheVolumes;
+    }
+    inline void invalidate_volumes() {
+        for (VolumeKey& key : m_volumes)
+            key = {};
+    }
+    inline uint32_t get_rebuilt_volumes() const {
+        return m_rebuiltVolumes;
+    }
+    inline uint32_t get_cached_volumes() const {
+        return m_cachedVolumes;
+    }
+    inline uint32_t get_brick_capacity() const {
+        return m_brickCapacity;
+    }
+    /*
+    Changes when the pool images are created again, passes sampling the volumes have to bind them again
+    */
+    inline uint32_t get_pool_revision() const {
+        return m_poolRevision;
+    }
+    /*
+    Bricks the last rebuild read back asked for, more than the capacity if density was dropped
+    */
+    inline uint32_t get_requested_bricks() const {
+        return m_requestedBricks;
+    }
+
     void cleanup() override;
 };
 
@@ -135,6 +135,9 @@ class BasePass
     inline std::unordered_map<uint32_t, Graphics::ShaderPass*> const get_shaderpasses() const {
         return m_shaderPasses;
     }
+    inline std::string get_name() const {
+        return m_name;
+    }
 
     /*
     Sets a table of depedencies with different passes.
@@ -152,8 +155,15 @@ class BasePass
 #pragma region Core Functions
     /*
     Setups de renderpass. Init, create framebuffers, pipelines and resources ...
+    With buildShaderPasses = false the shader passes are only configured. They have to be built before rendering, which lets
+    the renderer compile the shaders of every pass concurrently.
+    */
+    void setup(std::vector<Graphics::Frame>& frames, bool buildShaderPasses = true);
+    /*
+    Compiles the stages of one of the shader passes and creates its pipeline. Descriptor layouts must exist already. Safe to
+    call concurrently for different shader passes.
     */
-    void setup(std::vector<Graphics::Frame>& frames);
+    void build_shader_pass(Graphics::ShaderPass* shaderPass);
 
     virtual void render(Graphics::Frame& currentFrame, Scene* const scene, uint32_t presentImageIndex = 0) = 0;
 
@@ -0,0 +1,75 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#pragma once
+#include <engine/core/passes/pass.h>
+#include <engine/core/resource_manager.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Core {
+
+/*
+Culls the strand clusters of every instance batch against the camera and the shadow casting lights, compacting the survivors
+into the frame indirect draw buffers (see Graphics::StrandDrawList). Forward, shadow and voxelization passes draw from them.
+Needs Device::supports_indirect_count(), without it the frame keeps drawing whole geometries.
+*/
+class StrandCullingPass : public ComputePass
+{
+    struct FrameDescriptors {
+        Graphics::DescriptorSet globalDescritor;
+    };
+    std::vector<FrameDescriptors> m_descriptors;
+
+    bool m_strandVertexPulling = false;
+
+    // Mirrors the Culling block in strand_culling.glsl
+    struct CullingConstants {
+        uint64_t clusters        = 0;
+        uint64_t objects         = 0;
+        uint64_t commands        = 0;
+        uint64_t counts          = 0;
+        uint32_t firstCluster    = 0;
+        uint32_t clusterCount    = 0;
+        uint32_t indexLimit      = 0;
+        uint32_t firstInstance   = 0;
+        uint32_t instanceCount   = 0;
+        uint32_t firstOutput     = 0;
+        uint32_t mode            = 0; // 0 camera view, 1 shadow view
+        uint32_t pulled          = 0; // Camera view records as vertex pulled draws. 0 off, else 1 + StrandTopology
+        uint32_t firstCommand[4] = {}; // Per view
+        uint32_t capacity[4]     = {}; // Per view
+    };
+
+  public:
+    StrandCullingPass(Graphics::Device* ctx)
+        : BasePass(ctx, {1, 1}, 1, 1, false, "STRAND CULLING") {
+    }
+
+    void setup_attachments(std::vector<Graphics::AttachmentInfo>& attachments, std::vector<Graphics::SubPassDependency>& dependencies);
+
+    void setup_uniforms(std::vector<Graphics::Frame>& frames);
+
+    void setup_shader_passes();
+
+    void render(Graphics::Frame& currentFrame, Scene* const scene, uint32_t presentImageIndex = 0);
+
+    /*
+    Writes the camera view records for the vertex pulled strands of the forward pass (see
+    CommandBuffer::draw_strand_segments_indirect)
+    */
+    inline bool get_strand_vertex_pulling() const {
+        return m_strandVertexPulling;
+    }
+    inline void set_strand_vertex_pulling(bool op) {
+        m_strandVertexPulling = op;
+    }
+};
+
+} // namespace Core
+VULKAN_ENGINE_NAMESPACE_END
@@ -21,7 +21,9 @@
 
 #include <engine/graphics/device.h>
 
+#include <engine/tools/environment_cache.h>
 #include <engine/tools/loaders.h>
+#include <engine/tools/volume_cache.h>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
@@ -41,6 +43,11 @@ class ResourceManager
     static Core::PanoramaConverterPass*  panoramaConverterPass;
     static Core::IrrandianceComputePass* irradianceComputePass;
     /*
+    Skybox maps read from the environment cache, they replace the auxiliar passes outputs when loaded
+    */
+    static Graphics::Image CACHED_ENV_CUBEMAP;
+    static Graphics::Image CACHED_IRRADIANCE_CUBEMAP;
+    /*
     Texture Resources
     */
     static Core::Texture*    FALLBACK_TEXTURE;
@@ -53,6 +60,7 @@ class ResourceManager
     static Graphics::Image   HAIR_VOXEL_VOLUME;
     static Graphics::Image   HAIR_PERECEIVED_DENSITY_VOLUME;
     static Graphics::Image   HAIR_VOXEL_VOLUME_2;
+    static Graphics::Image   HAIR_BRICK_GRID;
     static Graphics::Image   HAIR_NG;
     static Graphics::Image   HAIR_NG_TRT;
     static Graphics::Image   HAIR_BACK_SHIFTS;
@@ -90,7 +98,10 @@ class ResourceManager
     /*
     Upload geometry vertex buffers to the GPU
     */
-    static void upload_geometry_data(Graphics::Device* const device, Core::Geometry* const g, bool createAccelStructure = true);
+    static void upload_geometry_data(Graphics::Device* const device,
+                                     Core::Geometry* const   g,
+                                     bool                    createAccelStructure = true,
+                                     VertexLayoutType        layout               = CANONICAL_VERTEX_LAYOUT);
     static void destroy_geometry_data(Core::Geometry* const g);
     /*
     Setup skybox
@@ -98,6 +109,11 @@ class ResourceManager
     static void setup_skybox(Graphics::Device* const device, Core::Scene* const scene);
     static void generate_skybox_maps(Graphics::Frame* const currentFrame, Core::Scene* const scene);
     /*
+    Environment and irradiance cubemaps of the current skybox, whether cached or generated
+    */
+    static Graphics::Image get_env_cubemap();
+    static Graphics::Image get_irradiance_cubemap();
+    /*
     Scene cleanup
     */
     static void clean_scene(Core::Scene* const scene);
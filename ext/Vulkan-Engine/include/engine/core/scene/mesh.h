@@ -61,6 +61,10 @@ struct BoundingSphere : public BVolume {
     virtual void setup(Mesh* const mesh);
 
     virtual bool is_on_frustrum(const Frustum& frustum) const;
+    /*
+    Projected diameter as a fraction of the viewport height. Infinite if the eye is inside.
+    */
+    float get_screen_coverage(const Vec3& eye, float fieldOfView) const;
 };
 struct AABB : public BVolume {
 
@@ -170,12 +174,14 @@ class Mesh : public Object3D
 
     inline void cast_shadows(bool op) {
         m_castShadows = op;
+        m_revision++;
     }
     inline bool cast_shadows() const {
         return m_castShadows;
     }
     inline void receive_shadows(bool op) {
         m_receiveShadows = op;
+        m_revision++;
     }
     inline IMaterial* set_debug_material(size_t id = 0) {
         IMaterial* m   = get_material(id);
@@ -187,6 +193,7 @@ class Mesh : public Object3D
     }
     inline void affected_by_fog(bool op) {
         m_affectedByFog = op;
+        m_revision++;
     }
     inline bool affected_by_fog() const {
         return m_affectedByFog;
@@ -225,6 +232,7 @@ class Mesh : public Object3D
         }
 
         m_volume->setup(this);
+        m_revision++;
     }
 
     inline const BV* const get_bounding_volume() const {
@@ -57,6 +57,16 @@ class Object3D
     bool enabled;
     bool m_isSelected{false};
     bool isDirty{true};
+    uint32_t m_revision{0};
+
+    /*
+    Flags the transform for recomputation. The revision is bumped as well
+    */
+    inline void mark_dirty()
+    {
+        isDirty = true;
+        m_revision++;
+    }
 
   public:
     Object3D(const std::string na, ObjectType t) : TYPE(t), m_name(na), enabled(true), m_parent(nullptr)
@@ -98,7 +108,7 @@ class Object3D
     virtual void set_position(const Vec3 p)
     {
         m_transform.position = p;
-        isDirty = true;
+        mark_dirty();
     }
 
     virtual inline Vec3 get_position()
@@ -124,7 +134,7 @@ class Object3D
         // Update UP
         m_transform.up = math::cross(m_transform.right, m_transform.forward);
 
-        isDirty = true;
+        mark_dirty();
     }
 
     virtual inline Vec3 get_rotation(bool radians = false)
@@ -135,13 +145,13 @@ class Object3D
     virtual void set_scale(const Vec3 s)
     {
         m_transform.scale = s;
-        isDirty = true;
+        mark_dirty();
     }
 
     virtual void set_scale(const float s)
     {
         m_transform.scale = Vec3(s);
-        isDirty = true;
+        mark_dirty();
     }
 
     virtual inline Vec3 get_scale()
@@ -157,7 +167,7 @@ class Object3D
     virtual inline void set_active(const bool s)
     {
         enabled = s;
-        isDirty = true;
+        mark_dirty();
         for (Object3D *child : m_children)
             child->set_active(s);
     }
@@ -191,6 +201,14 @@ class Object3D
     {
         return isDirty;
     }
+    /*
+    Incremented on every change of the object or its parents. Unlike the dirty flag it is never reset, so consumers keeping
+    their own copies (e.g. per frame uniform buffers) can tell whether theirs is stale.
+    */
+    virtual inline uint32_t get_revision() const
+    {
+        return m_parent ? m_revision + m_parent->get_revision() : m_revision;
+    }
 
     virtual inline std::string get_name()
     {
@@ -205,7 +223,7 @@ class Object3D
     virtual void set_transform(Transform t)
     {
         m_transform = t;
-        isDirty = true;
+        mark_dirty();
     }
 
     virtual Mat4 get_model_matrix()
@@ -230,6 +248,7 @@ class Object3D
     virtual void add_child(Object3D *child)
     {
         child->m_parent = this;
+        child->m_revision++;
         m_children.push_back(child);
     }
 
@@ -253,6 +272,7 @@ class Object3D
     inline void set_selected(bool op)
     {
         m_isSelected = op;
+        m_revision++;
     }
 
     virtual Object3D *get_parent() const
@@ -35,8 +35,10 @@ class ITexture
   protected:
     TextureSettings m_settings{};
 
-    Graphics::Image m_image{};
-    uint16_t        m_channels{0};
+    Graphics::Image                     m_image{};
+    uint16_t                            m_channels{0};
+    std::shared_ptr<Graphics::MipChain> m_mipChain;
+    std::string                         m_fileRoute;
 
     bool m_isDirty{true};
 
@@ -64,6 +66,17 @@ class ITexture
 
     virtual inline size_t get_bytes_per_pixel() const = 0;
 
+    /*
+    Precomputed levels (see Tools::TextureCache), uploaded as they are. Level 0 also backs the image cache.
+    */
+    inline void set_mip_chain(std::shared_ptr<Graphics::MipChain> chain, Extent3D extent, uint16_t channels) {
+        set_image_cache(chain->data.data() + chain->levels[0].offset, extent, channels);
+        m_mipChain = std::move(chain);
+    }
+    inline const std::shared_ptr<Graphics::MipChain>& get_mip_chain() const {
+        return m_mipChain;
+    }
+
     // GETTERS & SETTERS
 
     inline bool loaded_on_CPU() const {
@@ -116,6 +129,13 @@ class ITexture
     inline void set_adress_mode(AddressMode am) {
         m_settings.adressMode = am;
     }
+    // Source file, empty for procedural textures
+    inline std::string get_file_route() const {
+        return m_fileRoute;
+    }
+    inline void set_file_route(std::string r) {
+        m_fileRoute = r;
+    }
     inline void set_type(TextureTypeFlagBits t) {
         m_settings.type = t;
     }
@@ -0,0 +1,66 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef WINDOW_HEADLESS_H
+#define WINDOW_HEADLESS_H
+
+#include <chrono>
+#include <engine/core/windows/window.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Core {
+/**
+ * Window-less "window". There is no surface nor input: the renderer draws into offscreen images of the given extent, which
+ * can be read back with BaseRenderer::capture(). Meant for batch rendering on machines without a display (or GPU, through a
+ * software driver like lavapipe).
+ */
+class WindowHeadless : public IWindow
+{
+  private:
+    std::chrono::high_resolution_clock::time_point m_startTime;
+    bool                                           m_shouldClose{false};
+
+  public:
+    WindowHeadless(const std::string t, uint32_t w, uint32_t h)
+        : IWindow(t, w, h, false, false) {
+    }
+
+    void init();
+
+    inline void destroy() {
+        m_initialized = false;
+    }
+    inline void get_handle(void*& handlePtr) const {
+        handlePtr = nullptr;
+    }
+    inline WindowingSystem get_windowing_system() const {
+        return WindowingSystem::HEADLESS;
+    }
+    inline int get_window_should_close() const {
+        return m_shouldClose;
+    }
+    inline void set_window_should_close(bool op) {
+        m_shouldClose = op;
+    }
+    inline void set_fullscreen(bool t) {
+    }
+    inline void update_framebuffer() {
+    }
+    inline void poll_events() {
+    }
+    inline void set_window_icon(const char* iconPath) {
+    }
+
+    double get_time_elapsed();
+};
+
+} // namespace Core
+
+VULKAN_ENGINE_NAMESPACE_END
+#endif
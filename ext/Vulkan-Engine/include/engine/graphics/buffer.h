@@ -24,6 +24,7 @@ struct Buffer {
     /*IF Memory allocation is controlled by VMA*/
     VmaAllocator  allocator  = VK_NULL_HANDLE;
     VmaAllocation allocation = VK_NULL_HANDLE;
+    void*         mappedData = nullptr; // Set if the allocation is persistently mapped. Uploads write straight into it
     /*IF using Vulkan API*/
     VkDevice       device    = VK_NULL_HANDLE;
     VkDeviceMemory memory    = VK_NULL_HANDLE;
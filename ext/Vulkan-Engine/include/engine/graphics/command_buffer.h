@@ -34,7 +34,10 @@ struct CommandBuffer {
     void begin(VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
     void end();
     void reset();
-    void submit(Fence fence = {}, std::vector<Semaphore> waitSemaphores = {}, std::vector<Semaphore> signalSemaphores = {});
+    void submit(Fence                  fence            = {},
+                std::vector<Semaphore> waitSemaphores   = {},
+                std::vector<Semaphore> signalSemaphores = {},
+                TimelineWait           timelineWait     = {});
     void cleanup();
 
     /****************************************** */
@@ -44,6 +47,31 @@ struct CommandBuffer {
     void begin_renderpass(RenderPass& renderpass, Framebuffer& fbo, VkSubpassContents subpassContents = VK_SUBPASS_CONTENTS_INLINE);
     void end_renderpass(RenderPass& renderpass, Framebuffer& fbo);
     void draw_geometry(VertexArrays& vao, uint32_t instanceCount = 1, uint32_t firstOcurrence = 0, int32_t offset = 0, uint32_t firstInstance = 0);
+    /*
+    Draws a range of a strand level of detail. Level 0 reads the regular IBO, the rest the LOD one.
+    */
+    void draw_geometry_LOD(VertexArrays& vao, uint32_t level, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+    /*
+    Draws a strand level of detail from VkDrawIndexedIndirectCommand records written on the GPU, as many as the count stored
+    at countOffset (up to maxDrawCount). Needs VK_KHR_draw_indirect_count.
+    */
+    void draw_geometry_indirect(VertexArrays& vao,
+                                uint32_t      level,
+                                Buffer&       commands,
+                                size_t        offset,
+                                Buffer&       counts,
+                                size_t        countOffset,
+                                uint32_t      maxDrawCount);
+    /*
+    Draws a segment slot range of a strand index stream with vertex pulling, STRAND_PULLED_SEGMENT_VERTICES per slot (see
+    strand_segment_count). Nothing is bound, the shader reads the buffers in StrandUniforms.
+    */
+    void draw_strand_segments(uint32_t firstSegment, uint32_t segmentCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+    /*
+    Vertex pulled counterpart of draw_geometry_indirect. Records keep the stride of VkDrawIndexedIndirectCommand but hold a
+    VkDrawIndirectCommand, the culling pass writes them this way for the camera view when asked.
+    */
+    void draw_strand_segments_indirect(Buffer& commands, size_t offset, Buffer& counts, size_t countOffset, uint32_t maxDrawCount);
     void draw_gui_data();
     void bind_shaderpass(ShaderPass& pass);
     void bind_descriptor_set(DescriptorSet         descriptor,
@@ -57,6 +85,10 @@ struct CommandBuffer {
     void set_depth_test_enable(bool op);
     void set_depth_bias_enable(bool op);
     void set_depth_bias(float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor);
+    /*
+    Line list, or line strip with primitive restart. Needs a line pipeline with dynamic primitive topology and restart.
+    */
+    void set_strand_topology(StrandTopology topology);
 
     void pipeline_barrier(Image&        img,
                           ImageLayout   oldLayout = LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -105,6 +137,16 @@ struct CommandBuffer {
     void push_constants(ShaderPass& pass, ShaderStageFlags stage, const void* data, uint32_t size, uint32_t offset = 0);
 
     void dispatch_compute(Extent3D grid);
+    /*Grid read from a VkDispatchIndirectCommand stored in the buffer*/
+    void dispatch_compute_indirect(Buffer& args, size_t offset = 0);
+    /*Fills a range of the buffer with a repeated 32 bit value. Offset and size must be multiples of 4*/
+    void fill_buffer(Buffer& buffer, uint32_t value, size_t offset = 0, size_t size = VK_WHOLE_SIZE);
+    /*Copies a range of one buffer into another*/
+    void copy_buffer(Buffer& srcBuffer, Buffer& dstBuffer, size_t size, size_t srcOffset = 0, size_t dstOffset = 0);
+    /*Resets a range of queries. Has to be recorded before they are written again*/
+    void reset_queries(VkQueryPool pool, uint32_t firstQuery, uint32_t queryCount);
+    /*Writes the GPU clock once every previous command has reached the given stage*/
+    void write_timestamp(VkQueryPool pool, uint32_t query, PipelineStage stage = STAGE_BOTTOM_OF_PIPE);
 
     /*
  Generates mipmaps for a given image following a downsampling by 2 strategy
@@ -17,7 +17,9 @@
 #include <engine/graphics/frame.h>
 #include <engine/graphics/framebuffer.h>
 #include <engine/graphics/renderpass.h>
+#include <engine/graphics/shaderpass.h>
 #include <engine/graphics/swapchain.h>
+#include <engine/graphics/upload_queue.h>
 #include <engine/graphics/utilities/bootstrap.h>
 #include <engine/graphics/utilities/initializers.h>
 #include <engine/graphics/utilities/utils.h>
@@ -55,13 +57,29 @@ class Device
                                              VK_KHR_RAY_QUERY_EXTENSION_NAME};
     // Utils
     Utils::UploadContext      m_uploadContext = {};
+    UploadQueue               m_uploadQueue   = {};
     Utils::QueueFamilyIndices m_queueFamilies = {};
+    ComputeShaderPass*        m_positionsPass = nullptr; // Derives the positions SSBO from the VBO. Built on first use
+    // Headless
+    bool     m_headless       = false; // Renders into offscreen images instead of a surface
+    uint32_t m_offscreenIndex = 0;
 #ifdef NDEBUG
     const bool m_enableValidationLayers{false};
 #else
     const bool m_enableValidationLayers{true};
 #endif
 
+    struct PositionExtraction {
+        uint64_t vertices;  // VBO address
+        uint64_t positions; // Positions SSBO address
+        uint32_t count;
+        uint32_t stride; // In floats
+    };
+    /*
+    Records the compute pass filling vao.posSSBO from vao.vbo, right after the VBO copy.
+    */
+    void derive_positions(VertexArrays& vao);
+
   public:
     /*
     GETTERS
@@ -74,11 +92,21 @@ class Device
     inline Swapchain get_swapchain() const {
         return m_swapchain;
     }
+    inline bool is_headless() const {
+        return m_headless;
+    }
+    /*
+    Indirect draws with a GPU written count, many of them per call and with a first instance. GPU driven passes need it
+    */
+    inline bool supports_indirect_count() const {
+        return vkCmdDrawIndexedIndirectCountFn && vkCmdDrawIndirectCountFn && m_features.multiDrawIndirect && m_features.drawIndirectFirstInstance;
+    }
 
     /*
     INIT AND SHUTDOWN
     -----------------------------------------------
     */
+    /*A HEADLESS windowing system takes no window handle and renders into offscreen images of surfaceExtent*/
     void init(void*           windowHandle,
               WindowingSystem windowingSystem,
               Extent2D        surfaceExtent,
@@ -96,9 +124,12 @@ class Device
     -----------------------------------------------
     */
 
-    /*Create Buffer using Vulkan Memory Allocator (VMA)*/
-    Buffer
-    create_buffer_VMA(size_t allocSize, BufferUsageFlags usage, VmaMemoryUsage memoryUsage, uint32_t strideSize = 0);
+    /*Create Buffer using Vulkan Memory Allocator (VMA). Persistently mapped buffers skip the map/unmap on every upload*/
+    Buffer create_buffer_VMA(size_t           allocSize,
+                             BufferUsageFlags usage,
+                             VmaMemoryUsage   memoryUsage,
+                             uint32_t         strideSize         = 0,
+                             bool             persistentlyMapped = false);
     /*Create Buffer*/
     Buffer create_buffer(size_t              allocSize,
                          BufferUsageFlags    usage,
@@ -117,6 +148,8 @@ class Device
     /*Create Frame. A frame is a data structure that contains the objects needed for synchronize each frame rendered and
      * buffers to contain data needed for the GPU to render*/
     Frame create_frame(uint16_t id);
+    /*Create a timestamp pool for pairCount timed passes. Empty if the graphics queue cannot write timestamps*/
+    TimestampPool create_timestamp_pool(uint32_t pairCount);
     /*Create RenderPass*/
     RenderPass create_render_pass(std::vector<AttachmentInfo>& attachments, std::vector<SubPassDependency>& dependencies);
     /*Create Descriptor Pool*/
@@ -158,6 +191,10 @@ class Device
     /*
     DATA TRANSFER
     -----------------------------------------------
+    Vertex arrays and textures are staged in the upload queue and copied asynchronously. Frames started after the call can
+    already use them, submit_frame() makes the GPU wait for the copies. Source data can be released once the call returns.
+
+    For canonical vertex arrays, a posSize with no posData derives the positions SSBO from the VBO on the GPU.
     */
     void upload_vertex_arrays(VertexArrays& vao,
                               size_t        vboSize,
@@ -167,24 +204,56 @@ class Device
                               size_t        posSize = 0,
                               const void*   posData = nullptr,
                               size_t        voxelSize = 0,
-                              const void*   voxelData = nullptr);
+                              const void*   voxelData = nullptr,
+                              size_t        strandSize = 0,
+                              const void*   strandData = nullptr);
+    /*
+    Index stream of the simplified strand levels, into vao.lodIbo, and the culling clusters of every level, into
+    vao.clusterSSBO
+    */
+    void upload_strand_LODs(VertexArrays& vao, size_t indexSize, const void* indexData, size_t clusterSize = 0, const void* clusterData = nullptr);
     void upload_texture_image(Image&        img,
                               ImageConfig   config,
                               SamplerConfig samplerConfig,
                               const void*   imgCache,
                               size_t        bytesPerPixel,
                               bool          mipmapping);
+    /*
+    Uploads the first levelCount levels of a precomputed chain in a single transfer. Returns false, creating nothing, if the GPU
+    can not sample the format (e.g. block compression not supported).
+    */
+    bool upload_texture_image(Image& img, ImageConfig config, SamplerConfig samplerConfig, const MipChain& chain, uint32_t levelCount);
+    /*
+    Fills mip 0 of every layer of an image created elsewhere (e.g. a storage image a pass owns), which keeps its usage and
+    sampler. The image must have TRANSFER_DST usage and ends up in SHADER_READ_ONLY layout.
+    */
+    void upload_image_data(Image& img, const void* data, size_t size, size_t texelSize);
     void upload_BLAS(BLAS& accel, VAO& vao);
     void upload_TLAS(TLAS& accel, std::vector<BLASInstance>& BLASinstances);
     /*
+    Reads a presentable (or headless offscreen) image back to the CPU, texels in the present format order. Blocks until the
+    copy is done, so the frame that rendered it must have been submitted.
+    */
+    void download_present_image(uint32_t imageIndex, std::vector<uint8_t>& pixels);
+    /*
+    Reads mip 0 of every layer of a shader readable image back to the CPU, layers packed one after another (the layout
+    upload_texture_image expects). The image needs TRANSFER_SRC usage. Blocks until the copy is done.
+    */
+    void download_image(Image& img, size_t texelSize, std::vector<uint8_t>& data);
+    /*
     MISC
     -----------------------------------------------
     */
+    /*Waits for the GPU to be idle, pending uploads included*/
     void     wait();
+    /*Blocks until every upload issued so far is visible to the graphics queue*/
+    void     sync_uploads();
     void     wait_queue(QueueType queueType);
     void     init_imgui(void* windowHandle, WindowingSystem windowingSystem, RenderPass renderPass, uint16_t samples);
     void     destroy_imgui();
     uint32_t get_memory_type(uint32_t typeBits, MemoryPropertyFlags properties, uint32_t* memTypeFound = nullptr);
+    /*Bytes the VMA budget still leaves free in the largest device local heap*/
+    VkDeviceSize get_device_local_budget() const;
     /*
     Returns the size of the data having in mind the minimun alginment size per stride in the GPU
     */
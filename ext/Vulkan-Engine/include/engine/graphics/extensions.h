@@ -30,6 +30,8 @@ extern PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructure
 extern PFN_vkCmdBuildAccelerationStructuresKHR        vkCmdBuildAccelerationStructures;
 extern PFN_vkBuildAccelerationStructuresKHR           vkBuildAccelerationStructures;
 extern PFN_vkSetDebugUtilsObjectNameEXT               vkSetDebugUtilsObjectName;
+extern PFN_vkCmdDrawIndexedIndirectCountKHR           vkCmdDrawIndexedIndirectCountFn; // The core name is already a prototype
+extern PFN_vkCmdDrawIndirectCountKHR                  vkCmdDrawIndirectCountFn;
 
 void load_extensions(VkDevice& device, VkInstance& instance);
 
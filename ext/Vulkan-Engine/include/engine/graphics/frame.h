@@ -18,6 +18,86 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 
 namespace Graphics {
 
+/*
+Last content written on an object uniform slot. Lets unchanged slots be skipped.
+*/
+struct UniformSlot {
+    const void* object           = nullptr;
+    uint32_t    revision         = 0;
+    const void* material         = nullptr;
+    uint32_t    materialRevision = 0;
+    uint32_t    hairVolume       = UINT32_MAX; // Atlas slot the object data points at
+};
+/*
+Uniform buffer writes of a frame
+*/
+struct UniformStats {
+    size_t   bytesWritten     = 0;
+    uint32_t objectsWritten   = 0;
+    uint32_t materialsWritten = 0;
+    uint32_t slotsSkipped     = 0; // Object or material slots already up to date
+};
+
+/*
+Meshes sharing geometry and materials, drawn with a single instanced call. Instances read their object data from the frame
+object table, starting at firstInstance.
+*/
+struct InstanceBatch {
+    uint32_t meshIndex      = 0; // Mesh issuing the draw, the first one of the group in scene order
+    uint32_t firstInstance  = 0;
+    uint32_t instanceCount  = 0;
+    float    screenCoverage = 0.0f;  // Largest projected bounding sphere diameter of the group, as a fraction of the viewport height
+    bool     inFrustum      = false; // Some member is inside the camera frustum. Shadow casters are batched even if none is
+    uint32_t firstDraw      = 0;     // Strand draw list of each geometry of the issuing mesh, see Frame::strandDraws
+};
+#define NO_INSTANCE_BATCH UINT32_MAX
+#define NO_HAIR_VOLUME UINT32_MAX
+
+/*
+Views the strand culling pass compacts surviving clusters for. The camera one culls the selected level of detail, the shadow
+one level 0 against the union of the shadow casting light frusta.
+*/
+typedef enum StrandView
+{
+    STRAND_CAMERA_VIEW = 0,
+    STRAND_SHADOW_VIEW = 1,
+    STRAND_VIEW_COUNT  = 2,
+} StrandView;
+/*
+Culled draw of a batch geometry. Every view gets a range of VkDrawIndexedIndirectCommand records in Frame::strandCommands and
+a count in Frame::strandCounts. A zero capacity means the view is drawn directly.
+*/
+struct StrandDrawList {
+    uint32_t level                           = 0; // Level of detail drawn by the camera view
+    uint32_t firstIndex                      = 0;
+    uint32_t indexCount                      = 0; // Zero draws the whole geometry
+    float    widthScale                      = 1.0f;
+    uint32_t firstOutput                     = 0; // Count of the camera view, the other views follow
+    uint32_t firstCommand[STRAND_VIEW_COUNT] = {};
+    uint32_t capacity[STRAND_VIEW_COUNT]     = {};
+
+    inline uint32_t output(StrandView view) const {
+        return firstOutput + view;
+    }
+};
+
+/*
+Timestamp queries of a frame, a begin and end pair per timed pass. Populated by the device with create_timestamp_pool()
+*/
+struct TimestampPool {
+    VkQueryPool           handle   = VK_NULL_HANDLE;
+    VkDevice              device   = VK_NULL_HANDLE;
+    uint32_t              capacity = 0;    // In pairs
+    float                 period   = 0.0f; // Nanoseconds per tick
+    std::vector<uint32_t> passes;          // Pass timed by every pair written in the last recording
+
+    /*
+    Milliseconds between the two timestamps of every pair written. Call once the frame fence is signaled
+    */
+    bool read(std::vector<double>& milliseconds) const;
+    void cleanup();
+};
+
 struct Frame {
     // Control
     Semaphore presentSemaphore = {};
@@ -28,9 +108,23 @@ struct Frame {
     CommandBuffer commandBuffer        = {};
     CommandPool   computeCommandPool   = {};
     CommandBuffer computeCommandBuffer = {};
-    // Uniforms
-    std::vector<Buffer> uniformBuffers;
-    uint32_t            index = 0;
+    // Uniforms (persistently mapped)
+    std::vector<Buffer>      uniformBuffers;
+    std::vector<UniformSlot> objectSlots;
+    UniformStats             uniformStats = {};
+    uint32_t                 index        = 0;
+    // Object table (persistently mapped storage buffer, grows on demand)
+    Buffer                     objectTable = {};
+    std::vector<InstanceBatch> instanceBatches;
+    std::vector<uint32_t>      meshBatches; // Batch of each scene mesh, or NO_INSTANCE_BATCH
+    std::vector<uint32_t>      hairVolumes; // Hair volume atlas slot of each scene mesh, or NO_HAIR_VOLUME
+    // Culled strand draws (written by the strand culling pass, grow on demand)
+    Buffer                      strandCommands = {};
+    Buffer                      strandCounts   = {}; // uvec4 {count, 1, 1, 0} per output, also valid dispatch arguments
+    std::vector<StrandDrawList> strandDraws;
+    bool                        strandsCulled = false; // Set once the culling pass has filled the buffers this frame
+    // GPU pass timings, only if enabled in the renderer settings
+    TimestampPool timestamps = {};
 
     void cleanup();
 
@@ -40,6 +40,20 @@ struct SamplerConfig {
     BorderColor border             = BorderColor::FLOAT_OPAQUE_WHITE;
 };
 
+/*
+Every level of a 2D texture packed in a single buffer, ready to be copied in one go. Levels are 16 byte aligned and may be
+stored in any order.
+*/
+struct MipLevel {
+    size_t   offset = 0;
+    size_t   size   = 0;
+    Extent3D extent = {1, 1, 1};
+};
+struct MipChain {
+    std::vector<uint8_t>  data;
+    std::vector<MipLevel> levels;
+};
+
 struct Image {
 
     VkImage         handle        = VK_NULL_HANDLE;
@@ -66,7 +80,18 @@ struct Image {
 
     void create_GUI_handle();
 
-    void upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer);
+    /*
+    Records the copy of the staged texels into mip 0 of every layer. Layers are packed one after another starting at
+    bufferOffset (bufferSize = 0 takes the whole staging buffer). With readable = false the image stays in TRANSFER_DST
+    layout, so another queue can finish it.
+    */
+    void upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer, size_t bufferOffset = 0, size_t bufferSize = 0, bool readable = true);
+
+    /*
+    Records the copy of the first mipLevels levels of a staged chain, all of them in a single command. The chain data starts
+    at bufferOffset.
+    */
+    void upload_mip_chain(VkCommandBuffer& cmd, Buffer* stagingBuffer, size_t bufferOffset, const MipChain& chain, bool readable = true);
 
     void generate_mipmaps(VkCommandBuffer& cmd);
 
@@ -26,6 +26,7 @@ struct PipelineSettings {
 // GRAPHIC PIPELINE SETTINGS
 struct GraphicPipelineSettings {
     std::unordered_map<int, bool>                    attributes;
+    VertexLayoutType                                 vertexLayout     = CANONICAL_VERTEX_LAYOUT;
     VkPrimitiveTopology                              topology         = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     VkPolygonMode                                    poligonMode      = VK_POLYGON_MODE_FILL;
     VkCullModeFlagBits                               cullMode         = VK_CULL_MODE_NONE;
@@ -30,6 +30,16 @@ struct Semaphore
     void cleanup();
 };
 
+/*
+GPU side wait on a timeline semaphore value. Used to make a submission depend on an asynchronous upload batch
+*/
+struct TimelineWait
+{
+    VkSemaphore          handle = VK_NULL_HANDLE;
+    uint64_t             value  = 0;
+    VkPipelineStageFlags stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
 /*
 To be populated by device class with create_fence()
 */
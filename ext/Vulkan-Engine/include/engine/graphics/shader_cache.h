@@ -0,0 +1,76 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <engine/common.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+/*
+Preprocessor macros passed to shaderc. Ordered so they hash the same regardless of insertion order.
+*/
+typedef std::map<std::string, std::string> ShaderDefines;
+
+/*
+On-disk caches that make shader setup almost free after the first run.
+
+SPIR-V binaries are content addressed: the key hashes the preprocessed source (includes already inlined), the stage, the
+optimization level and the defines, so editing a shader or any of its includes simply misses. Each entry is a plain .spv file
+named after its key.
+
+The VkPipelineCache lives in the same directory and is written back on shutdown. Data saved by a different driver or GPU is
+discarded on load.
+*/
+namespace ShaderCache {
+
+#ifndef ENGINE_SHADER_CACHE_PATH
+#define ENGINE_SHADER_CACHE_PATH ENGINE_RESOURCES_PATH "cache/shaders/"
+#endif
+#define SHADER_CACHE_VERSION 1
+#define PIPELINE_CACHE_FILE "pipelines.bin"
+
+/*
+Directory holding both caches. An empty path disables them.
+*/
+void               set_directory(const std::string& directory);
+const std::string& get_directory();
+
+uint64_t hash(const std::string& source, shaderc_shader_kind kind, shaderc_optimization_level optimization, const ShaderDefines& defines);
+/*
+Returns false on a miss or if the cached binary is not valid SPIR-V
+*/
+bool load(uint64_t key, std::vector<uint32_t>& spirv);
+/*
+Writes through a temporary file so concurrent compilations never see partial entries
+*/
+void store(uint64_t key, const std::vector<uint32_t>& spirv);
+
+/*
+Creates the pipeline cache, seeded with the data persisted by a previous run on the same GPU and driver
+*/
+void init_pipeline_cache(VkDevice device, const VkPhysicalDeviceProperties& gpuProperties);
+/*
+Persists and destroys the pipeline cache
+*/
+void cleanup_pipeline_cache();
+/*
+VK_NULL_HANDLE before init, which is a valid (uncached) argument for pipeline creation
+*/
+VkPipelineCache get_pipeline_cache();
+
+} // namespace ShaderCache
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
@@ -11,6 +11,7 @@
 
 #include <engine/graphics/pipeline.h>
 #include <engine/graphics/renderpass.h>
+#include <engine/graphics/shader_cache.h>
 #include <engine/graphics/utilities/translator.h>
 
 #include <unordered_map>
@@ -38,10 +39,14 @@ struct ShaderSource {
 
     static ShaderSource read_file(const std::string& filePath);
 
+    /*
+    Looks the SPIR-V up in the shader cache first. Fresh compilations are stored back.
+    */
     static std::vector<uint32_t> compile_shader(const std::string          src,
                                                 const std::string          shaderName,
                                                 shaderc_shader_kind        kind,
-                                                shaderc_optimization_level optimization);
+                                                shaderc_optimization_level optimization,
+                                                const ShaderDefines&       defines = {});
 
     static ShaderStage
     create_shader_stage(VkDevice device, VkShaderStageFlagBits stageType, const std::vector<uint32_t> code);
@@ -59,6 +64,7 @@ struct BaseShaderPass {
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 
     PipelineSettings settings = {};
+    ShaderDefines    defines  = {}; // Preprocessor macros for every stage
 
     BaseShaderPass(VkDevice _device, const std::string shaderFile, QueueType type)
         : filePath(shaderFile)
@@ -84,6 +90,7 @@ struct GraphicShaderPass : public ShaderPass {
     GraphicPipelineSettings  graphicSettings = {};
     RenderPass*              renderpass      = nullptr;
     Extent2D                 extent          = {0, 0};
+    ShaderStageFlags         stages          = SHADER_STAGE_ALL_GRAPHICS; // Sections of the file that get compiled
 
     GraphicShaderPass(VkDevice _device, RenderPass& renderPass, Extent2D _extent, const std::string shaderFile)
         : ShaderPass(_device, shaderFile, GRAPHIC_QUEUE)
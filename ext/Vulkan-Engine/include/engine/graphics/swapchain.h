@@ -19,9 +19,9 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 namespace Graphics {
 class Swapchain
 {
-    VkSwapchainKHR             m_handle;
-    VkDevice                   m_device;
-    VkSurfaceKHR               m_surface;
+    VkSwapchainKHR             m_handle  = VK_NULL_HANDLE;
+    VkDevice                   m_device  = VK_NULL_HANDLE;
+    VkSurfaceKHR               m_surface = VK_NULL_HANDLE;
     VkFormat                   m_presentFormat;
     VkPresentModeKHR           m_presentMode;
     std::vector<Image>         m_presentImages;
@@ -47,8 +47,20 @@ class Swapchain
                 uint32_t          imageCount             = 2,
                 VkFormat          userDefinedcolorFormat = VK_FORMAT_B8G8R8A8_SRGB,
                 VkPresentModeKHR  userDefinedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR);
+    /*
+    Headless replacement for the swapchain: plain color images, readable through transfers, which the renderer cycles through
+    as if they were presentable. They are still left in PRESENT_SRC layout by the last pass.
+    */
+    void create_offscreen(VmaAllocator allocator,
+                          VkDevice&    device,
+                          VkExtent2D   extent,
+                          uint32_t     imageCount = 2,
+                          VkFormat     colorFormat = VK_FORMAT_B8G8R8A8_SRGB);
     void cleanup();
 
+    inline bool is_offscreen() const {
+        return m_initialized && m_handle == VK_NULL_HANDLE;
+    }
     inline VkSwapchainKHR& get_handle() {
         return m_handle;
     }
@@ -59,6 +59,8 @@ struct ObjectUniforms {
     Vec4 minCoord; // x is selected // is affected by ambient light
     Vec4 otherParams1; // x is affected by fog, y is receive shadows, z cast shadows
     Vec4 otherParams2; // x is selected // is affected by ambient light
+    Vec4 volumeAtlas;  // x is the hair volume atlas slot (negative if none), y the slot count
+    Mat4 normalMatrix; // Inverse transpose of model. Only read from the object table, UBO blocks stop before it
 };
 
 struct MaterialUniforms {
@@ -0,0 +1,138 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef UPLOAD_QUEUE_H
+#define UPLOAD_QUEUE_H
+
+#include <deque>
+#include <engine/graphics/buffer.h>
+#include <engine/graphics/image.h>
+#include <engine/graphics/semaphore.h>
+#include <functional>
+
+#define UPLOAD_RING_SIZE (64u << 20)
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+/*
+Batched asynchronous GPU uploads.
+
+Data is staged in a persistently mapped ring buffer and every copy requested between two flushes is recorded into a single
+command buffer, submitted to the dedicated transfer queue (or the graphics queue if the GPU has none). Completion is tracked
+with a timeline semaphore: frames wait on it on the GPU side, the CPU only blocks when the ring runs out of space.
+
+When transfers run on their own queue family, resources are released by the transfer queue and acquired by the next graphics
+command buffer that calls record_graphics_work(). Mipmap generation, which needs blits, happens there too.
+*/
+class UploadQueue
+{
+    struct Batch {
+        VkCommandBuffer cmd   = VK_NULL_HANDLE;
+        uint64_t        value = 0; // Timeline value signaled when the batch completes
+    };
+    struct RingRegion {
+        size_t   size; // Bytes consumed by a batch, alignment and wrap padding included
+        uint64_t value;
+    };
+    struct RetiredBuffer {
+        Buffer   buffer; // Dedicated staging for uploads that do not fit in the ring
+        uint64_t value;
+    };
+
+    VkDevice      m_device         = VK_NULL_HANDLE;
+    VmaAllocator  m_allocator      = VK_NULL_HANDLE;
+    VkQueue       m_queue          = VK_NULL_HANDLE;
+    uint32_t      m_family         = 0;
+    uint32_t      m_graphicsFamily = 0;
+    VkCommandPool m_pool           = VK_NULL_HANDLE;
+    VkSemaphore   m_timeline       = VK_NULL_HANDLE;
+    uint64_t      m_submittedValue = 0;
+    // Staging ring
+    Buffer                     m_ring       = {};
+    uint8_t*                   m_ringData   = nullptr;
+    size_t                     m_ringHead   = 0;
+    size_t                     m_ringUsed   = 0;
+    size_t                     m_batchBytes = 0;
+    std::deque<RingRegion>     m_regions;
+    std::vector<RetiredBuffer> m_retiredBuffers;
+    // Batches
+    Batch              m_current = {};
+    std::deque<Batch>  m_inFlight;
+    std::vector<Batch> m_freeBatches;
+    // Graphics side of the ownership transfers
+    std::vector<VkBufferMemoryBarrier>                m_bufferAcquires;
+    std::vector<std::function<void(VkCommandBuffer)>> m_graphicsWork;
+
+    size_t          allocate(size_t size, size_t alignment);
+    size_t          stage(const void* data, size_t size, size_t alignment, Buffer*& stagingBuffer);
+    VkCommandBuffer get_command_buffer();
+    void            retire();
+
+  public:
+    void init(VkDevice     device,
+              VmaAllocator allocator,
+              VkQueue      queue,
+              uint32_t     queueFamily,
+              uint32_t     graphicsFamily,
+              size_t       ringSize = UPLOAD_RING_SIZE);
+    void cleanup();
+
+    /*
+    Stages the data and records its copy into every target buffer. Targets must have TRANSFER_DST usage.
+    */
+    void upload_buffer(const void* data, size_t size, std::initializer_list<Buffer*> targets);
+    /*
+    Stages the texels and records the copy into the image. Mipmaps are generated if the image has more than one level. The
+    image ends up in SHADER_READ_ONLY layout.
+    */
+    void upload_image(Image& img, const void* data, size_t size, size_t texelSize);
+    /*
+    Stages a precomputed chain and records the copy of all its levels at once, no mipmap generation involved. blockSize is the
+    size of a texel, or of a compressed block. The image ends up in SHADER_READ_ONLY layout.
+    */
+    void upload_mip_chain(Image& img, const MipChain& chain, size_t blockSize);
+    /*
+    Records work consuming the uploaded data (e.g. a compute pass) on a graphics capable queue. It runs after the copies of
+    the current batch, or after acquiring them if uploads run on the transfer queue.
+    */
+    void enqueue_graphics_work(std::function<void(VkCommandBuffer)>&& work);
+    /*
+    Submits the batch recorded so far. Never blocks.
+    */
+    void flush();
+    /*
+    Records the pending ownership acquires and mipmap generation on a graphics command buffer. Only needed when the uploads
+    run on a dedicated transfer queue. The submission must wait on get_wait() as well.
+    */
+    void record_graphics_work(VkCommandBuffer cmd);
+    /*
+    Blocks until every submitted batch has completed
+    */
+    void wait_idle();
+
+    inline bool has_graphics_work() const {
+        return !m_bufferAcquires.empty() || !m_graphicsWork.empty();
+    }
+    inline bool dedicated() const {
+        return m_family != m_graphicsFamily;
+    }
+    /*
+    Wait on the last submitted batch. Empty if nothing has been uploaded yet
+    */
+    inline TimelineWait get_wait() const {
+        return m_submittedValue > 0 ? TimelineWait{m_timeline, m_submittedValue} : TimelineWait{};
+    }
+};
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
@@ -19,12 +19,13 @@ namespace Graphics
 namespace Booter
 {
 // Instance
+// Headless instances skip the windowing system extensions
 VkInstance create_instance(const char *appName, const char *engineName, bool validation,
-                           std::vector<const char *> validationLayers);
-std::vector<const char *> get_required_extensions(bool validation);
+                           std::vector<const char *> validationLayers, bool headless = false);
+std::vector<const char *> get_required_extensions(bool validation, bool headless = false);
 // Logger
 VkDebugUtilsMessengerEXT create_debug_messenger(VkInstance instance);
-// GPU
+// GPU. A null surface skips the presentation checks
 VkPhysicalDevice pick_graphics_card_device(VkInstance instance, VkSurfaceKHR surface,
                                            std::vector<const char *> extensions);
 
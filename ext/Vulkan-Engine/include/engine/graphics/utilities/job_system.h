@@ -0,0 +1,125 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <engine/common.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+/*
+Completion counter shared by one or more jobs. Default constructed handles are always done.
+*/
+class JobHandle
+{
+    std::shared_ptr<std::atomic<uint32_t>> m_pending;
+
+    friend class JobSystem;
+
+  public:
+    inline bool valid() const {
+        return m_pending != nullptr;
+    }
+    inline bool done() const {
+        return !m_pending || m_pending->load(std::memory_order_acquire) == 0;
+    }
+};
+
+/*
+Bounded work-stealing thread pool shared by the whole engine (asset decoding, parallel loops, shader builds...).
+
+Every worker owns a deque: jobs submitted from a worker go to the front of its own deque and are popped from there, idle
+workers steal from the back of the others. Jobs submitted from any other thread are spread round-robin. Waiting on a handle
+runs its pending jobs instead of blocking, so jobs can safely wait on other jobs. Jobs of other handles are left to the
+workers, so the main thread never ends up running an unrelated decode while it waits on a parallel loop.
+
+Work that must not run concurrently with rendering (e.g. adding decoded geometry to a mesh) is handed to the main thread with
+enqueue_main_thread(). The renderer runs those tasks at the start of every frame, before reading the scene.
+*/
+class JobSystem
+{
+    struct Job {
+        std::function<void()>                  function;
+        std::shared_ptr<std::atomic<uint32_t>> counter;
+    };
+    struct WorkQueue {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues; // One per worker
+    std::vector<std::thread>                m_workers;
+    std::atomic<uint32_t>                   m_queued{0};
+    std::atomic<uint32_t>                   m_nextQueue{0};
+    std::atomic<bool>                       m_running{true};
+    std::mutex                              m_sleepMutex;
+    std::condition_variable                 m_wake;
+    // Main thread handoff
+    std::mutex                         m_mainMutex;
+    std::vector<std::function<void()>> m_mainTasks;
+
+    bool pop(Job& job, const std::atomic<uint32_t>* counter = nullptr); // Only jobs of the counter if given
+    void execute(Job& job);
+    void worker_loop(uint32_t index);
+
+  public:
+    /*
+    Zero workers takes one per hardware thread but the calling one
+    */
+    JobSystem(uint32_t workerCount = 0);
+    /*
+    Joins the workers. Jobs still queued are dropped
+    */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&)            = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /*
+    Engine wide instance, created on first use
+    */
+    static JobSystem& get();
+
+    inline uint32_t get_worker_count() const {
+        return static_cast<uint32_t>(m_workers.size());
+    }
+
+    /*
+    Queues the job. Passing a handle groups the job with the ones already tracked by it.
+    */
+    JobHandle submit(std::function<void()>&& job, JobHandle handle = {});
+    /*
+    Runs queued jobs of the handle until every one of them has finished
+    */
+    void wait(const JobHandle& handle);
+
+    /*
+    Queues a task for the next run_main_thread_tasks() call. Thread safe.
+    */
+    void enqueue_main_thread(std::function<void()>&& task);
+    /*
+    Runs the tasks handed to the main thread so far, in submission order
+    */
+    void run_main_thread_tasks();
+};
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
@@ -121,6 +121,49 @@ struct memory_stream : virtual memory_buffer, public std::istream {
     }
 };
 
+/*
+Read-only memory mapped view of a whole file. Lets loaders parse binary formats in place without intermediate copies.
+*/
+class MappedFile
+{
+    const uint8_t* m_data{nullptr};
+    size_t         m_size{0};
+#ifdef _WIN32
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#else
+    int m_file{-1};
+#endif
+
+  public:
+    MappedFile() {
+    }
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string& path);
+    void close();
+
+    inline bool is_open() const {
+        return m_data != nullptr;
+    }
+    inline const uint8_t* data() const {
+        return m_data;
+    }
+    inline size_t size() const {
+        return m_size;
+    }
+};
+
+/*
+Splits the [0, count) range in contiguous batches and runs them concurrently on the engine job system. Blocks until every
+batch has been processed. Small ranges are run inline on the calling thread.
+*/
+void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t minBatchSize = 1024);
+
 // Function to trim leading and trailing whitespace
 std::string trim(const std::string& str);
 
@@ -217,6 +260,11 @@ Vec3 get_tangent_gram_smidt(Vec3& p1, Vec3& p2, Vec3& p3, glm::vec2& uv1, glm::v
 
 uint32_t murmur_hash3_32(const char* key, size_t len, uint32_t seed = 0);
 
+/*
+Bytes of a texel, or of a 4x4 block for compressed formats
+*/
+size_t get_block_size(ColorFormatType format);
+
 }; // namespace Utils
 } // namespace Graphics
 
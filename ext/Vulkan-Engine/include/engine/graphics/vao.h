@@ -16,23 +16,60 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 
 namespace Graphics {
 /*
+Push constant block needed to decode a StrandVertex. Mirrors StrandUniforms in strand.glsl.
+*/
+struct StrandUniforms {
+    Vec4     minCoord;         // Quantization AABB origin
+    Vec4     extent;           // Quantization AABB size
+    uint64_t strandBuffer = 0; // Device address of the per-strand StrandData SSBO
+    uint64_t objectTable  = 0; // Device address of the frame object table, indexed by instance
+    Vec4     params;           // Free for pass specific data. The forward pass puts the LOD width scale in x
+    uint64_t vertexBuffer = 0; // Device address of the VBO, for vertex pulled strands
+    uint64_t indexBuffer  = 0; // Device address of the indices drawn by vertex pulled strands (IBO or LOD IBO)
+    uint32_t topology     = STRAND_LINE_LIST; // StrandTopology of both index streams
+    uint32_t padding      = 0;
+};
+/*
+Vertex pulled strands expand every segment into a camera facing quad, drawn as a 6 vertex stretch of a single
+triangle strip (see strand_pulling.glsl)
+*/
+#define STRAND_PULLED_SEGMENT_VERTICES 6
+/*
 Geometric Render Data
 */
 struct VertexArrays {
-    bool loadedOnGPU = false;
+    bool     loadedOnGPU = false;
+    uint32_t revision    = 0; // Bumped on every upload, data derived on the GPU can tell the geometry changed
 
-    Buffer   vbo         = {};
-    uint32_t vertexCount = 0;
-    Buffer   ibo         = {};
-    uint32_t indexCount  = 0;
+    VertexLayoutType layout      = CANONICAL_VERTEX_LAYOUT;
+    Buffer           vbo         = {};
+    uint32_t         vertexCount = 0;
+    Buffer           ibo         = {};
+    uint32_t         indexCount  = 0;
 
-    Buffer   posSSBO;
-    Buffer   indexSSBO;
+    Buffer   posSSBO; // Only on canonical layout. Strand layout shaders read the VBO directly
     /*
     Optional, if the geometry need a proxy axis-aligned voxelized volume
     */
     Buffer   voxelBuffer = {};
     uint32_t voxelCount  = 0;
+    /*
+    Only on strand layout. Per-strand data and the constants to decode the vertices
+    */
+    Buffer         strandSSBO     = {};
+    uint32_t       strandCount    = 0;
+    StrandTopology strandTopology = STRAND_LINE_LIST;
+    StrandUniforms strandUniforms = {};
+    /*
+    Only on strand layout with levels of detail. Index stream of the simplified levels, level 0 being the regular IBO
+    */
+    Buffer   lodIbo        = {};
+    uint32_t lodIndexCount = 0;
+    /*
+    Only on strand layout with levels of detail. Culling clusters of every level, one after another
+    */
+    Buffer   clusterSSBO  = {};
+    uint32_t clusterCount = 0;
 };
 typedef VertexArrays VAO;
 /*
@@ -113,6 +150,114 @@ struct Vertex {
     }
 };
 /*
+Compressed vertex for hair strands (16 bytes against the 56 of Vertex). Position is quantized to 16 bits relative to the
+geometry AABB and the tangent is octahedral encoded. Color and thickness live per strand in a StrandData SSBO.
+*/
+struct StrandVertex {
+    uint16_t pos[4];     // UNORM, w unused
+    int16_t  tangent[2]; // SNORM octahedral
+    uint32_t strandID;
+
+    static StrandVertex encode(const Vec3& position, const Vec3& tangent, uint32_t strandID, const Vec3& minCoord, const Vec3& extent) {
+        StrandVertex v;
+        for (int i = 0; i < 3; i++)
+        {
+            float n  = extent[i] > 0.0f ? (position[i] - minCoord[i]) / extent[i] : 0.0f;
+            v.pos[i] = static_cast<uint16_t>(std::round(std::min(std::max(n, 0.0f), 1.0f) * 65535.0f));
+        }
+        v.pos[3] = 0;
+
+        // Octahedral projection
+        float l1 = std::abs(tangent.x) + std::abs(tangent.y) + std::abs(tangent.z);
+        Vec2  p  = l1 > 0.0f ? Vec2(tangent.x, tangent.y) / l1 : Vec2(0.0f);
+        if (l1 > 0.0f && tangent.z < 0.0f)
+            p = Vec2((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+        v.tangent[0] = static_cast<int16_t>(std::round(std::min(std::max(p.x, -1.0f), 1.0f) * 32767.0f));
+        v.tangent[1] = static_cast<int16_t>(std::round(std::min(std::max(p.y, -1.0f), 1.0f) * 32767.0f));
+
+        v.strandID = strandID;
+        return v;
+    }
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding   = 0;
+        bindingDescription.stride    = sizeof(StrandVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+    /*
+    Keeps the canonical locations. Position goes to 0, tangent to 3 and the strand ID to 4 (in place of color).
+    */
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(bool position = true, bool tangent = true, bool strandID = true) {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+        if (position)
+        {
+            VkVertexInputAttributeDescription posAtt{};
+            posAtt.binding  = 0;
+            posAtt.location = 0;
+            posAtt.format   = VK_FORMAT_R16G16B16A16_UNORM;
+            posAtt.offset   = offsetof(StrandVertex, pos);
+            attributeDescriptions.push_back(posAtt);
+        }
+        if (tangent)
+        {
+            VkVertexInputAttributeDescription tangentAtt{};
+            tangentAtt.binding  = 0;
+            tangentAtt.location = 3;
+            tangentAtt.format   = VK_FORMAT_R16G16_SNORM;
+            tangentAtt.offset   = offsetof(StrandVertex, tangent);
+            attributeDescriptions.push_back(tangentAtt);
+        }
+        if (strandID)
+        {
+            VkVertexInputAttributeDescription idAtt{};
+            idAtt.binding  = 0;
+            idAtt.location = 4;
+            idAtt.format   = VK_FORMAT_R32_UINT;
+            idAtt.offset   = offsetof(StrandVertex, strandID);
+            attributeDescriptions.push_back(idAtt);
+        }
+
+        return attributeDescriptions;
+    }
+};
+/*
+Per-strand attributes of a strand layout geometry
+*/
+struct StrandData {
+    Vec3  color     = Vec3(1.0f);
+    float thickness = 1.0f; // Multiplies the material thickness
+};
+// Max segments of a strand cluster. Also the workgroup size of the passes consuming them
+#define STRAND_CLUSTER_SEGMENTS 64
+// Closes every strand of a STRAND_LINE_STRIP index stream
+#define STRAND_RESTART_INDEX 0xFFFFFFFFu
+/*
+Segment slots of a strand index range. Line strips take one per index but the last, the ones touching a restart index
+join two strands and are skipped by every consumer.
+*/
+inline uint32_t strand_segment_count(StrandTopology topology, uint32_t indexCount) {
+    return topology == STRAND_LINE_STRIP ? (indexCount > 0 ? indexCount - 1 : 0) : indexCount / 2;
+}
+/*
+First of the two indices of a segment slot
+*/
+inline uint32_t strand_segment_index(StrandTopology topology, uint32_t segment) {
+    return topology == STRAND_LINE_STRIP ? segment : segment * 2;
+}
+/*
+Culling unit of a strand level. Covers up to STRAND_CLUSTER_SEGMENTS consecutive segments of a single strand, so clusters
+follow the level priority order and a strand prefix is always a cluster prefix. On line strips consecutive clusters of a
+strand share their boundary index and none covers a restart. Mirrors StrandCluster in strand_culling.glsl.
+*/
+struct StrandCluster {
+    Vec4     bounds;         // Object space bounding sphere, radius in w
+    uint32_t firstIndex = 0; // In the index stream of its level
+    uint32_t indexCount = 0;
+    uint32_t padding[2] = {0, 0};
+};
+/*
 Voxel data type configured as an Axis-Aligned-Box
 */
 struct Voxel {
@@ -6,6 +6,7 @@
 #include <engine/core/passes/hair_scattering_pass.h>
 #include <engine/core/passes/hair_voxelization_pass.h>
 #include <engine/core/passes/postprocess_pass.h>
+#include <engine/core/passes/strand_culling_pass.h>
 #include <engine/core/passes/variance_shadow_pass.h>
 
 #include <engine/systems/renderers/renderer.h>
@@ -22,17 +23,20 @@ class ForwardRenderer : public BaseRenderer
 
     enum RendererPasses
     {
-        SHADOW_PASS            = 0,
-        HAIR_SCATTER_PASS      = 1,
-        HAIR_VOXELIZATION_PASS = 2,
-        FORWARD_PASS           = 3,
-        BLOOM_PASS             = 4,
-        TONEMAPPIN_PASS        = 5,
-        FXAA_PASS              = 6,
+        STRAND_CULLING_PASS    = 0,
+        SHADOW_PASS            = 1,
+        HAIR_SCATTER_PASS      = 2,
+        HAIR_VOXELIZATION_PASS = 3,
+        FORWARD_PASS           = 4,
+        BLOOM_PASS             = 5,
+        TONEMAPPIN_PASS        = 6,
+        FXAA_PASS              = 7,
     };
 
-    ShadowResolution m_shadowQuality = ShadowResolution::MEDIUM;
-    bool             m_updateShadows = false;
+    ShadowResolution m_shadowQuality       = ShadowResolution::MEDIUM;
+    bool             m_updateShadows       = false;
+    bool             m_strandVertexPulling = false;
+    uint32_t         m_hairVolumePool      = 0; // Revision of the hair brick pool the forward pass samples
 
   public:
     ForwardRenderer(Core::IWindow* window)
@@ -65,6 +69,20 @@ class ForwardRenderer : public BaseRenderer
         }
     }
 
+    inline bool get_strand_vertex_pulling() const {
+        return m_strandVertexPulling;
+    }
+    /*
+    Expands strands in the vertex shader instead of the geometry shader (see Core::ForwardPass::set_strand_vertex_pulling)
+    */
+    inline void set_strand_vertex_pulling(bool op) {
+        m_strandVertexPulling = op;
+        if (m_passes.empty())
+            return;
+        static_cast<Core::StrandCullingPass*>(m_passes[STRAND_CULLING_PASS])->set_strand_vertex_pulling(op);
+        static_cast<Core::ForwardPass*>(m_passes[FORWARD_PASS])->set_strand_vertex_pulling(op);
+    }
+
   protected:
     virtual void on_before_render(Core::Scene* const scene);
 
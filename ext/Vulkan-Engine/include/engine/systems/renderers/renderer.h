@@ -19,6 +19,9 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 
 namespace Systems {
 
+// Passes timed per frame when GPU timings are enabled, the rest are skipped
+#define RENDERER_MAX_TIMED_PASSES 32
+
 /*
 Renderer Global Settings Data
 */
@@ -36,6 +39,7 @@ struct RendererSettings {
     bool            autoClearStencil = true;
     bool            enableUI         = false;
     bool            enableRaytracing = true;
+    bool            enableGPUTimings = false; // Timestamps around every pass, see BaseRenderer::get_pass_GPU_times()
 };
 /**
  * Basic class. Renders a given scene data to a given window. Fully
@@ -57,9 +61,11 @@ class BaseRenderer
     Graphics::Utils::DeletionQueue m_deletionQueue;
 
     // Query
-    uint32_t m_currentFrame       = 0;
-    bool     m_initialized        = false;
-    bool     m_updateFramebuffers = false;
+    uint32_t            m_currentFrame       = 0;
+    uint32_t            m_lastImageIndex     = 0; // Present image written by the last rendered frame
+    bool                m_initialized        = false;
+    bool                m_updateFramebuffers = false;
+    std::vector<double> m_passTimes;                // GPU milliseconds of every pass, as of the last frame read back
 
 #pragma endregion
   public:
@@ -84,6 +90,19 @@ class BaseRenderer
     inline RendererSettings get_settings() {
         return m_settings;
     }
+    /*
+    Uniform buffer writes of the last frame
+    */
+    inline Graphics::UniformStats get_uniform_stats() const {
+        return m_frames.empty() ? Graphics::UniformStats{} : m_frames[(m_currentFrame + m_frames.size() - 1) % m_frames.size()].uniformStats;
+    }
+    /*
+    GPU time of every pass (same order as get_render_passes(), zero if inactive), from the latest frame whose timestamps are
+    available. Frames in flight delay them. Empty unless enableGPUTimings is set.
+    */
+    inline const std::vector<double>& get_pass_GPU_times() const {
+        return m_passTimes;
+    }
     inline void set_settings(RendererSettings settings) {
         m_settings = settings;
     }
@@ -133,6 +152,10 @@ class BaseRenderer
      * Shut the renderer down.
      */
     void shutdown(Core::Scene* const scene);
+    /**
+     * Saves the last rendered frame, as presented (after tonemapping and FXAA), to a .png or .exr file. Waits for the GPU.
+     */
+    bool capture(const std::string& fileName);
 
 #pragma endregion
 #pragma region Core Functions
@@ -173,6 +196,11 @@ class BaseRenderer
     */
     virtual void clean_resources();
     /*
+    Sets up every active pass, compiling the shaders and creating the pipelines of all of them concurrently. Logs a startup
+    timing report per pass.
+    */
+    void setup_passes();
+    /*
     Link images of previous passes to current pass
     */
     void connect_pass(Core::BasePass* const currentPass);
@@ -0,0 +1,63 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef ENVIRONMENT_CACHE_H
+#define ENVIRONMENT_CACHE_H
+
+#include <engine/common.h>
+#include <engine/graphics/utilities/utils.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+/*
+Disk cache of the skybox products: the cubemap converted from the equirectangular panorama and its irradiance cubemap. An
+entry is keyed by the HDR file contents, both resolutions and the format, so a hit can be uploaded straight into the images
+the lighting passes sample, skipping the panorama upload and both auxiliar passes.
+*/
+namespace Tools::EnvironmentCache {
+
+#ifndef ENGINE_ENVIRONMENT_CACHE_PATH
+#define ENGINE_ENVIRONMENT_CACHE_PATH ENGINE_RESOURCES_PATH "cache/environments/"
+#endif
+#define ENVIRONMENT_CACHE_MAGIC   0x564E4543 // "CENV"
+#define ENVIRONMENT_CACHE_VERSION 1
+
+struct FileHeader {
+    uint32_t magic                = ENVIRONMENT_CACHE_MAGIC;
+    uint32_t version              = ENVIRONMENT_CACHE_VERSION;
+    uint32_t format               = 0;
+    uint32_t envResolution        = 0;
+    uint32_t irradianceResolution = 0;
+    uint32_t reserved             = 0;
+    uint64_t envSize              = 0; // Six faces, packed one after another
+    uint64_t irradianceSize       = 0;
+};
+
+/*
+Directory holding the entries. An empty path disables the cache.
+*/
+void               set_directory(const std::string& directory);
+const std::string& get_directory();
+
+/*
+Entry path of an environment, empty if the cache is disabled or the source can not be read
+*/
+std::string get_cache_path(const std::string& sourceFileName, uint32_t envResolution, uint32_t irradianceResolution, ColorFormatType format);
+
+bool write(const std::string& cacheFileName, const FileHeader& header, const void* envData, const void* irradianceData);
+/*
+Maps the entry and checks it against the expected header. Face data starts right after the header, irradiance right after
+the environment faces, both pointing into the mapping.
+*/
+bool read(const std::string& cacheFileName, const FileHeader& expected, Graphics::Utils::MappedFile& file, const uint8_t*& envData, const uint8_t*& irradianceData);
+
+} // namespace Tools::EnvironmentCache
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
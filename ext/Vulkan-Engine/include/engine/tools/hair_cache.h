@@ -0,0 +1,92 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef HAIR_CACHE_H
+#define HAIR_CACHE_H
+
+#include <engine/core/geometries/geometry.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+/*
+Compact binary cache (.hairc) for hair geometry. Stores the exact streams uploaded to the GPU so a load is just a
+memory map plus a staging copy.
+
+Layout:
+    FileHeader
+    SectionEntry[sectionCount]
+    Sections, each one starting at a SECTION_ALIGNMENT boundary
+*/
+namespace Tools::HairCache {
+
+#define HAIR_CACHE_EXTENSION "hairc"
+#define HAIR_CACHE_VERSION 7
+#define HAIR_CACHE_SECTION_ALIGNMENT 64
+
+typedef enum SectionType
+{
+    SECTION_VERTICES        = 0,  // Graphics::Vertex array, as in the VBO
+    SECTION_POSITIONS       = 1,  // Vec4 array, as in the positions SSBO. Omitted for quantized geometry
+    SECTION_INDICES         = 2,  // uint32_t strand indices, laid out as FileHeader::strandTopology says
+    SECTION_STRAND_OFFSETS  = 3,  // uint32_t first vertex of each strand plus a trailing end offset
+    SECTION_VOXELS          = 4,  // Graphics::Voxel array (optional)
+    SECTION_STRAND_VERTICES = 5,  // Graphics::StrandVertex array, the quantized VBO (optional)
+    SECTION_STRAND_DATA     = 6,  // Graphics::StrandData array (optional)
+    SECTION_LOD_INDICES     = 7,  // uint32_t strand indices of the simplified strand levels (optional)
+    SECTION_LOD_ERRORS      = 8,  // float error of every strand level, level 0 included (optional)
+    SECTION_LOD_PREFIXES    = 9,  // uint32_t index prefixes of every level, strand count + 1 each (optional)
+    SECTION_STRAND_CLUSTERS = 10, // Graphics::StrandCluster array of every level, one after another (optional)
+    SECTION_LOD_CLUSTERS    = 11, // uint32_t cluster count of every level (optional)
+    SECTION_STRAND_ORDER    = 12, // uint32_t source strand of every strand, if sorted (optional)
+    SECTION_COUNT
+} SectionType;
+
+struct FileHeader {
+    char     signature[8]; // "HAIRC"
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t sourceHash; // Content hash of the file the cache was built from
+    uint64_t sourceSize;
+    float    minCoords[3];
+    float    maxCoords[3];
+    float    avgFiberLength;
+    uint32_t vertexStride;   // Guards against layout changes of Graphics::Vertex
+    uint32_t strandTopology; // StrandTopology of both index sections
+    uint32_t strandSort;     // StrandSortKey the strands were ordered by
+};
+
+struct SectionEntry {
+    uint32_t type;
+    uint32_t elementSize;
+    uint64_t offset; // From the beginning of the file
+    uint64_t size;   // In bytes
+};
+
+/*
+Content hash of a whole file. Chunks are hashed in parallel.
+*/
+uint64_t hash_file(const std::string& fileName, uint64_t* fileSize = nullptr);
+/*
+Cache route for a given source file. It lives next to it, with the .hairc extension.
+*/
+std::string get_cache_path(const std::string& sourceFileName);
+/*
+Serializes the geometry streams. Returns false if the file could not be written.
+*/
+bool write(const std::string& cacheFileName, const Core::GeometricData& data, uint64_t sourceHash, uint64_t sourceSize);
+/*
+Maps the cache file and creates a geometry viewing its sections in place. Returns nullptr if the cache does not exist, is
+corrupted or was built from a different source (hash mismatch). Use sourceHash = 0 to skip that check.
+*/
+Core::Geometry* load(const std::string& cacheFileName, uint64_t sourceHash = 0);
+
+}; // namespace Tools::HairCache
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
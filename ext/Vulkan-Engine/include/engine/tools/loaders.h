@@ -9,6 +9,7 @@
 #ifndef LOADERS_H
 #define LOADERS_H
 
+#include <array>
 #include <chrono>
 #include <stb_image.h>
 #include <thread>
@@ -19,16 +20,52 @@
 #include <engine/core/scene/mesh.h>
 #include <engine/core/textures/textureHDR.h>
 #include <engine/core/textures/textureLDR.h>
+#include <engine/graphics/utilities/job_system.h>
+#include <engine/tools/hair_cache.h>
+#include <engine/tools/texture_cache.h>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
 // Load functions for several mesh and image files
 namespace Tools::Loaders {
+/*
+Progress of a load. Asynchronous loads decode on the job system and are handed to the scene on the main thread at the start
+of the next rendered frame, so a mesh gets all of its geometry at once and never changes while the renderer walks it.
+*/
+struct AssetLoad {
+    std::atomic<AssetState> state{ASSET_QUEUED};
+    Graphics::JobHandle     job;
+    Core::Mesh*             mesh    = nullptr;
+    Core::ITexture*         texture = nullptr;
+
+    /*
+    Reports ASSET_RESIDENT once the handed over data has been uploaded. Main thread only
+    */
+    AssetState get_state() const;
+};
+typedef std::shared_ptr<AssetLoad> AssetHandle;
+
+/*
+Runs decode on the job system over an empty scratch mesh, then moves the decoded geometries into the mesh on the main thread.
+Meant for custom loaders.
+*/
+AssetHandle load_mesh_async(Core::Mesh* const mesh, std::function<void(Core::Mesh* const)>&& decode);
+/*
+Blocks until the load has been decoded. The handoff still happens on the next frame.
+*/
+inline void wait(const AssetHandle& load) {
+    Graphics::JobSystem::get().wait(load->job);
+}
+/*
+Shapes are loaded concurrently. Their corners are welded with weld_vertices() and, if optimizeVertexCache is set, their
+triangles reordered with optimize_vertex_cache().
+*/
 void load_OBJ(Core::Mesh* const mesh,
               const std::string fileName,
-              bool              importMaterials   = false,
-              bool              calculateTangents = false,
-              bool              overrideGeometry  = false);
+              bool              importMaterials     = false,
+              bool              calculateTangents   = false,
+              bool              overrideGeometry    = false,
+              bool              optimizeVertexCache = false);
 
 void load_PLY(Core::Mesh* const mesh,
               const std::string fileName,
@@ -40,21 +77,23 @@ void load_PLY(Core::Mesh* const mesh,
 Generic loader. It automatically parses the file and find the needed loader for the file extension. Can be called
 asynchronously
 */
-void load_3D_file(Core::Mesh* const mesh,
-                  const std::string fileName,
-                  bool              asynCall         = true,
-                  bool              overrideGeometry = false);
+AssetHandle load_3D_file(Core::Mesh* const mesh,
+                         const std::string fileName,
+                         bool              asynCall         = true,
+                         bool              overrideGeometry = false);
 /*
-Use on .hair files.
+Use on .hair files. If useCache is set, a .hairc cache is looked up next to the file and used when its source hash and strand
+order match, otherwise it is (re)written after parsing. A sort key other than STRAND_SORT_NONE reorders the strands along a
+Morton curve (see Core::Geometry::sort_strands()).
 */
-void load_hair(Core::Mesh* const mesh, const char* fileName);
+void load_hair(Core::Mesh* const mesh, const char* fileName, bool useCache = true, StrandSortKey sortKey = STRAND_SORT_NONE);
 /*
-Load image texture
+Load image texture. Asynchronous loads decode on the job system and set the texture up on the main thread.
 */
-void load_texture(Core::ITexture*   texture,
-                  const std::string fileName,
-                  TextureFormatType textureFormat = TEXTURE_FORMAT_TYPE_COLOR,
-                  bool              asyncCall     = true);
+AssetHandle load_texture(Core::ITexture*   texture,
+                         const std::string fileName,
+                         TextureFormatType textureFormat = TEXTURE_FORMAT_TYPE_COLOR,
+                         bool              asyncCall     = true);
 /*
 Load .png file.
  */
@@ -76,6 +115,17 @@ void load_3D_texture(Core::ITexture* const texture,
 
 void compute_tangents_gram_smidt(std::vector<Graphics::Vertex>& vertices, const std::vector<uint32_t>& indices);
 
+/*
+Builds an indexed mesh out of a list of triangle corners. Corners whose quantized attributes match are merged: keys are
+hashed in parallel, sorted so duplicates become neighbours and the index buffer is emitted in a single sweep. Vertices keep
+the order of their first use.
+*/
+void weld_vertices(const std::vector<Graphics::Vertex>& corners, std::vector<Graphics::Vertex>& vertices, std::vector<uint32_t>& indices);
+/*
+Reorders the triangles of a triangle list for the post-transform vertex cache (Tipsify). The vertex buffer is not touched.
+*/
+void optimize_vertex_cache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
 }; // namespace Tools::Loaders
 
 VULKAN_ENGINE_NAMESPACE_END
@@ -0,0 +1,69 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <engine/common.h>
+#include <engine/graphics/image.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+/*
+Offline texture pipeline. Image files are cooked once into a complete mip chain (optionally block compressed) and stored as
+KTX2 files, so later launches skip decoding and GPU mipmap generation: the chain is read back and uploaded in one transfer.
+
+Entries are content addressed: the key hashes the source file, the requested format and the compression setting, so editing
+a texture simply misses.
+*/
+namespace Tools::TextureCache {
+
+#ifndef ENGINE_TEXTURE_CACHE_PATH
+#define ENGINE_TEXTURE_CACHE_PATH ENGINE_RESOURCES_PATH "cache/textures/"
+#endif
+#define TEXTURE_CACHE_VERSION 1
+
+/*
+Directory holding the cooked textures. An empty path disables cooking.
+*/
+void               set_directory(const std::string& directory);
+const std::string& get_directory();
+/*
+Block compresses cooked LDR color textures: BC1 when fully opaque, BC3 otherwise. Off by default.
+*/
+void set_compression(bool enabled);
+bool get_compression();
+
+/*
+Builds the whole mip chain of a 2D image with a box filter, in linear space for sRGB formats. Supports SRGBA_8, RGBA_8U and
+SRGBA_32F. With compress set, 8 bit chains are encoded to BC1/BC3 and format is updated accordingly.
+*/
+bool cook(const void* texels, Extent3D extent, ColorFormatType& format, bool compress, Graphics::MipChain& chain);
+/*
+Expands a BC1/BC3 chain back to 8 bit texels, for GPUs that can not sample the compressed format
+*/
+bool decompress(const Graphics::MipChain& chain, ColorFormatType& format, Graphics::MipChain& texels);
+
+bool write_KTX2(const std::string& fileName, ColorFormatType format, const Graphics::MipChain& chain);
+/*
+Returns false if the file is missing, is not a KTX2 file or uses a layout the engine does not produce
+*/
+bool read_KTX2(const std::string& fileName, ColorFormatType& format, Graphics::MipChain& chain);
+
+/*
+Cooked chain of an image file. It is read from the cache if present, otherwise the file is decoded, cooked and stored. format
+is the wanted uncompressed format on input and the format of the chain on output. Returns nullptr if cooking is disabled or
+not supported for the format, so the caller can take the regular path. Thread safe.
+*/
+std::shared_ptr<Graphics::MipChain> load(const std::string& fileName, ColorFormatType& format);
+
+} // namespace Tools::TextureCache
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
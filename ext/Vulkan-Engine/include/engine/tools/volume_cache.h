@@ -0,0 +1,69 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef VOLUME_CACHE_H
+#define VOLUME_CACHE_H
+
+#include <engine/common.h>
+#include <engine/graphics/utilities/utils.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+/*
+Disk cache of baked 3D lookup tables and volumes (hair scattering LUT, far field distribution, GI fallback). Entries hold the
+raw texels exactly as the image expects them, float data stored as half floats, so later runs map the file and copy it
+straight into the 3D image.
+
+Keys hash the contents of the files the data derives from (source images, or the shaders that integrate it, since those carry
+the material constants) together with the bake parameters, such as the LUT resolution.
+*/
+namespace Tools::VolumeCache {
+
+#ifndef ENGINE_VOLUME_CACHE_PATH
+#define ENGINE_VOLUME_CACHE_PATH ENGINE_RESOURCES_PATH "cache/volumes/"
+#endif
+#define VOLUME_CACHE_MAGIC   0x4C4F5643 // "CVOL"
+#define VOLUME_CACHE_VERSION 1
+
+struct FileHeader {
+    uint32_t magic    = VOLUME_CACHE_MAGIC;
+    uint32_t version  = VOLUME_CACHE_VERSION;
+    uint32_t format   = 0;
+    uint32_t width    = 0;
+    uint32_t height   = 0;
+    uint32_t depth    = 0;
+    uint64_t dataSize = 0;
+};
+
+/*
+Directory holding the entries. An empty path disables the cache.
+*/
+void               set_directory(const std::string& directory);
+const std::string& get_directory();
+
+/*
+Entry path for data derived from the given files and parameters. Empty if the cache is disabled or a source can not be read.
+*/
+std::string get_cache_path(const std::vector<std::string>& sources, const std::vector<uint64_t>& parameters);
+
+/*
+Half float copy of 32 bit float texels, converted in parallel
+*/
+void to_half(const float* src, size_t count, std::vector<uint16_t>& dst);
+
+bool write(const std::string& cacheFileName, ColorFormatType format, Extent3D extent, const void* data, size_t size);
+/*
+Maps the entry. data points into the mapping, so the file has to stay open until the texels are uploaded.
+*/
+bool read(const std::string& cacheFileName, Graphics::Utils::MappedFile& file, ColorFormatType& format, Extent3D& extent, const uint8_t*& data);
+
+} // namespace Tools::VolumeCache
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
@@ -307,9 +307,18 @@ class SceneExplorerWidget : public Widget
   protected:
     Core::Scene*    m_scene;
     Core::Object3D* m_selectedObject{nullptr};
+    // Strand picking
+    bool            m_strandPicking{false};
+    Core::StrandHit m_pickedStrand{};
+    uint32_t        m_pickedSourceStrand{UINT32_MAX}; // In file order, differs from the picked one on sorted grooms
     virtual void    render();
 
     void displayObject(Core::Object3D* const obj, int& counter);
+    void select(Core::Object3D* const obj);
+    /*
+    Ctrl + click on the viewport selects the closest strand under the cursor, through the segment BVH of the fiber geometries
+    */
+    void pick_strand();
 
   public:
     SceneExplorerWidget(Core::Scene* scene)
@@ -0,0 +1,36 @@
+/*
+    This file is part of Vulkan-Engine, a simple to use Vulkan based 3D library
+
+    MIT License
+
+    Copyright (c) 2023 Antonio Espinosa Garcia
+
+*/
+#ifndef WRITERS_H
+#define WRITERS_H
+
+#include <engine/common.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+// Save functions for image files
+namespace Tools::Writers {
+/*
+Writes 8 bit RGBA texels to a .png file
+*/
+bool write_PNG(const std::string fileName, uint32_t width, uint32_t height, const uint8_t* rgba);
+/*
+Writes 32 bit float RGBA texels to an uncompressed scanline .exr file
+*/
+bool write_EXR(const std::string fileName, uint32_t width, uint32_t height, const float* rgba);
+/*
+Generic writer for 8 bit sRGB encoded RGBA texels. The file extension picks the format: .exr files store linear values,
+anything else is written as PNG.
+*/
+bool write_image(const std::string fileName, uint32_t width, uint32_t height, const uint8_t* rgba);
+
+}; // namespace Tools::Writers
+
+VULKAN_ENGINE_NAMESPACE_END
+
+#endif
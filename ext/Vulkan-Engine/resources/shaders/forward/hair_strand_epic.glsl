@@ -1,27 +1,78 @@
 #shader vertex
 #version 460 core
-#include object.glsl
+#include strand.glsl
+#include object_table.glsl
 
-//Input
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
-layout(location = 2) in vec3 uv;
-layout(location = 3) in vec3 tangent;
-layout(location = 4) in vec3 color;
+#ifdef STRAND_VERTEX_PULLING
+#include camera.glsl
+#include strand_pulling.glsl
+
+// Expands the segments here, no geometry stage (see ForwardPass::set_strand_vertex_pulling)
+
+//Uniforms
+layout(set = 1, binding = 1) uniform MaterialUniforms {
+    vec3 baseColor;
+    float thickness;
+} material;
+
+//Output (same as the geometry stage)
+layout(location = 0) out vec3 g_pos;
+layout(location = 1) out vec3 g_modelPos;
+layout(location = 2) out vec3 g_normal;
+layout(location = 3) out vec3 g_modelNormal;
+layout(location = 4) out vec2 g_uv;
+layout(location = 5) out vec3 g_dir;
+layout(location = 6) out vec3 g_modelDir;
+layout(location = 7) out vec3 g_color;
+layout(location = 8) out vec3 g_origin;
+layout(location = 9) flat out uint g_instance;
+
+void main() {
+    loadObject(gl_InstanceIndex);
+
+    StrandQuadVertex v = pullStrandQuadVertex(gl_VertexIndex, material.thickness);
+    gl_Position        = v.clipPos;
+    g_pos              = v.pos;
+    g_modelPos         = v.modelPos;
+    g_normal           = v.normal;
+    g_modelNormal      = v.modelNormal;
+    g_uv               = v.uv;
+    g_dir              = v.dir;
+    g_modelDir         = v.modelDir;
+    g_color            = v.color;
+    g_origin           = v.origin;
+    g_instance         = gl_InstanceIndex;
+}
+
+#else
+
+//Input (strand layout)
+layout(location = 0) in vec4 position;
+layout(location = 3) in vec2 tangent;
+layout(location = 4) in uint strandID;
 
 //Output
 layout(location = 0) out vec3 v_color;
 layout(location = 1) out vec3 v_tangent;
+layout(location = 2) out float v_thickness;
+layout(location = 3) flat out uint v_instance;
 
 void main() {
+    loadObject(gl_InstanceIndex);
+    v_instance = gl_InstanceIndex;
+
+    gl_Position = object.model * vec4(decodeStrandPosition(position.xyz), 1.0);
 
-    gl_Position = object.model * vec4(position, 1.0);
+    v_tangent = normalize(mat3(object.normalMatrix) * decodeOctahedral(tangent));
 
-    v_tangent = normalize(mat3(transpose(inverse(object.model))) * tangent);
-    v_color = color;
+    vec4 strandInfo = strandData(strandID);
+    v_color = strandInfo.rgb;
+    v_thickness = strandInfo.w * strand.params.x; // Widened on thinned levels of detail
 
 }
 
+#endif
+
 #shader geometry
 #version 460 core
 #include camera.glsl
@@ -33,6 +84,8 @@ layout(triangle_strip, max_vertices = 4) out;
 //Input
 layout(location = 0) in vec3 v_color[];
 layout(location = 1) in vec3 v_tangent[];
+layout(location = 2) in float v_thickness[];
+layout(location = 3) flat in uint v_instance[];
 
 //Uniforms
 layout(set = 1, binding = 1) uniform MaterialUniforms {
@@ -50,6 +103,7 @@ layout(location = 5) out vec3 g_dir;
 layout(location = 6) out vec3 g_modelDir;
 layout(location = 7) out vec3 g_color;
 layout(location = 8) out vec3 g_origin;
+layout(location = 9) flat out uint g_instance;
 
 void emitQuadPoint(
     vec4 origin,
@@ -73,6 +127,8 @@ void emitQuadPoint(
     g_modelNormal = normal;
     g_origin = (camera.view * origin).xyz;
 
+    g_instance = v_instance[0];
+
     EmitVertex();
 }
 
@@ -97,7 +153,7 @@ void main() {
 
         //<<<----
 
-    float halfLength = material.thickness * 0.5;
+    float halfLength = material.thickness * v_thickness[0] * 0.5;
 
     emitQuadPoint(startPoint, right0, halfLength, dir0, normal0, vec2(1.0, 0.0), 0);
     emitQuadPoint(endPoint, right1, halfLength, dir1, normal1, vec2(1.0, 1.0), 1);
@@ -108,10 +164,11 @@ void main() {
 
 #shader fragment
 #version 460 core
+#include strand.glsl
 #include light.glsl
 #include scene.glsl
 #include camera.glsl
-#include object.glsl
+#include object_table.glsl
 #include utils.glsl
 #include shadow_mapping.glsl
 #include reindhart.glsl
@@ -128,13 +185,15 @@ layout(location = 5) in vec3 g_dir;
 layout(location = 6) in vec3 g_modelDir;
 layout(location = 7) in vec3 g_color;
 layout(location = 8) in vec3 g_origin;
+layout(location = 9) flat in uint g_instance;
 
 //Uniforms
 layout(set = 0, binding = 2) uniform sampler2DArray shadowMap;
 layout(set = 0, binding = 4) uniform samplerCube irradianceMap;
 
-layout(set = 0, binding = 10) uniform sampler3D hairVoxels;
+layout(set = 0, binding = 10) uniform sampler3D hairVoxels; // Brick pool
 layout(set = 0, binding = 13) uniform sampler3D hairLUT;
+layout(set = 0, binding = 14) uniform usampler3D hairBricks;
 
 layout(set = 1, binding = 1) uniform MaterialUniforms {
     vec3 baseColor;
@@ -188,16 +247,16 @@ vec3 computeAmbient(vec3 n) {
 
 //Anysotropic. Decoding from a L1 SH
 float getNumberOfStrands(vec3 worldPos, vec3 lightWorldPos) {
-    vec3 dir = normalize(lightWorldPos - worldPos);
+    if (!hasHairVolume(object.volumeAtlas)) return 0.0; // Groom not voxelized
+    // The volume was voxelized in object space, the model transform is undone instead of voxelizing again
+    vec3 dir = normalize(worldToObjectDir(lightWorldPos - worldPos));
 
     // Compute voxel UVW coords in object space
-    vec3 uvw = (worldPos - object.minCoord.xyz) / (object.maxCoord.xyz - object.minCoord.xyz);
+    vec3 uvw = (worldToObject(worldPos) - strand.minCoord.xyz) / strand.extent.xyz;
     uvw = clamp(uvw, 0.0, 0.9999);
 
-    // Fetch SH L1 and decode
-    // ivec3 coord = ivec3(uvw * vec3(textureSize(hairVoxels, 0)));
-    // vec4 SHL1 = texelFetch(hairVoxels, coord, 0);
-    vec4 SHL1 = texture(hairVoxels, uvw, 0);
+    // Filter the SH L1 of the bricks of the groom slot and decode
+    vec4 SHL1 = sampleHairVolume(hairBricks, hairVoxels, uvw, object.volumeAtlas);
 
     return decodeScalarFromSHL1(SHL1, dir);
 }
@@ -254,6 +313,7 @@ vec3 computeHairShadow(LightUniform light, int lightId, sampler2DArray shadowMap
 }
 
 void main() {
+    loadObject(g_instance);
 
     //BSDF setup ............................................................
     // bsdf.baseColor = material.baseColor;
@@ -1,13 +1,14 @@
 #shader vertex
 #version 460
 
+#include strand.glsl
 #include camera.glsl
 #include object.glsl
 #include light.glsl
 #include utils.glsl
 
 //Input
-layout(location = 0) in vec3 pos;
+layout(location = 0) in vec4 pos;
 
 //Output
 layout(location = 0) out vec3 v_pos;
@@ -26,7 +27,7 @@ layout(set = 1, binding = 1) uniform MaterialUniforms {
 
 void main() {
 
-    v_pos = (object.model * vec4(pos, 1.0)).xyz;
+    v_pos = (object.model * vec4(decodeStrandPosition(pos.xyz), 1.0)).xyz;
     // v_pos = pos;
 
     vec3 ndc = mapToZeroOne(v_pos, object.minCoord.xyz, object.maxCoord.xyz) ;
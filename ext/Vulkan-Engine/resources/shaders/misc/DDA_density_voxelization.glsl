@@ -6,22 +6,18 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 #extension GL_EXT_nonuniform_qualifier : require
 #extension GL_EXT_shader_atomic_float : require
+#include strand.glsl
 #include object.glsl  
 #include utils.glsl
 
-layout(local_size_x = 32, local_size_y = 1, local_size_z = 1) in;
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 
 
-layout(push_constant) uniform ObjectID {
-    float meshID;
-    float numSegments;
-} objectID;
-
 // Output voxel grid
 layout(set = 0, binding = 2, r32f) uniform image3D voxelImage;
 
 layout(std430, set = 2, binding = 0) readonly buffer PosBuffer {
-    vec4 pos[];
+    uvec4 verts[]; // Quantized strand vertices
 } posBuffers[];
 layout(std430, set = 2, binding = 1) readonly buffer IndexBuffer {
     uint indices[];
@@ -32,16 +28,17 @@ layout(std430, set = 2, binding = 1) readonly buffer IndexBuffer {
 
 void main() {
 
-    uint meshID = nonuniformEXT(uint(objectID.meshID));   // which mesh in the bindless buffers
-    uint segID  = gl_GlobalInvocationID.x;  // segment index = index pair
-    if(segID >= uint(objectID.numSegments)) return;
+    uint meshID = nonuniformEXT(uint(strand.params.x));   // which mesh in the bindless buffers
+    uint segID  = gl_GlobalInvocationID.x;  // segment slot of the index stream
+    if(segID >= uint(strand.params.y)) return;
 
-    uint i0 = indexBuffers[nonuniformEXT(meshID)].indices[segID * 2u + 0u];
-    uint i1 = indexBuffers[nonuniformEXT(meshID)].indices[segID * 2u + 1u];
+    uint i0 = indexBuffers[nonuniformEXT(meshID)].indices[strandSegmentIndex(segID) + 0u];
+    uint i1 = indexBuffers[nonuniformEXT(meshID)].indices[strandSegmentIndex(segID) + 1u];
+    if(i0 == STRAND_RESTART_INDEX || i1 == STRAND_RESTART_INDEX) return; // Joins two strips
 
-    // fetch positions (vec4 stored for alignment); take xyz
-    vec3 p0 = (object.model * posBuffers[nonuniformEXT(meshID)].pos[i0]).xyz;
-    vec3 p1 = (object.model * posBuffers[nonuniformEXT(meshID)].pos[i1]).xyz;
+    // fetch quantized positions (16 bytes per vertex) and decode them
+    vec3 p0 = (object.model * vec4(decodeStrandPosition(posBuffers[nonuniformEXT(meshID)].verts[i0].xy), 1.0)).xyz;
+    vec3 p1 = (object.model * vec4(decodeStrandPosition(posBuffers[nonuniformEXT(meshID)].verts[i1].xy), 1.0)).xyz;
 
     // Map to voxel-space [0, gridSize)
     ivec3 gridSize = imageSize(voxelImage);
@@ -7,49 +7,63 @@
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 #extension GL_EXT_nonuniform_qualifier : require
 #extension GL_EXT_shader_atomic_float : require
+#include strand.glsl
 #include object.glsl  
 #include utils.glsl
 
 #define USE_SPLAT_KERNEL 1
 
-layout(local_size_x = 32, local_size_y = 1, local_size_z = 1) in;
+// Voxelized in object space, within the quantization bounds of the geometry, so the volume survives any model transform.
+// Runs twice per rebuild. With strand.params.w unset it only marks the cells of the brick grid it would touch, which then
+// get their bricks. With it set, lengths are accumulated in the bricks. Cells left without a brick (full pool) are dropped
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 
 
-layout(push_constant) uniform ObjectID {
-    float meshID;
-    float numSegments;
-} objectID;
-
 // Output voxel grid
-layout(set = 0, binding = 6, r32f) uniform image3D voxelLengthImage;
+layout(set = 0, binding = 6, r32f) uniform image3D voxelLengthImage; // Brick pool
+layout(set = 0, binding = 7, r32ui) uniform uimage3D brickGrid;
 
 // Bindless Buffers
 layout(std430, set = 2, binding = 0) readonly buffer PosBuffer {
-    vec4 pos[];
+    uvec4 verts[]; // Quantized strand vertices
 } posBuffers[];
 layout(std430, set = 2, binding = 1) readonly buffer IndexBuffer {
     uint indices[];
 } indexBuffers[];
 
+void splat(ivec3 voxel, float len) {
+    if (len <= 0.0) return;
+    ivec3 cell  = hairBrickCell(voxel, object.volumeAtlas, imageSize(brickGrid));
+    uint  entry = imageLoad(brickGrid, cell).r;
+    if (strand.params.w < 0.5) {
+        if ((entry & HAIR_BRICK_MARKED) == 0u) imageAtomicOr(brickGrid, cell, HAIR_BRICK_MARKED);
+        return;
+    }
+    if (entry == 0u) return;
+    imageAtomicAdd(voxelLengthImage, hairBrickTexel(entry, voxel, imageSize(voxelLengthImage)), len);
+}
+
 void main() {
 
-    uint meshID = nonuniformEXT(uint(objectID.meshID));   // which mesh in the bindless buffers
-    uint segID  = gl_GlobalInvocationID.x;  // segment index = index pair
-    if(segID >= uint(objectID.numSegments)) return;
+    uint meshID = nonuniformEXT(uint(strand.params.x));   // which mesh in the bindless buffers
+    uint segID  = gl_GlobalInvocationID.x;                 // segment slot of the index stream
+    if(segID >= uint(strand.params.y)) return;
+    uint firstIndex = strandSegmentIndex(segID);
 
-    uint i0 = indexBuffers[nonuniformEXT(meshID)].indices[segID * 2u + 0u];
-    uint i1 = indexBuffers[nonuniformEXT(meshID)].indices[segID * 2u + 1u];
+    uint i0 = indexBuffers[nonuniformEXT(meshID)].indices[firstIndex + 0u];
+    uint i1 = indexBuffers[nonuniformEXT(meshID)].indices[firstIndex + 1u];
+    if(i0 == STRAND_RESTART_INDEX || i1 == STRAND_RESTART_INDEX) return; // Joins two strips
 
-    // fetch positions (vec4 stored for alignment); take xyz
-    vec3 p0 = (object.model * posBuffers[nonuniformEXT(meshID)].pos[i0]).xyz;
-    vec3 p1 = (object.model * posBuffers[nonuniformEXT(meshID)].pos[i1]).xyz;
+    // fetch quantized positions (16 bytes per vertex) and decode them
+    vec3 p0 = decodeStrandPosition(posBuffers[nonuniformEXT(meshID)].verts[i0].xy);
+    vec3 p1 = decodeStrandPosition(posBuffers[nonuniformEXT(meshID)].verts[i1].xy);
 
-    float segLenWorld = max(1e-9, length(p1 - p0));
+    float segLenWorld = max(1e-9, length(p1 - p0)); // Object space
 
-    // Map to voxel-space [0, gridSize)
-    ivec3 gridSize = imageSize(voxelLengthImage);
-    vec3 a = mapToZeroOne(p0, object.minCoord.xyz, object.maxCoord.xyz) * vec3(gridSize);
-    vec3 b = mapToZeroOne(p1, object.minCoord.xyz, object.maxCoord.xyz) * vec3(gridSize);
+    // Map to voxel-space [0, gridSize) of the groom slot
+    ivec3 gridSize = ivec3(hairVolumeResolution(object.volumeAtlas, imageSize(brickGrid)));
+    vec3 a = mapToZeroOne(p0, strand.minCoord.xyz, strand.minCoord.xyz + strand.extent.xyz) * vec3(gridSize);
+    vec3 b = mapToZeroOne(p1, strand.minCoord.xyz, strand.minCoord.xyz + strand.extent.xyz) * vec3(gridSize);
     a = clamp(a, vec3(0.0), vec3(gridSize - 1));
     b = clamp(b, vec3(0.0), vec3(gridSize - 1));
 
@@ -145,12 +159,12 @@ void main() {
 
             float w = wx * wy * wz; // trilinear weight
 
-            imageAtomicAdd(voxelLengthImage, c, lenInVoxel * w);
+            splat(c, lenInVoxel * w);
         }
 
 #else
 
-        imageAtomicAdd(voxelLengthImage, clamp(voxel, ivec3(0), gridSize - 1), lenInVoxel);
+        splat(clamp(voxel, ivec3(0), gridSize - 1), lenInVoxel);
 #endif
 
         if (all(equal(voxel, endVoxel))) break;
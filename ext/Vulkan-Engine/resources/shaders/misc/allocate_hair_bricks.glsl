@@ -0,0 +1,53 @@
+#shader compute
+#version 460
+#include utils.glsl
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// Gives a brick of the pool to every cell of the groom slot marked by the voxelization
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One dispatch per groom, over its slot of the brick grid. Grooms are dispatched one after another, so the bricks of each
+// are contiguous. Cells marked once the pool is used up, and those left over from the previous rebuild, are emptied
+layout(local_size_x = 4, local_size_y = 4, local_size_z = 4) in;
+
+layout(set = 0, binding = 6, r32f) uniform image3D voxelLengthImage; // Only its size, the pool layout
+layout(set = 0, binding = 7, r32ui) uniform uimage3D brickGrid;
+layout(std430, set = 0, binding = 8) buffer HairBricks {
+    uint              first[HAIR_MAX_VOLUMES];     // First brick of every slot
+    HairBrickDispatch dispatches[HAIR_MAX_VOLUMES]; // Bricks of every slot
+    uint              requested[HAIR_MAX_VOLUMES];  // Marked cells of every slot, with or without a brick
+    uint              allocated;                    // Shared by all slots, keeps counting past the capacity
+    uint              cells[];                      // Cell of every brick of the pool
+};
+
+layout(push_constant) uniform Bricks {
+    vec4  atlas; // Slot and slot count, as in the object volumeAtlas
+    float avgFiberLength;
+} bricks;
+
+void main() {
+    ivec3 gridSize = imageSize(brickGrid);
+    ivec3 cell     = ivec3(gl_GlobalInvocationID.xyz);
+    if (any(greaterThanEqual(cell, ivec3(hairVolumeSize(bricks.atlas, gridSize))))) return;
+
+    ivec3 texel = hairVolumeOrigin(bricks.atlas, gridSize) + cell;
+    if ((imageLoad(brickGrid, texel).r & HAIR_BRICK_MARKED) == 0u) {
+        imageStore(brickGrid, texel, uvec4(0u));
+        return;
+    }
+
+    uint slot  = uint(bricks.atlas.x);
+    uint brick = atomicAdd(allocated, 1u);
+    atomicAdd(requested[slot], 1u);
+    if (brick >= hairBrickCapacity(imageSize(voxelLengthImage))) {
+        imageStore(brickGrid, texel, uvec4(0u)); // Pool used up, its segments are dropped
+        return;
+    }
+
+    atomicMin(first[slot], brick);
+    if (atomicAdd(dispatches[slot].x, 1u) == 0u) {
+        dispatches[slot].y = 1u;
+        dispatches[slot].z = 1u;
+    }
+    cells[brick] = packHairBrickCell(cell);
+    imageStore(brickGrid, texel, uvec4(brick + 1u));
+}
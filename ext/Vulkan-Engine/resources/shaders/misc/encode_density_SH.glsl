@@ -1,22 +1,35 @@
 #shader compute
 #version 460
+#include strand.glsl
 #include object.glsl
 #include sh.glsl
+#include utils.glsl
 
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
 
-layout(set = 0, binding = 3, rgba32f) uniform image3D encodedVolume; 
+layout(set = 0, binding = 3, rgba16f) uniform image3D encodedVolume; // Brick pool
 layout(std430, binding = 4) readonly buffer Directions {
     vec4 directions[];
 };
-layout(set = 0, binding = 5) uniform sampler3D densityVolume; 
+layout(set = 0, binding = 5) uniform sampler3D densityVolume; // Brick pool
+layout(set = 0, binding = 7, r32ui) uniform uimage3D brickGrid;
+layout(std430, set = 0, binding = 8) readonly buffer HairBricks {
+    uint              first[HAIR_MAX_VOLUMES];
+    HairBrickDispatch dispatches[HAIR_MAX_VOLUMES];
+    uint              requested[HAIR_MAX_VOLUMES];
+    uint              allocated;
+    uint              cells[];
+};
 
 #define USE_AMANATIDES_WOO_DDA 1
 
-float sampleDensity(vec3 pos)
+// Encoded in object space, within the quantization bounds the groom was voxelized in. Directions are object space too
+
+float sampleDensity(ivec3 voxel)
 {
-    vec3 uv = (pos - object.minCoord.xyz) / (object.maxCoord.xyz - object.minCoord.xyz);
-    return texture(densityVolume, uv).r;
+    uint entry = imageLoad(brickGrid, hairBrickCell(voxel, object.volumeAtlas, imageSize(brickGrid))).r;
+    if (entry == 0u) return 0.0; // No segment landed in its cell
+    return texelFetch(densityVolume, hairBrickTexel(entry, voxel, textureSize(densityVolume, 0)), 0).r;
 }
 
 bool insideBounds(ivec3 v, ivec3 dim) {
@@ -25,19 +38,28 @@ bool insideBounds(ivec3 v, ivec3 dim) {
 
 void main()
 {
-    ivec3 dim = textureSize(densityVolume, 0);
-    ivec3 gid = ivec3(gl_GlobalInvocationID.xyz);
-    if (!insideBounds(gid, dim)) return;
+    // One indirect dispatch per groom, one workgroup per brick handed out to it
+    ivec3 poolSize = textureSize(densityVolume, 0);
+    if (!hasHairVolume(object.volumeAtlas)) return;
 
-    vec3 boundsMin = object.minCoord.xyz;
-    vec3 boundsMax = object.maxCoord.xyz;
+    uint  brick = first[uint(object.volumeAtlas.x)] + gl_WorkGroupID.x;
+    ivec3 cell  = unpackHairBrickCell(cells[brick]);
+    ivec3 gid   = cell * HAIR_BRICK_SIZE + ivec3(gl_LocalInvocationID.xyz);
+    ivec3 dim   = ivec3(hairVolumeResolution(object.volumeAtlas, imageSize(brickGrid)));
+
+    vec3 boundsMin = strand.minCoord.xyz;
+    vec3 boundsMax = strand.minCoord.xyz + strand.extent.xyz;
 
     vec3 gridSize = vec3(dim);
     vec3 voxelSize = (boundsMax - boundsMin) / gridSize;
     vec3 voxelCenter = boundsMin + (vec3(gid) + 0.5) * voxelSize;
 
-    // If empty voxel, skip
-    if (sampleDensity(voxelCenter) == 0.0) return;
+    // If empty voxel, skip. Bricks are not cleared between rebuilds
+    ivec3 texel = hairBrickOrigin(brick, poolSize) + ivec3(gl_LocalInvocationID.xyz);
+    if (sampleDensity(gid) == 0.0) {
+        imageStore(encodedVolume, texel, vec4(0.0));
+        return;
+    }
 
     vec4 sh = vec4(0.0);
     const uint NUM_DIRS = 32;
@@ -88,8 +110,7 @@ void main()
         {
             if (!insideBounds(voxel, dim)) break;
 
-            vec3 worldPos = boundsMin + (vec3(voxel) + 0.5) * voxelSize;
-            accum += sampleDensity(worldPos);
+            accum += sampleDensity(voxel);
 
             // advance voxel
             if (tMax.x < tMax.y)
@@ -111,7 +132,8 @@ void main()
         float t = 0.0;
         float maxT = length(boundsMax - boundsMin);
         while (t < maxT) {
-            accum += sampleDensity(voxelCenter + dir * t);
+            ivec3 voxel = ivec3(floor((voxelCenter + dir * t - boundsMin) / voxelSize));
+            if (insideBounds(voxel, dim)) accum += sampleDensity(voxel);
             t += length(voxelSize);
         }
 #endif
@@ -121,5 +143,5 @@ void main()
     }
 
     sh /= float(NUM_DIRS);
-    imageStore(encodedVolume, gid, sh);
+    imageStore(encodedVolume, texel, sh);
 }
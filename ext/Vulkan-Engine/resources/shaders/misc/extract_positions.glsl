@@ -0,0 +1,30 @@
+#shader compute
+#version 460
+#extension GL_EXT_buffer_reference : require
+// Derives the positions SSBO (vec4 per vertex) from the VBO (Graphics::Vertex), so it does not have to be built and
+// staged from the CPU.
+
+layout(local_size_x = 256) in;
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexBuffer {
+    float v[];
+};
+layout(buffer_reference, std430, buffer_reference_align = 16) writeonly buffer PositionBuffer {
+    vec4 p[];
+};
+
+layout(push_constant) uniform Extraction {
+    VertexBuffer   vertices;
+    PositionBuffer positions;
+    uint           count;
+    uint           stride; // In floats
+} extraction;
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= extraction.count)
+        return;
+
+    uint base = id * extraction.stride;
+    extraction.positions.p[id] = vec4(extraction.vertices.v[base], extraction.vertices.v[base + 1], extraction.vertices.v[base + 2], 1.0);
+}
@@ -1,27 +1,33 @@
 #shader compute
 #version 460
+#include utils.glsl
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Convert fiber length -> hairCount and density 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// One indirect dispatch per groom, one workgroup per brick handed out to it
 layout(local_size_x=8, local_size_y=8, local_size_z=8) in;
 
 // Output voxel grid
 layout(set = 0, binding = 6, r32f) uniform image3D voxelLengthImage; // input
 layout(set=0,binding=2,r32f) uniform image3D voxelHairCount; // output
 // layout(set=0,binding=2,r32f) uniform image3D voxelDensity; // optional
+layout(std430, set = 0, binding = 8) readonly buffer HairBricks {
+    uint first[HAIR_MAX_VOLUMES];
+};
 
-layout(push_constant) uniform ObjectID {
-    float meshID;
-    float numSegments;
+layout(push_constant) uniform Bricks {
+    vec4  atlas; // Slot and slot count, as in the object volumeAtlas
     float avgFiberLength;
-} objectID;
+} bricks;
 
 void main(){
-    ivec3 v = ivec3(gl_GlobalInvocationID.xyz);
+    uint  brick = first[uint(bricks.atlas.x)] + gl_WorkGroupID.x;
+    ivec3 v     = hairBrickOrigin(brick, imageSize(voxelLengthImage)) + ivec3(gl_LocalInvocationID.xyz);
     float L = imageLoad(voxelLengthImage, v).r;
+    imageStore(voxelLengthImage, v, vec4(0.0)); // Cleared for the next rebuild
 
-    float hairCount = (L / max(objectID.avgFiberLength, 1e-9));
+    float hairCount = (L / max(bricks.avgFiberLength, 1e-9));
     imageStore(voxelHairCount, v, vec4(hairCount));
 
     // density = volume fraction if needed: density = (L * crossArea) / voxelVol
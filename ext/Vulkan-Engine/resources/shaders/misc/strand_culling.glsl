@@ -0,0 +1,142 @@
+#shader compute
+#version 460
+#extension GL_EXT_buffer_reference : require
+#include light.glsl
+#include scene.glsl
+#include camera.glsl
+
+// Frustum culling of strand clusters (Graphics::StrandCluster). One thread per cluster and instance of a batch geometry,
+// survivors are appended as indexed indirect draws (VkDrawIndexedIndirectCommand) to the outputs of their views.
+
+#define STRAND_CAMERA_VIEW 0
+#define STRAND_SHADOW_VIEW 1
+
+#define STRAND_SEGMENT_VERTICES 6u // As in strand_pulling.glsl
+
+layout(local_size_x = 64) in;
+
+struct StrandCluster {
+    vec4 bounds; // Object space bounding sphere, radius in w
+    uint firstIndex;
+    uint indexCount;
+    uint padding0;
+    uint padding1;
+};
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ClusterBuffer {
+    StrandCluster clusters[];
+};
+// Frame object table (Graphics::ObjectUniforms), same as in strand.glsl
+struct ObjectEntry {
+    mat4 model;
+    vec4 maxCoord;
+    vec4 minCoord;
+    vec4 otherParams1;
+    vec4 otherParams2;
+    mat4 normalMatrix;
+};
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ObjectTable {
+    ObjectEntry entries[];
+};
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+layout(buffer_reference, std430, buffer_reference_align = 4) writeonly buffer CommandBuffer {
+    DrawCommand commands[];
+};
+layout(buffer_reference, std430, buffer_reference_align = 16) buffer CountBuffer {
+    uvec4 counts[]; // x draw count, yz set to 1 so they work as dispatch arguments
+};
+
+layout(push_constant) uniform Culling {
+    ClusterBuffer clusters;
+    ObjectTable   objects;
+    CommandBuffer commands;
+    CountBuffer   counts;
+    uint          firstCluster;
+    uint          clusterCount;
+    uint          indexLimit; // Clusters starting past it are outside the selected strand prefix
+    uint          firstInstance;
+    uint          instanceCount;
+    uint          firstOutput;
+    uint          mode;   // 0 culls for the camera view, 1 for the shadow view
+    uint          pulled; // Camera view records hold a VkDrawIndirectCommand for vertex pulled strands. 1 line lists, 2 line strips
+    uvec4         firstCommand; // Per view
+    uvec4         capacity;     // Per view
+} culling;
+
+// Conservative test against the planes of a clip space transform. The near plane is taken as -w, valid for both depth ranges
+bool sphereInFrustum(mat4 viewProj, vec3 center, float radius) {
+    vec4 rowX = vec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    vec4 rowY = vec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    vec4 rowZ = vec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    vec4 rowW = vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    vec4 planes[6] = vec4[6](rowW + rowX, rowW - rowX, rowW + rowY, rowW - rowY, rowW + rowZ, rowW - rowZ);
+    for (int i = 0; i < 6; i++)
+    {
+        float len = length(planes[i].xyz);
+        if (len > 0.0 && dot(planes[i], vec4(center, 1.0)) < -radius * len)
+            return false;
+    }
+    return true;
+}
+
+void append(uint view, StrandCluster cluster, uint instance) {
+    uint counter = culling.firstOutput + view;
+    uint slot    = atomicAdd(culling.counts.counts[counter].x, 1u);
+    if (slot >= culling.capacity[view])
+        return;
+    culling.counts.counts[counter].yz = uvec2(1u);
+
+    DrawCommand command;
+    command.indexCount    = cluster.indexCount;
+    command.instanceCount = 1u;
+    command.firstIndex    = cluster.firstIndex;
+    command.vertexOffset  = 0;
+    command.firstInstance = culling.firstInstance + instance;
+    if (view == STRAND_CAMERA_VIEW && culling.pulled != 0u)
+    {
+        // {vertexCount, instanceCount, firstVertex, firstInstance} over the same record, see strand_pulling.glsl
+        bool strips           = culling.pulled == 2u;
+        command.indexCount    = (strips ? cluster.indexCount - 1u : cluster.indexCount / 2u) * STRAND_SEGMENT_VERTICES - 2u;
+        command.firstIndex    = (strips ? cluster.firstIndex : cluster.firstIndex / 2u) * STRAND_SEGMENT_VERTICES;
+        command.vertexOffset  = int(culling.firstInstance + instance);
+        command.firstInstance = 0u;
+    }
+    culling.commands.commands[culling.firstCommand[view] + slot] = command;
+}
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= culling.clusterCount * culling.instanceCount)
+        return;
+    uint          instance = id / culling.clusterCount;
+    StrandCluster cluster  = culling.clusters.clusters[culling.firstCluster + id % culling.clusterCount];
+    if (cluster.firstIndex >= culling.indexLimit)
+        return;
+
+    ObjectEntry object = culling.objects.entries[culling.firstInstance + instance];
+    vec3  center = (object.model * vec4(cluster.bounds.xyz, 1.0)).xyz;
+    float scale  = max(length(object.model[0].xyz), max(length(object.model[1].xyz), length(object.model[2].xyz)));
+    float radius = cluster.bounds.w * scale;
+
+    if (culling.mode == 0u)
+    {
+        if (sphereInFrustum(camera.viewProj, center, radius))
+            append(STRAND_CAMERA_VIEW, cluster, instance);
+        return;
+    }
+
+    bool inLights = false;
+    for (int i = 0; i < min(scene.numLights, MAX_LIGHTS) && !inLights; i++)
+    {
+        if (scene.lights[i].shadowCast != 0.0)
+            inLights = sphereInFrustum(scene.lights[i].viewProj, center, radius);
+    }
+    if (inLights && object.otherParams1.z != 0.0)
+        append(STRAND_SHADOW_VIEW, cluster, instance);
+}
@@ -3,7 +3,7 @@ layout(set = 1, binding = 0) uniform ObjectUniforms {
     vec4    maxCoord;
     vec4    minCoord;
     vec4    otherParams;
-    int     selected;
-    vec3    volumeCenter;
+    vec4    otherParams2; // x selected, yzw volume center
+    vec4    volumeAtlas;
 
 } object;
\ No newline at end of file
@@ -0,0 +1,34 @@
+// Per instance object data read from the frame object table. Needs strand.glsl.
+// Same members as the ObjectUniforms block in object.glsl, so shader bodies work with either, plus the normal matrix.
+struct ObjectData {
+    mat4 model;
+    vec4 maxCoord;
+    vec4 minCoord;
+    vec4 otherParams;
+    int  selected;
+    vec3 volumeCenter;
+    vec4 volumeAtlas;
+    mat4 normalMatrix;
+};
+
+ObjectData object;
+
+void loadObject(uint instance) {
+    ObjectEntry entry   = strand.objects.entries[instance];
+    object.model        = entry.model;
+    object.maxCoord     = entry.maxCoord;
+    object.minCoord     = entry.minCoord;
+    object.otherParams  = entry.otherParams1;
+    object.selected     = int(entry.otherParams2.x);
+    object.volumeCenter = entry.otherParams2.yzw;
+    object.volumeAtlas  = entry.volumeAtlas;
+    object.normalMatrix = entry.normalMatrix;
+}
+
+// Inverse model transform, the normal matrix being its transpose. The object must be loaded.
+vec3 worldToObject(vec3 worldPos) {
+    return (transpose(object.normalMatrix) * vec4(worldPos, 1.0)).xyz;
+}
+vec3 worldToObjectDir(vec3 worldDir) {
+    return transpose(mat3(object.normalMatrix)) * worldDir;
+}
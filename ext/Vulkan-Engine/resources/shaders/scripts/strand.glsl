@@ -0,0 +1,73 @@
+#extension GL_EXT_buffer_reference : require
+
+// Decoding of Graphics::StrandVertex. Include it first thing after #version.
+
+// Per-strand data (Graphics::StrandData)
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer StrandBuffer {
+    vec4 data[]; // xyz color, w thickness
+};
+// Frame object table (Graphics::ObjectUniforms), indexed by instance
+struct ObjectEntry {
+    mat4 model;
+    vec4 maxCoord;
+    vec4 minCoord;
+    vec4 otherParams1;
+    vec4 otherParams2;
+    vec4 volumeAtlas;
+    mat4 normalMatrix;
+};
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer ObjectTable {
+    ObjectEntry entries[];
+};
+
+// Raw streams for vertex pulling (Graphics::StrandVertex as uvec4 and the strand indices)
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer StrandVertices {
+    uvec4 vertices[];
+};
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer StrandIndices {
+    uint indices[];
+};
+
+layout(push_constant) uniform StrandUniforms {
+    vec4           minCoord;
+    vec4           extent;
+    StrandBuffer   strands;
+    ObjectTable    objects;
+    vec4           params;
+    StrandVertices vertexBuffer;
+    StrandIndices  indexBuffer;
+    uint           topology; // Of the index streams
+    uint           padding;
+} strand;
+
+// Graphics::StrandTopology
+#define STRAND_LINE_LIST 0u
+#define STRAND_LINE_STRIP 1u
+#define STRAND_RESTART_INDEX 0xFFFFFFFFu
+
+// Segment slots of an index range and the first index of a slot. Strip slots touching a restart index join two strands
+uint strandSegmentCount(uint indexCount) {
+    return strand.topology == STRAND_LINE_STRIP ? max(indexCount, 1u) - 1u : indexCount / 2u;
+}
+uint strandSegmentIndex(uint segment) {
+    return strand.topology == STRAND_LINE_STRIP ? segment : segment * 2u;
+}
+
+vec3 decodeStrandPosition(vec3 quantizedPos) {
+    return strand.minCoord.xyz + quantizedPos * strand.extent.xyz;
+}
+// When reading the VBO as a storage buffer (uvec4 per vertex)
+vec3 decodeStrandPosition(uvec2 packedPos) {
+    return decodeStrandPosition(vec3(unpackUnorm2x16(packedPos.x), unpackUnorm2x16(packedPos.y).x));
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+}
+
+vec4 strandData(uint strandID) {
+    return strand.strands.data[strandID];
+}
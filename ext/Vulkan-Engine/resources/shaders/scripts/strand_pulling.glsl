@@ -0,0 +1,94 @@
+// Vertex pulled strand quads, in place of the geometry shader expansion. Needs strand.glsl, object_table.glsl and camera.glsl.
+//
+// Every segment slot takes STRAND_SEGMENT_VERTICES vertices of one triangle strip: its four corners, in the order the
+// geometry shader emits them, then its last corner again and the first corner of the next slot. The triangles bridging two
+// slots are degenerate, so a single non-indexed draw covers any slot range. Line strip slots touching a restart index
+// collapse to a point, which leaves every triangle reaching them degenerate too.
+
+#define STRAND_SEGMENT_VERTICES 6u
+
+// Same outputs as the geometry shader path
+struct StrandQuadVertex {
+    vec4 clipPos;
+    vec3 pos;
+    vec3 modelPos;
+    vec3 normal;
+    vec3 modelNormal;
+    vec2 uv;
+    vec3 dir;
+    vec3 modelDir;
+    vec3 color;
+    vec3 origin;
+};
+
+struct StrandPoint {
+    vec3  position; // World space
+    vec3  tangent;
+    vec3  color;
+    float thickness;
+};
+
+StrandPoint pullStrandPoint(uint index) {
+    uvec4 v          = strand.vertexBuffer.vertices[index];
+    vec4  strandInfo = strandData(v.w);
+
+    StrandPoint point;
+    point.position  = (object.model * vec4(decodeStrandPosition(v.xy), 1.0)).xyz;
+    point.tangent   = normalize(mat3(object.normalMatrix) * decodeOctahedral(unpackSnorm2x16(v.z)));
+    point.color     = strandInfo.rgb;
+    point.thickness = strandInfo.w * strand.params.x; // Widened on thinned levels of detail
+    return point;
+}
+
+// Expands the corner of the segment drawn by gl_VertexIndex. The object must be loaded.
+StrandQuadVertex pullStrandQuadVertex(uint vertexIndex, float materialThickness) {
+    uint segment = vertexIndex / STRAND_SEGMENT_VERTICES;
+    uint corner  = vertexIndex % STRAND_SEGMENT_VERTICES;
+    if (corner == STRAND_SEGMENT_VERTICES - 1u)
+    {
+        segment++;
+        corner = 0u;
+    } else
+        corner = min(corner, 3u);
+
+    bool  end  = (corner & 1u) != 0u;
+    float side = corner < 2u ? 1.0 : -1.0;
+
+    uint first = strandSegmentIndex(segment);
+    uint i0    = strand.indexBuffer.indices[first];
+    uint i1    = strand.indexBuffer.indices[first + 1u];
+
+    StrandQuadVertex v;
+    if (i0 == STRAND_RESTART_INDEX || i1 == STRAND_RESTART_INDEX)
+    {
+        v.clipPos = vec4(0.0);
+        v.pos = v.modelPos = v.normal = v.modelNormal = v.dir = v.modelDir = v.color = v.origin = vec3(0.0);
+        v.uv = vec2(0.0);
+        return v;
+    }
+
+    StrandPoint point = pullStrandPoint(end ? i1 : i0);
+
+    vec3 view   = camera.position.xyz - point.position;
+    vec3 right  = normalize(cross(point.tangent, view));
+    vec3 normal = normalize(cross(right, point.tangent));
+
+    // Both points of a segment belong to the same strand, so they share the thickness
+    float halfLength = materialThickness * point.thickness * 0.5;
+    vec4  newPos     = vec4(point.position + right * side * halfLength, 1.0);
+
+    // The view transform is rigid, its rotation is its own inverse transpose
+    mat3 viewRotation = mat3(camera.view);
+
+    v.clipPos     = camera.viewProj * newPos;
+    v.pos         = (camera.view * newPos).xyz;
+    v.modelPos    = newPos.xyz;
+    v.normal      = normalize(viewRotation * normal);
+    v.modelNormal = normal;
+    v.uv          = vec2(corner < 2u ? 1.0 : 0.0, end ? 1.0 : 0.0);
+    v.dir         = normalize(viewRotation * point.tangent);
+    v.modelDir    = point.tangent;
+    v.color       = point.color;
+    v.origin      = (camera.view * vec4(point.position, 1.0)).xyz;
+    return v;
+}
@@ -44,4 +44,81 @@ vec3 fromLinearAbsorption(vec3 x) {
 }
 vec3 toLinearAbsorption(vec3 x) {
   return x * x;
-}
\ No newline at end of file
+}
+// Hair volume atlas. Every voxelized groom owns a cubic slot of the brick grid, slots lie side by side along x. atlas is
+// the object volumeAtlas: slot (negative if none) and slot count
+bool hasHairVolume(vec4 atlas) {
+  return atlas.x >= 0.0;
+}
+int hairVolumeSize(vec4 atlas, ivec3 atlasSize) {
+  return atlasSize.x / max(int(atlas.y), 1);
+}
+ivec3 hairVolumeOrigin(vec4 atlas, ivec3 atlasSize) {
+  return ivec3(int(atlas.x) * hairVolumeSize(atlas, atlasSize), 0, 0);
+}
+
+// Sparse hair volumes. Every texel of the brick grid covers HAIR_BRICK_SIZE^3 voxels of the groom bounds and holds its brick
+// of the pool plus one, zero where no segment landed. Bricks are packed in the pool images, slots take them from one
+// shared counter, the bricks of a slot are contiguous
+#define HAIR_BRICK_SIZE 8            // ENGINE_HAIR_BRICK_SIZE
+#define HAIR_BRICK_MARKED 0x80000000u // Cell touched by a segment, waiting for its brick
+#define HAIR_MAX_VOLUMES 4           // ENGINE_MAX_HAIR_VOLUMES
+
+// VkDispatchIndirectCommand over the bricks of a slot, one workgroup each
+struct HairBrickDispatch {
+  uint x;
+  uint y;
+  uint z;
+};
+
+// Voxels per side of a slot
+int hairVolumeResolution(vec4 atlas, ivec3 gridSize) {
+  return hairVolumeSize(atlas, gridSize) * HAIR_BRICK_SIZE;
+}
+// Voxel of the slot holding a point of the object bounds, given in [0,1]
+ivec3 hairVolumeVoxel(vec3 uvw, vec4 atlas, ivec3 gridSize) {
+  return ivec3(clamp(uvw, 0.0, 0.9999) * float(hairVolumeResolution(atlas, gridSize)));
+}
+// Brick grid texel of a voxel of the slot
+ivec3 hairBrickCell(ivec3 voxel, vec4 atlas, ivec3 gridSize) {
+  return hairVolumeOrigin(atlas, gridSize) + voxel / HAIR_BRICK_SIZE;
+}
+uint hairBrickCapacity(ivec3 poolSize) {
+  ivec3 bricks = poolSize / HAIR_BRICK_SIZE;
+  return uint(bricks.x * bricks.y * bricks.z);
+}
+ivec3 hairBrickOrigin(uint brick, ivec3 poolSize) {
+  ivec3 bricks = poolSize / HAIR_BRICK_SIZE;
+  return ivec3(brick % uint(bricks.x), (brick / uint(bricks.x)) % uint(bricks.y), brick / uint(bricks.x * bricks.y)) * HAIR_BRICK_SIZE;
+}
+// Pool texel of a voxel, given the brick grid entry of its cell. The entry must not be zero
+ivec3 hairBrickTexel(uint entry, ivec3 voxel, ivec3 poolSize) {
+  return hairBrickOrigin(entry - 1u, poolSize) + (voxel & (HAIR_BRICK_SIZE - 1));
+}
+// Cells of the slot are kept along with their bricks, 10 bits per axis
+uint packHairBrickCell(ivec3 cell) {
+  return uint(cell.x) | (uint(cell.y) << 10) | (uint(cell.z) << 20);
+}
+ivec3 unpackHairBrickCell(uint cell) {
+  return ivec3(cell & 0x3FFu, (cell >> 10) & 0x3FFu, (cell >> 20) & 0x3FFu);
+}
+// Voxel of a sparse volume, zero where no brick was allocated
+vec4 fetchHairVolume(usampler3D grid, sampler3D pool, ivec3 voxel, vec4 atlas) {
+  uint entry = texelFetch(grid, hairBrickCell(voxel, atlas, textureSize(grid, 0)), 0).r;
+  if (entry == 0u) return vec4(0.0);
+  return texelFetch(pool, hairBrickTexel(entry, voxel, textureSize(pool, 0)), 0);
+}
+// Trilinear filtering by hand, neighbouring voxels are rarely neighbours in the pool
+vec4 sampleHairVolume(usampler3D grid, sampler3D pool, vec3 uvw, vec4 atlas) {
+  int   res = hairVolumeResolution(atlas, textureSize(grid, 0));
+  vec3  p   = clamp(uvw * float(res) - 0.5, vec3(0.0), vec3(res - 1));
+  ivec3 v0  = ivec3(p);
+  ivec3 v1  = min(v0 + 1, ivec3(res - 1));
+  vec3  f   = p - vec3(v0);
+
+  vec4 c00 = mix(fetchHairVolume(grid, pool, v0, atlas), fetchHairVolume(grid, pool, ivec3(v1.x, v0.y, v0.z), atlas), f.x);
+  vec4 c10 = mix(fetchHairVolume(grid, pool, ivec3(v0.x, v1.y, v0.z), atlas), fetchHairVolume(grid, pool, ivec3(v1.x, v1.y, v0.z), atlas), f.x);
+  vec4 c01 = mix(fetchHairVolume(grid, pool, ivec3(v0.x, v0.y, v1.z), atlas), fetchHairVolume(grid, pool, ivec3(v1.x, v0.y, v1.z), atlas), f.x);
+  vec4 c11 = mix(fetchHairVolume(grid, pool, ivec3(v0.x, v1.y, v1.z), atlas), fetchHairVolume(grid, pool, v1, atlas), f.x);
+  return mix(mix(c00, c10, f.y), mix(c01, c11, f.y), f.z);
+}
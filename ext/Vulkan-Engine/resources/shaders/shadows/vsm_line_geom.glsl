@@ -1,25 +1,36 @@
 #shader vertex
 #version 460
+#include strand.glsl
+#include object_table.glsl
 
-//Input VBO
-layout(location = 0) in vec3 pos;
+//Input VBO (strand layout)
+layout(location = 0) in vec4 pos;
+
+layout(location = 0) out float v_castShadows;
 
 void main() {
-   gl_Position = vec4(pos, 1.0);
+   // Batched draws, the instance indexes the object table
+   loadObject(gl_InstanceIndex);
+   v_castShadows = object.otherParams.z;
+   gl_Position = object.model * vec4(decodeStrandPosition(pos.xyz), 1.0);
 }
 
 #shader geometry
 #version 460
 #include light.glsl
 #include scene.glsl
-#include object.glsl
 
 
 layout(lines) in;
 layout(line_strip, max_vertices = 100) out;
 
+layout(location = 0) in float v_castShadows[];
+
 
 void main() {
+    //Batch members that do not cast shadows
+    if(v_castShadows[0] == 0.0) return;
+
     for(int i = 0; i < MAX_LIGHTS; i++) {
 
         //Stop emitting vertex if theres no more lights
@@ -28,10 +39,10 @@ void main() {
         gl_Layer = i;
         if(scene.lights[i].type == 2) continue; //If some light is raytraced
 
-        gl_Position = scene.lights[i].viewProj * object.model*gl_in[0].gl_Position;
+        gl_Position = scene.lights[i].viewProj * gl_in[0].gl_Position;
         EmitVertex();
         
-        gl_Position = scene.lights[i].viewProj * object.model*gl_in[1].gl_Position;
+        gl_Position = scene.lights[i].viewProj * gl_in[1].gl_Position;
         EmitVertex();
         
 
@@ -5,13 +5,32 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 namespace Core {
 
 void Geometry::fill(std::vector<Graphics::Vertex> vertexInfo) {
-    m_properties.vertexData = vertexInfo;
+    m_properties.view.reset();
+    m_properties.strandVertexData.clear();
+    m_properties.strandData.clear();
+    m_properties.strandLODs.clear();
+    m_properties.lodIndexData.clear();
+    m_properties.strandClusters.clear();
+    m_properties.strandPermutation.clear();
+    m_strandBVH.reset();
+    m_properties.strandSort = STRAND_SORT_NONE;
+    m_properties.vertexData = std::move(vertexInfo);
     m_properties.compute_statistics();
     m_properties.loaded = true;
 }
 void Geometry::fill(std::vector<Graphics::Vertex> vertexInfo, std::vector<uint32_t> vertexIndex) {
-    m_properties.vertexData  = vertexInfo;
-    m_properties.vertexIndex = vertexIndex;
+    m_properties.view.reset();
+    m_properties.strandVertexData.clear();
+    m_properties.strandData.clear();
+    m_properties.strandLODs.clear();
+    m_properties.lodIndexData.clear();
+    m_properties.strandClusters.clear();
+    m_properties.strandPermutation.clear();
+    m_strandBVH.reset();
+    m_properties.strandTopology = STRAND_LINE_LIST;
+    m_properties.strandSort     = STRAND_SORT_NONE;
+    m_properties.vertexData     = std::move(vertexInfo);
+    m_properties.vertexIndex    = std::move(vertexIndex);
     m_properties.compute_statistics();
     m_properties.loaded = true;
 }
@@ -25,15 +44,482 @@ void Geometry::fill(Vec3* pos, Vec3* normal, Vec2* uv, Vec3* tangent, uint32_t v
     m_properties.loaded = true;
 }
 
+void Geometry::fill(std::shared_ptr<GeometricView> view, Vec3 minCoords, Vec3 maxCoords) {
+    m_properties.vertexData.clear();
+    m_properties.vertexIndex.clear();
+    m_properties.strandVertexData.clear();
+    m_properties.strandData.clear();
+    m_properties.strandLODs.clear();
+    m_properties.lodIndexData.clear();
+    m_properties.strandClusters.clear();
+    m_properties.strandPermutation.clear();
+    m_strandBVH.reset();
+    m_properties.strandTopology = STRAND_LINE_LIST;
+    m_properties.strandSort     = STRAND_SORT_NONE;
+    m_properties.view           = std::move(view);
+    m_properties.minCoords      = minCoords;
+    m_properties.maxCoords      = maxCoords;
+    m_properties.center         = (maxCoords + minCoords) * 0.5f;
+    m_properties.loaded         = true;
+}
+
 void Geometry::fill_voxel_array(std::vector<Graphics::Voxel> voxels) {
-    m_properties.voxelData = voxels;
+    m_properties.voxelData = std::move(voxels);
+}
+void Geometry::swap_properties(Geometry& other) {
+    std::swap(m_properties, other.m_properties);
+    m_strandBVH.reset();
+    other.m_strandBVH.reset();
+}
+const StrandBVH* Geometry::build_strand_BVH() {
+    const size_t indexCount = m_properties.index_count();
+    if (m_properties.vertex_count() == 0 || indexCount < 2)
+    {
+        LOG_DEBUG("Strand BVH needs vertex data and strand indices");
+        return m_strandBVH.get();
+    }
+    const std::vector<uint32_t>& offsets = m_properties.strandOffsets;
+
+    auto bvh = std::make_shared<StrandBVH>();
+    bvh->build(m_properties.vertex_data(),
+               m_properties.index_data(),
+               Graphics::strand_segment_count(m_properties.strandTopology, static_cast<uint32_t>(indexCount)),
+               offsets.size() > 1 ? offsets.data() : nullptr,
+               offsets.size() > 1 ? offsets.size() - 1 : 0,
+               m_properties.strandTopology);
+    m_strandBVH = std::move(bvh);
+    return m_strandBVH.get();
+}
+void Geometry::refit_strand_BVH() {
+    if (m_strandBVH && m_properties.vertex_count() > 0 && m_properties.index_count() > 0)
+        m_strandBVH->refit(m_properties.vertex_data(), m_properties.index_data());
+}
+void Geometry::release_CPU_streams() {
+    // Swap with empty vectors so the memory is actually given back
+    std::vector<Graphics::Vertex>().swap(m_properties.vertexData);
+    std::vector<uint32_t>().swap(m_properties.vertexIndex);
+    std::vector<Graphics::Voxel>().swap(m_properties.voxelData);
+    std::vector<Graphics::StrandVertex>().swap(m_properties.strandVertexData);
+    std::vector<Graphics::StrandData>().swap(m_properties.strandData);
+    std::vector<uint32_t>().swap(m_properties.lodIndexData); // The LOD table is kept, draws need it
+    std::vector<Graphics::StrandCluster>().swap(m_properties.strandClusters);
+    m_properties.view.reset();
+}
+void Geometry::quantize_strands() {
+    const size_t vertexCount = m_properties.vertex_count();
+    if (vertexCount == 0)
+        return;
+
+    std::vector<uint32_t> offsets = m_properties.strandOffsets;
+    if (offsets.size() < 2)
+        offsets = {0, static_cast<uint32_t>(vertexCount)};
+    const size_t strandCount = offsets.size() - 1;
+
+    const Graphics::Vertex* vertices = m_properties.vertex_data();
+    const Vec3              minCoord = m_properties.minCoords;
+    const Vec3              extent   = m_properties.maxCoords - m_properties.minCoords;
+
+    std::vector<Graphics::StrandVertex> strandVertices(vertexCount);
+    std::vector<Graphics::StrandData>   strands(strandCount);
+    Graphics::Utils::parallel_for(
+        strandCount,
+        [&](size_t begin, size_t end) {
+            for (size_t strand = begin; strand < end; strand++)
+            {
+                const size_t first = offsets[strand];
+                const size_t last  = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+                if (first < last)
+                    strands[strand].color = vertices[first].color;
+                for (size_t i = first; i < last; i++)
+                    strandVertices[i] =
+                        Graphics::StrandVertex::encode(vertices[i].pos, vertices[i].tangent, static_cast<uint32_t>(strand), minCoord, extent);
+            }
+        },
+        256);
+
+    m_properties.strandVertexData = std::move(strandVertices);
+    m_properties.strandData       = std::move(strands);
+}
+// Spreads the low 21 bits of v two bits apart, to interleave three of them into a 63 bit Morton code
+static uint64_t morton_spread(uint64_t v) {
+    v &= 0x1fffffull;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8) & 0x100f00f00f00f00full;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+void Geometry::sort_strands(StrandSortKey key) {
+    const size_t                 vertexCount = m_properties.vertex_count();
+    const std::vector<uint32_t>& offsets     = m_properties.strandOffsets;
+    if (key == STRAND_SORT_NONE)
+        return;
+    if (m_properties.view || vertexCount == 0 || offsets.size() < 2)
+    {
+        LOG_DEBUG("Strand sorting needs owned strand vertices and offsets");
+        return;
+    }
+    const size_t strandCount = offsets.size() - 1;
+
+    // Morton code of every strand key point, quantized against the bounds
+    const Graphics::Vertex* vertices = m_properties.vertex_data();
+    const Vec3              minCoord = m_properties.minCoords;
+    const Vec3              extent   = math::max(m_properties.maxCoords - m_properties.minCoords, Vec3(1e-6f));
+    const float             cells    = float((1u << 21) - 1);
+
+    std::vector<uint64_t> codes(strandCount, 0);
+    Graphics::Utils::parallel_for(
+        strandCount,
+        [&](size_t begin, size_t end) {
+            for (size_t strand = begin; strand < end; strand++)
+            {
+                const size_t first = offsets[strand];
+                const size_t last  = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+                if (first >= last)
+                    continue;
+                Vec3 point = vertices[first].pos;
+                if (key == STRAND_SORT_CENTROID)
+                {
+                    for (size_t i = first + 1; i < last; i++)
+                        point += vertices[i].pos;
+                    point /= float(last - first);
+                }
+                const Vec3 cell = math::clamp((point - minCoord) / extent * cells, Vec3(0.0f), Vec3(cells));
+                codes[strand]   = morton_spread(static_cast<uint64_t>(cell.x)) | morton_spread(static_cast<uint64_t>(cell.y)) << 1 |
+                                morton_spread(static_cast<uint64_t>(cell.z)) << 2;
+            }
+        },
+        256);
+
+    // Ties keep the current order, so sorting is deterministic
+    std::vector<uint32_t> order(strandCount);
+    for (size_t strand = 0; strand < strandCount; strand++)
+        order[strand] = static_cast<uint32_t>(strand);
+    std::sort(order.begin(), order.end(), [&codes](uint32_t a, uint32_t b) { return codes[a] < codes[b] || (codes[a] == codes[b] && a < b); });
+
+    std::vector<uint32_t> sortedOffsets(strandCount + 1);
+    sortedOffsets[0] = 0;
+    for (size_t i = 0; i < strandCount; i++)
+    {
+        const size_t strand  = order[i];
+        const size_t first   = std::min(static_cast<size_t>(offsets[strand]), vertexCount);
+        const size_t last    = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+        sortedOffsets[i + 1] = sortedOffsets[i] + static_cast<uint32_t>(last > first ? last - first : 0);
+    }
+
+    // Vertices move as whole strand ranges. Indices are rebuilt as a line list over the new ranges
+    const bool            indexed = m_properties.index_count() > 0;
+    std::vector<uint32_t> indexOffsets(strandCount + 1);
+    indexOffsets[0] = 0;
+    for (size_t i = 0; i < strandCount; i++)
+    {
+        const uint32_t points = sortedOffsets[i + 1] - sortedOffsets[i];
+        indexOffsets[i + 1]   = indexOffsets[i] + (indexed && points > 0 ? points - 1 : 0) * 2;
+    }
+    std::vector<Graphics::Vertex> sortedVertices(sortedOffsets.back());
+    std::vector<uint32_t>         sortedIndices(indexOffsets.back());
+    Graphics::Utils::parallel_for(
+        strandCount,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const size_t first = sortedOffsets[i];
+                const size_t last  = sortedOffsets[i + 1];
+                const size_t src   = std::min(static_cast<size_t>(offsets[order[i]]), vertexCount);
+                std::copy(vertices + src, vertices + src + (last - first), sortedVertices.begin() + first);
+
+                uint32_t* dst = sortedIndices.data() + indexOffsets[i];
+                for (size_t v = first + 1; indexed && v < last; v++)
+                {
+                    *dst++ = static_cast<uint32_t>(v - 1);
+                    *dst++ = static_cast<uint32_t>(v);
+                }
+            }
+        },
+        256);
+
+    // Per strand voxels (e.g. the strand boxes of the procedural acceleration structure) follow their strand
+    if (m_properties.voxelData.size() == strandCount)
+    {
+        std::vector<Graphics::Voxel> sortedVoxels(strandCount);
+        for (size_t i = 0; i < strandCount; i++)
+            sortedVoxels[i] = m_properties.voxelData[order[i]];
+        m_properties.voxelData = std::move(sortedVoxels);
+    }
+    // Composed with the current permutation, so sorting twice still maps back to the file
+    std::vector<uint32_t> permutation(strandCount);
+    for (size_t i = 0; i < strandCount; i++)
+        permutation[i] = m_properties.source_strand(order[i]);
+
+    m_properties.vertexData        = std::move(sortedVertices);
+    m_properties.vertexIndex       = std::move(sortedIndices);
+    m_properties.strandOffsets     = std::move(sortedOffsets);
+    m_properties.strandPermutation = std::move(permutation);
+    m_properties.strandSort        = key;
+    m_properties.strandTopology    = STRAND_LINE_LIST;
+    m_properties.strandVertexData.clear();
+    m_properties.strandData.clear();
+    m_properties.strandLODs.clear();
+    m_properties.lodIndexData.clear();
+    m_properties.strandClusters.clear();
+    m_strandBVH.reset();
+}
+// Tier visited k-th, the bit reversal of k. Every prefix of the visit order spreads its tiers evenly over the strands
+static uint32_t priority_tier(uint32_t k) {
+    uint32_t tier = 0;
+    for (uint32_t bit = 1; bit < STRAND_PRIORITY_TIERS; bit <<= 1, k >>= 1)
+        tier = (tier << 1) | (k & 1u);
+    return tier;
+}
+static uint32_t priority_tier_size(uint32_t tier, uint32_t strandCount) {
+    return tier < strandCount ? (strandCount - tier + STRAND_PRIORITY_TIERS - 1) / STRAND_PRIORITY_TIERS : 0;
+}
+// Douglas-Peucker over the vertices [first, last). Flags the ones kept for the given error
+static void simplify_strand(const Graphics::Vertex*                 vertices,
+                            size_t                                  first,
+                            size_t                                  last,
+                            float                                   error,
+                            std::vector<uint8_t>&                   keep,
+                            std::vector<std::pair<size_t, size_t>>& stack) {
+    if (first >= last)
+        return;
+    std::fill(keep.begin() + first, keep.begin() + last, 0);
+    keep[first]    = 1;
+    keep[last - 1] = 1;
+
+    stack.clear();
+    stack.push_back({first, last - 1});
+    while (!stack.empty())
+    {
+        const auto [a, b] = stack.back();
+        stack.pop_back();
+        if (b <= a + 1)
+            continue;
+
+        const Vec3  pa       = vertices[a].pos;
+        const Vec3  ab       = vertices[b].pos - pa;
+        const float length2  = math::dot(ab, ab);
+        float       maxDist  = 0.0f;
+        size_t      farthest = a;
+        for (size_t v = a + 1; v < b; v++)
+        {
+            const float t    = length2 > 0.0f ? math::clamp(math::dot(vertices[v].pos - pa, ab) / length2, 0.0f, 1.0f) : 0.0f;
+            const float dist = math::length(vertices[v].pos - (pa + t * ab));
+            if (dist > maxDist)
+            {
+                maxDist  = dist;
+                farthest = v;
+            }
+        }
+        if (maxDist > error)
+        {
+            keep[farthest] = 1;
+            stack.push_back({a, farthest});
+            stack.push_back({farthest, b});
+        }
+    }
+}
+void Geometry::build_strand_LODs(StrandTopology topology) {
+    const size_t                 vertexCount = m_properties.vertex_count();
+    const std::vector<uint32_t>& offsets     = m_properties.strandOffsets;
+    if (vertexCount == 0 || offsets.size() < 2)
+        return;
+    const size_t strandCount = offsets.size() - 1;
+
+    size_t segmentCount = 0, stripCount = 0;
+    for (size_t strand = 0; strand < strandCount; strand++)
+    {
+        const size_t first = offsets[strand];
+        const size_t last  = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+        segmentCount += last > first ? last - first - 1 : 0;
+        stripCount += last > first + 1;
+    }
+    // Indices are rebuilt from the offsets, the current ones only have to match them
+    const bool   strips       = topology == STRAND_LINE_STRIP;
+    const size_t currentCount = m_properties.strandTopology == STRAND_LINE_STRIP ? segmentCount + stripCount : segmentCount * 2;
+    if (m_properties.view || m_properties.index_count() != currentCount)
+    {
+        LOG_DEBUG("Strand LODs need owned strand indices, one segment per pair of consecutive strand vertices");
+        return;
+    }
+
+    // Priority order. Strands keep their storage order within a tier, so spatially sorted grooms are drawn coherently
+    std::vector<uint32_t> order;
+    order.reserve(strandCount);
+    for (uint32_t k = 0; k < STRAND_PRIORITY_TIERS; k++)
+        for (size_t strand = priority_tier(k); strand < strandCount; strand += STRAND_PRIORITY_TIERS)
+            order.push_back(static_cast<uint32_t>(strand));
+
+    const Graphics::Vertex*              vertices = m_properties.vertex_data();
+    const float                          radius   = math::length(m_properties.maxCoords - m_properties.minCoords) * 0.5f;
+    const float                          errors[] = STRAND_LOD_ERRORS;
+    std::vector<uint8_t>                 keep(vertexCount, 1);
+    std::vector<uint32_t>                segments(strandCount);
+    std::vector<uint32_t>                levelIndices;
+    std::vector<uint32_t>                lodIndices;
+    std::vector<StrandLOD>               lods(STRAND_LOD_LEVELS);
+    std::vector<uint32_t>                clusterPrefix(strandCount + 1);
+    std::vector<Graphics::StrandCluster> clusters;
+    for (size_t level = 0; level < STRAND_LOD_LEVELS; level++)
+    {
+        // Kept vertices of every strand. Level 0 keeps them all
+        Graphics::Utils::parallel_for(
+            strandCount,
+            [&](size_t begin, size_t end) {
+                std::vector<std::pair<size_t, size_t>> stack;
+                for (size_t strand = begin; strand < end; strand++)
+                {
+                    const size_t first = offsets[strand];
+                    const size_t last  = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+                    if (level > 0)
+                        simplify_strand(vertices, first, last, errors[level] * radius, keep, stack);
+                    uint32_t kept = 0;
+                    for (size_t i = first; i < last; i++)
+                        kept += keep[i];
+                    segments[strand] = kept > 0 ? kept - 1 : 0;
+                }
+            },
+            256);
+
+        StrandLOD& lod = lods[level];
+        lod.error      = errors[level];
+        lod.firstIndex = level > 0 ? static_cast<uint32_t>(lodIndices.size()) : 0;
+        lod.indexPrefix.resize(strandCount + 1);
+        lod.indexPrefix[0] = 0;
+        for (size_t i = 0; i < strandCount; i++)
+        {
+            const uint32_t strandSegments = segments[order[i]];
+            lod.indexPrefix[i + 1]        = lod.indexPrefix[i] + (strips ? (strandSegments > 0 ? strandSegments + 2 : 0) : strandSegments * 2);
+        }
+
+        // Segments between consecutive kept vertices, strands in priority order. Strips list the kept vertices and a restart
+        std::vector<uint32_t>& indices = level > 0 ? lodIndices : levelIndices;
+        indices.resize(lod.firstIndex + lod.indexPrefix.back());
+        Graphics::Utils::parallel_for(
+            strandCount,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const size_t strand = order[i];
+                    const size_t first  = offsets[strand];
+                    const size_t last   = std::min(static_cast<size_t>(offsets[strand + 1]), vertexCount);
+                    uint32_t*    dst    = indices.data() + lod.firstIndex + lod.indexPrefix[i];
+                    size_t       prev   = first;
+                    if (strips)
+                    {
+                        if (segments[strand] == 0)
+                            continue;
+                        *dst++ = static_cast<uint32_t>(first);
+                        for (size_t v = first + 1; v < last; v++)
+                            if (keep[v])
+                                *dst++ = static_cast<uint32_t>(v);
+                        *dst = STRAND_RESTART_INDEX;
+                        continue;
+                    }
+                    for (size_t v = first + 1; v < last; v++)
+                    {
+                        if (!keep[v])
+                            continue;
+                        *dst++ = static_cast<uint32_t>(prev);
+                        *dst++ = static_cast<uint32_t>(v);
+                        prev   = v;
+                    }
+                }
+            },
+            256);
+
+        // Clusters never span two strands, so the ones of a strand prefix are a prefix of the level clusters
+        const uint32_t clusterSegments = STRAND_CLUSTER_SEGMENTS;
+        clusterPrefix[0]               = 0;
+        for (size_t i = 0; i < strandCount; i++)
+            clusterPrefix[i + 1] = clusterPrefix[i] + (segments[order[i]] + clusterSegments - 1) / clusterSegments;
+        lod.firstCluster = static_cast<uint32_t>(clusters.size());
+        lod.clusterCount = clusterPrefix.back();
+        clusters.resize(lod.firstCluster + lod.clusterCount);
+        Graphics::Utils::parallel_for(
+            strandCount,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const uint32_t           strandFirst    = lod.firstIndex + lod.indexPrefix[i];
+                    const uint32_t           strandSegments = segments[order[i]];
+                    Graphics::StrandCluster* cluster        = clusters.data() + lod.firstCluster + clusterPrefix[i];
+                    for (uint32_t segment = 0; segment < strandSegments; segment += clusterSegments, cluster++)
+                    {
+                        const uint32_t span  = std::min(clusterSegments, strandSegments - segment);
+                        const uint32_t first = strandFirst + Graphics::strand_segment_index(topology, segment);
+                        const uint32_t count = strips ? span + 1 : span * 2;
+                        // Sphere around the box of the segment ends
+                        Vec3 minCoords = vertices[indices[first]].pos;
+                        Vec3 maxCoords = minCoords;
+                        for (uint32_t j = first + 1; j < first + count; j++)
+                        {
+                            minCoords = math::min(minCoords, vertices[indices[j]].pos);
+                            maxCoords = math::max(maxCoords, vertices[indices[j]].pos);
+                        }
+                        const Vec3 center = (minCoords + maxCoords) * 0.5f;
+                        float      radius = 0.0f;
+                        for (uint32_t j = first; j < first + count; j++)
+                            radius = std::max(radius, math::length(vertices[indices[j]].pos - center));
+
+                        cluster->bounds     = Vec4(center, radius);
+                        cluster->firstIndex = first;
+                        cluster->indexCount = count;
+                    }
+                }
+            },
+            256);
+    }
+
+    m_properties.vertexIndex    = std::move(levelIndices);
+    m_properties.strandLODs     = std::move(lods);
+    m_properties.lodIndexData   = std::move(lodIndices);
+    m_properties.strandClusters = std::move(clusters);
+    m_properties.strandTopology = topology;
+    m_strandBVH.reset(); // Segments were renumbered
+}
+StrandLODSelection Geometry::select_strand_LOD(float pixels) const {
+    StrandLODSelection selection = {};
+    selection.pixels             = pixels;
+
+    const std::vector<StrandLOD>& lods = m_properties.strandLODs;
+    if (lods.empty() || lods[0].indexPrefix.size() < 2)
+        return selection;
+    const uint32_t total = static_cast<uint32_t>(lods[0].indexPrefix.size() - 1);
+
+    uint32_t count = total;
+    size_t   level = 0;
+    if (m_lodSettings.enabled)
+    {
+        const float size     = std::min(pixels, 1e5f); // The camera may be inside the bounds
+        const float fraction = std::min(std::max(m_lodSettings.strandsPerPixel * size * size / total, m_lodSettings.minStrandFraction), 1.0f);
+        count                = std::min(std::max(static_cast<uint32_t>(std::ceil(fraction * total)), 1u), total);
+        // Whole tiers only, a partial one would thin part of the groom more than the rest
+        uint32_t tierEnd = 0;
+        for (uint32_t k = 0; k < STRAND_PRIORITY_TIERS && tierEnd < count; k++)
+            tierEnd += priority_tier_size(priority_tier(k), total);
+        count = std::min(tierEnd, total);
+        // Coarsest level whose error stays under the allowed one once projected
+        for (level = lods.size() - 1; level > 0; level--)
+            if (lods[level].error * size * 0.5f <= m_lodSettings.maxPixelError)
+                break;
+    }
+    selection.level       = static_cast<uint32_t>(level);
+    selection.strandCount = count;
+    selection.firstIndex  = lods[level].firstIndex;
+    selection.indexCount  = lods[level].indexPrefix[count];
+    selection.widthScale  = static_cast<float>(total) / count;
+    return selection;
 }
 void GeometricData::compute_statistics() {
     maxCoords = {0.0f, 0.0f, 0.0f};
     minCoords = {INFINITY, INFINITY, INFINITY};
 
-   for (const Graphics::Vertex& v : vertexData)
+    const Graphics::Vertex* vertices = vertex_data();
+    for (size_t i = 0; i < vertex_count(); i++)
     {
+        const Graphics::Vertex& v = vertices[i];
         if (v.pos.x > maxCoords.x)
             maxCoords.x = v.pos.x;
         if (v.pos.y > maxCoords.y)
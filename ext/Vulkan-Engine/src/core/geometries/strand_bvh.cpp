@@ -0,0 +1,775 @@
+#include <atomic>
+#include <engine/core/geometries/strand_bvh.h>
+#include <engine/graphics/utilities/utils.h>
+#include <mutex>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Core {
+
+namespace {
+
+#define STRAND_BVH_STACK_SIZE 256
+
+struct Bounds {
+    Vec3 min = Vec3(FLT_MAX);
+    Vec3 max = Vec3(-FLT_MAX);
+
+    inline void grow(const Vec3& p) {
+        min = math::min(min, p);
+        max = math::max(max, p);
+    }
+    inline void grow(const Bounds& b) {
+        min = math::min(min, b.min);
+        max = math::max(max, b.max);
+    }
+    inline bool valid() const {
+        return min.x <= max.x;
+    }
+    inline float area() const {
+        if (!valid())
+            return 0.0f;
+        const Vec3 e = max - min;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+// Left uninitialized, small ranges only reset the bins they use
+struct Bin {
+    Vec3     min;
+    Vec3     max;
+    uint32_t count;
+
+    inline void reset() {
+        min   = Vec3(FLT_MAX);
+        max   = Vec3(-FLT_MAX);
+        count = 0;
+    }
+    inline void grow(const Bin& b) {
+        min = math::min(min, b.min);
+        max = math::max(max, b.max);
+        count += b.count;
+    }
+};
+typedef Bin Bins[3][STRAND_BVH_BINS];
+
+/*
+Binary node of the intermediate tree. Deferred subtrees are leaves pointing to a build task.
+*/
+struct BuildNode {
+    Bounds   bounds;
+    uint32_t left  = UINT32_MAX;
+    uint32_t right = UINT32_MAX;
+    uint32_t first = 0; // Leaves: first reference. Deferred: task index
+    uint32_t count = 0;
+    bool     deferred = false;
+
+    inline bool leaf() const {
+        return left == UINT32_MAX;
+    }
+};
+struct BuildTask {
+    uint32_t begin;
+    uint32_t end;
+    Bounds   bounds;
+    Bounds   centroids;
+};
+
+/*
+Segment endpoints, partitioned in place so the build walks them linearly. The centroid is taken as p0 + p1
+*/
+struct PrimRef {
+    Vec3     p0;
+    uint32_t segment;
+    Vec3     p1;
+    uint32_t strand;
+
+    inline Vec3 centroid() const {
+        return p0 + p1;
+    }
+};
+
+class Builder
+{
+    std::vector<PrimRef>& m_refs;
+
+    struct Binning {
+        Vec3 offset;
+        Vec3 scale; // Zero on flat axes
+        int  count; // Fewer bins on small ranges
+
+        Binning(const Bounds& centroids, uint32_t primitives) {
+            offset = centroids.min;
+            count  = static_cast<int>(std::min<uint32_t>(STRAND_BVH_BINS, std::max<uint32_t>(4, primitives / 2)));
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const float extent = centroids.max[axis] - centroids.min[axis];
+                scale[axis]        = extent > 0.0f ? count * 0.99999f / extent : 0.0f;
+            }
+        }
+        inline int bin_of(int axis, const Vec3& c) const {
+            const int bin = static_cast<int>((c[axis] - offset[axis]) * scale[axis]);
+            return std::min(std::max(bin, 0), count - 1);
+        }
+        inline void reset(Bins& bins) const {
+            for (int axis = 0; axis < 3; axis++)
+                for (int b = 0; b < count; b++)
+                    bins[axis][b].reset();
+        }
+    };
+
+    void bin_range(uint32_t begin, uint32_t end, const Binning& binning, Bins& bins) const {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const PrimRef& ref      = m_refs[i];
+            const Vec3     centroid = ref.centroid();
+            const Vec3     min      = math::min(ref.p0, ref.p1);
+            const Vec3     max      = math::max(ref.p0, ref.p1);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                Bin& bin = bins[axis][binning.bin_of(axis, centroid)];
+                bin.min  = math::min(bin.min, min);
+                bin.max  = math::max(bin.max, max);
+                bin.count++;
+            }
+        }
+    }
+    /*
+    Large ranges are binned in chunks on the job system and merged
+    */
+    void bin(uint32_t begin, uint32_t end, const Binning& binning, Bins& bins) const {
+        binning.reset(bins);
+        if (end - begin < 2 * STRAND_BVH_TASK_SIZE)
+        {
+            bin_range(begin, end, binning, bins);
+            return;
+        }
+        std::mutex mutex;
+        Graphics::Utils::parallel_for(
+            end - begin,
+            [&](size_t first, size_t last) {
+                Bins local;
+                binning.reset(local);
+                bin_range(begin + static_cast<uint32_t>(first), begin + static_cast<uint32_t>(last), binning, local);
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int axis = 0; axis < 3; axis++)
+                    for (int b = 0; b < binning.count; b++)
+                        bins[axis][b].grow(local[axis][b]);
+            },
+            STRAND_BVH_TASK_SIZE);
+    }
+    inline void grow(const PrimRef& ref, Bounds& bounds, Bounds& centroids) const {
+        bounds.grow(ref.p0);
+        bounds.grow(ref.p1);
+        centroids.grow(ref.centroid());
+    }
+    void range_bounds(uint32_t begin, uint32_t end, Bounds& bounds, Bounds& centroids) const {
+        for (uint32_t i = begin; i < end; i++)
+            grow(m_refs[i], bounds, centroids);
+    }
+    /*
+    Moves the references of the bins up to the split one to the front, gathering the bounds of both sides on the way
+    */
+    uint32_t partition(uint32_t begin, uint32_t end, const Binning& binning, int axis, int split, Bounds* bounds, Bounds* centroids) const {
+        uint32_t i = begin;
+        uint32_t j = end;
+        while (true)
+        {
+            while (i < j && binning.bin_of(axis, m_refs[i].centroid()) <= split)
+                grow(m_refs[i++], bounds[0], centroids[0]);
+            while (i < j && binning.bin_of(axis, m_refs[j - 1].centroid()) > split)
+                grow(m_refs[--j], bounds[1], centroids[1]);
+            if (i >= j)
+                return i;
+            std::swap(m_refs[i], m_refs[j - 1]);
+        }
+    }
+    uint32_t make_leaf(std::vector<BuildNode>& nodes, uint32_t node, uint32_t begin, uint32_t end) const {
+        nodes[node].first = begin;
+        nodes[node].count = end - begin;
+        return node;
+    }
+
+  public:
+    Builder(std::vector<PrimRef>& refs)
+        : m_refs(refs) {
+    }
+
+    /*
+    Builds the subtree of a range, children after their parent. With a task list, ranges small enough are deferred into it
+    */
+    uint32_t build(std::vector<BuildNode>& nodes,
+                   uint32_t                begin,
+                   uint32_t                end,
+                   const Bounds&           bounds,
+                   const Bounds&           centroids,
+                   std::vector<BuildTask>* tasks) const {
+        const uint32_t node  = static_cast<uint32_t>(nodes.size());
+        const uint32_t count = end - begin;
+        nodes.emplace_back();
+        nodes[node].bounds = bounds;
+
+        if (tasks && count <= STRAND_BVH_TASK_SIZE)
+        {
+            nodes[node].deferred = true;
+            nodes[node].first    = static_cast<uint32_t>(tasks->size());
+            tasks->push_back({begin, end, bounds, centroids});
+            return node;
+        }
+        if (count <= 2)
+            return make_leaf(nodes, node, begin, end);
+
+        const Binning binning(centroids, count);
+        Bins          bins;
+        bin(begin, end, binning, bins);
+
+        // SAH over every bin boundary of the three axes, traversal and intersection costs taken as equal
+        int   bestAxis = -1;
+        int   bestBin  = 0;
+        float bestCost = FLT_MAX;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (binning.scale[axis] == 0.0f)
+                continue;
+            float    rightArea[STRAND_BVH_BINS];
+            uint32_t rightCount[STRAND_BVH_BINS];
+            Bounds   right;
+            uint32_t rightN = 0;
+            for (int b = binning.count - 1; b > 0; b--)
+            {
+                right.min = math::min(right.min, bins[axis][b].min);
+                right.max = math::max(right.max, bins[axis][b].max);
+                rightN += bins[axis][b].count;
+                rightArea[b]  = right.area();
+                rightCount[b] = rightN;
+            }
+            Bounds   left;
+            uint32_t leftN = 0;
+            for (int b = 0; b < binning.count - 1; b++)
+            {
+                left.min = math::min(left.min, bins[axis][b].min);
+                left.max = math::max(left.max, bins[axis][b].max);
+                leftN += bins[axis][b].count;
+                if (leftN == 0 || rightCount[b + 1] == 0)
+                    continue;
+                const float cost = left.area() * leftN + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin  = b;
+                }
+            }
+        }
+
+        uint32_t middle = begin;
+        Bounds   childBounds[2], childCentroids[2];
+        if (bestAxis >= 0)
+        {
+            const float area = bounds.area();
+            const float cost = 1.0f + (area > 0.0f ? bestCost / area : static_cast<float>(count));
+            if (cost >= static_cast<float>(count) && count <= STRAND_BVH_MAX_LEAF_SIZE)
+                return make_leaf(nodes, node, begin, end);
+
+            middle = partition(begin, end, binning, bestAxis, bestBin, childBounds, childCentroids);
+        } else if (count <= STRAND_BVH_MAX_LEAF_SIZE)
+            return make_leaf(nodes, node, begin, end);
+
+        // Coincident centroids, split in half
+        if (middle == begin || middle == end)
+        {
+            middle         = begin + count / 2;
+            childBounds[0] = childBounds[1] = childCentroids[0] = childCentroids[1] = Bounds();
+            range_bounds(begin, middle, childBounds[0], childCentroids[0]);
+            range_bounds(middle, end, childBounds[1], childCentroids[1]);
+        }
+
+        const uint32_t left  = build(nodes, begin, middle, childBounds[0], childCentroids[0], tasks);
+        const uint32_t right = build(nodes, middle, end, childBounds[1], childCentroids[1], tasks);
+        nodes[node].left     = left;
+        nodes[node].right    = right;
+        return node;
+    }
+};
+
+/*
+Collapses the binary trees into the 4-wide pre-order layout
+*/
+class Collapser
+{
+    struct Ref {
+        const std::vector<BuildNode>* tree;
+        uint32_t                      node;
+    };
+
+    const std::vector<BuildNode>&              m_top;
+    const std::vector<std::vector<BuildNode>>& m_subtrees;
+    std::vector<StrandBVH::Node>&              m_nodes;
+
+    inline const BuildNode& get(const Ref& ref) const {
+        return (*ref.tree)[ref.node];
+    }
+    inline Ref resolve(Ref ref) const {
+        if (get(ref).deferred)
+            return {&m_subtrees[get(ref).first], 0};
+        return ref;
+    }
+
+  public:
+    Collapser(const std::vector<BuildNode>& top, const std::vector<std::vector<BuildNode>>& subtrees, std::vector<StrandBVH::Node>& nodes)
+        : m_top(top)
+        , m_subtrees(subtrees)
+        , m_nodes(nodes) {
+    }
+
+    void emit_root() {
+        const Ref root = resolve({&m_top, 0});
+        if (!get(root).leaf())
+        {
+            emit(root);
+            return;
+        }
+        // A single leaf still gets a node
+        Ref children[1] = {root};
+        emit_node(children, 1);
+    }
+    uint32_t emit(Ref ref) {
+        Ref children[4] = {resolve({ref.tree, get(ref).left}), resolve({ref.tree, get(ref).right})};
+        int count       = 2;
+        // Open the largest inner children until the node is full
+        while (count < 4)
+        {
+            int   best     = -1;
+            float bestArea = -1.0f;
+            for (int i = 0; i < count; i++)
+            {
+                const BuildNode& child = get(children[i]);
+                if (!child.leaf() && child.bounds.area() > bestArea)
+                {
+                    best     = i;
+                    bestArea = child.bounds.area();
+                }
+            }
+            if (best < 0)
+                break;
+            const Ref opened  = children[best];
+            children[best]    = resolve({opened.tree, get(opened).left});
+            children[count++] = resolve({opened.tree, get(opened).right});
+        }
+        return emit_node(children, count);
+    }
+    uint32_t emit_node(const Ref* children, int count) {
+        const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        for (int i = 0; i < 4; i++)
+        {
+            StrandBVH::Node& node = m_nodes[index];
+            node.minX[i] = node.minY[i] = node.minZ[i] = FLT_MAX;
+            node.maxX[i] = node.maxY[i] = node.maxZ[i] = -FLT_MAX;
+            node.child[i]                              = UINT32_MAX;
+            node.count[i]                              = 0;
+            if (i >= count)
+                continue;
+
+            const BuildNode& child = get(children[i]);
+            node.minX[i]           = child.bounds.min.x;
+            node.minY[i]           = child.bounds.min.y;
+            node.minZ[i]           = child.bounds.min.z;
+            node.maxX[i]           = child.bounds.max.x;
+            node.maxY[i]           = child.bounds.max.y;
+            node.maxZ[i]           = child.bounds.max.z;
+            if (child.leaf())
+            {
+                node.child[i] = child.first;
+                node.count[i] = child.count;
+            } else
+            {
+                const uint32_t childIndex = emit(children[i]); // May grow the node array
+                m_nodes[index].child[i]   = childIndex;
+            }
+        }
+        return index;
+    }
+};
+
+inline Vec3 safe_inverse(const Vec3& d) {
+    Vec3 inv;
+    for (int axis = 0; axis < 3; axis++)
+        inv[axis] = 1.0f / (std::abs(d[axis]) > 1e-12f ? d[axis] : std::copysign(1e-12f, d[axis]));
+    return inv;
+}
+/*
+Closest approach between a ray (normalized direction) and a segment. Returns the distance and sets the ray distance and the
+closest point on the segment.
+*/
+inline float ray_segment_distance(const Vec3& origin, const Vec3& dir, const Vec3& p0, const Vec3& p1, float& t, Vec3& point) {
+    const Vec3  e     = p1 - p0;
+    const Vec3  w     = p0 - origin;
+    const float b     = math::dot(dir, e);
+    const float c     = math::dot(e, e);
+    const float dw    = math::dot(dir, w);
+    const float ew    = math::dot(e, w);
+    const float denom = c - b * b;
+    float       s     = denom > 1e-12f * c ? math::clamp((b * dw - ew) / denom, 0.0f, 1.0f) : 0.0f;
+    t                 = dw + s * b;
+    if (t < 0.0f)
+    {
+        // Behind the origin, closest to the origin itself
+        t = 0.0f;
+        s = c > 0.0f ? math::clamp(-ew / c, 0.0f, 1.0f) : 0.0f;
+    }
+    point = p0 + e * s;
+    return math::length(origin + dir * t - point);
+}
+inline float point_segment_distance(const Vec3& p, const Vec3& p0, const Vec3& p1, Vec3& point) {
+    const Vec3  e = p1 - p0;
+    const float c = math::dot(e, e);
+    const float s = c > 0.0f ? math::clamp(math::dot(p - p0, e) / c, 0.0f, 1.0f) : 0.0f;
+    point         = p0 + e * s;
+    return math::length(p - point);
+}
+
+} // namespace
+
+void StrandBVH::clear() {
+    m_nodes.clear();
+    m_p0.clear();
+    m_p1.clear();
+    m_segments.clear();
+    m_strands.clear();
+    m_min = m_max = Vec3(0.0f);
+}
+
+void StrandBVH::build(const Graphics::Vertex* vertices,
+                      const uint32_t*         indices,
+                      size_t                  segmentCount,
+                      const uint32_t*         strandOffsets,
+                      size_t                  strandCount,
+                      StrandTopology          topology) {
+    clear();
+    if (!vertices || !indices || segmentCount == 0 || segmentCount >= UINT32_MAX)
+        return;
+    m_topology = topology;
+
+    // Strip slots touching a restart index join two strands
+    std::vector<uint32_t> slots;
+    if (topology == STRAND_LINE_STRIP)
+    {
+        slots.reserve(segmentCount);
+        for (size_t i = 0; i < segmentCount; i++)
+            if (indices[i] != STRAND_RESTART_INDEX && indices[i + 1] != STRAND_RESTART_INDEX)
+                slots.push_back(static_cast<uint32_t>(i));
+        segmentCount = slots.size();
+        if (segmentCount == 0)
+            return;
+    }
+
+    std::vector<PrimRef> refs(segmentCount);
+    Bounds               rootBounds, rootCentroids;
+    std::mutex           mutex;
+    Graphics::Utils::parallel_for(segmentCount, [&](size_t begin, size_t end) {
+        Bounds localBounds, localCentroids;
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint32_t segment = slots.empty() ? static_cast<uint32_t>(i) : slots[i];
+            const uint32_t index   = Graphics::strand_segment_index(topology, segment);
+            const uint32_t first   = indices[index];
+            refs[i].p0             = vertices[first].pos;
+            refs[i].p1             = vertices[indices[index + 1]].pos;
+            refs[i].segment        = segment;
+            refs[i].strand       = UINT32_MAX;
+            if (strandOffsets && strandCount > 0)
+                refs[i].strand = static_cast<uint32_t>(
+                    std::max<ptrdiff_t>(std::upper_bound(strandOffsets, strandOffsets + strandCount + 1, first) - strandOffsets - 1, 0));
+            localBounds.grow(refs[i].p0);
+            localBounds.grow(refs[i].p1);
+            localCentroids.grow(refs[i].centroid());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        rootBounds.grow(localBounds);
+        rootCentroids.grow(localCentroids);
+    });
+
+    // Top levels split with parallel binning, the subtrees below them are built as independent jobs
+    Builder                builder(refs);
+    std::vector<BuildNode> top;
+    std::vector<BuildTask> tasks;
+    builder.build(top, 0, static_cast<uint32_t>(segmentCount), rootBounds, rootCentroids, &tasks);
+
+    std::vector<uint32_t> order(tasks.size()); // Largest first
+    for (size_t i = 0; i < tasks.size(); i++)
+        order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return tasks[a].end - tasks[a].begin > tasks[b].end - tasks[b].begin;
+    });
+    std::vector<std::vector<BuildNode>> subtrees(tasks.size());
+    std::atomic<size_t>                 next{0};
+    Graphics::Utils::parallel_for(
+        tasks.size(),
+        [&](size_t, size_t) {
+            for (size_t i = next++; i < tasks.size(); i = next++)
+            {
+                const BuildTask& task = tasks[order[i]];
+                subtrees[order[i]].reserve((task.end - task.begin) / 2);
+                builder.build(subtrees[order[i]], task.begin, task.end, task.bounds, task.centroids, nullptr);
+            }
+        },
+        1);
+
+    m_nodes.reserve(segmentCount / 4 + 1);
+    Collapser(top, subtrees, m_nodes).emit_root();
+    m_nodes.shrink_to_fit();
+
+    m_p0.resize(segmentCount);
+    m_p1.resize(segmentCount);
+    m_segments.resize(segmentCount);
+    if (strandOffsets && strandCount > 0)
+        m_strands.resize(segmentCount);
+    Graphics::Utils::parallel_for(segmentCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            m_p0[i]       = refs[i].p0;
+            m_p1[i]       = refs[i].p1;
+            m_segments[i] = refs[i].segment;
+            if (!m_strands.empty())
+                m_strands[i] = refs[i].strand;
+        }
+    });
+    m_min = rootBounds.min;
+    m_max = rootBounds.max;
+}
+
+void StrandBVH::refit(const Graphics::Vertex* vertices, const uint32_t* indices) {
+    if (m_nodes.empty() || !vertices || !indices)
+        return;
+    Graphics::Utils::parallel_for(m_segments.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const uint32_t index = Graphics::strand_segment_index(m_topology, m_segments[i]);
+            m_p0[i]              = vertices[indices[index]].pos;
+            m_p1[i]              = vertices[indices[index + 1]].pos;
+        }
+    });
+    refit_nodes();
+}
+
+void StrandBVH::refit_nodes() {
+    // Leaves do not depend on each other
+    Graphics::Utils::parallel_for(
+        m_nodes.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t n = begin; n < end; n++)
+            {
+                Node& node = m_nodes[n];
+                for (int i = 0; i < 4; i++)
+                {
+                    if (node.count[i] == 0)
+                        continue;
+                    Bounds leaf;
+                    for (uint32_t p = node.child[i]; p < node.child[i] + node.count[i]; p++)
+                    {
+                        leaf.grow(m_p0[p]);
+                        leaf.grow(m_p1[p]);
+                    }
+                    node.minX[i] = leaf.min.x;
+                    node.minY[i] = leaf.min.y;
+                    node.minZ[i] = leaf.min.z;
+                    node.maxX[i] = leaf.max.x;
+                    node.maxY[i] = leaf.max.y;
+                    node.maxZ[i] = leaf.max.z;
+                }
+            }
+        },
+        256);
+    // Children always come after their parent
+    for (size_t n = m_nodes.size(); n-- > 0;)
+    {
+        Node& node = m_nodes[n];
+        for (int i = 0; i < 4; i++)
+        {
+            if (node.count[i] != 0 || node.child[i] == UINT32_MAX)
+                continue;
+            const Node& child = m_nodes[node.child[i]];
+            node.minX[i]      = std::min(std::min(child.minX[0], child.minX[1]), std::min(child.minX[2], child.minX[3]));
+            node.minY[i]      = std::min(std::min(child.minY[0], child.minY[1]), std::min(child.minY[2], child.minY[3]));
+            node.minZ[i]      = std::min(std::min(child.minZ[0], child.minZ[1]), std::min(child.minZ[2], child.minZ[3]));
+            node.maxX[i]      = std::max(std::max(child.maxX[0], child.maxX[1]), std::max(child.maxX[2], child.maxX[3]));
+            node.maxY[i]      = std::max(std::max(child.maxY[0], child.maxY[1]), std::max(child.maxY[2], child.maxY[3]));
+            node.maxZ[i]      = std::max(std::max(child.maxZ[0], child.maxZ[1]), std::max(child.maxZ[2], child.maxZ[3]));
+        }
+    }
+    const Node& root = m_nodes[0];
+    m_min = Vec3(std::min(std::min(root.minX[0], root.minX[1]), std::min(root.minX[2], root.minX[3])),
+                 std::min(std::min(root.minY[0], root.minY[1]), std::min(root.minY[2], root.minY[3])),
+                 std::min(std::min(root.minZ[0], root.minZ[1]), std::min(root.minZ[2], root.minZ[3])));
+    m_max = Vec3(std::max(std::max(root.maxX[0], root.maxX[1]), std::max(root.maxX[2], root.maxX[3])),
+                 std::max(std::max(root.maxY[0], root.maxY[1]), std::max(root.maxY[2], root.maxY[3])),
+                 std::max(std::max(root.maxZ[0], root.maxZ[1]), std::max(root.maxZ[2], root.maxZ[3])));
+}
+
+StrandHit StrandBVH::intersect(const Vec3& origin, const Vec3& direction, float radius, float tMax) const {
+    StrandHit   hit;
+    const float length = math::length(direction);
+    if (m_nodes.empty() || length == 0.0f)
+        return hit;
+    const Vec3 dir    = direction / length;
+    const Vec3 invDir = safe_inverse(dir);
+
+    uint32_t stack[STRAND_BVH_STACK_SIZE];
+    int      top   = 0;
+    stack[top++]   = 0;
+    float closest  = tMax;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+
+        float tNear[4];
+        for (int i = 0; i < 4; i++)
+        {
+            const float x0 = (node.minX[i] - radius - origin.x) * invDir.x;
+            const float x1 = (node.maxX[i] + radius - origin.x) * invDir.x;
+            const float y0 = (node.minY[i] - radius - origin.y) * invDir.y;
+            const float y1 = (node.maxY[i] + radius - origin.y) * invDir.y;
+            const float z0 = (node.minZ[i] - radius - origin.z) * invDir.z;
+            const float z1 = (node.maxZ[i] + radius - origin.z) * invDir.z;
+            const float t0 = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+            const float t1 = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), closest));
+            tNear[i]       = t0 <= t1 ? t0 : FLT_MAX;
+        }
+
+        // Leaves are tested right away, inner children pushed far to near
+        int order[4] = {0, 1, 2, 3};
+        std::sort(order, order + 4, [&](int a, int b) { return tNear[a] < tNear[b]; });
+        for (int k = 3; k >= 0; k--)
+        {
+            const int i = order[k];
+            if (tNear[i] == FLT_MAX || tNear[i] > closest || node.child[i] == UINT32_MAX)
+                continue;
+            if (node.count[i] == 0)
+            {
+                if (top < STRAND_BVH_STACK_SIZE)
+                    stack[top++] = node.child[i];
+                continue;
+            }
+            for (uint32_t p = node.child[i]; p < node.child[i] + node.count[i]; p++)
+            {
+                float      t;
+                Vec3       point;
+                const float distance = ray_segment_distance(origin, dir, m_p0[p], m_p1[p], t, point);
+                if (distance <= radius && t < closest)
+                {
+                    closest      = t;
+                    hit.segment  = m_segments[p];
+                    hit.strand   = m_strands.empty() ? UINT32_MAX : m_strands[p];
+                    hit.t        = t;
+                    hit.distance = distance;
+                    hit.point    = point;
+                }
+            }
+        }
+    }
+    return hit;
+}
+
+StrandHit StrandBVH::nearest(const Vec3& point, float maxDistance) const {
+    StrandHit hit;
+    if (m_nodes.empty())
+        return hit;
+
+    uint32_t stack[STRAND_BVH_STACK_SIZE];
+    float    stackDistance[STRAND_BVH_STACK_SIZE];
+    int      top       = 0;
+    stack[top]         = 0;
+    stackDistance[top] = 0.0f;
+    top++;
+    float closest = maxDistance == FLT_MAX ? FLT_MAX : maxDistance * maxDistance; // Squared
+    while (top > 0)
+    {
+        top--;
+        if (stackDistance[top] > closest)
+            continue;
+        const Node& node = m_nodes[stack[top]];
+
+        float boxDistance[4];
+        for (int i = 0; i < 4; i++)
+        {
+            const float dx = std::max(std::max(node.minX[i] - point.x, point.x - node.maxX[i]), 0.0f);
+            const float dy = std::max(std::max(node.minY[i] - point.y, point.y - node.maxY[i]), 0.0f);
+            const float dz = std::max(std::max(node.minZ[i] - point.z, point.z - node.maxZ[i]), 0.0f);
+            boxDistance[i] = node.child[i] == UINT32_MAX ? FLT_MAX : dx * dx + dy * dy + dz * dz;
+        }
+
+        int order[4] = {0, 1, 2, 3};
+        std::sort(order, order + 4, [&](int a, int b) { return boxDistance[a] < boxDistance[b]; });
+        for (int k = 3; k >= 0; k--)
+        {
+            const int i = order[k];
+            if (boxDistance[i] > closest)
+                continue;
+            if (node.count[i] == 0)
+            {
+                if (top < STRAND_BVH_STACK_SIZE)
+                {
+                    stack[top]         = node.child[i];
+                    stackDistance[top] = boxDistance[i];
+                    top++;
+                }
+                continue;
+            }
+            for (uint32_t p = node.child[i]; p < node.child[i] + node.count[i]; p++)
+            {
+                Vec3        closestPoint;
+                const float distance = point_segment_distance(point, m_p0[p], m_p1[p], closestPoint);
+                if (distance * distance <= closest)
+                {
+                    closest      = distance * distance;
+                    hit.segment  = m_segments[p];
+                    hit.strand   = m_strands.empty() ? UINT32_MAX : m_strands[p];
+                    hit.distance = distance;
+                    hit.point    = closestPoint;
+                }
+            }
+        }
+    }
+    return hit;
+}
+
+void StrandBVH::query(const Vec3& boxMin, const Vec3& boxMax, float radius, std::vector<uint32_t>& segments) const {
+    if (m_nodes.empty())
+        return;
+    const Vec3 queryMin = boxMin - Vec3(radius);
+    const Vec3 queryMax = boxMax + Vec3(radius);
+
+    uint32_t stack[STRAND_BVH_STACK_SIZE];
+    int      top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        for (int i = 0; i < 4; i++)
+        {
+            const bool overlap = node.minX[i] <= queryMax.x && node.maxX[i] >= queryMin.x && node.minY[i] <= queryMax.y &&
+                                 node.maxY[i] >= queryMin.y && node.minZ[i] <= queryMax.z && node.maxZ[i] >= queryMin.z;
+            if (!overlap || node.child[i] == UINT32_MAX)
+                continue;
+            if (node.count[i] == 0)
+            {
+                if (top < STRAND_BVH_STACK_SIZE)
+                    stack[top++] = node.child[i];
+                continue;
+            }
+            for (uint32_t p = node.child[i]; p < node.child[i] + node.count[i]; p++)
+            {
+                const Vec3 segmentMin = math::min(m_p0[p], m_p1[p]);
+                const Vec3 segmentMax = math::max(m_p0[p], m_p1[p]);
+                if (segmentMin.x <= queryMax.x && segmentMax.x >= queryMin.x && segmentMin.y <= queryMax.y && segmentMax.y >= queryMin.y &&
+                    segmentMin.z <= queryMax.z && segmentMax.z >= queryMin.z)
+                    segments.push_back(m_segments[p]);
+            }
+        }
+    }
+}
+
+} // namespace Core
+
+VULKAN_ENGINE_NAMESPACE_END
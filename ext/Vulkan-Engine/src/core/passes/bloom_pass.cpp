@@ -74,8 +74,6 @@ void BloomPass::setup_shader_passes() {
     downsamplePass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}};
     downsamplePass->settings.pushConstants.push_back(PushConstant(SHADER_STAGE_COMPUTE, MIPMAP_UNIFORM_SIZE));
 
-    downsamplePass->build_shader_stages();
-    downsamplePass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("downsample")] = downsamplePass;
 
@@ -84,8 +82,6 @@ void BloomPass::setup_shader_passes() {
     upsamplePass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}};
     upsamplePass->settings.pushConstants.push_back(PushConstant(SHADER_STAGE_COMPUTE, MIPMAP_UNIFORM_SIZE));
 
-    upsamplePass->build_shader_stages();
-    upsamplePass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("upsample")] = upsamplePass;
 
@@ -99,8 +95,6 @@ void BloomPass::setup_shader_passes() {
                                                   {COLOR_ATTRIBUTE, false}};
     bloomPass->settings.pushConstants.push_back(PushConstant(SHADER_STAGE_FRAGMENT, SETTINGS_UNIFORM_SIZE));
 
-    bloomPass->build_shader_stages();
-    bloomPass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("bloom")] = bloomPass;
 }
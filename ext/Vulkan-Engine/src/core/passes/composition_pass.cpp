@@ -150,8 +150,6 @@ void CompositionPass::setup_shader_passes() {
         Init::color_blend_attachment_state(false), Init::color_blend_attachment_state(false)};
     compPass->settings.pushConstants = {PushConstant(SHADER_STAGE_FRAGMENT, sizeof(Settings))};
 
-    compPass->build_shader_stages();
-    compPass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("composition")] = compPass;
 }
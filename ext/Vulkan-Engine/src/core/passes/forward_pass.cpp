@@ -100,6 +100,7 @@ void ForwardPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
     LayoutBinding hairng(UNIFORM_COMBINED_IMAGE_SAMPLER, SHADER_STAGE_FRAGMENT, 11);
     LayoutBinding hairngt(UNIFORM_COMBINED_IMAGE_SAMPLER, SHADER_STAGE_FRAGMENT, 12);
     LayoutBinding hairGI(UNIFORM_COMBINED_IMAGE_SAMPLER, SHADER_STAGE_FRAGMENT, 13);
+    LayoutBinding hairBricks(UNIFORM_COMBINED_IMAGE_SAMPLER, SHADER_STAGE_FRAGMENT, 14);
     m_descriptorPool.set_layout(GLOBAL_LAYOUT,
                                 {camBufferBinding,
                                  sceneBufferBinding,
@@ -114,7 +115,8 @@ void ForwardPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
                                  hairVoxels,
                                  hairng,
                                  hairngt,
-                                 hairGI});
+                                 hairGI,
+                                 hairBricks});
 
     // PER-OBJECT SET
     LayoutBinding objectBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, 0);
@@ -159,6 +161,7 @@ void ForwardPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
         m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_NG, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 11);
         m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_NG_TRT, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 12);
         m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_GI, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 13);
+        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_BRICK_GRID, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 14);
         // m_descriptorPool.set_descriptor_write( get_image(ResourceManager::HAIR_GI_FALLBACK), LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 13);
 
         // Per-object
@@ -167,7 +170,7 @@ void ForwardPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
             &frames[i].uniformBuffers[OBJECT_LAYOUT], sizeof(ObjectUniforms), 0, &m_descriptors[i].objectDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[OBJECT_LAYOUT],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
@@ -186,6 +189,10 @@ void ForwardPass::setup_shader_passes() {
                                                                       VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
                                                                       VK_DYNAMIC_STATE_CULL_MODE};
     std::vector<VkPipelineColorBlendAttachmentState> blendAttachments{Init::color_blend_attachment_state(true), Init::color_blend_attachment_state(true)};
+    // Strand index streams are either line lists or line strips with restart
+    std::vector<VkDynamicState> strandDynamicStates = dynamicStates;
+    strandDynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+    strandDynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
 
     VkSampleCountFlagBits samples = static_cast<VkSampleCountFlagBits>(m_aa);
 
@@ -225,11 +232,13 @@ void ForwardPass::setup_shader_passes() {
     hairStrandPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, false}};
     hairStrandPass->graphicSettings.attributes      = {
         {POSITION_ATTRIBUTE, true}, {NORMAL_ATTRIBUTE, false}, {UV_ATTRIBUTE, false}, {TANGENT_ATTRIBUTE, true}, {COLOR_ATTRIBUTE, true}};
-    hairStrandPass->graphicSettings.dynamicStates    = dynamicStates;
+    hairStrandPass->graphicSettings.dynamicStates    = strandDynamicStates;
     hairStrandPass->graphicSettings.blendAttachments = blendAttachments;
     hairStrandPass->graphicSettings.samples          = samples;
     hairStrandPass->graphicSettings.sampleShading    = false;
     hairStrandPass->graphicSettings.topology         = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    hairStrandPass->graphicSettings.vertexLayout     = STRAND_VERTEX_LAYOUT;
+    hairStrandPass->settings.pushConstants           = {PushConstant(SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, sizeof(StrandUniforms))};
     m_shaderPasses[IMaterial::Type::HAIR_STR_TYPE]   = hairStrandPass;
 
     GraphicShaderPass* hairStrandPass2 =
@@ -237,11 +246,13 @@ void ForwardPass::setup_shader_passes() {
     hairStrandPass2->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, true}};
     hairStrandPass2->graphicSettings.attributes      = {
         {POSITION_ATTRIBUTE, true}, {NORMAL_ATTRIBUTE, false}, {UV_ATTRIBUTE, false}, {TANGENT_ATTRIBUTE, true}, {COLOR_ATTRIBUTE, true}};
-    hairStrandPass2->graphicSettings.dynamicStates    = dynamicStates;
+    hairStrandPass2->graphicSettings.dynamicStates    = strandDynamicStates;
     hairStrandPass2->graphicSettings.samples          = samples;
     hairStrandPass2->graphicSettings.sampleShading    = false;
     hairStrandPass2->graphicSettings.blendAttachments = blendAttachments;
     hairStrandPass2->graphicSettings.topology         = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    hairStrandPass2->graphicSettings.vertexLayout     = STRAND_VERTEX_LAYOUT;
+    hairStrandPass2->settings.pushConstants           = {PushConstant(SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, sizeof(StrandUniforms))};
     m_shaderPasses[IMaterial::Type::HAIR_STR_EPIC_TYPE]    = hairStrandPass2;
 
     GraphicShaderPass* hairStrandPassDisney =
@@ -249,13 +260,31 @@ void ForwardPass::setup_shader_passes() {
     hairStrandPassDisney->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, true}};
     hairStrandPassDisney->graphicSettings.attributes      = {
         {POSITION_ATTRIBUTE, true}, {NORMAL_ATTRIBUTE, false}, {UV_ATTRIBUTE, false}, {TANGENT_ATTRIBUTE, true}, {COLOR_ATTRIBUTE, true}};
-    hairStrandPassDisney->graphicSettings.dynamicStates    = dynamicStates;
+    hairStrandPassDisney->graphicSettings.dynamicStates    = strandDynamicStates;
     hairStrandPassDisney->graphicSettings.samples          = samples;
     hairStrandPassDisney->graphicSettings.sampleShading    = false;
     hairStrandPassDisney->graphicSettings.blendAttachments = blendAttachments;
     hairStrandPassDisney->graphicSettings.topology         = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    hairStrandPassDisney->graphicSettings.vertexLayout     = STRAND_VERTEX_LAYOUT;
+    hairStrandPassDisney->settings.pushConstants           = {PushConstant(SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, sizeof(StrandUniforms))};
     m_shaderPasses[IMaterial::Type::HAIR_STR_DISNEY_TYPE]    = hairStrandPassDisney;
 
+    // Vertex pulled variants of the strand passes. Same files, no vertex input nor geometry stage
+    for (IMaterial::Type type : {IMaterial::Type::HAIR_STR_TYPE, IMaterial::Type::HAIR_STR_EPIC_TYPE, IMaterial::Type::HAIR_STR_DISNEY_TYPE})
+    {
+        GraphicShaderPass* geometryPass = static_cast<GraphicShaderPass*>(m_shaderPasses[type]);
+        GraphicShaderPass* pulledPass   = new GraphicShaderPass(m_device->get_handle(), m_renderpass, m_imageExtent, geometryPass->filePath);
+        pulledPass->settings          = geometryPass->settings;
+        pulledPass->graphicSettings   = geometryPass->graphicSettings;
+        pulledPass->graphicSettings.attributes = {
+            {POSITION_ATTRIBUTE, false}, {NORMAL_ATTRIBUTE, false}, {UV_ATTRIBUTE, false}, {TANGENT_ATTRIBUTE, false}, {COLOR_ATTRIBUTE, false}};
+        pulledPass->graphicSettings.topology      = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        pulledPass->graphicSettings.dynamicStates = dynamicStates;
+        pulledPass->stages                        = SHADER_STAGE_VERTEX | SHADER_STAGE_FRAGMENT;
+        pulledPass->defines                  = {{"STRAND_VERTEX_PULLING", "1"}};
+        m_shaderPasses[pulled_strand_pass(type)] = pulledPass;
+    }
+
     GraphicShaderPass* skyboxPass =
         new GraphicShaderPass(m_device->get_handle(), m_renderpass, m_imageExtent, ENGINE_RESOURCES_PATH "shaders/forward/skybox.glsl");
     skyboxPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, false}, {OBJECT_TEXTURE_LAYOUT, false}};
@@ -266,14 +295,6 @@ void ForwardPass::setup_shader_passes() {
     skyboxPass->graphicSettings.blendAttachments = blendAttachments;
     skyboxPass->graphicSettings.depthOp          = VK_COMPARE_OP_LESS_OR_EQUAL;
     m_shaderPasses[hash_string("skybox")]        = skyboxPass;
-
-    for (auto pair : m_shaderPasses)
-    {
-        ShaderPass* pass = pair.second;
-
-        pass->build_shader_stages();
-        pass->build(m_descriptorPool);
-    }
 }
 
 void ForwardPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint32_t presentImageIndex) {
@@ -286,16 +307,28 @@ void ForwardPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint
     if (scene->get_active_camera() && scene->get_active_camera()->is_active())
     {
 
+        const uint64_t objectTable = currentFrame.objectTable.handle ? currentFrame.objectTable.get_device_address() : 0;
+
         unsigned int mesh_idx = 0;
         for (Mesh* m : scene->get_meshes())
         {
-            if (m)
+            if (m && mesh_idx < ENGINE_MAX_OBJECTS)
             {
+                // Strand meshes are drawn by the first mesh of their instance batch, if any member is visible
+                const uint32_t batchIdx = mesh_idx < currentFrame.meshBatches.size() ? currentFrame.meshBatches[mesh_idx] : NO_INSTANCE_BATCH;
+                const InstanceBatch* batch = batchIdx != NO_INSTANCE_BATCH ? &currentFrame.instanceBatches[batchIdx] : nullptr;
+                if (batch && batch->meshIndex != mesh_idx)
+                {
+                    mesh_idx++;
+                    continue;
+                }
+
                 if (m->is_active() &&              // Check if is active
                     m->get_num_geometries() > 0 && // Check if has geometry
-                    (scene->get_active_camera()->get_frustrum_culling() && m->get_bounding_volume()
-                         ? m->get_bounding_volume()->is_on_frustrum(scene->get_active_camera()->get_frustrum())
-                         : true)) // Check if is inside frustrum
+                    (batch ? batch->inFrustum
+                           : (scene->get_active_camera()->get_frustrum_culling() && m->get_bounding_volume()
+                                  ? m->get_bounding_volume()->is_on_frustrum(scene->get_active_camera()->get_frustrum())
+                                  : true))) // Check if is inside frustrum
                 {
                     // Offset calculation
                     uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
@@ -305,11 +338,17 @@ void ForwardPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint
                         Geometry*  g   = m->get_geometry(i);
                         IMaterial* mat = m->get_material(g->get_material_ID());
 
+                        // Strand shaders need the object table entry written by the resource manager
+                        const bool strands = get_VAO(g)->layout == STRAND_VERTEX_LAYOUT;
+                        if (strands && !batch)
+                            continue;
+
                         cmd.set_depth_test_enable(mat->get_parameters().depthTest);
                         cmd.set_depth_write_enable(mat->get_parameters().depthWrite);
                         cmd.set_cull_mode(mat->get_parameters().faceCulling ? mat->get_parameters().culling : CullingMode::NO_CULLING);
 
-                        ShaderPass* shaderPass = m_shaderPasses[mat->get_type()];
+                        const bool  pulled     = strands && m_strandVertexPulling;
+                        ShaderPass* shaderPass = m_shaderPasses[pulled ? pulled_strand_pass(mat->get_type()) : mat->get_type()];
 
                         // Bind pipeline
                         cmd.bind_shaderpass(*shaderPass);
@@ -322,7 +361,52 @@ void ForwardPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint
                             cmd.bind_descriptor_set(mat->get_texture_descriptor(), 2, *shaderPass);
 
                         // DRAW
-                        cmd.draw_geometry(*get_VAO(g));
+                        if (strands)
+                        {
+                            // STRAND DECODING CONSTANTS AND OBJECT TABLE
+                            // LEVEL OF DETAIL AND CULLED CLUSTERS FROM THE FRAME DRAW LIST
+                            const StrandDrawList& draw = currentFrame.strandDraws[batch->firstDraw + i];
+
+                            VAO*           vao            = get_VAO(g);
+                            StrandUniforms strandUniforms = vao->strandUniforms;
+                            strandUniforms.objectTable    = objectTable;
+                            strandUniforms.params         = Vec4(draw.widthScale, 0.0f, 0.0f, 0.0f);
+                            if (pulled && draw.level > 0)
+                                strandUniforms.indexBuffer = vao->lodIbo.get_device_address();
+                            cmd.push_constants(
+                                *shaderPass, SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, &strandUniforms, sizeof(StrandUniforms));
+
+                            if (!pulled)
+                                cmd.set_strand_topology(vao->strandTopology);
+
+                            // Same ranges, in segment slots
+                            if (pulled && currentFrame.strandsCulled && draw.capacity[STRAND_CAMERA_VIEW] > 0)
+                                cmd.draw_strand_segments_indirect(currentFrame.strandCommands,
+                                                                  draw.firstCommand[STRAND_CAMERA_VIEW] * sizeof(VkDrawIndexedIndirectCommand),
+                                                                  currentFrame.strandCounts,
+                                                                  draw.output(STRAND_CAMERA_VIEW) * sizeof(math::uvec4),
+                                                                  draw.capacity[STRAND_CAMERA_VIEW]);
+                            else if (pulled && draw.indexCount > 0)
+                                cmd.draw_strand_segments(vao->strandTopology == STRAND_LINE_STRIP ? draw.firstIndex : draw.firstIndex / 2,
+                                                         strand_segment_count(vao->strandTopology, draw.indexCount),
+                                                         batch->instanceCount,
+                                                         batch->firstInstance);
+                            else if (pulled)
+                                cmd.draw_strand_segments(0, strand_segment_count(vao->strandTopology, vao->indexCount), batch->instanceCount, batch->firstInstance);
+                            else if (currentFrame.strandsCulled && draw.capacity[STRAND_CAMERA_VIEW] > 0)
+                                cmd.draw_geometry_indirect(*vao,
+                                                           draw.level,
+                                                           currentFrame.strandCommands,
+                                                           draw.firstCommand[STRAND_CAMERA_VIEW] * sizeof(VkDrawIndexedIndirectCommand),
+                                                           currentFrame.strandCounts,
+                                                           draw.output(STRAND_CAMERA_VIEW) * sizeof(math::uvec4),
+                                                           draw.capacity[STRAND_CAMERA_VIEW]);
+                            else if (draw.indexCount > 0)
+                                cmd.draw_geometry_LOD(*vao, draw.level, draw.firstIndex, draw.indexCount, batch->instanceCount, batch->firstInstance);
+                            else
+                                cmd.draw_geometry(*vao, batch->instanceCount, 0, 0, batch->firstInstance);
+                        } else
+                            cmd.draw_geometry(*get_VAO(g));
                     }
                 }
             }
@@ -406,6 +490,13 @@ void ForwardPass::set_hair_scattering_map_descriptor(Graphics::Image frontAtt, G
         m_descriptorPool.set_descriptor_write(&backAtt, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 9);
     }
 }
+void ForwardPass::set_hair_volume_descriptor(Graphics::Image volume, Graphics::Image bricks) {
+    for (size_t i = 0; i < m_descriptors.size(); i++)
+    {
+        m_descriptorPool.set_descriptor_write(&volume, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 10);
+        m_descriptorPool.set_descriptor_write(&bricks, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 14);
+    }
+}
 void ForwardPass::setup_material_descriptor(IMaterial* mat) {
     if (!mat->get_texture_descriptor().allocated)
         m_descriptorPool.allocate_descriptor_set(OBJECT_TEXTURE_LAYOUT, &mat->get_texture_descriptor());
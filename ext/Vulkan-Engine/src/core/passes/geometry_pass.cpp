@@ -145,7 +145,7 @@ void GeometryPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
                                               0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[OBJECT_LAYOUT],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
@@ -183,8 +183,6 @@ void GeometryPass::setup_shader_passes() {
                                                   Init::color_blend_attachment_state(false),
                                                   Init::color_blend_attachment_state(false)};
 
-    geomPass->build_shader_stages();
-    geomPass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("geometry")] = geomPass;
 
@@ -201,8 +199,6 @@ void GeometryPass::setup_shader_passes() {
     skyboxPass->graphicSettings.blendAttachments = geomPass->graphicSettings.blendAttachments;
     skyboxPass->graphicSettings.depthOp          = VK_COMPARE_OP_LESS_OR_EQUAL;
 
-    skyboxPass->build_shader_stages();
-    skyboxPass->build(m_descriptorPool);
 
     m_shaderPasses[hash_string("skybox")] = skyboxPass;
 }
@@ -221,7 +217,7 @@ void GeometryPass::render(Graphics::Frame& currentFrame, Scene* const scene, uin
         unsigned int mesh_idx = 0;
         for (Mesh* m : scene->get_meshes())
         {
-            if (m)
+            if (m && mesh_idx < ENGINE_MAX_OBJECTS) // Meshes past the uniform slots are not drawn
             {
                 if (m->is_active() &&              // Check if is active
                     m->get_num_geometries() > 0 && // Check if has geometry
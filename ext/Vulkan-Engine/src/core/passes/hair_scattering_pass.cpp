@@ -73,10 +73,37 @@ void HairScatteringPass::create_hair_scattering_images() {
     configGI.format          = SRGBA_32F;
     configGI.usageFlags      = IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_DST | IMAGE_USAGE_TRANSFER_SRC | IMAGE_USAGE_STORAGE;
     configGI.mipLevels       = 1;
+
+    // The integration only depends on the BSDF constants in the shaders and on the resolution. A cached LUT is stored as half
+    // floats, skipping the dispatch altogether
+    const std::string cachePath = Tools::VolumeCache::get_cache_path({ENGINE_RESOURCES_PATH "shaders/misc/compute_hair_LUT.glsl",
+                                                                       ENGINE_RESOURCES_PATH "shaders/scripts/BRDFs/epic_hair_BSDF.glsl",
+                                                                       ENGINE_RESOURCES_PATH "shaders/scripts/montecarlo.glsl",
+                                                                       ENGINE_RESOURCES_PATH "shaders/scripts/utils.glsl"},
+                                                                      {m_imageExtent.width});
+    Graphics::Utils::MappedFile cacheFile;
+    ColorFormatType             cachedFormat;
+    Extent3D                    cachedExtent;
+    const uint8_t*              cachedData = nullptr;
+    bool                        cached     = Tools::VolumeCache::read(cachePath, cacheFile, cachedFormat, cachedExtent, cachedData);
+    cached = cached && cachedExtent.width == m_imageExtent.width && cachedExtent.height == m_imageExtent.width &&
+             cachedExtent.depth == m_imageExtent.width;
+    if (cached)
+        configGI.format = cachedFormat;
+
     ResourceManager::HAIR_GI = m_device->create_image({m_imageExtent.width, m_imageExtent.width,  m_imageExtent.width}, configGI, false);
     ResourceManager::HAIR_GI.create_view(configGI);
     ResourceManager::HAIR_GI.create_sampler(samplerConfig);
 
+    m_pendingLUTCache = "";
+    if (cached)
+        m_device->upload_image_data(ResourceManager::HAIR_GI,
+                                    cachedData,
+                                    size_t(cachedExtent.width) * cachedExtent.height * cachedExtent.depth * Graphics::Utils::get_block_size(cachedFormat),
+                                    Graphics::Utils::get_block_size(cachedFormat));
+    else
+        m_pendingLUTCache = cachePath;
+
     // // Normalizing Buffer
     //     m_normBuffer = m_device->create_buffer_VMA(
     //         sizeof(Vec4), BufferUsageFlags::BUFFER_USAGE_STORAGE_BUFFER | BufferUsageFlags::BUFFER_USAGE_TRANSFER_DST,
@@ -142,7 +169,7 @@ void HairScatteringPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
             &frames[i].uniformBuffers[OBJECT_LAYOUT], sizeof(ObjectUniforms), 0, &m_descriptors[i].objectDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[OBJECT_LAYOUT],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
@@ -155,8 +182,6 @@ void HairScatteringPass::setup_shader_passes() {
     ComputeShaderPass* NPass               = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/compute_hair_NGI.glsl");
     NPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, false}};
 
-    NPass->build_shader_stages();
-    NPass->build(m_descriptorPool);
 
     m_shaderPasses[1] = NPass;
 
@@ -170,8 +195,6 @@ void HairScatteringPass::setup_shader_passes() {
 
     ComputeShaderPass* LUTPass               = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/compute_hair_LUT.glsl");
     LUTPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, TRUE}, {OBJECT_LAYOUT, false}, {OBJECT_TEXTURE_LAYOUT, false}};
-    LUTPass->build_shader_stages();
-    LUTPass->build(m_descriptorPool);
     m_shaderPasses[2] = LUTPass;
 
    
@@ -304,18 +327,28 @@ void HairScatteringPass::render(Graphics::Frame& currentFrame, Scene* const scen
         //                      STAGE_COMPUTE_SHADER);
     }
 
-    unsigned int mesh_idx = 0;
+    // The LUTs only depend on the material, grooms sharing it share the integration. They hold a single one though
+    IMaterial*   integrated = nullptr;
+    unsigned int mesh_idx   = 0;
     for (Mesh* m : scene->get_meshes())
     {
-        if (m)
+        if (m && mesh_idx < ENGINE_MAX_OBJECTS) // Meshes past the uniform slots are not drawn
         {
             if (m->is_active() &&  // Check if is active
                 m->get_geometry()) // Check if is inside frustrum
             {
                 auto mat = m->get_material();
+                if (mat->get_type() == Core::IMaterial::Type::HAIR_STR_DISNEY_TYPE && integrated && mat != integrated)
+                {
+                    static bool warned = false;
+                    if (!warned)
+                        LOG_WARN("Grooms with different Disney hair materials share the scattering LUTs of the first one");
+                    warned = true;
+                }
                 // if (mat->get_type() == Core::IMaterial::Type::HAIR_STR_DISNEY_TYPE && mat->dirty())
-                if (mat->get_type() == Core::IMaterial::Type::HAIR_STR_DISNEY_TYPE)
+                if (mat->get_type() == Core::IMaterial::Type::HAIR_STR_DISNEY_TYPE && !integrated)
                 {
+                    integrated = mat;
 
                     // Offset calculation
                     uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
@@ -412,8 +445,6 @@ void HairScatteringPass::render(Graphics::Frame& currentFrame, Scene* const scen
                     cmd.dispatch_compute({gridSize2, gridSize2, gridSize3});
 
                     mat->dirty(false);
-
-                    break; // WIP for now compute just one hair volume AND EXIT LOOP
                 }
             }
         }
@@ -490,6 +521,21 @@ void HairScatteringPass::render(Graphics::Frame& currentFrame, Scene* const scen
 #endif
 }
 
+void HairScatteringPass::update_uniforms(uint32_t frameIndex, Scene* const scene) {
+    if (m_pendingLUTCache.empty() || ResourceManager::HAIR_GI.currentLayout != LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        return;
+
+    m_device->wait();
+    std::vector<uint8_t> texels;
+    m_device->download_image(ResourceManager::HAIR_GI, Graphics::Utils::get_block_size(SRGBA_32F), texels);
+    std::vector<uint16_t> halfTexels;
+    Tools::VolumeCache::to_half(reinterpret_cast<const float*>(texels.data()), texels.size() / sizeof(float), halfTexels);
+    if (!Tools::VolumeCache::write(
+            m_pendingLUTCache, SRGBA_16F, ResourceManager::HAIR_GI.extent, halfTexels.data(), halfTexels.size() * sizeof(uint16_t)))
+        LOG_WARN("Could not write hair LUT cache " + m_pendingLUTCache);
+    m_pendingLUTCache = "";
+}
+
 void HairScatteringPass::cleanup() {
     ComputePass::cleanup();
     ResourceManager::HAIR_BACK_ATT.cleanup();
@@ -1,4 +1,5 @@
 #include <engine/core/passes/hair_voxelization_pass.h>
+#include <engine/core/materials/hair.h>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 using namespace Graphics;
@@ -6,43 +7,112 @@ namespace Core {
 
 void HairVoxelizationPass::create_voxelization_image() {
 
-    // Actual Voxel Image
+    // Every groom owns a cubic slot of the brick grid, side by side along x
+    const uint32_t cells = m_imageExtent.width / ENGINE_HAIR_BRICK_SIZE;
+    if (cells * ENGINE_HAIR_BRICK_SIZE != m_imageExtent.width)
+        LOG_WARN("Hair volume resolution " + std::to_string(m_imageExtent.width) + " rounded down to a multiple of the brick size");
+    const Extent3D gridExtent = {cells * ENGINE_MAX_HAIR_VOLUMES, cells, cells};
+
+    // Bricks are packed in rows and columns of POOL_SIDE, as many layers as the capacity asks for
+    const uint32_t poolLayers = std::clamp((m_brickCapacity + POOL_SIDE * POOL_SIDE - 1) / (POOL_SIDE * POOL_SIDE), 1u, MAX_POOL_LAYERS);
+    const uint32_t poolBricks = POOL_SIDE * POOL_SIDE * poolLayers;
+    const Extent3D poolExtent = {POOL_SIDE * ENGINE_HAIR_BRICK_SIZE, POOL_SIDE * ENGINE_HAIR_BRICK_SIZE, poolLayers * ENGINE_HAIR_BRICK_SIZE};
+    m_brickCapacity           = poolBricks;
+
+    // Brick Grid
+    ResourceManager::HAIR_BRICK_GRID.cleanup();
+
+    ImageConfig config               = {};
+    config.viewType                  = TEXTURE_3D;
+    config.format                    = R_32_UINT;
+    config.usageFlags                = IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_DST | IMAGE_USAGE_STORAGE;
+    config.mipLevels                 = 1;
+    ResourceManager::HAIR_BRICK_GRID = m_device->create_image(gridExtent, config, false);
+    ResourceManager::HAIR_BRICK_GRID.create_view(config);
+
+    SamplerConfig samplerConfig      = {};
+    samplerConfig.filters            = FILTER_NEAREST;
+    samplerConfig.mipmapMode         = MIPMAP_NEAREST;
+    samplerConfig.samplerAddressMode = ADDRESS_MODE_CLAMP_TO_EDGE;
+    ResourceManager::HAIR_BRICK_GRID.create_sampler(samplerConfig);
+
+    // Actual Voxel Image. Brick pool
     ResourceManager::HAIR_VOXEL_VOLUME.cleanup();
 
-    ImageConfig config                 = {};
+    config                             = {};
     config.viewType                    = TEXTURE_3D;
     config.format                      = SR_32F;
     config.usageFlags                  = IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_DST | IMAGE_USAGE_TRANSFER_SRC | IMAGE_USAGE_STORAGE;
     config.mipLevels                   = 1;
-    ResourceManager::HAIR_VOXEL_VOLUME = m_device->create_image({m_imageExtent.width, m_imageExtent.width, m_imageExtent.width}, config, false);
+    ResourceManager::HAIR_VOXEL_VOLUME = m_device->create_image(poolExtent, config, false);
     ResourceManager::HAIR_VOXEL_VOLUME.create_view(config);
 
-    SamplerConfig samplerConfig      = {};
+    samplerConfig                    = {};
     samplerConfig.samplerAddressMode = ADDRESS_MODE_CLAMP_TO_BORDER;
     samplerConfig.border             = BorderColor::FLOAT_OPAQUE_BLACK;
     ResourceManager::HAIR_VOXEL_VOLUME.create_sampler(samplerConfig);
 
-    // Count Voxel Image
+    // Count Voxel Image. Brick pool
     ResourceManager::HAIR_VOXEL_VOLUME_2.cleanup();
-    ResourceManager::HAIR_VOXEL_VOLUME_2 = m_device->create_image({m_imageExtent.width, m_imageExtent.width, m_imageExtent.width}, config, false);
+    ResourceManager::HAIR_VOXEL_VOLUME_2 = m_device->create_image(poolExtent, config, false);
     ResourceManager::HAIR_VOXEL_VOLUME_2.create_view(config);
     ResourceManager::HAIR_VOXEL_VOLUME_2.create_sampler(samplerConfig);
 
-    // Codified percieved Density
+    // Codified percieved Density. Brick pool, half precision is plenty for the SH of strand counts
     ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME.cleanup();
 
     config                                          = {};
     config.viewType                                 = TEXTURE_3D;
-    config.format                                   = SRGBA_32F;
+    config.format                                   = SRGBA_16F;
     config.usageFlags                               = IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_DST | IMAGE_USAGE_TRANSFER_SRC | IMAGE_USAGE_STORAGE;
     config.mipLevels                                = 1;
-    ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME = m_device->create_image({m_imageExtent.width, m_imageExtent.width, m_imageExtent.width}, config, false);
+    ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME = m_device->create_image(poolExtent, config, false);
     ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME.create_view(config);
 
     samplerConfig                    = {};
     samplerConfig.samplerAddressMode = ADDRESS_MODE_CLAMP_TO_BORDER;
     samplerConfig.border             = BorderColor::FLOAT_OPAQUE_BLACK;
     ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME.create_sampler(samplerConfig);
+
+    // Bricks handed out per slot and their cells. The head doubles as the indirect dispatches over them
+    m_brickBuffer.cleanup();
+    m_brickBuffer = m_device->create_buffer_VMA(sizeof(BrickHeader) + sizeof(uint32_t) * poolBricks,
+                                                BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_TRANSFER_SRC |
+                                                    BUFFER_USAGE_INDIRECT_BUFFER,
+                                                VMA_MEMORY_USAGE_GPU_ONLY);
+}
+void HairVoxelizationPass::write_volume_descriptors() {
+    for (size_t i = 0; i < m_descriptors.size(); i++)
+    {
+        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 2, UNIFORM_STORAGE_IMAGE);
+        m_descriptorPool.set_descriptor_write(
+            &ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 3, UNIFORM_STORAGE_IMAGE);
+        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 5);
+        m_descriptorPool.set_descriptor_write(
+            &ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 6, UNIFORM_STORAGE_IMAGE);
+        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_BRICK_GRID, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 7, UNIFORM_STORAGE_IMAGE);
+        m_descriptorPool.set_descriptor_write(&m_brickBuffer, m_brickBuffer.size, 0, &m_descriptors[i].globalDescritor, UNIFORM_STORAGE_BUFFER, 8);
+    }
+}
+uint32_t HairVoxelizationPass::max_pool_layers() const {
+    // Counts, lengths and SH of every voxel, the cell of every brick
+    const VkDeviceSize LAYER_BYTES = VkDeviceSize(POOL_SIDE * POOL_SIDE) * (ENGINE_HAIR_BRICK_SIZE * ENGINE_HAIR_BRICK_SIZE * ENGINE_HAIR_BRICK_SIZE * 16 + 4);
+    const VkDeviceSize poolBytes   = VkDeviceSize(m_brickCapacity / (POOL_SIDE * POOL_SIDE)) * LAYER_BYTES;
+    const VkDeviceSize budget      = (m_device->get_device_local_budget() + poolBytes) / 2;
+    return static_cast<uint32_t>(std::clamp<VkDeviceSize>(budget / LAYER_BYTES, 1, MAX_POOL_LAYERS));
+}
+void HairVoxelizationPass::resize_brick_pool(uint32_t bricks) {
+    // Frames in flight still sample the old pool
+    m_device->wait();
+
+    m_brickCapacity = bricks;
+    create_voxelization_image();
+    write_volume_descriptors();
+    invalidate_volumes();
+    m_poolRevision++;
+
+    // Rebuilds still in flight were handed out of the old pool
+    m_brickReadbackPending.assign(m_brickReadbackPending.size(), false);
 }
 
 void HairVoxelizationPass::setup_attachments(std::vector<Graphics::AttachmentInfo>& attachments, std::vector<Graphics::SubPassDependency>& dependencies) {
@@ -56,6 +126,7 @@ void HairVoxelizationPass::setup_attachments(std::vector<Graphics::AttachmentInf
                                               IMAGE_USAGE_COLOR_ATTACHMENT | IMAGE_USAGE_SAMPLED,
                                               COLOR_ATTACHMENT,
                                               ASPECT_COLOR);
+    // A single pool layer until grooms show up, update_uniforms sizes it
     create_voxelization_image();
     // Depdencies
     dependencies.resize(2);
@@ -101,18 +172,28 @@ void HairVoxelizationPass::setup_uniforms(std::vector<Graphics::Frame>& frames)
 
     // //////////////////////////////////////
 
+    // Brick counters read back by every frame
+    m_brickReadback.resize(frames.size());
+    m_brickReadbackPending.assign(frames.size(), false);
+    for (Buffer& readback : m_brickReadback)
+        readback = m_device->create_buffer_VMA(sizeof(BrickHeader), BUFFER_USAGE_TRANSFER_DST, VMA_MEMORY_USAGE_GPU_TO_CPU, 0, true);
+
     m_descriptorPool = m_device->create_descriptor_pool(ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS);
     m_descriptors.resize(frames.size());
 
     // GLOBAL SET
     LayoutBinding camBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_VERTEX | SHADER_STAGE_COMPUTE | SHADER_STAGE_FRAGMENT, 0);
     LayoutBinding sceneBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_VERTEX | SHADER_STAGE_COMPUTE | SHADER_STAGE_FRAGMENT, 1);
-    LayoutBinding voxelBinding(UNIFORM_STORAGE_IMAGE, SHADER_STAGE_FRAGMENT, 2);
+    LayoutBinding voxelBinding(UNIFORM_STORAGE_IMAGE, SHADER_STAGE_FRAGMENT | SHADER_STAGE_COMPUTE, 2);
     LayoutBinding shBinding(UNIFORM_STORAGE_IMAGE, SHADER_STAGE_COMPUTE, 3);
     LayoutBinding dirBinding(UNIFORM_STORAGE_BUFFER, SHADER_STAGE_COMPUTE, 4);
     LayoutBinding voxelSamplerBindng(UNIFORM_COMBINED_IMAGE_SAMPLER, SHADER_STAGE_COMPUTE, 5);
     LayoutBinding voxelBindng2(UNIFORM_STORAGE_IMAGE, SHADER_STAGE_COMPUTE, 6);
-    m_descriptorPool.set_layout(GLOBAL_LAYOUT, {camBufferBinding, sceneBufferBinding, voxelBinding, shBinding, dirBinding, voxelSamplerBindng, voxelBindng2});
+    LayoutBinding brickGridBinding(UNIFORM_STORAGE_IMAGE, SHADER_STAGE_COMPUTE, 7);
+    LayoutBinding brickBinding(UNIFORM_STORAGE_BUFFER, SHADER_STAGE_COMPUTE, 8);
+    m_descriptorPool.set_layout(
+        GLOBAL_LAYOUT,
+        {camBufferBinding, sceneBufferBinding, voxelBinding, shBinding, dirBinding, voxelSamplerBindng, voxelBindng2, brickGridBinding, brickBinding});
 
     // PER-OBJECT SET
     LayoutBinding objectBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_VERTEX | SHADER_STAGE_GEOMETRY | SHADER_STAGE_FRAGMENT, 0);
@@ -140,14 +221,7 @@ void HairVoxelizationPass::setup_uniforms(std::vector<Graphics::Frame>& frames)
                                               &m_descriptors[i].globalDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
-        // Voxelization Image
-        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 2, UNIFORM_STORAGE_IMAGE);
-        m_descriptorPool.set_descriptor_write(
-            &ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 3, UNIFORM_STORAGE_IMAGE);
         m_descriptorPool.set_descriptor_write(&m_directionsBuffer, BUFFER_SIZE, 0, &m_descriptors[i].globalDescritor, UNIFORM_STORAGE_BUFFER, 4);
-        m_descriptorPool.set_descriptor_write(&ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_SHADER_READ_ONLY_OPTIMAL, &m_descriptors[i].globalDescritor, 5);
-        m_descriptorPool.set_descriptor_write(
-            &ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_GENERAL, &m_descriptors[i].globalDescritor, 6, UNIFORM_STORAGE_IMAGE);
 
         // Per-object
         m_descriptorPool.allocate_descriptor_set(OBJECT_LAYOUT, &m_descriptors[i].objectDescritor);
@@ -155,40 +229,42 @@ void HairVoxelizationPass::setup_uniforms(std::vector<Graphics::Frame>& frames)
             &frames[i].uniformBuffers[OBJECT_LAYOUT], sizeof(ObjectUniforms), 0, &m_descriptors[i].objectDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[OBJECT_LAYOUT],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
 
         m_descriptorPool.allocate_varaible_descriptor_set(2, &m_descriptors[i].bufferDescritor, ENGINE_MAX_OBJECTS);
     }
+    // Voxelization Images
+    write_volume_descriptors();
 }
 void HairVoxelizationPass::setup_shader_passes() {
 
 #if OPTICAL_DENSITY == 1
     ComputeShaderPass* voxelPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/DDA_fiber_optical_density.glsl");
     voxelPass->settings.descriptorSetLayoutIDs = {{0, true}, {1, true}, {2, true}};
-    voxelPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(Vec4))};
-    voxelPass->build_shader_stages();
-    voxelPass->build(m_descriptorPool);
+    voxelPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(StrandUniforms))};
 
     m_shaderPasses[0] = voxelPass;
 
     ComputeShaderPass* countPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/opticaldensity_to_count.glsl");
     countPass->settings.descriptorSetLayoutIDs = {{0, true}, {1, false}, {2, false}};
-    countPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(Vec4))};
-    countPass->build_shader_stages();
-    countPass->build(m_descriptorPool);
+    countPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(BrickConstants))};
 
     m_shaderPasses[2] = countPass;
 
+    ComputeShaderPass* brickPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/allocate_hair_bricks.glsl");
+    brickPass->settings.descriptorSetLayoutIDs = {{0, true}, {1, false}, {2, false}};
+    brickPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(BrickConstants))};
+
+    m_shaderPasses[3] = brickPass;
+
 #endif
 #if DDA_VOXELIZATION == 1
     ComputeShaderPass* voxelPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/DDA_density_voxelization.glsl");
     voxelPass->settings.descriptorSetLayoutIDs = {{0, true}, {1, true}, {2, true}};
-    voxelPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(Vec4))};
-    voxelPass->build_shader_stages();
-    voxelPass->build(m_descriptorPool);
+    voxelPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(StrandUniforms))};
     
     m_shaderPasses[0] = voxelPass;
 #elif RASTER_VOXELIZATION == 1
@@ -198,23 +274,23 @@ void HairVoxelizationPass::setup_shader_passes() {
     voxelPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, false}};
     voxelPass->graphicSettings.attributes      = {
         {POSITION_ATTRIBUTE, true}, {NORMAL_ATTRIBUTE, false}, {UV_ATTRIBUTE, false}, {TANGENT_ATTRIBUTE, false}, {COLOR_ATTRIBUTE, false}};
-    voxelPass->graphicSettings.dynamicStates    = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    voxelPass->graphicSettings.vertexLayout    = STRAND_VERTEX_LAYOUT;
+    voxelPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_VERTEX, sizeof(StrandUniforms))};
+    voxelPass->graphicSettings.dynamicStates    = {
+        VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY, VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE};
     VkPipelineColorBlendAttachmentState state   = Init::color_blend_attachment_state(false);
     state.colorWriteMask                        = 0;
     voxelPass->graphicSettings.depthTest        = false;
     voxelPass->graphicSettings.blendAttachments = {state};
     voxelPass->graphicSettings.topology         = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-    voxelPass->build_shader_stages();
-    voxelPass->build(m_descriptorPool);
 
     m_shaderPasses[0] = voxelPass;
 #endif
 
     ComputeShaderPass* shPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/encode_density_SH.glsl");
     shPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}, {OBJECT_LAYOUT, true}, {OBJECT_TEXTURE_LAYOUT, false}};
+    shPass->settings.pushConstants          = {Graphics::PushConstant(SHADER_STAGE_COMPUTE, sizeof(StrandUniforms))};
 
-    shPass->build_shader_stages();
-    shPass->build(m_descriptorPool);
 
     m_shaderPasses[1] = shPass;
 }
@@ -224,29 +300,89 @@ void HairVoxelizationPass::render(Graphics::Frame& currentFrame, Scene* const sc
     CommandBuffer cmd = currentFrame.commandBuffer;
 
     /*
-    PREPARE VOXEL IMAGES TO BE USED IN SHADERS
+    PREPARE VOXEL IMAGES TO BE USED IN SHADERS. Cleared once, afterwards every rebuild hands out the bricks of its slot again
     */
-    if (ResourceManager::HAIR_VOXEL_VOLUME.currentLayout == LAYOUT_UNDEFINED)
+    const bool created = ResourceManager::HAIR_VOXEL_VOLUME.currentLayout == LAYOUT_UNDEFINED;
+    if (created)
     {
+        // Cleared right away
         cmd.pipeline_barrier(
-            ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_UNDEFINED, LAYOUT_GENERAL, ACCESS_NONE, ACCESS_SHADER_WRITE, STAGE_TOP_OF_PIPE, STAGE_FRAGMENT_SHADER);
+            ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_UNDEFINED, LAYOUT_GENERAL, ACCESS_NONE, ACCESS_TRANSFER_WRITE, STAGE_TOP_OF_PIPE, STAGE_TRANSFER);
         cmd.pipeline_barrier(
-            ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_UNDEFINED, LAYOUT_GENERAL, ACCESS_NONE, ACCESS_SHADER_WRITE, STAGE_TOP_OF_PIPE, STAGE_FRAGMENT_SHADER);
+            ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_UNDEFINED, LAYOUT_GENERAL, ACCESS_NONE, ACCESS_TRANSFER_WRITE, STAGE_TOP_OF_PIPE, STAGE_TRANSFER);
         cmd.pipeline_barrier(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME,
                              LAYOUT_UNDEFINED,
                              LAYOUT_GENERAL,
                              ACCESS_NONE,
-                             ACCESS_SHADER_WRITE,
+                             ACCESS_TRANSFER_WRITE,
                              STAGE_TOP_OF_PIPE,
-                             STAGE_FRAGMENT_SHADER);
-    } else
-    {
+                             STAGE_TRANSFER);
+        cmd.pipeline_barrier(
+            ResourceManager::HAIR_BRICK_GRID, LAYOUT_UNDEFINED, LAYOUT_GENERAL, ACCESS_NONE, ACCESS_TRANSFER_WRITE, STAGE_TOP_OF_PIPE, STAGE_TRANSFER);
+
+        /*
+        CLEAR IMAGES. An empty brick grid, no bricks handed out
+        */
+        cmd.clear_image(ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
+        cmd.clear_image(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
+        cmd.clear_image(ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
+        cmd.clear_image(ResourceManager::HAIR_BRICK_GRID, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
+        invalidate_volumes();
+    }
 
+    // Live grooms, one mesh per slot. Object data not rewritten this frame could still point at an older slot
+    std::vector<uint32_t> grooms;
+    VolumeKey             keys[ENGINE_MAX_HAIR_VOLUMES] = {};
+    bool                  queued[ENGINE_MAX_HAIR_VOLUMES] = {};
+    bool                  stale                           = created || !m_cacheVolumes;
+    for (uint32_t mesh_idx = 0; mesh_idx < currentFrame.hairVolumes.size(); mesh_idx++)
+    {
+        const uint32_t     slot   = currentFrame.hairVolumes[mesh_idx];
+        const UniformSlot& object = currentFrame.objectSlots[mesh_idx];
+        Mesh*              m      = scene->get_meshes()[mesh_idx];
+        if (slot == NO_HAIR_VOLUME || queued[slot] || object.object != m || object.hairVolume != slot || !get_VAO(m->get_geometry())->loadedOnGPU)
+            continue;
+
+        keys[slot] = {m->get_geometry(), get_VAO(m->get_geometry())->revision, 0.0f};
+        if (auto mat = dynamic_cast<HairMaterial*>(m->get_material()))
+            keys[slot].thickness = mat->get_thickness();
+        else if (auto epic = dynamic_cast<HairEpicMaterial*>(m->get_material()))
+            keys[slot].thickness = epic->get_thickness();
+        queued[slot] = true;
+        stale        = stale || !(m_volumes[slot] == keys[slot]);
+        grooms.push_back(mesh_idx);
+    }
+    if (!stale)
+    {
+        m_rebuiltVolumes = 0;
+        m_cachedVolumes  = static_cast<uint32_t>(grooms.size());
+        return;
+    }
+    // The pool is handed out from its start again. Slots left without a groom lose their bricks too
+    for (uint32_t slot = 0; slot < ENGINE_MAX_HAIR_VOLUMES; slot++)
+        m_volumes[slot] = keys[slot];
+    m_rebuiltVolumes = static_cast<uint32_t>(grooms.size());
+    m_cachedVolumes  = 0;
+
+    // Brick counters start over. Last read by the previous rebuild, as dispatch arguments too, and its read back
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_SHADER_READ, ACCESS_TRANSFER_WRITE, STAGE_COMPUTE_SHADER, STAGE_TRANSFER);
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_INDIRECT_COMMAND_READ, ACCESS_TRANSFER_WRITE, STAGE_DRAW_INDIRECT, STAGE_TRANSFER);
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_TRANSFER_READ, ACCESS_TRANSFER_WRITE, STAGE_TRANSFER, STAGE_TRANSFER);
+    cmd.fill_buffer(m_brickBuffer, UINT32_MAX, offsetof(BrickHeader, first), sizeof(BrickHeader::first));
+    cmd.fill_buffer(m_brickBuffer, 0, offsetof(BrickHeader, dispatches), sizeof(BrickHeader) - offsetof(BrickHeader, dispatches));
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_READ, STAGE_TRANSFER, STAGE_COMPUTE_SHADER);
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_WRITE, STAGE_TRANSFER, STAGE_COMPUTE_SHADER);
+
+    // Written by the count pass, or by the fragment shader of the raster voxelization
+    const PipelineStage countStage = RASTER_VOXELIZATION == 1 ? STAGE_FRAGMENT_SHADER : STAGE_COMPUTE_SHADER;
+    if (!created)
+    {
 #if OPTICAL_DENSITY == 1
+        // Left zeroed by the last rebuild
         cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME_2,
                              LAYOUT_GENERAL,
                              LAYOUT_GENERAL,
-                             ACCESS_SHADER_READ,
+                             ACCESS_SHADER_WRITE,
                              ACCESS_SHADER_WRITE,
                              STAGE_COMPUTE_SHADER,
                              STAGE_COMPUTE_SHADER);
@@ -258,7 +394,7 @@ void HairVoxelizationPass::render(Graphics::Frame& currentFrame, Scene* const sc
                              ACCESS_SHADER_READ,
                              ACCESS_SHADER_WRITE,
                              STAGE_COMPUTE_SHADER,
-                             STAGE_FRAGMENT_SHADER);
+                             countStage);
 
         cmd.pipeline_barrier(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME,
                              LAYOUT_SHADER_READ_ONLY_OPTIMAL,
@@ -267,131 +403,193 @@ void HairVoxelizationPass::render(Graphics::Frame& currentFrame, Scene* const sc
                              ACCESS_SHADER_WRITE,
                              STAGE_FRAGMENT_SHADER,
                              STAGE_COMPUTE_SHADER);
-    }
-    /*
-    CLEAR IMAGES
-    */
-    cmd.clear_image(ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
-    cmd.clear_image(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
-#if OPTICAL_DENSITY == 1
-    cmd.clear_image(ResourceManager::HAIR_VOXEL_VOLUME_2, LAYOUT_GENERAL, ASPECT_COLOR, Vec4(0.0));
-#endif
 
-    if (scene->get_active_camera() && scene->get_active_camera()->is_active())
+        cmd.pipeline_barrier(ResourceManager::HAIR_BRICK_GRID,
+                             LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             LAYOUT_GENERAL,
+                             ACCESS_SHADER_READ,
+                             ACCESS_SHADER_WRITE,
+                             STAGE_FRAGMENT_SHADER,
+                             STAGE_COMPUTE_SHADER);
+    } else
     {
+        cmd.pipeline_barrier(
+            ResourceManager::HAIR_VOXEL_VOLUME, LAYOUT_GENERAL, LAYOUT_GENERAL, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_WRITE, STAGE_TRANSFER, countStage);
+        cmd.pipeline_barrier(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME,
+                             LAYOUT_GENERAL,
+                             LAYOUT_GENERAL,
+                             ACCESS_TRANSFER_WRITE,
+                             ACCESS_SHADER_WRITE,
+                             STAGE_TRANSFER,
+                             STAGE_COMPUTE_SHADER);
+        cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME_2,
+                             LAYOUT_GENERAL,
+                             LAYOUT_GENERAL,
+                             ACCESS_TRANSFER_WRITE,
+                             ACCESS_SHADER_WRITE,
+                             STAGE_TRANSFER,
+                             STAGE_COMPUTE_SHADER);
+        cmd.pipeline_barrier(
+            ResourceManager::HAIR_BRICK_GRID, LAYOUT_GENERAL, LAYOUT_GENERAL, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_WRITE, STAGE_TRANSFER, STAGE_COMPUTE_SHADER);
+    }
 
-        unsigned int mesh_idx = 0;
-        for (Mesh* m : scene->get_meshes())
-        {
-            if (m)
-            {
-                if (m->is_active() &&  // Check if is active
-                    m->get_geometry()) // Check if is inside frustrum
-                {
-                    auto mat = m->get_material();
-                    if (mat->get_type() == Core::IMaterial::Type::HAIR_STR_TYPE || mat->get_type() == Core::IMaterial::Type::HAIR_STR_EPIC_TYPE)
-                    {
-
-                        uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
+    /*
+    POPULATE AUXILIAR IMAGES WITH DENSITY. Slots are disjoint, so every groom is recorded back to back
+    */
 #if DDA_VOXELIZATION == 1 || OPTICAL_DENSITY == 1
+    ShaderPass* shPass = m_shaderPasses[0];
+    // First the cells segments land in are marked, then lengths are accumulated in the bricks handed out to them
+    auto voxelize = [&](float phase) {
+        cmd.bind_shaderpass(*shPass);
+        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0}, BINDING_TYPE_COMPUTE);
+        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].bufferDescritor, 2, *shPass, {}, BINDING_TYPE_COMPUTE);
+        for (uint32_t mesh_idx : grooms)
+        {
+            Mesh*    m            = scene->get_meshes()[mesh_idx];
+            uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
+            cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *shPass, {objectOffset, objectOffset}, BINDING_TYPE_COMPUTE);
+
+            // The whole groom, in object space. Quantization bounds travel along with the mesh parameters
+            const VAO*     vao            = get_VAO(m->get_geometry());
+            uint32_t       numSegments    = strand_segment_count(vao->strandTopology, vao->indexCount);
+            StrandUniforms strandUniforms = vao->strandUniforms;
+            strandUniforms.params         = Vec4(float(mesh_idx), float(numSegments), m->get_geometry()->get_properties().avgFiberLength, phase);
+            cmd.push_constants(*shPass, SHADER_STAGE_COMPUTE, &strandUniforms, sizeof(StrandUniforms));
+
+            // Dispatch
+            uint32_t wg = (numSegments + 63) / 64; // 64 threads
+            cmd.dispatch_compute({wg, 1, 1});
+        }
+    };
+#if OPTICAL_DENSITY == 1
+    voxelize(0.0f);
 
-                        ShaderPass* shPass = m_shaderPasses[0];
-                        cmd.bind_shaderpass(*shPass);
-
-                        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0}, BINDING_TYPE_COMPUTE);
-                        cmd.bind_descriptor_set(
-                            m_descriptors[currentFrame.index].objectDescritor, 1, *shPass, {objectOffset, objectOffset}, BINDING_TYPE_COMPUTE);
-                        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].bufferDescritor, 2, *shPass, {}, BINDING_TYPE_COMPUTE);
+    cmd.pipeline_barrier(ResourceManager::HAIR_BRICK_GRID,
+                         LAYOUT_GENERAL,
+                         LAYOUT_GENERAL,
+                         ACCESS_SHADER_WRITE,
+                         ACCESS_SHADER_READ,
+                         STAGE_COMPUTE_SHADER,
+                         STAGE_COMPUTE_SHADER);
 
-                        uint32_t numSegments = m->get_geometry()->get_properties().vertexIndex.size() * 0.5;
-                        float    avgHairLength = m->get_geometry()->get_properties().avgFiberLength * m->get_scale().x;
-                        Vec4     data        = Vec4(float(mesh_idx), float(numSegments), avgHairLength, 0.0);
-                        cmd.push_constants(*shPass, SHADER_STAGE_COMPUTE, &data, sizeof(Vec4));
+    ShaderPass* brickPass = m_shaderPasses[3];
+    cmd.bind_shaderpass(*brickPass);
+    cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *brickPass, {0, 0}, BINDING_TYPE_COMPUTE);
 
-                        // Dispatch
-                        uint32_t wg = (numSegments + 31) / 32; // 32 threads
-                        cmd.dispatch_compute({wg, 1, 1});
-#if OPTICAL_DENSITY == 1
+    // One groom after another, so the bricks of every slot are contiguous
+    const uint32_t CELL_GROUP_SIZE = 4;
+    const uint32_t cellGroups      = (ResourceManager::HAIR_BRICK_GRID.extent.height + CELL_GROUP_SIZE - 1) / CELL_GROUP_SIZE;
+    for (size_t i = 0; i < grooms.size(); i++)
+    {
+        if (i > 0)
+            cmd.pipeline_barrier(m_brickBuffer, ACCESS_SHADER_WRITE, ACCESS_SHADER_WRITE, STAGE_COMPUTE_SHADER, STAGE_COMPUTE_SHADER);
+        BrickConstants constants = {};
+        constants.volumeAtlas    = Vec4(float(currentFrame.hairVolumes[grooms[i]]), float(ENGINE_MAX_HAIR_VOLUMES), 0.0f, 0.0f);
+        cmd.push_constants(*brickPass, SHADER_STAGE_COMPUTE, &constants, sizeof(BrickConstants));
+        cmd.dispatch_compute({cellGroups, cellGroups, cellGroups});
+    }
 
-                        cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME_2,
-                                             LAYOUT_GENERAL,
-                                             LAYOUT_GENERAL,
-                                             ACCESS_SHADER_WRITE,
-                                             ACCESS_SHADER_READ,
-                                             STAGE_COMPUTE_SHADER,
-                                             STAGE_COMPUTE_SHADER);
+    cmd.pipeline_barrier(ResourceManager::HAIR_BRICK_GRID,
+                         LAYOUT_GENERAL,
+                         LAYOUT_GENERAL,
+                         ACCESS_SHADER_WRITE,
+                         ACCESS_SHADER_READ,
+                         STAGE_COMPUTE_SHADER,
+                         STAGE_COMPUTE_SHADER);
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_SHADER_WRITE, ACCESS_SHADER_READ, STAGE_COMPUTE_SHADER, STAGE_COMPUTE_SHADER);
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_SHADER_WRITE, ACCESS_INDIRECT_COMMAND_READ, STAGE_COMPUTE_SHADER, STAGE_DRAW_INDIRECT);
 
-                        shPass = m_shaderPasses[2];
-                        cmd.bind_shaderpass(*shPass);
+    voxelize(1.0f);
 
-                        
-                        cmd.push_constants(*shPass, SHADER_STAGE_COMPUTE, &data, sizeof(Vec4));
+    cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME_2,
+                         LAYOUT_GENERAL,
+                         LAYOUT_GENERAL,
+                         ACCESS_SHADER_WRITE,
+                         ACCESS_SHADER_READ,
+                         STAGE_COMPUTE_SHADER,
+                         STAGE_COMPUTE_SHADER);
 
-                        // Dispatch
-                        const uint32_t WORK_GROUP_SIZE = 8;
-                        uint32_t       gridSize        = std::max(1u, m_imageExtent.width);
-                        gridSize                       = (gridSize + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
-                        cmd.dispatch_compute({gridSize, gridSize, gridSize});
+    shPass = m_shaderPasses[2];
+    cmd.bind_shaderpass(*shPass);
+    cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0}, BINDING_TYPE_COMPUTE);
 
+    // One workgroup per brick handed out to the slot
+    for (uint32_t mesh_idx : grooms)
+    {
+        // Object space lengths, like the accumulated ones
+        const uint32_t slot      = currentFrame.hairVolumes[mesh_idx];
+        BrickConstants constants = {};
+        constants.volumeAtlas    = Vec4(float(slot), float(ENGINE_MAX_HAIR_VOLUMES), 0.0f, 0.0f);
+        constants.avgFiberLength = scene->get_meshes()[mesh_idx]->get_geometry()->get_properties().avgFiberLength;
+        cmd.push_constants(*shPass, SHADER_STAGE_COMPUTE, &constants, sizeof(BrickConstants));
+        cmd.dispatch_compute_indirect(m_brickBuffer, offsetof(BrickHeader, dispatches) + sizeof(BrickHeader::dispatches[0]) * slot);
+    }
+#else
+    voxelize(0.0f);
 #endif
 
 #else
-                        /*
-                        POPULATE AUXILIAR IMAGES WITH DENSITY
-                        */
-                        cmd.begin_renderpass(m_renderpass, m_framebuffers[0]);
+    for (uint32_t mesh_idx : grooms)
+    {
+        Mesh*    m            = scene->get_meshes()[mesh_idx];
+        uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
 
-                        cmd.set_viewport(m_imageExtent);
+        cmd.begin_renderpass(m_renderpass, m_framebuffers[0]);
 
-                        ShaderPass* shPass = m_shaderPasses[0];
-                        // Bind pipeline
-                        cmd.bind_shaderpass(*shPass);
-                        // GLOBAL LAYOUT BINDING
-                        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0});
+        cmd.set_viewport(m_imageExtent);
 
-                        // PER OBJECT LAYOUT BINDING
-                        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *shPass, {objectOffset, objectOffset});
+        ShaderPass* shPass = m_shaderPasses[0];
+        // Bind pipeline
+        cmd.bind_shaderpass(*shPass);
+        // GLOBAL LAYOUT BINDING
+        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0});
 
-                        // DRAW
-                        auto g = m->get_geometry();
-                        cmd.draw_geometry(*get_VAO(g));
+        // PER OBJECT LAYOUT BINDING
+        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *shPass, {objectOffset, objectOffset});
 
-                        cmd.end_renderpass(m_renderpass, m_framebuffers[0]);
+        // DRAW
+        auto g = m->get_geometry();
+        cmd.push_constants(*shPass, SHADER_STAGE_VERTEX, &get_VAO(g)->strandUniforms, sizeof(StrandUniforms));
+        cmd.set_strand_topology(get_VAO(g)->strandTopology);
+        cmd.draw_geometry(*get_VAO(g));
+
+        cmd.end_renderpass(m_renderpass, m_framebuffers[0]);
+    }
 #endif
 
-                        /*
-                        DISPATCH COMPUTE FOR POPULATING FINAL PERCEIVED DENSITY IMAGE
-                        */
-
-                        cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME,
-                                             LAYOUT_GENERAL,
-                                             LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                             ACCESS_SHADER_WRITE,
-                                             ACCESS_SHADER_READ,
-                                             STAGE_FRAGMENT_SHADER,
-                                             STAGE_COMPUTE_SHADER);
-
-                        shPass = m_shaderPasses[1];
-                        cmd.bind_shaderpass(*shPass);
-
-                        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shPass, {0, 0}, BINDING_TYPE_COMPUTE);
-                        cmd.bind_descriptor_set(
-                            m_descriptors[currentFrame.index].objectDescritor, 1, *shPass, {objectOffset, objectOffset}, BINDING_TYPE_COMPUTE);
-
-                        // Dispatch the compute shader
-                        const uint32_t WORK_GROUP_SIZE_2 = 8;
-                        uint32_t       gridSize2        = std::max(1u, m_imageExtent.width);
-                        gridSize2                       = (gridSize2 + WORK_GROUP_SIZE_2 - 1) / WORK_GROUP_SIZE_2;
-                        cmd.dispatch_compute({gridSize2, gridSize2, gridSize2});
-
-                        break;
-                    }
-                }
-            }
-            mesh_idx++;
-        }
+    /*
+    DISPATCH COMPUTE FOR POPULATING FINAL PERCEIVED DENSITY IMAGE
+    */
+
+    cmd.pipeline_barrier(ResourceManager::HAIR_VOXEL_VOLUME,
+                         LAYOUT_GENERAL,
+                         LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         ACCESS_SHADER_WRITE,
+                         ACCESS_SHADER_READ,
+                         countStage,
+                         STAGE_COMPUTE_SHADER);
+
+    ShaderPass* encodePass = m_shaderPasses[1];
+    cmd.bind_shaderpass(*encodePass);
+    cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *encodePass, {0, 0}, BINDING_TYPE_COMPUTE);
+
+    // Dispatch the compute shader over the bricks handed out to every groom
+    for (uint32_t mesh_idx : grooms)
+    {
+        uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
+        cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *encodePass, {objectOffset, objectOffset}, BINDING_TYPE_COMPUTE);
+        // Same object space bounds the groom was voxelized in
+        cmd.push_constants(
+            *encodePass, SHADER_STAGE_COMPUTE, &get_VAO(scene->get_meshes()[mesh_idx]->get_geometry())->strandUniforms, sizeof(StrandUniforms));
+        cmd.dispatch_compute_indirect(
+            m_brickBuffer, offsetof(BrickHeader, dispatches) + sizeof(BrickHeader::dispatches[0]) * currentFrame.hairVolumes[mesh_idx]);
     }
 
+    // Counters of this rebuild, read back once the frame is done
+    cmd.pipeline_barrier(m_brickBuffer, ACCESS_SHADER_WRITE, ACCESS_TRANSFER_READ, STAGE_COMPUTE_SHADER, STAGE_TRANSFER);
+    cmd.copy_buffer(m_brickBuffer, m_brickReadback[currentFrame.index], sizeof(BrickHeader));
+    m_brickReadbackPending[currentFrame.index] = true;
+
     cmd.pipeline_barrier(ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME,
                          LAYOUT_GENERAL,
                          LAYOUT_SHADER_READ_ONLY_OPTIMAL,
@@ -399,26 +597,82 @@ void HairVoxelizationPass::render(Graphics::Frame& currentFrame, Scene* const sc
                          ACCESS_SHADER_READ,
                          STAGE_COMPUTE_SHADER,
                          STAGE_FRAGMENT_SHADER);
+    cmd.pipeline_barrier(ResourceManager::HAIR_BRICK_GRID,
+                         LAYOUT_GENERAL,
+                         LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                         ACCESS_SHADER_WRITE,
+                         ACCESS_SHADER_READ,
+                         STAGE_COMPUTE_SHADER,
+                         STAGE_FRAGMENT_SHADER);
 }
 
 void HairVoxelizationPass::update_uniforms(uint32_t frameIndex, Scene* const scene) {
+    // The fence of the frame is signaled, the counters of the rebuild it recorded last time are in
+    if (frameIndex < m_brickReadback.size() && m_brickReadbackPending[frameIndex])
+    {
+        Buffer& readback = m_brickReadback[frameIndex];
+        vmaInvalidateAllocation(readback.allocator, readback.allocation, 0, VK_WHOLE_SIZE);
+        BrickHeader header;
+        memcpy(&header, readback.mappedData, sizeof(BrickHeader));
+        m_brickReadbackPending[frameIndex] = false;
+
+        // Once per overflow, rebuilding every frame would repeat it
+        const bool wasFull = m_requestedBricks > m_brickCapacity;
+        m_requestedBricks  = header.allocated;
+        for (uint32_t slot = 0; slot < ENGINE_MAX_HAIR_VOLUMES && !wasFull; slot++)
+        {
+            const uint32_t dropped = header.requested[slot] - header.dispatches[slot][0];
+            if (dropped > 0)
+                LOG_WARN("Hair brick pool full, " + std::to_string(dropped) + " of the " + std::to_string(header.requested[slot]) +
+                         " cells of hair volume " + std::to_string(slot) + " were dropped. " + std::to_string(header.allocated) +
+                         " bricks were asked for, the pool holds " + std::to_string(m_brickCapacity));
+        }
+    }
+
+    // The budget of every groom in the scene (same ones the atlas gives a slot), or what the last rebuild asked for plus
+    // some slack. Shrunk only once it is twice as large as that
+    std::set<const Geometry*> grooms;
+    for (Mesh* m : scene->get_meshes())
+    {
+        if (!m || !m->is_active() || !m->get_geometry() || !m->get_material() || grooms.size() == ENGINE_MAX_HAIR_VOLUMES)
+            continue;
+        const IMaterial::Type type = m->get_material()->get_type();
+        if (type == IMaterial::Type::HAIR_STR_TYPE || type == IMaterial::Type::HAIR_STR_EPIC_TYPE)
+            grooms.insert(m->get_geometry());
+    }
+    const uint32_t LAYER_BRICKS = POOL_SIDE * POOL_SIDE;
+    const uint32_t bricks       = std::max(static_cast<uint32_t>(grooms.size()) * m_volumeBricks, m_requestedBricks + m_requestedBricks / 4);
+    uint32_t       layers       = std::max((bricks + LAYER_BRICKS - 1) / LAYER_BRICKS, 1u);
+    if (layers * LAYER_BRICKS > m_brickCapacity)
+    {
+        const uint32_t maxLayers = max_pool_layers();
+        if (layers > maxLayers && !m_poolCapped)
+            LOG_WARN("Hair brick pool capped at " + std::to_string(maxLayers * LAYER_BRICKS) + " bricks by the memory budget, " +
+                     std::to_string(bricks) + " were asked for. Cells past the cap are dropped");
+        m_poolCapped = layers > maxLayers;
+        layers       = std::min(layers, maxLayers);
+    }
+    if (layers * LAYER_BRICKS > m_brickCapacity || layers * LAYER_BRICKS * 2 < m_brickCapacity)
+        resize_brick_pool(layers * LAYER_BRICKS);
+
 #if DDA_VOXELIZATION == 1 || OPTICAL_DENSITY == 1
     uint32_t meshIdx = 0;
     for (Mesh* m : scene->get_meshes())
     {
-        if (m)
+        if (m && meshIdx < ENGINE_MAX_OBJECTS)
         {
             auto g = m->get_geometry();
 
             VAO* vao = get_VAO(g);
             if (vao->loadedOnGPU)
             {
-                // Pos SSBO binding
+                // Pos SSBO binding. Strand geometry is read straight from its quantized VBO
+                Buffer* posBuffer = vao->layout == STRAND_VERTEX_LAYOUT ? &vao->vbo : &vao->posSSBO;
                 m_descriptorPool.set_descriptor_write(
-                    &vao->posSSBO, vao->posSSBO.size, 0, &m_descriptors[frameIndex].bufferDescritor, UNIFORM_STORAGE_BUFFER, 0, meshIdx);
-                // IBO binding
+                    posBuffer, posBuffer->size, 0, &m_descriptors[frameIndex].bufferDescritor, UNIFORM_STORAGE_BUFFER, 0, meshIdx);
+                // IBO binding, it doubles as a storage buffer
                 m_descriptorPool.set_descriptor_write(
-                    &vao->indexSSBO, vao->indexSSBO.size, 0, &m_descriptors[frameIndex].bufferDescritor, UNIFORM_STORAGE_BUFFER, 1, meshIdx);
+                    &vao->ibo, vao->ibo.size, 0, &m_descriptors[frameIndex].bufferDescritor, UNIFORM_STORAGE_BUFFER, 1, meshIdx);
             }
         }
         meshIdx++;
@@ -429,7 +683,11 @@ void HairVoxelizationPass::cleanup() {
     ResourceManager::HAIR_VOXEL_VOLUME.cleanup();
     ResourceManager::HAIR_VOXEL_VOLUME_2.cleanup();
     ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME.cleanup();
+    ResourceManager::HAIR_BRICK_GRID.cleanup();
     m_directionsBuffer.cleanup();
+    m_brickBuffer.cleanup();
+    for (Buffer& readback : m_brickReadback)
+        readback.cleanup();
     GraphicPass::cleanup();
 }
 } // namespace Core
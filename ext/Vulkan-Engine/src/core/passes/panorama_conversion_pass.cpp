@@ -13,7 +13,7 @@ void PanoramaConverterPass::setup_attachments(std::vector<Graphics::AttachmentIn
                                               1,
                                               LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                               LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                              IMAGE_USAGE_COLOR_ATTACHMENT | IMAGE_USAGE_SAMPLED,
+                                              IMAGE_USAGE_COLOR_ATTACHMENT | IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_SRC,
                                               COLOR_ATTACHMENT,
                                               ASPECT_COLOR,
                                               TEXTURE_CUBE,
@@ -49,8 +49,6 @@ void PanoramaConverterPass::setup_shader_passes() {
                                                       {TANGENT_ATTRIBUTE, false},
                                                       {COLOR_ATTRIBUTE, false}};
 
-    converterPass->build_shader_stages();
-    converterPass->build(m_descriptorPool);
 
     m_shaderPasses[0] = converterPass;
 }
@@ -4,7 +4,7 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 using namespace Graphics;
 namespace Core {
 
-void BasePass::setup(std::vector<Graphics::Frame>& frames) {
+void BasePass::setup(std::vector<Graphics::Frame>& frames, bool buildShaderPasses) {
     std::vector<Graphics::AttachmentInfo>        attachments;
     std::vector<Graphics::SubPassDependency> dependencies;
     setup_attachments(attachments, dependencies);
@@ -20,6 +20,17 @@ void BasePass::setup(std::vector<Graphics::Frame>& frames) {
     create_framebuffer();
     setup_uniforms(frames);
     setup_shader_passes();
+
+    if (buildShaderPasses)
+    {
+        for (auto pair : m_shaderPasses)
+            build_shader_pass(pair.second);
+    }
+}
+
+void BasePass::build_shader_pass(Graphics::ShaderPass* shaderPass) {
+    shaderPass->build_shader_stages();
+    shaderPass->build(m_descriptorPool);
 }
 
 void BasePass::cleanup() {
@@ -69,8 +69,6 @@ void PostProcessPass::setup_shader_passes() {
                                                {TANGENT_ATTRIBUTE, false},
                                                {COLOR_ATTRIBUTE, false}};
 
-    ppPass->build_shader_stages();
-    ppPass->build(m_descriptorPool);
 
     m_shaderPasses[0] = ppPass;
 }
@@ -145,8 +145,6 @@ void PreCompositionPass::setup_shader_passes() {
 
     compPass->settings.pushConstants = {PushConstant(SHADER_STAGE_FRAGMENT, sizeof(SSAOSettings))};
 
-    compPass->build_shader_stages();
-    compPass->build(m_descriptorPool);
     m_shaderPasses[0] = compPass;
 
     GraphicShaderPass* blurPass = new GraphicShaderPass(
@@ -160,8 +158,6 @@ void PreCompositionPass::setup_shader_passes() {
 
     blurPass->settings.pushConstants = {PushConstant(SHADER_STAGE_FRAGMENT, sizeof(SSAOSettings))};
 
-    blurPass->build_shader_stages();
-    blurPass->build(m_descriptorPool);
     m_shaderPasses[1] = blurPass;
 }
 
@@ -72,7 +72,7 @@ void ShadowPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
             &frames[i].uniformBuffers[1], sizeof(ObjectUniforms), 0, &m_descriptors[i].objectDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[1],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
@@ -100,8 +100,6 @@ void ShadowPass::setup_shader_passes() {
         new GraphicShaderPass(m_device->get_handle(), m_renderpass, m_imageExtent, ENGINE_RESOURCES_PATH "shaders/shadows/shadows_geom.glsl");
     depthPass->settings        = settings;
     depthPass->graphicSettings = gfxSettings;
-    depthPass->build_shader_stages();
-    depthPass->build(m_descriptorPool);
     m_shaderPasses[0] = depthPass;
 
     GraphicShaderPass* depthLinePass =
@@ -110,8 +108,11 @@ void ShadowPass::setup_shader_passes() {
     depthLinePass->graphicSettings             = gfxSettings;
     depthLinePass->graphicSettings.topology    = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
     depthLinePass->graphicSettings.poligonMode = VK_POLYGON_MODE_LINE;
-    depthLinePass->build_shader_stages();
-    depthLinePass->build(m_descriptorPool);
+    // Strand geometry is the only one drawn as lines, either line lists or line strips with restart
+    depthLinePass->graphicSettings.vertexLayout = STRAND_VERTEX_LAYOUT;
+    depthLinePass->graphicSettings.dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+    depthLinePass->graphicSettings.dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
+    depthLinePass->settings.pushConstants       = {PushConstant(SHADER_STAGE_VERTEX, sizeof(StrandUniforms))};
     m_shaderPasses[1] = depthLinePass;
 }
 
@@ -130,7 +131,7 @@ void ShadowPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint3
     int mesh_idx = 0;
     for (Mesh* m : scene->get_meshes())
     {
-        if (m)
+        if (m && mesh_idx < ENGINE_MAX_OBJECTS) // Meshes past the uniform slots are not drawn
         {
             if (m->is_active() && m->cast_shadows() && m->get_num_geometries() > 0)
             {
@@ -143,7 +144,8 @@ void ShadowPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint3
                     Geometry*  g   = m->get_geometry(i);
                     IMaterial* mat = m->get_material(g->get_material_ID());
 
-                    ShaderPass* shaderPass = mat->get_type() != IMaterial::Type::HAIR_STR_TYPE ? m_shaderPasses[0] : m_shaderPasses[1];
+                    VAO*        vao        = get_VAO(g);
+                    ShaderPass* shaderPass = vao->layout != STRAND_VERTEX_LAYOUT ? m_shaderPasses[0] : m_shaderPasses[1];
 
                     cmd.set_depth_test_enable(mat->get_parameters().depthTest);
                     cmd.set_depth_write_enable(mat->get_parameters().depthWrite);
@@ -154,9 +156,15 @@ void ShadowPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint3
                     cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shaderPass, {0, 0});
                     // PER OBJECT LAYOUT BINDING
                     cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *shaderPass, {objectOffset, objectOffset});
+                    // STRAND DECODING CONSTANTS
+                    if (vao->layout == STRAND_VERTEX_LAYOUT)
+                    {
+                        cmd.push_constants(*shaderPass, SHADER_STAGE_VERTEX, &vao->strandUniforms, sizeof(StrandUniforms));
+                        cmd.set_strand_topology(vao->strandTopology);
+                    }
 
                     // DRAW
-                    cmd.draw_geometry(*get_VAO(g));
+                    cmd.draw_geometry(*vao);
                 }
             }
             mesh_idx++;
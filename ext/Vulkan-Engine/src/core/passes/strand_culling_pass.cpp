@@ -0,0 +1,119 @@
+#include <engine/core/passes/strand_culling_pass.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+using namespace Graphics;
+namespace Core {
+
+void StrandCullingPass::setup_attachments(std::vector<Graphics::AttachmentInfo>& attachments, std::vector<Graphics::SubPassDependency>& dependencies) {
+    // Compute only, no attachments
+    m_isResizeable = false;
+}
+void StrandCullingPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
+    m_descriptorPool = m_device->create_descriptor_pool(ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS, ENGINE_MAX_OBJECTS);
+    m_descriptors.resize(frames.size());
+
+    // GLOBAL SET
+    LayoutBinding camBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_COMPUTE, 0);
+    LayoutBinding sceneBufferBinding(UNIFORM_DYNAMIC_BUFFER, SHADER_STAGE_COMPUTE, 1);
+    m_descriptorPool.set_layout(GLOBAL_LAYOUT, {camBufferBinding, sceneBufferBinding});
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        m_descriptorPool.allocate_descriptor_set(GLOBAL_LAYOUT, &m_descriptors[i].globalDescritor);
+        m_descriptorPool.set_descriptor_write(
+            &frames[i].uniformBuffers[GLOBAL_LAYOUT], sizeof(CameraUniforms), 0, &m_descriptors[i].globalDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
+        m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[GLOBAL_LAYOUT],
+                                              sizeof(SceneUniforms),
+                                              m_device->pad_uniform_buffer_size(sizeof(CameraUniforms)),
+                                              &m_descriptors[i].globalDescritor,
+                                              UNIFORM_DYNAMIC_BUFFER,
+                                              1);
+    }
+}
+void StrandCullingPass::setup_shader_passes() {
+    ComputeShaderPass* cullPass = new ComputeShaderPass(m_device->get_handle(), ENGINE_RESOURCES_PATH "shaders/misc/strand_culling.glsl");
+    cullPass->settings.descriptorSetLayoutIDs = {{GLOBAL_LAYOUT, true}};
+    cullPass->settings.pushConstants          = {PushConstant(SHADER_STAGE_COMPUTE, sizeof(CullingConstants))};
+
+    m_shaderPasses[0] = cullPass;
+}
+
+void StrandCullingPass::render(Graphics::Frame& currentFrame, Scene* const scene, uint32_t presentImageIndex) {
+    PROFILING_EVENT()
+
+    bool anyCapacity = false;
+    for (const StrandDrawList& draw : currentFrame.strandDraws)
+        for (uint32_t view = 0; view < STRAND_VIEW_COUNT; view++)
+            anyCapacity |= draw.capacity[view] > 0;
+    if (!anyCapacity || !currentFrame.strandCounts.handle || !currentFrame.strandCommands.handle)
+        return;
+
+    CommandBuffer cmd = currentFrame.commandBuffer;
+
+    // Counts start at zero every frame. The previous reads were waited by the frame fence
+    cmd.fill_buffer(currentFrame.strandCounts, 0);
+    cmd.pipeline_barrier(currentFrame.strandCounts, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_READ, STAGE_TRANSFER, STAGE_COMPUTE_SHADER);
+    cmd.pipeline_barrier(currentFrame.strandCounts, ACCESS_TRANSFER_WRITE, ACCESS_SHADER_WRITE, STAGE_TRANSFER, STAGE_COMPUTE_SHADER);
+
+    ShaderPass* shaderPass = m_shaderPasses[0];
+    cmd.bind_shaderpass(*shaderPass);
+    cmd.bind_descriptor_set(m_descriptors[currentFrame.index].globalDescritor, 0, *shaderPass, {0, 0}, BINDING_TYPE_COMPUTE);
+
+    CullingConstants constants = {};
+    constants.objects          = currentFrame.objectTable.get_device_address();
+    constants.commands         = currentFrame.strandCommands.get_device_address();
+    constants.counts           = currentFrame.strandCounts.get_device_address();
+
+    auto dispatch = [&](uint32_t firstCluster, uint32_t clusterCount, uint32_t indexLimit, uint32_t mode) {
+        constants.firstCluster = firstCluster;
+        constants.clusterCount = clusterCount;
+        constants.indexLimit   = indexLimit;
+        constants.mode         = mode;
+        cmd.push_constants(*shaderPass, SHADER_STAGE_COMPUTE, &constants, sizeof(CullingConstants));
+
+        const uint32_t threads = clusterCount * constants.instanceCount;
+        cmd.dispatch_compute({(threads + 63) / 64, 1, 1});
+    };
+
+    for (const InstanceBatch& batch : currentFrame.instanceBatches)
+    {
+        Mesh* m = scene->get_meshes()[batch.meshIndex];
+        for (size_t i = 0; i < m->get_num_geometries(); i++)
+        {
+            const StrandDrawList& draw = currentFrame.strandDraws[batch.firstDraw + i];
+            Geometry*             g    = m->get_geometry(i);
+            VAO*                  vao  = get_VAO(g);
+            if (vao->clusterCount == 0)
+                continue;
+
+            const std::vector<StrandLOD>& lods = g->get_properties().strandLODs;
+            constants.clusters                 = vao->clusterSSBO.get_device_address();
+            constants.firstInstance            = batch.firstInstance;
+            constants.instanceCount            = batch.instanceCount;
+            constants.firstOutput              = draw.firstOutput;
+            constants.pulled                   = m_strandVertexPulling ? 1 + vao->strandTopology : 0;
+            for (uint32_t view = 0; view < STRAND_VIEW_COUNT; view++)
+            {
+                constants.firstCommand[view] = draw.firstCommand[view];
+                constants.capacity[view]     = draw.capacity[view];
+            }
+
+            // Clusters of the selected level, those past the drawn strand prefix are skipped
+            if (draw.capacity[STRAND_CAMERA_VIEW] > 0)
+                dispatch(lods[draw.level].firstCluster, lods[draw.level].clusterCount, draw.firstIndex + draw.indexCount, 0);
+            // Shadows use the full detail
+            if (draw.capacity[STRAND_SHADOW_VIEW] > 0)
+                dispatch(lods[0].firstCluster, lods[0].clusterCount, UINT32_MAX, 1);
+        }
+    }
+
+    cmd.pipeline_barrier(currentFrame.strandCounts, ACCESS_SHADER_WRITE, ACCESS_INDIRECT_COMMAND_READ, STAGE_COMPUTE_SHADER, STAGE_DRAW_INDIRECT);
+    cmd.pipeline_barrier(currentFrame.strandCommands, ACCESS_SHADER_WRITE, ACCESS_INDIRECT_COMMAND_READ, STAGE_COMPUTE_SHADER, STAGE_DRAW_INDIRECT);
+    cmd.pipeline_barrier(currentFrame.strandCommands, ACCESS_SHADER_WRITE, ACCESS_SHADER_READ, STAGE_COMPUTE_SHADER, STAGE_COMPUTE_SHADER);
+
+    currentFrame.strandsCulled = true;
+}
+
+} // namespace Core
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -73,7 +73,7 @@ void VarianceShadowPass::setup_uniforms(std::vector<Graphics::Frame>& frames) {
             &frames[i].uniformBuffers[1], sizeof(ObjectUniforms), 0, &m_descriptors[i].objectDescritor, UNIFORM_DYNAMIC_BUFFER, 0);
         m_descriptorPool.set_descriptor_write(&frames[i].uniformBuffers[1],
                                               sizeof(MaterialUniforms),
-                                              m_device->pad_uniform_buffer_size(sizeof(MaterialUniforms)),
+                                              m_device->pad_uniform_buffer_size(sizeof(ObjectUniforms)),
                                               &m_descriptors[i].objectDescritor,
                                               UNIFORM_DYNAMIC_BUFFER,
                                               1);
@@ -101,8 +101,6 @@ void VarianceShadowPass::setup_shader_passes() {
         new GraphicShaderPass(m_device->get_handle(), m_renderpass, m_imageExtent, ENGINE_RESOURCES_PATH "shaders/shadows/vsm_geom.glsl");
     depthPass->settings        = settings;
     depthPass->graphicSettings = gfxSettings;
-    depthPass->build_shader_stages();
-    depthPass->build(m_descriptorPool);
     m_shaderPasses[0] = depthPass;
 
     GraphicShaderPass* depthLinePass =
@@ -111,8 +109,11 @@ void VarianceShadowPass::setup_shader_passes() {
     depthLinePass->graphicSettings             = gfxSettings;
     depthLinePass->graphicSettings.topology    = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
     depthLinePass->graphicSettings.poligonMode = VK_POLYGON_MODE_LINE;
-    depthLinePass->build_shader_stages();
-    depthLinePass->build(m_descriptorPool);
+    // Strand geometry is the only one drawn as lines, either line lists or line strips with restart
+    depthLinePass->graphicSettings.vertexLayout = STRAND_VERTEX_LAYOUT;
+    depthLinePass->graphicSettings.dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+    depthLinePass->graphicSettings.dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
+    depthLinePass->settings.pushConstants       = {PushConstant(SHADER_STAGE_VERTEX, sizeof(StrandUniforms))};
     m_shaderPasses[1] = depthLinePass;
 }
 
@@ -130,12 +131,18 @@ void VarianceShadowPass::render(Graphics::Frame& currentFrame, Scene* const scen
     float depthBiasSlope    = 0.0f;
     cmd.set_depth_bias(depthBiasConstant, 0.0f, depthBiasSlope);
 
+    const uint64_t objectTable = currentFrame.objectTable.handle ? currentFrame.objectTable.get_device_address() : 0;
+
     int mesh_idx = 0;
     for (Mesh* m : scene->get_meshes())
     {
-        if (m)
+        if (m && mesh_idx < ENGINE_MAX_OBJECTS) // Meshes past the uniform slots are not drawn
         {
-            if (m->is_active() && m->cast_shadows() && m->get_num_geometries() > 0)
+            // Strand meshes are drawn by the first mesh of their instance batch. Members not casting shadows are culled
+            const uint32_t batchIdx = static_cast<uint32_t>(mesh_idx) < currentFrame.meshBatches.size() ? currentFrame.meshBatches[mesh_idx] : NO_INSTANCE_BATCH;
+            const InstanceBatch* batch = batchIdx != NO_INSTANCE_BATCH ? &currentFrame.instanceBatches[batchIdx] : nullptr;
+
+            if (m->is_active() && (m->cast_shadows() || batch) && m->get_num_geometries() > 0 && (!batch || batch->meshIndex == static_cast<uint32_t>(mesh_idx)))
             {
                 uint32_t objectOffset = currentFrame.uniformBuffers[1].strideSize * mesh_idx;
 
@@ -146,7 +153,12 @@ void VarianceShadowPass::render(Graphics::Frame& currentFrame, Scene* const scen
                     Geometry*  g   = m->get_geometry(i);
                     IMaterial* mat = m->get_material(g->get_material_ID());
 
-                    ShaderPass* shaderPass = mat->get_type() != IMaterial::Type::HAIR_STR_EPIC_TYPE ? m_shaderPasses[0] : m_shaderPasses[1];
+                    VAO*        vao        = get_VAO(g);
+                    const bool  strands    = vao->layout == STRAND_VERTEX_LAYOUT;
+                    ShaderPass* shaderPass = !strands ? m_shaderPasses[0] : m_shaderPasses[1];
+                    // Strand shaders need the object table entry written by the resource manager
+                    if ((strands && !batch) || (!strands && !m->cast_shadows()))
+                        continue;
 
                     cmd.set_depth_test_enable(mat->get_parameters().depthTest);
                     cmd.set_depth_write_enable(mat->get_parameters().depthWrite);
@@ -159,7 +171,29 @@ void VarianceShadowPass::render(Graphics::Frame& currentFrame, Scene* const scen
                     cmd.bind_descriptor_set(m_descriptors[currentFrame.index].objectDescritor, 1, *shaderPass, {objectOffset, objectOffset});
 
                     // DRAW
-                    cmd.draw_geometry(*get_VAO(g));
+                    if (strands)
+                    {
+                        // STRAND DECODING CONSTANTS AND OBJECT TABLE
+                        const StrandDrawList& draw = currentFrame.strandDraws[batch->firstDraw + i];
+
+                        StrandUniforms strandUniforms = vao->strandUniforms;
+                        strandUniforms.objectTable    = objectTable;
+                        cmd.push_constants(*shaderPass, SHADER_STAGE_VERTEX, &strandUniforms, sizeof(StrandUniforms));
+                        cmd.set_strand_topology(vao->strandTopology);
+
+                        // Clusters outside every shadow casting light were culled, the rest of the batch is drawn at full detail
+                        if (currentFrame.strandsCulled && draw.capacity[STRAND_SHADOW_VIEW] > 0)
+                            cmd.draw_geometry_indirect(*vao,
+                                                       0,
+                                                       currentFrame.strandCommands,
+                                                       draw.firstCommand[STRAND_SHADOW_VIEW] * sizeof(VkDrawIndexedIndirectCommand),
+                                                       currentFrame.strandCounts,
+                                                       draw.output(STRAND_SHADOW_VIEW) * sizeof(math::uvec4),
+                                                       draw.capacity[STRAND_SHADOW_VIEW]);
+                        else
+                            cmd.draw_geometry(*vao, batch->instanceCount, 0, 0, batch->firstInstance);
+                    } else
+                        cmd.draw_geometry(*vao);
                 }
             }
             mesh_idx++;
@@ -6,6 +6,10 @@ namespace Core {
 
 Core::PanoramaConverterPass*  ResourceManager::panoramaConverterPass = nullptr;
 Core::IrrandianceComputePass* ResourceManager::irradianceComputePass = nullptr;
+Graphics::Image               ResourceManager::CACHED_ENV_CUBEMAP;
+Graphics::Image               ResourceManager::CACHED_IRRADIANCE_CUBEMAP;
+// Entry to fill with the maps generated by the last frame, empty if there is none
+static std::string            pendingEnvironmentCache;
 
 Core::Texture*    ResourceManager::FALLBACK_TEXTURE    = nullptr;
 Core::Texture*    ResourceManager::FALLBACK_CUBEMAP    = nullptr;
@@ -16,6 +20,7 @@ Graphics::Image   ResourceManager::HAIR_BACK_ATT;
 Graphics::Image   ResourceManager::HAIR_FRONT_ATT;
 Graphics::Image   ResourceManager::HAIR_VOXEL_VOLUME;
 Graphics::Image   ResourceManager::HAIR_VOXEL_VOLUME_2;
+Graphics::Image   ResourceManager::HAIR_BRICK_GRID;
 Graphics::Image   ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME;
 Graphics::Image   ResourceManager::HAIR_NG;
 Graphics::Image   ResourceManager::HAIR_NG_TRT;
@@ -26,6 +31,48 @@ Graphics::Image   ResourceManager::HAIR_FRONT_BETAS;
 Graphics::Image   ResourceManager::HAIR_GI;
 Core::Mesh*       ResourceManager::VIGNETTE = nullptr;
 
+// 3D lookup textures decoded from image files are baked into the volume cache once, later runs map them into the image
+static bool upload_cached_volume(Graphics::Device* const device, Core::ITexture* const t, const std::string& cachePath) {
+    Graphics::Utils::MappedFile cacheFile;
+    ColorFormatType             format;
+    Extent3D                    extent;
+    const uint8_t*              data = nullptr;
+    if (!Tools::VolumeCache::read(cachePath, cacheFile, format, extent, data))
+        return false;
+
+    t->set_type(TEXTURE_3D);
+    t->set_format(format);
+    t->set_size(extent);
+
+    Graphics::ImageConfig   config        = {};
+    Graphics::SamplerConfig samplerConfig = {};
+    Core::TextureSettings   textSettings  = t->get_settings();
+    config.viewType                       = TEXTURE_3D;
+    config.format                         = format;
+    samplerConfig.filters                 = textSettings.filter;
+    samplerConfig.samplerAddressMode      = textSettings.adressMode;
+    samplerConfig.border                  = BorderColor::FLOAT_OPAQUE_BLACK;
+    device->upload_texture_image(*get_image(t), config, samplerConfig, data, Graphics::Utils::get_block_size(format), false);
+    return true;
+}
+static bool store_cached_volume(Core::ITexture* const t, const std::string& cachePath) {
+    void* imgCache{nullptr};
+    t->get_image_cache(imgCache);
+    if (cachePath.empty() || !t->loaded_on_CPU() || !imgCache)
+        return false;
+
+    const ColorFormatType format = t->get_settings().format;
+    const Extent3D        extent = t->get_size();
+    const size_t          count  = size_t(extent.width) * extent.height * extent.depth;
+    if (format == SRGBA_32F)
+    {
+        std::vector<uint16_t> halfTexels;
+        Tools::VolumeCache::to_half(static_cast<const float*>(imgCache), count * 4, halfTexels);
+        return Tools::VolumeCache::write(cachePath, SRGBA_16F, extent, halfTexels.data(), halfTexels.size() * sizeof(uint16_t));
+    }
+    return Tools::VolumeCache::write(cachePath, format, extent, imgCache, count * Graphics::Utils::get_block_size(format));
+}
+
 void ResourceManager::init_basic_resources(Graphics::Device* const device) {
 
     // Setup vignette
@@ -67,8 +114,14 @@ void ResourceManager::init_basic_resources(Graphics::Device* const device) {
         settings.adressMode = ADDRESS_MODE_CLAMP_TO_BORDER;
         HAIR_FAR_FIELD_DIST = new TextureHDR(settings);
 
-        Tools::Loaders::load_3D_texture(HAIR_FAR_FIELD_DIST, ENGINE_RESOURCES_PATH "textures/Dp.hdr");
-        // Tools::Loaders::load_HDRi(HAIR_FAR_FIELD_DIST, ENGINE_RESOURCES_PATH "textures/DpNorm.hdr");
+        const std::string cachePath = Tools::VolumeCache::get_cache_path({ENGINE_RESOURCES_PATH "textures/Dp.hdr"}, {});
+        if (!upload_cached_volume(device, HAIR_FAR_FIELD_DIST, cachePath))
+        {
+            Tools::Loaders::load_3D_texture(HAIR_FAR_FIELD_DIST, ENGINE_RESOURCES_PATH "textures/Dp.hdr");
+            // Tools::Loaders::load_HDRi(HAIR_FAR_FIELD_DIST, ENGINE_RESOURCES_PATH "textures/DpNorm.hdr");
+            if (store_cached_volume(HAIR_FAR_FIELD_DIST, cachePath))
+                upload_cached_volume(device, HAIR_FAR_FIELD_DIST, cachePath);
+        }
     }
     upload_texture_data(device, HAIR_FAR_FIELD_DIST);
 
@@ -80,9 +133,15 @@ void ResourceManager::init_basic_resources(Graphics::Device* const device) {
         settings.adressMode = ADDRESS_MODE_CLAMP_TO_BORDER;
         HAIR_GI_FALLBACK    = new Texture(settings);
 
-        Tools::Loaders::load_3D_texture(HAIR_GI_FALLBACK, ENGINE_RESOURCES_PATH "textures/LUTs/blonde/GI.png");
-        HAIR_GI_FALLBACK->set_format(RGBA_8U);
-        HAIR_GI_FALLBACK->set_type(TEXTURE_3D);
+        const std::string cachePath = Tools::VolumeCache::get_cache_path({ENGINE_RESOURCES_PATH "textures/LUTs/blonde/GI.png"}, {});
+        if (!upload_cached_volume(device, HAIR_GI_FALLBACK, cachePath))
+        {
+            Tools::Loaders::load_3D_texture(HAIR_GI_FALLBACK, ENGINE_RESOURCES_PATH "textures/LUTs/blonde/GI.png");
+            HAIR_GI_FALLBACK->set_format(RGBA_8U);
+            HAIR_GI_FALLBACK->set_type(TEXTURE_3D);
+            if (store_cached_volume(HAIR_GI_FALLBACK, cachePath))
+                upload_cached_volume(device, HAIR_GI_FALLBACK, cachePath);
+        }
     }
     upload_texture_data(device, HAIR_GI_FALLBACK);
 }
@@ -105,6 +164,8 @@ void ResourceManager::clean_basic_resources() {
         panoramaConverterPass->clean_framebuffer();
         panoramaConverterPass->cleanup();
     }
+    CACHED_ENV_CUBEMAP.cleanup();
+    CACHED_IRRADIANCE_CUBEMAP.cleanup();
 }
 void ResourceManager::update_global_data(Graphics::Device* const device,
                                          Graphics::Frame* const  currentFrame,
@@ -152,6 +213,7 @@ void ResourceManager::update_global_data(Graphics::Device* const device,
     camData.farPlane     = camera->get_far();
 
     currentFrame->uniformBuffers[GLOBAL_LAYOUT].upload_data(&camData, sizeof(Graphics::CameraUniforms), 0);
+    currentFrame->uniformStats.bytesWritten += sizeof(Graphics::CameraUniforms);
 
     /*
     SCENE UNIFORMS LOAD
@@ -194,6 +256,7 @@ void ResourceManager::update_global_data(Graphics::Device* const device,
 
     currentFrame->uniformBuffers[GLOBAL_LAYOUT].upload_data(
         &sceneParams, sizeof(Graphics::SceneUniforms), device->pad_uniform_buffer_size(sizeof(Graphics::CameraUniforms)));
+    currentFrame->uniformStats.bytesWritten += sizeof(Graphics::SceneUniforms);
 
     /*
     SKYBOX MESH AND TEXTURE UPLOAD
@@ -240,41 +303,117 @@ void ResourceManager::update_object_data(Graphics::Device* const device,
 
         std::vector<Graphics::BLASInstance> BLASInstances; // RT Acceleration Structures per instanced mesh
         BLASInstances.reserve(scene->get_meshes().size());
-        unsigned int mesh_idx = 0;
+
+        // Voxelized grooms get a slot of the hair volume atlas, in scene order. Volumes are in object space, so meshes sharing a
+        // geometry share the slot
+        currentFrame->hairVolumes.assign(scene->get_meshes().size(), NO_HAIR_VOLUME);
+        std::map<const Core::Geometry*, uint32_t> hairVolumeSlots;
+        for (size_t i = 0; i < scene->get_meshes().size() && i < ENGINE_MAX_OBJECTS; i++)
+        {
+            Core::Mesh* m = scene->get_meshes()[i];
+            if (!m || !m->is_active() || !m->get_geometry() || !m->get_material())
+                continue;
+            const Core::IMaterial::Type type = m->get_material()->get_type();
+            if (type != Core::IMaterial::Type::HAIR_STR_TYPE && type != Core::IMaterial::Type::HAIR_STR_EPIC_TYPE)
+                continue;
+            auto slot = hairVolumeSlots.find(m->get_geometry());
+            if (slot != hairVolumeSlots.end())
+            {
+                currentFrame->hairVolumes[i] = slot->second;
+                continue;
+            }
+            if (hairVolumeSlots.size() == ENGINE_MAX_HAIR_VOLUMES)
+            {
+                static bool warned = false; // Once, the assignment is redone every frame
+                if (!warned)
+                    LOG_WARN("Hair volume atlas full, grooms past the first " + std::to_string(ENGINE_MAX_HAIR_VOLUMES) + " are not voxelized");
+                warned = true;
+                continue;
+            }
+            currentFrame->hairVolumes[i] = static_cast<uint32_t>(hairVolumeSlots.size());
+            hairVolumeSlots.emplace(m->get_geometry(), currentFrame->hairVolumes[i]);
+        }
+
+        auto get_object_uniforms = [](Core::Mesh* m, uint32_t hairVolume) {
+            Graphics::ObjectUniforms objectData;
+            objectData.model        = m->get_model_matrix();
+            objectData.otherParams1 = {m->affected_by_fog(), m->receive_shadows(), m->cast_shadows(), false};
+            objectData.otherParams2 = {m->is_selected(), m->get_bounding_volume()->center};
+            objectData.volumeAtlas  = {hairVolume == NO_HAIR_VOLUME ? -1.0f : float(hairVolume), float(ENGINE_MAX_HAIR_VOLUMES), 0.0f, 0.0f};
+            objectData.maxCoord     = objectData.model * Vec4(m->get_bounding_volume()->maxCoords, 1.0);
+            objectData.minCoord     = objectData.model * Vec4(m->get_bounding_volume()->minCoords, 1.0);
+            objectData.normalMatrix = math::transpose(math::inverse(objectData.model));
+            // objectData.maxCoord     =  Vec4(m->get_bounding_volume()->maxCoords, 1.0);
+            // objectData.minCoord     =  Vec4(m->get_bounding_volume()->minCoords, 1.0);
+            return objectData;
+        };
+
+        // Strand meshes drawing the same geometries with the same materials are grouped into instanced batches
+        std::map<std::vector<const void*>, uint32_t> batchKeys;
+        std::vector<std::vector<uint32_t>>           batchMeshes; // Scene indices of the members
+        currentFrame->instanceBatches.clear();
+        currentFrame->meshBatches.assign(scene->get_meshes().size(), NO_INSTANCE_BATCH);
+        currentFrame->strandDraws.clear();
+        currentFrame->strandsCulled = false;
+
+        Graphics::UniformStats& stats    = currentFrame->uniformStats;
+        Core::Camera* const     camera   = scene->get_active_camera();
+        unsigned int            mesh_idx = 0;
         for (Core::Mesh* m : scene->get_meshes())
         {
             if (m) // If mesh exists
             {
-                if (m->is_active() &&                                                                     // Check if is active
-                    m->get_num_geometries() > 0 &&                                                        // Check if has geometry
-                    m->get_bounding_volume()->is_on_frustrum(scene->get_active_camera()->get_frustrum())) // Check if is inside frustrum
+                const bool inFrustum = camera->get_frustrum_culling() && m->get_bounding_volume()
+                                           ? m->get_bounding_volume()->is_on_frustrum(camera->get_frustrum())
+                                           : true;
+                if (m->is_active() &&              // Check if is active
+                    m->get_num_geometries() > 0 && // Check if has geometry
+                    (inFrustum || m->cast_shadows())) // Check if is inside frustrum. Shadow casters are needed anyway
                 {
+                    // Only the first ENGINE_MAX_OBJECTS meshes get a uniform slot. The rest can only be drawn instanced
+                    const bool hasSlot = mesh_idx < ENGINE_MAX_OBJECTS;
+
                     // Offset calculation
                     uint32_t objectOffset = currentFrame->uniformBuffers[OBJECT_LAYOUT].strideSize * mesh_idx;
 
-                    Graphics::ObjectUniforms objectData;
-                    objectData.model        = m->get_model_matrix();
-                    objectData.otherParams1 = {m->affected_by_fog(), m->receive_shadows(), m->cast_shadows(), false};
-                    objectData.otherParams2 = {m->is_selected(), m->get_bounding_volume()->center};
-                    objectData.maxCoord     = objectData.model * Vec4(m->get_bounding_volume()->maxCoords, 1.0);
-                    objectData.minCoord     = objectData.model * Vec4(m->get_bounding_volume()->minCoords, 1.0);
-                    // objectData.maxCoord     =  Vec4(m->get_bounding_volume()->maxCoords, 1.0);
-                    // objectData.minCoord     =  Vec4(m->get_bounding_volume()->minCoords, 1.0);
-                    currentFrame->uniformBuffers[OBJECT_LAYOUT].upload_data(&objectData, sizeof(Graphics::ObjectUniforms), objectOffset);
+                    // Slots are only rewritten if the mesh changed since this frame last wrote them
+                    const uint32_t revision   = m->get_revision();
+                    const uint32_t hairVolume = currentFrame->hairVolumes[mesh_idx];
+                    if (hasSlot)
+                    {
+                        Graphics::UniformSlot& slot = currentFrame->objectSlots[mesh_idx];
+                        if (slot.object != m || slot.revision != revision || slot.hairVolume != hairVolume)
+                        {
+                            Graphics::ObjectUniforms objectData = get_object_uniforms(m, hairVolume);
+                            currentFrame->uniformBuffers[OBJECT_LAYOUT].upload_data(&objectData, sizeof(Graphics::ObjectUniforms), objectOffset);
+
+                            slot.object     = m;
+                            slot.revision   = revision;
+                            slot.hairVolume = hairVolume;
+                            stats.bytesWritten += sizeof(Graphics::ObjectUniforms);
+                            stats.objectsWritten++;
+                        } else
+                            stats.slotsSkipped++;
+                    }
 
+                    Core::IMaterial*         slotMaterial = nullptr;
+                    std::vector<const void*> batchKey;
+                    bool                     strands      = false;
+                    bool                     onlyStrands  = true;
                     for (size_t i = 0; i < m->get_num_geometries(); i++)
                     {
+                        Core::Geometry*  g   = m->get_geometry(i);
+                        Core::IMaterial* mat = m->get_material(g->get_material_ID());
+                        if (!mat)
+                            mat = Core::IMaterial::DEBUG_MATERIAL;
+
                         // Object vertex buffer setup
-                        Core::Geometry* g = m->get_geometry(i);
-                        upload_geometry_data(device, g, enableRT && m->ray_hittable());
+                        upload_geometry_data(device, g, enableRT && m->ray_hittable(), mat ? mat->get_vertex_layout() : CANONICAL_VERTEX_LAYOUT);
                         // Add BLASS to instances list
                         if (enableRT && m->ray_hittable() && get_BLAS(g)->handle)
                             BLASInstances.push_back({*get_BLAS(g), m->get_model_matrix()});
 
                         // Object material setup
-                        Core::IMaterial* mat = m->get_material(g->get_material_ID());
-                        if (!mat)
-                            mat = Core::IMaterial::DEBUG_MATERIAL;
                         if (mat)
                         {
                             auto textures = mat->get_textures();
@@ -285,17 +424,180 @@ void ResourceManager::update_object_data(Graphics::Device* const device,
                             }
                         }
 
-                        // ObjectUniforms materialData;
-                        Graphics::MaterialUniforms materialData = mat->get_uniforms();
-                        currentFrame->uniformBuffers[OBJECT_LAYOUT].upload_data(
-                            &materialData,
-                            sizeof(Graphics::MaterialUniforms),
-                            objectOffset + device->pad_uniform_buffer_size(sizeof(Graphics::MaterialUniforms)));
+                        const bool strandGeometry = get_VAO(g)->layout == STRAND_VERTEX_LAYOUT;
+                        strands |= strandGeometry;
+                        onlyStrands &= strandGeometry;
+                        batchKey.push_back(g);
+                        batchKey.push_back(mat);
+
+                        slotMaterial = mat;
+                    }
+                    // All geometries share the material slot, the last one wins
+                    if (slotMaterial && hasSlot)
+                    {
+                        Graphics::UniformSlot& slot             = currentFrame->objectSlots[mesh_idx];
+                        const uint32_t         materialRevision = slotMaterial->reconcile();
+                        if (slot.material != slotMaterial || slot.materialRevision != materialRevision)
+                        {
+                            Graphics::MaterialUniforms materialData = slotMaterial->get_uniforms();
+                            currentFrame->uniformBuffers[OBJECT_LAYOUT].upload_data(
+                                &materialData,
+                                sizeof(Graphics::MaterialUniforms),
+                                objectOffset + device->pad_uniform_buffer_size(sizeof(Graphics::ObjectUniforms)));
+
+                            slot.material         = slotMaterial;
+                            slot.materialRevision = materialRevision;
+                            stats.bytesWritten += sizeof(Graphics::MaterialUniforms);
+                            stats.materialsWritten++;
+                        } else
+                            stats.slotsSkipped++;
+                    }
+
+                    // Strand geometry reads its object data from the table. Meshes mixing layouts are never grouped
+                    if (strands)
+                    {
+                        if (!onlyStrands)
+                            batchKey = {m};
+                        auto it = batchKeys.find(batchKey);
+                        if (it == batchKeys.end())
+                        {
+                            // The first mesh of a group binds its slot for the material, so it needs one
+                            if (hasSlot)
+                            {
+                                it = batchKeys.emplace(std::move(batchKey), static_cast<uint32_t>(batchMeshes.size())).first;
+                                currentFrame->instanceBatches.push_back({mesh_idx, 0, 0});
+                                batchMeshes.emplace_back();
+                            }
+                        }
+                        if (it != batchKeys.end())
+                        {
+                            batchMeshes[it->second].push_back(mesh_idx);
+                            currentFrame->meshBatches[mesh_idx] = it->second;
+
+                            // The whole group is drawn at the detail its closest visible member needs
+                            if (inFrustum)
+                            {
+                                const Core::BV* volume   = m->get_bounding_volume();
+                                const float     coverage = volume && volume->TYPE == VolumeType::SPHERE_VOLUME
+                                                               ? static_cast<const Core::BoundingSphere*>(volume)->get_screen_coverage(
+                                                                     camera->get_position(), camera->get_field_of_view())
+                                                               : INFINITY;
+                                Graphics::InstanceBatch& batch = currentFrame->instanceBatches[it->second];
+                                batch.screenCoverage           = std::max(batch.screenCoverage, coverage);
+                                batch.inFrustum                = true;
+                            }
+                        }
                     }
                 }
             }
             mesh_idx++;
         }
+
+        // Object table. Written in batch order so every batch reads a contiguous range
+        size_t instanceCount = 0;
+        for (const std::vector<uint32_t>& group : batchMeshes)
+            instanceCount += group.size();
+        if (instanceCount > 0)
+        {
+            Graphics::Buffer& table     = currentFrame->objectTable;
+            const size_t      tableSize = instanceCount * sizeof(Graphics::ObjectUniforms);
+            if (table.size < tableSize)
+            {
+                // The frame fence has already been waited, so the old table is no longer in use
+                size_t capacity = std::max(static_cast<size_t>(table.size), ENGINE_MAX_OBJECTS * sizeof(Graphics::ObjectUniforms));
+                while (capacity < tableSize)
+                    capacity *= 2;
+                table.cleanup();
+                table = device->create_buffer_VMA(capacity,
+                                                  BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_SHADER_DEVICE_ADDRESS,
+                                                  VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                                  sizeof(Graphics::ObjectUniforms),
+                                                  true);
+            }
+
+            uint32_t instance = 0;
+            for (size_t i = 0; i < batchMeshes.size(); i++)
+            {
+                currentFrame->instanceBatches[i].firstInstance = instance;
+                currentFrame->instanceBatches[i].instanceCount = static_cast<uint32_t>(batchMeshes[i].size());
+                for (uint32_t meshIdx : batchMeshes[i])
+                {
+                    Graphics::ObjectUniforms objectData = get_object_uniforms(scene->get_meshes()[meshIdx], currentFrame->hairVolumes[meshIdx]);
+                    table.upload_data(&objectData, sizeof(Graphics::ObjectUniforms), instance * sizeof(Graphics::ObjectUniforms));
+                    instance++;
+                }
+            }
+            stats.bytesWritten += tableSize;
+        }
+
+        // Strand draw lists. Levels of detail are chosen here so the culling pass compacts the clusters that get drawn
+        const bool cullStrands  = device->supports_indirect_count();
+        uint32_t   outputCount  = 0;
+        uint32_t   commandCount = 0;
+        for (Graphics::InstanceBatch& batch : currentFrame->instanceBatches)
+        {
+            Core::Mesh* m   = scene->get_meshes()[batch.meshIndex];
+            batch.firstDraw = static_cast<uint32_t>(currentFrame->strandDraws.size());
+            for (size_t i = 0; i < m->get_num_geometries(); i++)
+            {
+                Core::Geometry*          g    = m->get_geometry(i);
+                Graphics::StrandDrawList draw = {};
+                if (get_VAO(g)->layout == STRAND_VERTEX_LAYOUT)
+                {
+                    const StrandLODSelection lod = g->select_strand_LOD(batch.screenCoverage * window->get_extent().height);
+                    if (batch.inFrustum)
+                        g->set_strand_LOD_stats(lod);
+                    draw.level      = lod.level;
+                    draw.firstIndex = lod.firstIndex;
+                    draw.indexCount = lod.indexCount;
+                    draw.widthScale = lod.widthScale;
+
+                    const std::vector<StrandLOD>& lods = g->get_properties().strandLODs;
+                    if (cullStrands && get_VAO(g)->clusterCount > 0 && lod.indexCount > 0)
+                    {
+                        draw.capacity[Graphics::STRAND_CAMERA_VIEW] = batch.inFrustum ? lods[lod.level].clusterCount * batch.instanceCount : 0;
+                        draw.capacity[Graphics::STRAND_SHADOW_VIEW] = lods[0].clusterCount * batch.instanceCount;
+                    }
+                }
+                draw.firstOutput = outputCount;
+                for (uint32_t view = 0; view < Graphics::STRAND_VIEW_COUNT; view++)
+                {
+                    draw.firstCommand[view] = commandCount;
+                    commandCount += draw.capacity[view];
+                }
+                outputCount += Graphics::STRAND_VIEW_COUNT;
+                currentFrame->strandDraws.push_back(draw);
+            }
+        }
+        if (commandCount > 0)
+        {
+            // The frame fence has already been waited, so the old buffers are no longer in use
+            Graphics::Buffer& commands = currentFrame->strandCommands;
+            if (commands.size < commandCount * sizeof(VkDrawIndexedIndirectCommand))
+            {
+                size_t capacity = std::max(static_cast<size_t>(commands.size), 1024 * sizeof(VkDrawIndexedIndirectCommand));
+                while (capacity < commandCount * sizeof(VkDrawIndexedIndirectCommand))
+                    capacity *= 2;
+                commands.cleanup();
+                commands = device->create_buffer_VMA(capacity,
+                                                     BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_INDIRECT_BUFFER | BUFFER_USAGE_SHADER_DEVICE_ADDRESS,
+                                                     VMA_MEMORY_USAGE_GPU_ONLY,
+                                                     sizeof(VkDrawIndexedIndirectCommand));
+            }
+            Graphics::Buffer& counts = currentFrame->strandCounts;
+            if (counts.size < outputCount * sizeof(math::uvec4))
+            {
+                size_t capacity = std::max(static_cast<size_t>(counts.size), 64 * sizeof(math::uvec4));
+                while (capacity < outputCount * sizeof(math::uvec4))
+                    capacity *= 2;
+                counts.cleanup();
+                counts = device->create_buffer_VMA(capacity,
+                                                   BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_INDIRECT_BUFFER | BUFFER_USAGE_SHADER_DEVICE_ADDRESS |
+                                                       BUFFER_USAGE_TRANSFER_DST,
+                                                   VMA_MEMORY_USAGE_GPU_ONLY,
+                                                   sizeof(math::uvec4));
+            }
+        }
         // CREATE TOP LEVEL (STATIC) ACCELERATION STRUCTURE
         if (enableRT)
         {
@@ -330,6 +632,21 @@ void ResourceManager::upload_texture_data(Graphics::Device* const device, Core::
             samplerConfig.samplerAddressMode      = textSettings.adressMode;
             samplerConfig.border                  = BorderColor::FLOAT_OPAQUE_BLACK;
 
+            // Cooked textures bring their whole chain
+            if (const std::shared_ptr<Graphics::MipChain>& chain = t->get_mip_chain())
+            {
+                const uint32_t levelCount = textSettings.useMipmaps ? static_cast<uint32_t>(chain->levels.size()) : 1;
+                if (device->upload_texture_image(*get_image(t), config, samplerConfig, *chain, levelCount))
+                    return;
+                // Compressed format not supported by the GPU
+                Graphics::MipChain texels;
+                if (Tools::TextureCache::decompress(*chain, config.format, texels) &&
+                    device->upload_texture_image(*get_image(t), config, samplerConfig, texels, levelCount))
+                    return;
+                LOG_WARN("Could not upload cooked texture, format not supported");
+                return;
+            }
+
             void* imgCache{nullptr};
             t->get_image_cache(imgCache);
             device->upload_texture_image(*get_image(t), config, samplerConfig, imgCache, t->get_bytes_per_pixel(), t->get_settings().useMipmaps);
@@ -341,31 +658,66 @@ void ResourceManager::destroy_texture_data(Core::ITexture* const t) {
     if (t)
         get_image(t)->cleanup();
 }
-void ResourceManager::upload_geometry_data(Graphics::Device* const device, Core::Geometry* const g, bool createAccelStructure) {
+void ResourceManager::upload_geometry_data(Graphics::Device* const device, Core::Geometry* const g, bool createAccelStructure, VertexLayoutType layout) {
     PROFILING_EVENT()
     /*
     VERTEX ARRAYS
     */
     Graphics::VertexArrays* rd = get_VAO(g);
     if (!rd->loadedOnGPU)
+        rd->revision++;
+    if (!rd->loadedOnGPU && layout == STRAND_VERTEX_LAYOUT)
     {
-        const Core::GeometricData gd        = g->get_properties();
-        size_t                    vboSize   = sizeof(gd.vertexData[0]) * gd.vertexData.size();
-        size_t                    iboSize   = sizeof(gd.vertexIndex[0]) * gd.vertexIndex.size();
-        size_t                    voxelSize = sizeof(gd.voxelData[0]) * gd.voxelData.size();
-        rd->indexCount                      = gd.vertexIndex.size();
-        rd->vertexCount                     = gd.vertexData.size();
-        rd->voxelCount                      = gd.voxelData.size();
-
-        std::vector<Vec4> positions;
-        positions.reserve(gd.vertexData.size());
-
-        for (const auto& v : gd.vertexData)
-            positions.push_back(Vec4(v.pos, 1.0));
-        size_t positionsSize = sizeof(Vec4) * positions.size();
+        if (!g->get_properties().quantized())
+            g->quantize_strands();
+        if (!g->has_strand_LODs() && !g->get_properties().view)
+            g->build_strand_LODs();
+
+        const Core::GeometricData& gd = g->get_properties();
+        rd->layout                    = STRAND_VERTEX_LAYOUT;
+        rd->indexCount                = gd.index_count();
+        rd->vertexCount               = gd.vertex_count();
+        rd->voxelCount                = gd.voxelData.size();
+        rd->strandCount               = gd.strand_count();
+        rd->strandTopology            = gd.strandTopology;
+        rd->strandUniforms.minCoord   = Vec4(gd.minCoords, 0.0f);
+        rd->strandUniforms.extent     = Vec4(gd.maxCoords - gd.minCoords, 0.0f);
+
+        // No positions SSBO, shaders read the quantized positions straight from the VBO
+        device->upload_vertex_arrays(*rd,
+                                     sizeof(Graphics::StrandVertex) * gd.vertex_count(),
+                                     gd.strand_vertex_data(),
+                                     sizeof(uint32_t) * gd.index_count(),
+                                     gd.index_data(),
+                                     0,
+                                     nullptr,
+                                     sizeof(Graphics::Voxel) * gd.voxelData.size(),
+                                     gd.voxelData.data(),
+                                     sizeof(Graphics::StrandData) * gd.strand_count(),
+                                     gd.strand_data());
+        device->upload_strand_LODs(*rd,
+                                   sizeof(uint32_t) * gd.lod_index_count(),
+                                   gd.lod_index_data(),
+                                   sizeof(Graphics::StrandCluster) * gd.strandClusters.size(),
+                                   gd.strandClusters.data());
+    }
+    if (!rd->loadedOnGPU)
+    {
+        const Core::GeometricData& gd        = g->get_properties();
+        size_t                     vboSize   = sizeof(Graphics::Vertex) * gd.vertex_count();
+        size_t                     iboSize   = sizeof(uint32_t) * gd.index_count();
+        size_t                     voxelSize = sizeof(Graphics::Voxel) * gd.voxelData.size();
+        rd->indexCount                       = gd.index_count();
+        rd->vertexCount                      = gd.vertex_count();
+        rd->voxelCount                       = gd.voxelData.size();
+
+        // Cached geometry already carries the positions stream, copy it straight from the mapped file. Otherwise the
+        // device derives it from the VBO on the GPU
+        const Vec4* positionsData = gd.view ? gd.view->positions : nullptr;
+        size_t      positionsSize = sizeof(Vec4) * gd.vertex_count();
 
         device->upload_vertex_arrays(
-            *rd, vboSize, gd.vertexData.data(), iboSize, gd.vertexIndex.data(), positionsSize, positions.data(), voxelSize, gd.voxelData.data());
+            *rd, vboSize, gd.vertex_data(), iboSize, gd.index_data(), positionsSize, positionsData, voxelSize, gd.voxelData.data());
     }
     /*
     ACCELERATION STRUCTURE
@@ -376,24 +728,42 @@ void ResourceManager::upload_geometry_data(Graphics::Device* const device, Core:
         if (!accel->handle)
             device->upload_BLAS(*accel, *get_VAO(g));
     }
+    // Everything the GPU needs has been staged by now
+    if (g->release_CPU_data())
+        g->release_CPU_streams();
 }
 void ResourceManager::destroy_geometry_data(Core::Geometry* const g) {
     Graphics::VertexArrays* rd = get_VAO(g);
     if (rd->loadedOnGPU)
     {
         rd->vbo.cleanup();
-        if (rd->indexCount > 0){
+        if (rd->indexCount > 0)
             rd->ibo.cleanup();
-            rd->indexSSBO.cleanup();
-        }
         if (rd->voxelCount > 0)
             rd->voxelBuffer.cleanup();
+        if (rd->strandCount > 0)
+            rd->strandSSBO.cleanup();
+        if (rd->lodIndexCount > 0)
+            rd->lodIbo.cleanup();
+        if (rd->clusterCount > 0)
+            rd->clusterSSBO.cleanup();
         rd->posSSBO.cleanup();
 
         rd->loadedOnGPU = false;
         get_BLAS(g)->cleanup();
     }
 }
+// Uploads the six faces of a cached cubemap, sampled like the auxiliar passes attachments
+static void upload_cached_cubemap(Graphics::Device* const device, Graphics::Image& img, uint32_t resolution, ColorFormatType format, const void* data) {
+    Graphics::ImageConfig   config        = {};
+    Graphics::SamplerConfig samplerConfig = {};
+    config.format                         = format;
+    config.viewType                       = TEXTURE_CUBE;
+    samplerConfig.filters                 = FILTER_LINEAR;
+    samplerConfig.samplerAddressMode      = ADDRESS_MODE_CLAMP_TO_BORDER;
+    img.extent                            = {resolution, resolution, 1};
+    device->upload_texture_image(img, config, samplerConfig, data, Graphics::Utils::get_block_size(format), false);
+}
 void ResourceManager::setup_skybox(Graphics::Device* const device, Core::Scene* const scene) {
     Core::Skybox* const skybox = scene->get_skybox();
     if (skybox)
@@ -404,6 +774,53 @@ void ResourceManager::setup_skybox(Graphics::Device* const device, Core::Scene*
             Core::TextureHDR* envMap = skybox->get_enviroment_map();
             if (envMap && envMap->loaded_on_CPU())
             {
+                // Drop the maps of the previous enviroment
+                if (panoramaConverterPass)
+                { // If already exists
+                    panoramaConverterPass->cleanup();
+                    irradianceComputePass->cleanup();
+                    panoramaConverterPass->clean_framebuffer();
+                    irradianceComputePass->clean_framebuffer();
+                    delete panoramaConverterPass;
+                    delete irradianceComputePass;
+                    panoramaConverterPass = nullptr;
+                    irradianceComputePass = nullptr;
+                }
+                if (CACHED_ENV_CUBEMAP.handle)
+                {
+                    device->wait();
+                    CACHED_ENV_CUBEMAP.cleanup();
+                    CACHED_IRRADIANCE_CUBEMAP.cleanup();
+                    CACHED_ENV_CUBEMAP        = {};
+                    CACHED_IRRADIANCE_CUBEMAP = {};
+                }
+                pendingEnvironmentCache = "";
+
+                // Try the cache first, a hit needs neither the panorama on the GPU nor the auxiliar passes
+                const ColorFormatType format               = envMap->get_settings().format;
+                const uint32_t        envResolution        = envMap->get_size().height;
+                const uint32_t        irradianceResolution = skybox->get_irradiance_resolution();
+                const size_t          texelSize            = Graphics::Utils::get_block_size(format);
+                const std::string     cachePath =
+                    Tools::EnvironmentCache::get_cache_path(envMap->get_file_route(), envResolution, irradianceResolution, format);
+
+                Tools::EnvironmentCache::FileHeader header = {};
+                header.format                              = format;
+                header.envResolution                       = envResolution;
+                header.irradianceResolution                = irradianceResolution;
+                header.envSize                             = uint64_t(envResolution) * envResolution * texelSize * CUBEMAP_FACES;
+                header.irradianceSize                      = uint64_t(irradianceResolution) * irradianceResolution * texelSize * CUBEMAP_FACES;
+
+                Graphics::Utils::MappedFile cacheFile;
+                const uint8_t*              envData        = nullptr;
+                const uint8_t*              irradianceData = nullptr;
+                if (!cachePath.empty() && Tools::EnvironmentCache::read(cachePath, header, cacheFile, envData, irradianceData))
+                {
+                    upload_cached_cubemap(device, CACHED_ENV_CUBEMAP, envResolution, format, envData);
+                    upload_cached_cubemap(device, CACHED_IRRADIANCE_CUBEMAP, irradianceResolution, format, irradianceData);
+                    return;
+                }
+
                 if (!envMap->loaded_on_GPU())
                 {
                     Graphics::ImageConfig   config        = {};
@@ -419,38 +836,71 @@ void ResourceManager::setup_skybox(Graphics::Device* const device, Core::Scene*
                     device->upload_texture_image(*get_image(envMap), config, samplerConfig, imgCache, envMap->get_bytes_per_pixel(), false);
                 }
                 // Create Panorama converter pass
-                if (panoramaConverterPass)
-                { // If already exists
-                    panoramaConverterPass->cleanup();
-                    irradianceComputePass->cleanup();
-                    panoramaConverterPass->clean_framebuffer();
-                    irradianceComputePass->clean_framebuffer();
-                    delete panoramaConverterPass;
-                    delete irradianceComputePass;
-                }
                 panoramaConverterPass =
-                    new Core::PanoramaConverterPass(device, envMap->get_settings().format, {envMap->get_size().height, envMap->get_size().height}, VIGNETTE);
+                    new Core::PanoramaConverterPass(device, format, {envResolution, envResolution}, VIGNETTE);
                 std::vector<Graphics::Frame> empty;
                 panoramaConverterPass->setup(empty);
                 panoramaConverterPass->update_uniforms(0, scene);
                 // Create Irradiance converter pass
-                irradianceComputePass = new Core::IrrandianceComputePass(
-                    device, envMap->get_settings().format, {skybox->get_irradiance_resolution(), skybox->get_irradiance_resolution()});
+                irradianceComputePass =
+                    new Core::IrrandianceComputePass(device, format, {irradianceResolution, irradianceResolution});
                 irradianceComputePass->setup(empty);
                 irradianceComputePass->update_uniforms(0, scene);
                 irradianceComputePass->connect_env_cubemap(panoramaConverterPass->get_framebuffers()[0].attachmentImages[0]);
+
+                pendingEnvironmentCache = cachePath;
             }
+        } else if (!pendingEnvironmentCache.empty() && panoramaConverterPass)
+        {
+            // The maps were rendered by the previous frame. Read them back once and store them
+            device->wait();
+            Core::TextureHDR* envMap    = skybox->get_enviroment_map();
+            const size_t      texelSize = Graphics::Utils::get_block_size(envMap->get_settings().format);
+            Graphics::Image   envImg    = panoramaConverterPass->get_framebuffers()[0].attachmentImages[0];
+            Graphics::Image   irrImg    = irradianceComputePass->get_framebuffers()[0].attachmentImages[0];
+
+            std::vector<uint8_t> envData, irradianceData;
+            device->download_image(envImg, texelSize, envData);
+            device->download_image(irrImg, texelSize, irradianceData);
+
+            Tools::EnvironmentCache::FileHeader header = {};
+            header.format                              = envMap->get_settings().format;
+            header.envResolution                       = envImg.extent.width;
+            header.irradianceResolution                = irrImg.extent.width;
+            header.envSize                             = envData.size();
+            header.irradianceSize                      = irradianceData.size();
+            if (!Tools::EnvironmentCache::write(pendingEnvironmentCache, header, envData.data(), irradianceData.data()))
+                LOG_WARN("Could not write environment cache " + pendingEnvironmentCache);
+            pendingEnvironmentCache = "";
         }
     }
 }
 void ResourceManager::generate_skybox_maps(Graphics::Frame* const currentFrame, Core::Scene* const scene) {
     if (scene->get_skybox()->update_enviroment())
     {
-        panoramaConverterPass->render(*currentFrame, scene);
-        irradianceComputePass->render(*currentFrame, scene);
+        // Nothing to render on a cache hit
+        if (panoramaConverterPass)
+        {
+            panoramaConverterPass->render(*currentFrame, scene);
+            irradianceComputePass->render(*currentFrame, scene);
+        }
         scene->get_skybox()->set_update_enviroment(false);
     }
 }
+Graphics::Image ResourceManager::get_env_cubemap() {
+    if (CACHED_ENV_CUBEMAP.handle)
+        return CACHED_ENV_CUBEMAP;
+    if (panoramaConverterPass)
+        return panoramaConverterPass->get_framebuffers()[0].attachmentImages[0];
+    return *get_image(FALLBACK_CUBEMAP);
+}
+Graphics::Image ResourceManager::get_irradiance_cubemap() {
+    if (CACHED_IRRADIANCE_CUBEMAP.handle)
+        return CACHED_IRRADIANCE_CUBEMAP;
+    if (irradianceComputePass)
+        return irradianceComputePass->get_framebuffers()[0].attachmentImages[0];
+    return *get_image(FALLBACK_CUBEMAP);
+}
 void ResourceManager::clean_scene(Core::Scene* const scene) {
     if (scene)
     {
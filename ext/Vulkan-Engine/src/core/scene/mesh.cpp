@@ -52,6 +52,18 @@ bool BoundingSphere::is_on_frustrum(const Frustum& frustum) const
             frustum.farFace.get_signed_distance(globalCenter) >= -globalRadius && frustum.nearFace.get_signed_distance(globalCenter) >= -globalRadius &&
             frustum.topFace.get_signed_distance(globalCenter) >= -globalRadius && frustum.bottomFace.get_signed_distance(globalCenter) >= -globalRadius);
 }
+float BoundingSphere::get_screen_coverage(const Vec3& eye, float fieldOfView) const {
+    const Vec3 globalScale = obj->get_scale();
+
+    const Vec3 globalCenter{obj->get_model_matrix() * Vec4(center, 1.f)};
+
+    const float maxScale     = std::max(std::max(globalScale.x, globalScale.y), globalScale.z);
+    const float globalRadius = radius * maxScale;
+    const float distance     = math::length(globalCenter - eye);
+    if (distance <= globalRadius)
+        return INFINITY;
+    return globalRadius / (distance * tanf(math::radians(fieldOfView) * 0.5f));
+}
 void AABB::setup(Mesh* const mesh) {
 }
 bool AABB::is_on_frustrum(const Frustum& frustum) const {
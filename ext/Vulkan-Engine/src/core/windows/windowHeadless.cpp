@@ -0,0 +1,14 @@
+#include <engine/core/windows/windowHeadless.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+namespace Core {
+void WindowHeadless::init() {
+    m_startTime   = std::chrono::high_resolution_clock::now();
+    m_initialized = true;
+}
+
+double WindowHeadless::get_time_elapsed() {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_startTime).count();
+}
+} // namespace Core
+VULKAN_ENGINE_NAMESPACE_END
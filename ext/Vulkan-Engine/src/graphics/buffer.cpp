@@ -8,6 +8,13 @@ void Buffer::upload_data(const void* bufferData, size_t size) {
     PROFILING_EVENT()
     if (!bufferData)
         return;
+    if (mappedData)
+    {
+        memcpy(mappedData, bufferData, size);
+        // No-op on host coherent memory
+        VK_CHECK(vmaFlushAllocation(allocator, allocation, 0, size));
+        return;
+    }
     if (allocation)
     {
         void* data;
@@ -38,6 +45,12 @@ void Buffer::upload_data(const void* bufferData, size_t size, size_t offset) {
     PROFILING_EVENT()
     if (!bufferData)
         return;
+    if (mappedData)
+    {
+        memcpy(static_cast<char*>(mappedData) + offset, bufferData, size);
+        VK_CHECK(vmaFlushAllocation(allocator, allocation, offset, size));
+        return;
+    }
     if (allocation)
     {
         char* data;
@@ -76,6 +89,7 @@ void Buffer::cleanup() {
     {
         vmaDestroyBuffer(allocator, handle, allocation);
         allocation = VK_NULL_HANDLE;
+        mappedData = nullptr;
     }
     if (memory)
     {
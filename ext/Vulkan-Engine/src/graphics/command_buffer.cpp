@@ -72,7 +72,7 @@ void CommandBuffer::reset() {
     isRecording = false;
 }
 
-void CommandBuffer::submit(Fence fence, std::vector<Semaphore> waitSemaphores, std::vector<Semaphore> signalSemaphores) {
+void CommandBuffer::submit(Fence fence, std::vector<Semaphore> waitSemaphores, std::vector<Semaphore> signalSemaphores, TimelineWait timelineWait) {
 
     std::vector<VkSemaphore> signalSemaphoreHandles;
     signalSemaphoreHandles.resize(signalSemaphores.size());
@@ -89,13 +89,27 @@ void CommandBuffer::submit(Fence fence, std::vector<Semaphore> waitSemaphores, s
 
     VkSubmitInfo submitInfo = Init::submit_info(&handle);
 
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    std::vector<VkPipelineStageFlags> waitStages(waitSemaphoreHandles.size(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    // Binary semaphores ignore their value
+    std::vector<uint64_t>         waitValues(waitSemaphoreHandles.size(), 0);
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    if (timelineWait.handle)
+    {
+        waitSemaphoreHandles.push_back(timelineWait.handle);
+        waitStages.push_back(timelineWait.stages);
+        waitValues.push_back(timelineWait.value);
+
+        timelineInfo.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+        timelineInfo.pWaitSemaphoreValues    = waitValues.data();
+        submitInfo.pNext                     = &timelineInfo;
+    }
 
     if (!waitSemaphoreHandles.empty())
     {
         submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphoreHandles.size());
         submitInfo.pWaitSemaphores    = waitSemaphoreHandles.data();
-        submitInfo.pWaitDstStageMask  = waitStages;
+        submitInfo.pWaitDstStageMask  = waitStages.data();
     }
 
     if (!signalSemaphoreHandles.empty())
@@ -153,6 +167,54 @@ void CommandBuffer::draw_geometry(VertexArrays& vao, uint32_t instanceCount, uin
         vkCmdDraw(handle, vao.vertexCount, instanceCount, firstOcurrence, firstInstance);
     }
 }
+void CommandBuffer::draw_geometry_LOD(VertexArrays& vao, uint32_t level, uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance) {
+    Buffer& indexBuffer = level > 0 ? vao.lodIbo : vao.ibo;
+    if (!vao.loadedOnGPU || !indexBuffer.handle || indexCount == 0)
+        return;
+    PROFILING_EVENT()
+
+    VkBuffer     vertexBuffers[] = {vao.vbo.handle};
+    VkDeviceSize offsets[]       = {0};
+    vkCmdBindVertexBuffers(handle, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(handle, indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexed(handle, indexCount, instanceCount, firstIndex, 0, firstInstance);
+}
+void CommandBuffer::draw_geometry_indirect(VertexArrays& vao,
+                                           uint32_t      level,
+                                           Buffer&       commands,
+                                           size_t        offset,
+                                           Buffer&       counts,
+                                           size_t        countOffset,
+                                           uint32_t      maxDrawCount) {
+    Buffer& indexBuffer = level > 0 ? vao.lodIbo : vao.ibo;
+    if (!vao.loadedOnGPU || !indexBuffer.handle || !vkCmdDrawIndexedIndirectCountFn || maxDrawCount == 0)
+        return;
+    PROFILING_EVENT()
+
+    VkBuffer     vertexBuffers[] = {vao.vbo.handle};
+    VkDeviceSize offsets[]       = {0};
+    vkCmdBindVertexBuffers(handle, 0, 1, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(handle, indexBuffer.handle, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexedIndirectCountFn(
+        handle, commands.handle, offset, counts.handle, countOffset, maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+}
+void CommandBuffer::draw_strand_segments(uint32_t firstSegment, uint32_t segmentCount, uint32_t instanceCount, uint32_t firstInstance) {
+    if (segmentCount == 0)
+        return;
+    PROFILING_EVENT()
+    // The last segment skips its bridge to the next one
+    vkCmdDraw(handle,
+              segmentCount * STRAND_PULLED_SEGMENT_VERTICES - 2,
+              instanceCount,
+              firstSegment * STRAND_PULLED_SEGMENT_VERTICES,
+              firstInstance);
+}
+void CommandBuffer::draw_strand_segments_indirect(Buffer& commands, size_t offset, Buffer& counts, size_t countOffset, uint32_t maxDrawCount) {
+    if (!vkCmdDrawIndirectCountFn || maxDrawCount == 0)
+        return;
+    PROFILING_EVENT()
+    vkCmdDrawIndirectCountFn(handle, commands.handle, offset, counts.handle, countOffset, maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+}
 void CommandBuffer::draw_gui_data() {
     if (ImGui::GetDrawData())
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), handle);
@@ -200,6 +262,11 @@ void CommandBuffer::set_depth_bias_enable(bool op) {
 void CommandBuffer::set_depth_bias(float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor) {
     vkCmdSetDepthBias(handle, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
 }
+void CommandBuffer::set_strand_topology(StrandTopology topology) {
+    const bool strips = topology == STRAND_LINE_STRIP;
+    vkCmdSetPrimitiveTopology(handle, strips ? VK_PRIMITIVE_TOPOLOGY_LINE_STRIP : VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+    vkCmdSetPrimitiveRestartEnable(handle, strips);
+}
 } // namespace Graphics
 
 void Graphics::CommandBuffer::pipeline_barrier(Image&        img,
@@ -352,6 +419,25 @@ void Graphics::CommandBuffer::push_constants(ShaderPass& pass, ShaderStageFlags
 void Graphics::CommandBuffer::dispatch_compute(Extent3D grid) {
     vkCmdDispatch(handle, grid.width, grid.height, grid.depth);
 }
+void Graphics::CommandBuffer::dispatch_compute_indirect(Buffer& args, size_t offset) {
+    vkCmdDispatchIndirect(handle, args.handle, offset);
+}
+void Graphics::CommandBuffer::fill_buffer(Buffer& buffer, uint32_t value, size_t offset, size_t size) {
+    vkCmdFillBuffer(handle, buffer.handle, offset, size, value);
+}
+void Graphics::CommandBuffer::copy_buffer(Buffer& srcBuffer, Buffer& dstBuffer, size_t size, size_t srcOffset, size_t dstOffset) {
+    VkBufferCopy region = {};
+    region.srcOffset    = srcOffset;
+    region.dstOffset    = dstOffset;
+    region.size         = size;
+    vkCmdCopyBuffer(handle, srcBuffer.handle, dstBuffer.handle, 1, &region);
+}
+void Graphics::CommandBuffer::reset_queries(VkQueryPool pool, uint32_t firstQuery, uint32_t queryCount) {
+    vkCmdResetQueryPool(handle, pool, firstQuery, queryCount);
+}
+void Graphics::CommandBuffer::write_timestamp(VkQueryPool pool, uint32_t query, PipelineStage stage) {
+    vkCmdWriteTimestamp(handle, static_cast<VkPipelineStageFlagBits>(Translator::get(stage)), pool, query);
+}
 
 void Graphics::CommandBuffer::generate_mipmaps(Image& img, ImageLayout initialLayout, ImageLayout finalLayout, FilterType filtering) {
 
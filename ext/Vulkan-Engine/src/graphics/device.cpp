@@ -13,14 +13,18 @@ void Device::init(void*           windowHandle,
 
     // BOOT Vulkan ------>>>
 
+    m_headless = windowingSystem == WindowingSystem::HEADLESS;
+
     // Instance
-    m_instance = Booter::create_instance("xxx", "VulkanDevice", m_enableValidationLayers, m_validationLayers);
+    m_instance = Booter::create_instance("xxx", "VulkanDevice", m_enableValidationLayers, m_validationLayers, m_headless);
     if (m_enableValidationLayers)
         m_debugMessenger = Booter::create_debug_messenger(m_instance);
     // Surface
-    Extent2D actualExtent = m_swapchain.create_surface(m_instance, windowHandle, windowingSystem);
-    // Get gpu
-    m_gpu = Booter::pick_graphics_card_device(m_instance, m_swapchain.get_surface(), m_extensions);
+    Extent2D actualExtent = m_headless ? surfaceExtent : m_swapchain.create_surface(m_instance, windowHandle, windowingSystem);
+    // Get gpu. Headless rendering only needs what the rasterization passes use, so software drivers qualify
+    m_gpu = Booter::pick_graphics_card_device(m_instance,
+                                              m_swapchain.get_surface(),
+                                              m_headless ? std::vector<const char*>{VK_KHR_SWAPCHAIN_EXTENSION_NAME} : m_extensions);
     // Create logical device
     m_handle =
         Booter::create_logical_device(m_queues, m_gpu, Utils::get_gpu_features(m_gpu), m_swapchain.get_surface(), m_enableValidationLayers, m_validationLayers);
@@ -28,9 +32,18 @@ void Device::init(void*           windowHandle,
     m_allocator = Booter::setup_memory(m_instance, m_handle, m_gpu);
 
     // Create swapchain
-    m_swapchain.create(m_gpu, m_handle, actualExtent, surfaceExtent, framesPerFlight, Translator::get(presentFormat), Translator::get(presentMode));
+    if (m_headless)
+        m_swapchain.create_offscreen(m_allocator, m_handle, actualExtent, framesPerFlight, Translator::get(presentFormat));
+    else
+        m_swapchain.create(m_gpu, m_handle, actualExtent, surfaceExtent, framesPerFlight, Translator::get(presentFormat), Translator::get(presentMode));
 
     m_uploadContext.init(m_handle, m_gpu, m_swapchain.get_surface());
+    m_queueFamilies = Utils::find_queue_families(m_gpu, m_swapchain.get_surface());
+    m_uploadQueue.init(m_handle,
+                       m_allocator,
+                       m_queues[QueueType::TRANSFER_QUEUE],
+                       m_queueFamilies.transferFamily.value_or(m_queueFamilies.graphicsFamily.value()),
+                       m_queueFamilies.graphicsFamily.value());
 
     load_extensions(m_handle, m_instance);
 
@@ -38,6 +51,7 @@ void Device::init(void*           windowHandle,
     vkGetPhysicalDeviceProperties(m_gpu, &m_properties);
     vkGetPhysicalDeviceFeatures(m_gpu, &m_features);
     vkGetPhysicalDeviceMemoryProperties(m_gpu, &m_memoryProperties);
+    ShaderCache::init_pipeline_cache(m_handle, m_properties);
     // uint32_t queueFamilyCount;
     // vkGetPhysicalDeviceQueueFamilyProperties(m_gpu, &queueFamilyCount, nullptr);
     // assert(queueFamilyCount > 0);
@@ -48,12 +62,25 @@ void Device::init(void*           windowHandle,
 }
 
 void Device::update_swapchain(Extent2D surfaceExtent, uint32_t framesPerFlight, ColorFormatType presentFormat, SyncType presentMode) {
+    if (m_headless)
+    {
+        m_swapchain.create_offscreen(m_allocator, m_handle, surfaceExtent, framesPerFlight, Translator::get(presentFormat));
+        return;
+    }
     m_swapchain.create(m_gpu, m_handle, surfaceExtent, surfaceExtent, framesPerFlight, Translator::get(presentFormat), Translator::get(presentMode));
 }
 
 void Device::cleanup() {
 
     m_uploadContext.cleanup(m_handle);
+    m_uploadQueue.cleanup();
+    if (m_positionsPass)
+    {
+        m_positionsPass->cleanup();
+        delete m_positionsPass;
+        m_positionsPass = nullptr;
+    }
+    ShaderCache::cleanup_pipeline_cache();
 
     m_swapchain.cleanup();
 
@@ -70,7 +97,7 @@ void Device::cleanup() {
     vkDestroyInstance(m_instance, nullptr);
 }
 
-Buffer Device::create_buffer_VMA(size_t allocSize, BufferUsageFlags usage, VmaMemoryUsage memoryUsage, uint32_t strideSize) {
+Buffer Device::create_buffer_VMA(size_t allocSize, BufferUsageFlags usage, VmaMemoryUsage memoryUsage, uint32_t strideSize, bool persistentlyMapped) {
 
     Buffer buffer = {};
 
@@ -81,13 +108,17 @@ Buffer Device::create_buffer_VMA(size_t allocSize, BufferUsageFlags usage, VmaMe
     bufferInfo.usage                     = Translator::get(usage);
     VmaAllocationCreateInfo vmaallocInfo = {};
     vmaallocInfo.usage                   = memoryUsage;
+    if (persistentlyMapped)
+        vmaallocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
-    VK_CHECK(vmaCreateBuffer(m_allocator, &bufferInfo, &vmaallocInfo, &buffer.handle, &buffer.allocation, nullptr));
+    VmaAllocationInfo allocationInfo = {};
+    VK_CHECK(vmaCreateBuffer(m_allocator, &bufferInfo, &vmaallocInfo, &buffer.handle, &buffer.allocation, &allocationInfo));
 
     buffer.device     = m_handle;
     buffer.allocator  = m_allocator;
     buffer.size       = allocSize;
     buffer.strideSize = strideSize == 0 ? allocSize : strideSize;
+    buffer.mappedData = persistentlyMapped ? allocationInfo.pMappedData : nullptr;
 
     return buffer;
 }
@@ -411,6 +442,23 @@ Frame Device::create_frame(uint16_t id) {
 
     return frame;
 }
+TimestampPool Device::create_timestamp_pool(uint32_t pairCount) {
+    TimestampPool pool = {};
+    if (pairCount == 0 || !m_properties.limits.timestampComputeAndGraphics || m_properties.limits.timestampPeriod <= 0.0f)
+    {
+        LOG_WARN("GPU timestamps are not supported on the graphics queue");
+        return pool;
+    }
+    VkQueryPoolCreateInfo info = {};
+    info.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount            = pairCount * 2;
+    VK_CHECK(vkCreateQueryPool(m_handle, &info, nullptr, &pool.handle));
+    pool.device   = m_handle;
+    pool.capacity = pairCount;
+    pool.period   = m_properties.limits.timestampPeriod;
+    return pool;
+}
 RenderResult Device::wait_frame(Frame& frame, uint32_t& imageIndex) {
 
     frame.renderFence.wait();
@@ -422,21 +470,36 @@ void Device::start_frame(Frame& frame) {
     frame.renderFence.reset();
     frame.commandBuffer.reset();
     frame.commandBuffer.begin();
+    // Submits the uploads issued this frame and takes ownership of them if they ran on the transfer queue
+    m_uploadQueue.record_graphics_work(frame.commandBuffer.handle);
 }
 RenderResult Device::submit_frame(Frame& frame, uint32_t imageIndex) {
 
     frame.commandBuffer.end();
-    frame.commandBuffer.submit(frame.renderFence, {frame.presentSemaphore}, {frame.renderSemaphore});
+    // Nothing signals or waits on the binary semaphores without a presentation engine
+    if (m_headless)
+        frame.commandBuffer.submit(frame.renderFence, {}, {}, m_uploadQueue.get_wait());
+    else
+        frame.commandBuffer.submit(frame.renderFence, {frame.presentSemaphore}, {frame.renderSemaphore}, m_uploadQueue.get_wait());
 
     return present_image(frame.renderSemaphore, imageIndex);
 }
 RenderResult Device::aquire_present_image(Semaphore& waitSemahpore, uint32_t& imageIndex) {
+    if (m_headless)
+    {
+        // Frames in flight are fenced, so the image used frames ago is free to reuse
+        imageIndex       = m_offscreenIndex;
+        m_offscreenIndex = (m_offscreenIndex + 1) % static_cast<uint32_t>(m_swapchain.get_present_images().size());
+        return RenderResult::SUCCESS;
+    }
 
     VkResult result = vkAcquireNextImageKHR(m_handle, m_swapchain.get_handle(), UINT64_MAX, waitSemahpore.handle, VK_NULL_HANDLE, &imageIndex);
     return static_cast<RenderResult>(result);
 }
 
 RenderResult Device::present_image(Semaphore& signalSemaphore, uint32_t imageIndex) {
+    if (m_headless)
+        return RenderResult::SUCCESS;
 
     VkSemaphore      signalSemaphores[] = {signalSemaphore.handle};
     VkPresentInfoKHR presentInfo        = Init::present_info();
@@ -452,6 +515,97 @@ RenderResult Device::present_image(Semaphore& signalSemaphore, uint32_t imageInd
     return static_cast<RenderResult>(result);
 }
 
+void Device::download_present_image(uint32_t imageIndex, std::vector<uint8_t>& pixels) {
+    Image&         img     = m_swapchain.get_present_images()[imageIndex];
+    const Extent3D extent  = img.extent;
+    const size_t   size    = static_cast<size_t>(extent.width) * extent.height * 4; // 8 bit RGBA/BGRA formats only
+    Buffer         staging = create_buffer_VMA(size, BUFFER_USAGE_TRANSFER_DST, VMA_MEMORY_USAGE_GPU_TO_CPU, 0, true);
+
+    m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
+        VkImageMemoryBarrier barrier        = {};
+        barrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask               = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask               = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout                   = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        barrier.newLayout                   = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                       = img.handle;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region           = {};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent                 = extent;
+        vkCmdCopyImageToBuffer(cmd, img.handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging.handle, 1, &region);
+
+        // Back to where the next frame expects it
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+
+    vmaInvalidateAllocation(m_allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+    pixels.resize(size);
+    memcpy(pixels.data(), staging.mappedData, size);
+    staging.cleanup();
+}
+
+void Device::download_image(Image& img, size_t texelSize, std::vector<uint8_t>& data) {
+    const size_t layerSize = static_cast<size_t>(img.extent.width) * img.extent.height * img.extent.depth * texelSize;
+    const size_t size      = layerSize * img.layers;
+    Buffer       staging   = create_buffer_VMA(size, BUFFER_USAGE_TRANSFER_DST, VMA_MEMORY_USAGE_GPU_TO_CPU, 0, true);
+
+    m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
+        VkImageMemoryBarrier barrier        = {};
+        barrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask               = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask               = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout                   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout                   = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                       = img.handle;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = img.mipLevels;
+        barrier.subresourceRange.layerCount = img.layers;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        std::vector<VkBufferImageCopy> regions(img.layers);
+        for (uint32_t layer = 0; layer < img.layers; layer++)
+        {
+            regions[layer]                                 = {};
+            regions[layer].bufferOffset                    = layer * layerSize;
+            regions[layer].imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            regions[layer].imageSubresource.baseArrayLayer = layer;
+            regions[layer].imageSubresource.layerCount     = 1;
+            regions[layer].imageExtent                     = img.extent;
+        }
+        vkCmdCopyImageToBuffer(
+            cmd, img.handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging.handle, static_cast<uint32_t>(regions.size()), regions.data());
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+
+    vmaInvalidateAllocation(m_allocator, staging.allocation, 0, VK_WHOLE_SIZE);
+    data.resize(size);
+    memcpy(data.data(), staging.mappedData, size);
+    staging.cleanup();
+}
+
 void Device::upload_vertex_arrays(VertexArrays& vao,
                                   size_t        vboSize,
                                   const void*   vboData,
@@ -460,109 +614,114 @@ void Device::upload_vertex_arrays(VertexArrays& vao,
                                   size_t        posSize,
                                   const void*   posData,
                                   size_t        voxelSize,
-                                  const void*   voxelData) {
+                                  const void*   voxelData,
+                                  size_t        strandSize,
+                                  const void*   strandData) {
     PROFILING_EVENT()
     // Should be executed only once if geometry data is not changed
 
-    Buffer vboStagingBuffer = create_buffer_VMA(vboSize, BUFFER_USAGE_TRANSFER_SRC, VMA_MEMORY_USAGE_CPU_ONLY);
-    vboStagingBuffer.upload_data(vboData, vboSize);
-
     // GPU vertex buffer
     vao.vbo = create_buffer_VMA(vboSize,
                                 BUFFER_USAGE_VERTEX_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS |
                                     BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY | BUFFER_USAGE_STORAGE_BUFFER,
                                 VMA_MEMORY_USAGE_GPU_ONLY);
-
-    m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
-        VkBufferCopy copy;
-        copy.dstOffset = 0;
-        copy.srcOffset = 0;
-        copy.size      = vboSize;
-        vkCmdCopyBuffer(cmd, vboStagingBuffer.handle, vao.vbo.handle, 1, &copy);
-    });
-
-    vboStagingBuffer.cleanup();
+    m_uploadQueue.upload_buffer(vboData, vboSize, {&vao.vbo});
 
     if (vao.indexCount > 0)
     {
-        // Staging index buffer (CPU only)
-        Buffer iboStagingBuffer = create_buffer_VMA(iboSize, BUFFER_USAGE_TRANSFER_SRC, VMA_MEMORY_USAGE_CPU_ONLY);
-        iboStagingBuffer.upload_data(iboData, iboSize);
-
-        // GPU index buffer
+        // GPU index buffer. Also bound as a storage buffer by the passes reading indices on their own
         vao.ibo = create_buffer_VMA(iboSize,
                                     BUFFER_USAGE_INDEX_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS |
                                         BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY | BUFFER_USAGE_STORAGE_BUFFER,
                                     VMA_MEMORY_USAGE_GPU_ONLY);
-
-        m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
-            VkBufferCopy index_copy;
-            index_copy.dstOffset = 0;
-            index_copy.srcOffset = 0;
-            index_copy.size      = iboSize;
-            vkCmdCopyBuffer(cmd, iboStagingBuffer.handle, vao.ibo.handle, 1, &index_copy);
-        });
-
-        // GPU index buffer
-        vao.indexSSBO =
-            create_buffer_VMA(iboSize, BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS, VMA_MEMORY_USAGE_GPU_ONLY);
-
-        m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
-            VkBufferCopy index_copy;
-            index_copy.dstOffset = 0;
-            index_copy.srcOffset = 0;
-            index_copy.size      = iboSize;
-            vkCmdCopyBuffer(cmd, iboStagingBuffer.handle, vao.indexSSBO.handle, 1, &index_copy);
-        });
-
-        iboStagingBuffer.cleanup();
+        m_uploadQueue.upload_buffer(iboData, iboSize, {&vao.ibo});
     }
-    if (posData)
+    if (posSize > 0)
     {
-
-        // Staging Pos buffer (CPU only)
-        Buffer posStagingBuffer = create_buffer_VMA(posSize, BUFFER_USAGE_TRANSFER_SRC, VMA_MEMORY_USAGE_CPU_ONLY);
-        posStagingBuffer.upload_data(posData, posSize);
-
         // GPU Pos buffer
         vao.posSSBO =
             create_buffer_VMA(posSize, BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS, VMA_MEMORY_USAGE_GPU_ONLY);
-
-        m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
-            VkBufferCopy pos_copy;
-            pos_copy.dstOffset = 0;
-            pos_copy.srcOffset = 0;
-            pos_copy.size      = posSize;
-            vkCmdCopyBuffer(cmd, posStagingBuffer.handle, vao.posSSBO.handle, 1, &pos_copy);
-        });
-
-        posStagingBuffer.cleanup();
+        if (posData)
+            m_uploadQueue.upload_buffer(posData, posSize, {&vao.posSSBO});
+        else
+            derive_positions(vao);
     }
     if (vao.voxelCount > 0)
     {
-        // Staging Voxel buffer (CPU only)
-        Buffer voxelStagingBuffer = create_buffer_VMA(voxelSize, BUFFER_USAGE_TRANSFER_SRC, VMA_MEMORY_USAGE_CPU_ONLY);
-        voxelStagingBuffer.upload_data(voxelData, voxelSize);
-
         // GPU Voxel buffer
         vao.voxelBuffer =
             create_buffer_VMA(voxelSize,
                               BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS | BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY,
                               VMA_MEMORY_USAGE_GPU_ONLY);
-
-        m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) {
-            VkBufferCopy voxel_copy;
-            voxel_copy.dstOffset = 0;
-            voxel_copy.srcOffset = 0;
-            voxel_copy.size      = voxelSize;
-            vkCmdCopyBuffer(cmd, voxelStagingBuffer.handle, vao.voxelBuffer.handle, 1, &voxel_copy);
-        });
-
-        voxelStagingBuffer.cleanup();
+        m_uploadQueue.upload_buffer(voxelData, voxelSize, {&vao.voxelBuffer});
+    }
+    if (vao.strandCount > 0)
+    {
+        // GPU Strand buffer. Accessed through its device address
+        vao.strandSSBO =
+            create_buffer_VMA(strandSize, BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_SHADER_DEVICE_ADDRESS, VMA_MEMORY_USAGE_GPU_ONLY);
+        m_uploadQueue.upload_buffer(strandData, strandSize, {&vao.strandSSBO});
+        vao.strandUniforms.strandBuffer = vao.strandSSBO.get_device_address();
+    }
+    if (vao.layout == STRAND_VERTEX_LAYOUT)
+    {
+        // Vertex pulled strands read both streams as storage buffers
+        vao.strandUniforms.vertexBuffer = vao.vbo.get_device_address();
+        vao.strandUniforms.indexBuffer  = vao.indexCount > 0 ? vao.ibo.get_device_address() : 0;
+        vao.strandUniforms.topology     = vao.strandTopology;
     }
 
     vao.loadedOnGPU = true;
 }
+void Device::upload_strand_LODs(VertexArrays& vao, size_t indexSize, const void* indexData, size_t clusterSize, const void* clusterData) {
+    vao.lodIndexCount = static_cast<uint32_t>(indexSize / sizeof(uint32_t));
+    if (vao.lodIndexCount > 0)
+    {
+        vao.lodIbo = create_buffer_VMA(indexSize,
+                                       BUFFER_USAGE_INDEX_BUFFER | BUFFER_USAGE_TRANSFER_DST | BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_SHADER_DEVICE_ADDRESS,
+                                       VMA_MEMORY_USAGE_GPU_ONLY);
+        m_uploadQueue.upload_buffer(indexData, indexSize, {&vao.lodIbo});
+    }
+    vao.clusterCount = clusterData ? static_cast<uint32_t>(clusterSize / sizeof(StrandCluster)) : 0;
+    if (vao.clusterCount > 0)
+    {
+        vao.clusterSSBO = create_buffer_VMA(clusterSize,
+                                            BUFFER_USAGE_STORAGE_BUFFER | BUFFER_USAGE_SHADER_DEVICE_ADDRESS | BUFFER_USAGE_TRANSFER_DST,
+                                            VMA_MEMORY_USAGE_GPU_ONLY);
+        m_uploadQueue.upload_buffer(clusterData, clusterSize, {&vao.clusterSSBO});
+    }
+}
+void Device::derive_positions(VertexArrays& vao) {
+    if (!m_positionsPass)
+    {
+        m_positionsPass                         = new ComputeShaderPass(m_handle, ENGINE_RESOURCES_PATH "shaders/misc/extract_positions.glsl");
+        m_positionsPass->settings.pushConstants = {PushConstant(SHADER_STAGE_COMPUTE, sizeof(PositionExtraction))};
+        m_positionsPass->build_shader_stages();
+        DescriptorPool noDescriptors = {};
+        m_positionsPass->build(noDescriptors);
+    }
+
+    PositionExtraction extraction = {};
+    extraction.vertices           = vao.vbo.get_device_address();
+    extraction.positions          = vao.posSSBO.get_device_address();
+    extraction.count              = vao.vertexCount;
+    extraction.stride             = sizeof(Vertex) / sizeof(float);
+
+    VkPipeline       pipeline = m_positionsPass->pipeline;
+    VkPipelineLayout layout   = m_positionsPass->pipelineLayout;
+    m_uploadQueue.enqueue_graphics_work([=](VkCommandBuffer cmd) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PositionExtraction), &extraction);
+        vkCmdDispatch(cmd, (extraction.count + 255) / 256, 1, 1);
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    });
+}
 void Device::upload_texture_image(Image& img, ImageConfig config, SamplerConfig samplerConfig, const void* imgCache, size_t bytesPerPixel, bool mipmapping) {
     PROFILING_EVENT()
 
@@ -575,14 +734,7 @@ void Device::upload_texture_image(Image& img, ImageConfig config, SamplerConfig
 
     VkDeviceSize imageSize = img.extent.width * img.extent.height * img.extent.depth * bytesPerPixel;
 
-    Buffer stagingBuffer = create_buffer_VMA(imageSize, BUFFER_USAGE_TRANSFER_SRC, VMA_MEMORY_USAGE_CPU_ONLY);
-    stagingBuffer.upload_data(imgCache, static_cast<size_t>(imageSize));
-
-    m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) { img.upload_image(cmd, &stagingBuffer); });
-
-    stagingBuffer.cleanup();
-
-    // GENERATE MIPMAPS
+    // GENERATE MIPMAPS (recorded by the upload queue)
     if (img.mipLevels > 1)
     {
         VkFormatProperties formatProperties;
@@ -591,10 +743,10 @@ void Device::upload_texture_image(Image& img, ImageConfig config, SamplerConfig
         {
             throw std::runtime_error("texture image format does not support linear blitting!");
         }
-
-        m_uploadContext.immediate_submit(m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) { img.generate_mipmaps(cmd); });
     }
 
+    m_uploadQueue.upload_image(img, imgCache, static_cast<size_t>(imageSize), bytesPerPixel);
+
     // CREATE SAMPLER
     samplerConfig.mipmapMode    = MipmapMode::MIPMAP_LINEAR;
     samplerConfig.maxAnysotropy = m_properties.limits.maxSamplerAnisotropy;
@@ -605,9 +757,50 @@ void Device::upload_texture_image(Image& img, ImageConfig config, SamplerConfig
 
     img.loadedOnGPU = true;
 }
+bool Device::upload_texture_image(Image& img, ImageConfig config, SamplerConfig samplerConfig, const MipChain& chain, uint32_t levelCount) {
+    PROFILING_EVENT()
+    if (chain.levels.empty())
+        return false;
+
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_gpu, Translator::get(config.format), &formatProperties);
+    if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+        return false;
+
+    // CREATE IMAGE
+    levelCount         = std::clamp<uint32_t>(levelCount, 1, static_cast<uint32_t>(chain.levels.size()));
+    config.usageFlags  = IMAGE_USAGE_SAMPLED | IMAGE_USAGE_TRANSFER_DST;
+    config.samples     = 1;
+    config.aspectFlags = ASPECT_COLOR;
+    config.viewType    = TEXTURE_2D;
+    config.mipLevels   = levelCount;
+    img                = create_image(chain.levels[0].extent, config, levelCount > 1);
+    img.create_view(config);
+
+    m_uploadQueue.upload_mip_chain(img, chain, Utils::get_block_size(config.format));
+
+    // CREATE SAMPLER
+    samplerConfig.mipmapMode    = MipmapMode::MIPMAP_LINEAR;
+    samplerConfig.maxAnysotropy = m_properties.limits.maxSamplerAnisotropy;
+    img.create_sampler(samplerConfig);
+
+    if (ImGui::GetCurrentContext())
+        img.create_GUI_handle();
+
+    img.loadedOnGPU = true;
+    return true;
+}
+void Device::upload_image_data(Image& img, const void* data, size_t size, size_t texelSize) {
+    PROFILING_EVENT()
+    m_uploadQueue.upload_image(img, data, size, texelSize);
+    img.currentLayout = LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    img.loadedOnGPU   = true;
+}
 void Device::upload_BLAS(BLAS& accel, VAO& vao) {
     if (!vao.loadedOnGPU)
         return;
+    // The build reads the vertex arrays straight away
+    sync_uploads();
     if (accel.handle && !accel.dynamic)
         accel.cleanup();
 
@@ -837,8 +1030,16 @@ void Device::upload_TLAS(TLAS& accel, std::vector<BLASInstance>& BLASinstances)
     accel.device = m_handle;
 }
 void Device::wait() {
+    sync_uploads();
     VK_CHECK(vkDeviceWaitIdle(m_handle));
 }
+void Device::sync_uploads() {
+    m_uploadQueue.flush();
+    m_uploadQueue.wait_idle();
+    if (m_uploadQueue.has_graphics_work())
+        m_uploadContext.immediate_submit(
+            m_handle, m_queues[QueueType::GRAPHIC_QUEUE], [&](VkCommandBuffer cmd) { m_uploadQueue.record_graphics_work(cmd); });
+}
 
 void Device::wait_queue(QueueType queueType) {
     VK_CHECK(vkQueueWaitIdle(m_queues[queueType]));
@@ -872,6 +1073,18 @@ void Device::destroy_imgui() {
     m_guiPool.cleanup();
 } // namespace Graphics
 
+VkDeviceSize Device::get_device_local_budget() const {
+    std::vector<VmaBudget> budgets(m_memoryProperties.memoryHeapCount);
+    vmaGetHeapBudgets(m_allocator, budgets.data());
+
+    VkDeviceSize available = 0;
+    for (uint32_t i = 0; i < m_memoryProperties.memoryHeapCount; i++)
+    {
+        if ((m_memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) && budgets[i].budget > budgets[i].usage)
+            available = std::max(available, budgets[i].budget - budgets[i].usage);
+    }
+    return available;
+}
 uint32_t Device::get_memory_type(uint32_t typeBits, MemoryPropertyFlags properties, uint32_t* memTypeFound) {
     VkMemoryPropertyFlags vkproperties = Translator::get(properties);
     for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
@@ -9,6 +9,8 @@ PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceA
 PFN_vkCmdBuildAccelerationStructuresKHR        vkCmdBuildAccelerationStructures        = nullptr;
 PFN_vkBuildAccelerationStructuresKHR           vkBuildAccelerationStructures           = nullptr;
 PFN_vkSetDebugUtilsObjectNameEXT               vkSetDebugUtilsObjectName               = nullptr;
+PFN_vkCmdDrawIndexedIndirectCountKHR           vkCmdDrawIndexedIndirectCountFn         = nullptr;
+PFN_vkCmdDrawIndirectCountKHR                  vkCmdDrawIndirectCountFn                = nullptr;
 
 void load_extensions(VkDevice& device, VkInstance& instance) {
 
@@ -76,4 +78,15 @@ void load_extensions(VkDevice& device, VkInstance& instance) {
     {
         LOG_ERROR("Failed to load vkSetDebugUtilsObjectNameEXT!");
     }
+
+    // Optional. GPU driven passes fall back to direct draws without it
+    vkCmdDrawIndexedIndirectCountFn = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+
+    if (!vkCmdDrawIndexedIndirectCountFn)
+    {
+        LOG_WARN("vkCmdDrawIndexedIndirectCountKHR not available, strand culling disabled");
+    }
+    vkCmdDrawIndirectCountFn =
+        reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>(vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR"));
 }
\ No newline at end of file
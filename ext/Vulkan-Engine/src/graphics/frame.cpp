@@ -11,11 +11,39 @@ void Frame::cleanup() {
     {
         buffer.cleanup();
     }
+    objectTable.cleanup();
+    strandCommands.cleanup();
+    strandCounts.cleanup();
     commandPool.cleanup();
     computeCommandPool.cleanup();
     renderFence.cleanup();
     renderSemaphore.cleanup();
     presentSemaphore.cleanup();
+    timestamps.cleanup();
+}
+bool TimestampPool::read(std::vector<double>& milliseconds) const {
+    milliseconds.clear();
+    if (!handle || passes.empty())
+        return false;
+    std::vector<uint64_t> ticks(passes.size() * 2);
+    if (vkGetQueryPoolResults(device,
+                              handle,
+                              0,
+                              static_cast<uint32_t>(ticks.size()),
+                              ticks.size() * sizeof(uint64_t),
+                              ticks.data(),
+                              sizeof(uint64_t),
+                              VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return false;
+    milliseconds.resize(passes.size());
+    for (size_t i = 0; i < passes.size(); i++)
+        milliseconds[i] = ticks[i * 2 + 1] > ticks[i * 2] ? (ticks[i * 2 + 1] - ticks[i * 2]) * period * 1e-6 : 0.0;
+    return true;
+}
+void TimestampPool::cleanup() {
+    if (handle)
+        vkDestroyQueryPool(device, handle, nullptr);
+    handle = VK_NULL_HANDLE;
 }
 
 } // namespace Graphics
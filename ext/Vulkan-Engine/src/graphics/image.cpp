@@ -32,7 +32,7 @@ void Image::create_GUI_handle() {
         GUIReadHandle =
             ImGui_ImplVulkan_AddTexture(sampler, view, VkImageLayout::VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
-void Image::upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer) {
+void Image::upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer, size_t bufferOffset, size_t bufferSize, bool readable) {
 
     VkImageSubresourceRange range;
     range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -65,11 +65,11 @@ void Image::upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer) {
                          &imageBarrier_toTransfer);
 
     // For each layer
+    const size_t layerSize = (bufferSize > 0 ? bufferSize : stagingBuffer->size) / layers;
     for (uint32_t layer = 0; layer < layers; ++layer)
     {
         VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset =
-            layer * ((extent.width * extent.height * stagingBuffer->size) / layers); // Offset per face
+        copyRegion.bufferOffset      = bufferOffset + layer * layerSize; // Offset per face
         copyRegion.bufferRowLength   = 0;
         copyRegion.bufferImageHeight = 0;
 
@@ -83,7 +83,7 @@ void Image::upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer) {
             cmd, stagingBuffer->handle, handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
     }
 
-    if (mipLevels == 1)
+    if (mipLevels == 1 && readable)
     {
         VkImageMemoryBarrier imageBarrier_toReadable = imageBarrier_toTransfer;
 
@@ -106,6 +106,50 @@ void Image::upload_image(VkCommandBuffer& cmd, Buffer* stagingBuffer) {
                              &imageBarrier_toReadable);
     }
 }
+void Image::upload_mip_chain(VkCommandBuffer& cmd, Buffer* stagingBuffer, size_t bufferOffset, const MipChain& chain, bool readable) {
+
+    VkImageMemoryBarrier barrier            = {};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = handle;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = layers;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask                   = 0;
+    barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    std::vector<VkBufferImageCopy> regions(std::min<size_t>(mipLevels, chain.levels.size()));
+    for (uint32_t level = 0; level < regions.size(); level++)
+    {
+        VkBufferImageCopy& region              = regions[level];
+        region.bufferOffset                    = bufferOffset + chain.levels[level].offset;
+        region.bufferRowLength                 = 0;
+        region.bufferImageHeight               = 0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = 1;
+        region.imageExtent                     = chain.levels[level].extent;
+    }
+    vkCmdCopyBufferToImage(
+        cmd, stagingBuffer->handle, handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+    if (readable)
+    {
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(
+            cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
 void Image::generate_mipmaps(VkCommandBuffer& cmd) {
 
     int32_t mipWidth  = extent.width;
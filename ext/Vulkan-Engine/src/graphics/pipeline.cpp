@@ -1,4 +1,5 @@
 #include <engine/graphics/pipeline.h>
+#include <engine/graphics/shader_cache.h>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
@@ -49,16 +50,26 @@ void PipelineBuilder::build_graphic_pipeline(VkPipeline&
     VkPipelineVertexInputStateCreateInfo   vertexInputInfo = Init::vertex_input_state_create_info();
     VkPipelineInputAssemblyStateCreateInfo inputAssembly   = Init::input_assembly_create_info(settings.topology);
 
-    auto bindingDescription                       = Vertex::getBindingDescription();
+    VkVertexInputBindingDescription                bindingDescription;
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+    if (settings.vertexLayout == STRAND_VERTEX_LAYOUT)
+    {
+        bindingDescription    = StrandVertex::getBindingDescription();
+        attributeDescriptions = StrandVertex::getAttributeDescriptions(settings.attributes[VertexAttributeType::POSITION_ATTRIBUTE],
+                                                                       settings.attributes[VertexAttributeType::TANGENT_ATTRIBUTE],
+                                                                       settings.attributes[VertexAttributeType::COLOR_ATTRIBUTE]);
+    } else
+    {
+        bindingDescription    = Vertex::getBindingDescription();
+        attributeDescriptions = Vertex::getAttributeDescriptions(settings.attributes[VertexAttributeType::POSITION_ATTRIBUTE],
+                                                                 settings.attributes[VertexAttributeType::NORMAL_ATTRIBUTE],
+                                                                 settings.attributes[VertexAttributeType::TANGENT_ATTRIBUTE],
+                                                                 settings.attributes[VertexAttributeType::UV_ATTRIBUTE],
+                                                                 settings.attributes[VertexAttributeType::COLOR_ATTRIBUTE]);
+    }
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.pVertexBindingDescriptions    = &bindingDescription;
 
-    auto attributeDescriptions =
-        Vertex::getAttributeDescriptions(settings.attributes[VertexAttributeType::POSITION_ATTRIBUTE],
-                                         settings.attributes[VertexAttributeType::NORMAL_ATTRIBUTE],
-                                         settings.attributes[VertexAttributeType::TANGENT_ATTRIBUTE],
-                                         settings.attributes[VertexAttributeType::UV_ATTRIBUTE],
-                                         settings.attributes[VertexAttributeType::COLOR_ATTRIBUTE]);
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexAttributeDescriptions    = attributeDescriptions.data();
 
@@ -126,7 +137,7 @@ void PipelineBuilder::build_graphic_pipeline(VkPipeline&
     pipelineInfo.subpass            = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    if (vkCreateGraphicsPipelines(device, ShaderCache::get_pipeline_cache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         throw VKFW_Exception("Failed to create Grahic "
                              "Pipeline");
@@ -142,7 +153,7 @@ void PipelineBuilder::build_compute_pipeline(VkPipeline&                     pip
     pipelineInfo.stage                       = computeStage;
     pipelineInfo.layout                      = layout;
 
-    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    if (vkCreateComputePipelines(device, ShaderCache::get_pipeline_cache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
     {
         throw VKFW_Exception("Failed to create compute pipeline!");
     }
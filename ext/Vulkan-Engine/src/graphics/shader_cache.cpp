@@ -0,0 +1,182 @@
+#include <engine/graphics/shader_cache.h>
+
+#include <filesystem>
+#include <thread>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+static std::string     cacheDirectory = ENGINE_SHADER_CACHE_PATH;
+static VkDevice        cacheDevice    = VK_NULL_HANDLE;
+static VkPipelineCache pipelineCache  = VK_NULL_HANDLE;
+
+// FNV-1a
+static void hash_bytes(uint64_t& hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+static void hash_text(uint64_t& hash, const std::string& str) {
+    const uint64_t size = str.size();
+    hash_bytes(hash, &size, sizeof(uint64_t)); // Length prefix keeps concatenations apart
+    hash_bytes(hash, str.data(), str.size());
+}
+
+static std::string get_entry_path(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+    return cacheDirectory + name;
+}
+static bool ensure_directory() {
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    return !error;
+}
+
+void ShaderCache::set_directory(const std::string& directory) {
+    cacheDirectory = directory;
+    if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\')
+        cacheDirectory += '/';
+}
+const std::string& ShaderCache::get_directory() {
+    return cacheDirectory;
+}
+
+uint64_t
+ShaderCache::hash(const std::string& source, shaderc_shader_kind kind, shaderc_optimization_level optimization, const ShaderDefines& defines) {
+    uint64_t       hash    = 0xcbf29ce484222325ull;
+    const uint32_t version = SHADER_CACHE_VERSION;
+    hash_bytes(hash, &version, sizeof(uint32_t));
+    hash_bytes(hash, &kind, sizeof(kind));
+    hash_bytes(hash, &optimization, sizeof(optimization));
+    for (auto& define : defines)
+    {
+        hash_text(hash, define.first);
+        hash_text(hash, define.second);
+    }
+    hash_text(hash, source);
+    return hash;
+}
+
+bool ShaderCache::load(uint64_t key, std::vector<uint32_t>& spirv) {
+    if (cacheDirectory.empty())
+        return false;
+
+    std::ifstream file(get_entry_path(key), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    const size_t size = static_cast<size_t>(file.tellg());
+    if (size < 5 * sizeof(uint32_t) || size % sizeof(uint32_t) != 0)
+        return false;
+
+    spirv.resize(size / sizeof(uint32_t));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(spirv.data()), size) || spirv[0] != 0x07230203) // SPIR-V magic number
+    {
+        spirv.clear();
+        return false;
+    }
+    return true;
+}
+
+void ShaderCache::store(uint64_t key, const std::vector<uint32_t>& spirv) {
+    if (cacheDirectory.empty() || spirv.empty() || !ensure_directory())
+        return;
+
+    const std::string path = get_entry_path(key);
+    std::stringstream tmpPath;
+    tmpPath << path << "." << std::hash<std::thread::id>{}(std::this_thread::get_id()) << ".tmp";
+    {
+        std::ofstream file(tmpPath.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARN("Could not write shader cache entry " + path);
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    }
+    std::error_code error;
+    std::filesystem::rename(tmpPath.str(), path, error);
+    if (error)
+        std::filesystem::remove(tmpPath.str(), error);
+}
+
+void ShaderCache::init_pipeline_cache(VkDevice device, const VkPhysicalDeviceProperties& gpuProperties) {
+    std::vector<uint8_t> data;
+    if (!cacheDirectory.empty())
+    {
+        std::ifstream file(cacheDirectory + PIPELINE_CACHE_FILE, std::ios::binary | std::ios::ate);
+        if (file.is_open())
+        {
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(data.data()), data.size());
+        }
+    }
+    // Drivers should reject foreign data themselves, but not all of them do
+    if (!data.empty())
+    {
+        VkPipelineCacheHeaderVersionOne header = {};
+        if (data.size() < sizeof(header))
+            data.clear();
+        else
+        {
+            memcpy(&header, data.data(), sizeof(header));
+            if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.vendorID != gpuProperties.vendorID ||
+                header.deviceID != gpuProperties.deviceID || memcmp(header.pipelineCacheUUID, gpuProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+            {
+                LOG_DEBUG("Discarding pipeline cache built for a different GPU or driver");
+                data.clear();
+            }
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize           = data.size();
+    cacheInfo.pInitialData              = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS)
+    {
+        // Retry empty in case the driver choked on the seed data
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData    = nullptr;
+        VK_CHECK(vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache));
+    }
+    cacheDevice = device;
+}
+
+void ShaderCache::cleanup_pipeline_cache() {
+    if (!pipelineCache)
+        return;
+
+    size_t size = 0;
+    if (!cacheDirectory.empty() && vkGetPipelineCacheData(cacheDevice, pipelineCache, &size, nullptr) == VK_SUCCESS && size > 0 &&
+        ensure_directory())
+    {
+        std::vector<uint8_t> data(size);
+        if (vkGetPipelineCacheData(cacheDevice, pipelineCache, &size, data.data()) == VK_SUCCESS)
+        {
+            std::ofstream file(cacheDirectory + PIPELINE_CACHE_FILE, std::ios::binary | std::ios::trunc);
+            if (file.is_open())
+                file.write(reinterpret_cast<const char*>(data.data()), size);
+            else
+                LOG_WARN("Could not write pipeline cache to " + cacheDirectory);
+        }
+    }
+
+    vkDestroyPipelineCache(cacheDevice, pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
+    cacheDevice   = VK_NULL_HANDLE;
+}
+
+VkPipelineCache ShaderCache::get_pipeline_cache() {
+    return pipelineCache;
+}
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -85,13 +85,21 @@ ShaderSource ShaderSource::read_file(const std::string& filePath) {
 std::vector<uint32_t> ShaderSource::compile_shader(const std::string          src,
                                                    const std::string          shaderName,
                                                    shaderc_shader_kind        kind,
-                                                   shaderc_optimization_level optimization) {
+                                                   shaderc_optimization_level optimization,
+                                                   const ShaderDefines&       defines) {
+    const uint64_t        key = ShaderCache::hash(src, kind, optimization, defines);
+    std::vector<uint32_t> spirv;
+    if (ShaderCache::load(key, spirv))
+        return spirv;
+
     shaderc::Compiler       compiler;
     shaderc::CompileOptions options;
     options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
     options.SetTargetSpirv(shaderc_spirv_version_1_4);
 
     options.SetOptimizationLevel(optimization);
+    for (auto& define : defines)
+        options.AddMacroDefinition(define.first, define.second);
 
     shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(src, kind, shaderName.c_str(), options);
     if (result.GetCompilationStatus() != shaderc_compilation_status_success)
@@ -99,7 +107,9 @@ std::vector<uint32_t> ShaderSource::compile_shader(const std::string          sr
         Logger::log(LogLevel::Error, Logger::format_with_tag("[Shader]", "\033[35m",  "Compile Error - " + result.GetErrorMessage()));
     }
 
-    std::vector<uint32_t> spirv = {result.cbegin(), result.cend()};
+    spirv = {result.cbegin(), result.cend()};
+    if (result.GetCompilationStatus() == shaderc_compilation_status_success)
+        ShaderCache::store(key, spirv);
 
     return spirv;
 }
@@ -109,48 +119,48 @@ void GraphicShaderPass::build_shader_stages(shaderc_optimization_level optimizat
         return;
     auto shader = ShaderSource::read_file(filePath);
 
-    if (shader.vertSource != "")
+    if (shader.vertSource != "" && (stages & SHADER_STAGE_VERTEX))
     {
         ShaderStage vertShaderStage = ShaderSource::create_shader_stage(
             device,
             VK_SHADER_STAGE_VERTEX_BIT,
-            ShaderSource::compile_shader(shader.vertSource, shader.name + "vert", shaderc_vertex_shader, optimization));
+            ShaderSource::compile_shader(shader.vertSource, shader.name + "vert", shaderc_vertex_shader, optimization, defines));
         shaderStages.push_back(vertShaderStage);
     }
-    if (shader.fragSource != "")
+    if (shader.fragSource != "" && (stages & SHADER_STAGE_FRAGMENT))
     {
         ShaderStage fragShaderStage = ShaderSource::create_shader_stage(
             device,
             VK_SHADER_STAGE_FRAGMENT_BIT,
             ShaderSource::compile_shader(
-                shader.fragSource, shader.name + "frag", shaderc_fragment_shader, optimization));
+                shader.fragSource, shader.name + "frag", shaderc_fragment_shader, optimization, defines));
         shaderStages.push_back(fragShaderStage);
     }
-    if (shader.geomSource != "")
+    if (shader.geomSource != "" && (stages & SHADER_STAGE_GEOMETRY))
     {
         ShaderStage geomShaderStage = ShaderSource::create_shader_stage(
             device,
             VK_SHADER_STAGE_GEOMETRY_BIT,
             ShaderSource::compile_shader(
-                shader.geomSource, shader.name + "geom", shaderc_geometry_shader, optimization));
+                shader.geomSource, shader.name + "geom", shaderc_geometry_shader, optimization, defines));
         shaderStages.push_back(geomShaderStage);
     }
-    if (shader.tessControlSource != "")
+    if (shader.tessControlSource != "" && (stages & SHADER_STAGE_TESSELLATION_CONTROL))
     {
         ShaderStage tessControlShaderStage = ShaderSource::create_shader_stage(
             device,
             VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
             ShaderSource::compile_shader(
-                shader.tessControlSource, shader.name + "control", shaderc_tess_control_shader, optimization));
+                shader.tessControlSource, shader.name + "control", shaderc_tess_control_shader, optimization, defines));
         shaderStages.push_back(tessControlShaderStage);
     }
-    if (shader.tessEvalSource != "")
+    if (shader.tessEvalSource != "" && (stages & SHADER_STAGE_TESSELLATION_EVALUATION))
     {
         ShaderStage tessEvalShaderStage = ShaderSource::create_shader_stage(
             device,
             VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
             ShaderSource::compile_shader(
-                shader.tessEvalSource, shader.name + "eval", shaderc_tess_evaluation_shader, optimization));
+                shader.tessEvalSource, shader.name + "eval", shaderc_tess_evaluation_shader, optimization, defines));
         shaderStages.push_back(tessEvalShaderStage);
     }
 }
@@ -165,7 +175,7 @@ void ComputeShaderPass::build_shader_stages(shaderc_optimization_level optimizat
             device,
             VK_SHADER_STAGE_COMPUTE_BIT,
             ShaderSource::compile_shader(
-                shader.computeSource, shader.name + "compute", shaderc_compute_shader, optimization));
+                shader.computeSource, shader.name + "compute", shaderc_compute_shader, optimization, defines));
     }
 }
 
@@ -55,6 +55,9 @@ void Swapchain::create(VkPhysicalDevice &gpu, VkDevice &device, VkExtent2D actua
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Lets frames be read back (screenshots)
+    if (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
     if (indices.graphicsFamily != indices.presentFamily)
     {
@@ -86,6 +89,7 @@ void Swapchain::create(VkPhysicalDevice &gpu, VkDevice &device, VkExtent2D actua
     {
         m_presentImages[i].handle = images[i];
         m_presentImages[i].device = device;
+        m_presentImages[i].extent = {extent.width, extent.height, 1};
     }
 
     m_presentFormat = surfaceFormat.format;
@@ -97,18 +101,59 @@ void Swapchain::create(VkPhysicalDevice &gpu, VkDevice &device, VkExtent2D actua
     m_initialized = true;
 }
 
+void Swapchain::create_offscreen(VmaAllocator allocator, VkDevice &device, VkExtent2D extent, uint32_t imageCount,
+                                 VkFormat colorFormat)
+{
+    m_device = device;
+    if (m_initialized)
+        cleanup();
+
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    m_presentImages.resize(imageCount);
+    for (size_t i = 0; i < imageCount; i++)
+    {
+        VkImageCreateInfo imageInfo =
+            Init::image_create_info(colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                    {extent.width, extent.height, 1});
+
+        m_presentImages[i] = {};
+        VK_CHECK(vmaCreateImage(allocator, &imageInfo, &allocInfo, &m_presentImages[i].handle,
+                                &m_presentImages[i].allocation, nullptr));
+        m_presentImages[i].device = device;
+        m_presentImages[i].memory = allocator;
+        m_presentImages[i].extent = {extent.width, extent.height, 1};
+    }
+
+    m_handle = VK_NULL_HANDLE;
+    m_presentFormat = colorFormat;
+    m_presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+    create_image_views(device);
+
+    m_initialized = true;
+}
+
 void Swapchain::destroy_surface(VkInstance instance)
 {
-    vkDestroySurfaceKHR(instance, m_surface, nullptr);
+    if (m_surface)
+        vkDestroySurfaceKHR(instance, m_surface, nullptr);
 }
 void Swapchain::cleanup()
 {
     for (size_t i = 0; i < m_presentImages.size(); i++)
     {
-        vkDestroyImageView(m_device, m_presentImages[i].view, nullptr);
+        // Offscreen images are owned by us, swapchain ones by the swapchain
+        if (m_handle)
+            vkDestroyImageView(m_device, m_presentImages[i].view, nullptr);
+        else
+            m_presentImages[i].cleanup();
     }
 
-    vkDestroySwapchainKHR(m_device, m_handle, nullptr);
+    if (m_handle)
+        vkDestroySwapchainKHR(m_device, m_handle, nullptr);
+    m_handle = VK_NULL_HANDLE;
 
     m_initialized = false;
 }
@@ -0,0 +1,395 @@
+#include <engine/graphics/upload_queue.h>
+#include <numeric>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+void UploadQueue::init(VkDevice device, VmaAllocator allocator, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, size_t ringSize) {
+    m_device         = device;
+    m_allocator      = allocator;
+    m_queue          = queue;
+    m_family         = queueFamily;
+    m_graphicsFamily = graphicsFamily;
+
+    VkCommandPoolCreateInfo poolInfo = Init::command_pool_create_info(m_family, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VK_CHECK(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_pool));
+
+    VkSemaphoreTypeCreateInfo timelineInfo = {};
+    timelineInfo.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue              = 0;
+    VkSemaphoreCreateInfo semaphoreInfo    = Init::semaphore_create_info();
+    semaphoreInfo.pNext                    = &timelineInfo;
+    VK_CHECK(vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_timeline));
+
+    // Persistently mapped staging ring
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = ringSize;
+    bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage                   = VMA_MEMORY_USAGE_CPU_ONLY;
+    vmaallocInfo.flags                   = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo allocationInfo     = {};
+    VK_CHECK(vmaCreateBuffer(m_allocator, &bufferInfo, &vmaallocInfo, &m_ring.handle, &m_ring.allocation, &allocationInfo));
+
+    m_ring.device     = m_device;
+    m_ring.allocator  = m_allocator;
+    m_ring.size       = static_cast<uint32_t>(ringSize);
+    m_ring.strideSize = m_ring.size;
+    m_ringData        = static_cast<uint8_t*>(allocationInfo.pMappedData);
+}
+
+void UploadQueue::cleanup() {
+    if (!m_device)
+        return;
+    flush();
+    wait_idle();
+    retire();
+
+    m_ring.cleanup();
+    m_ringData = nullptr;
+    m_bufferAcquires.clear();
+    m_graphicsWork.clear();
+    m_freeBatches.clear();
+
+    vkDestroySemaphore(m_device, m_timeline, nullptr);
+    vkDestroyCommandPool(m_device, m_pool, nullptr);
+    m_device = VK_NULL_HANDLE;
+}
+
+size_t UploadQueue::allocate(size_t size, size_t alignment) {
+    const size_t capacity = m_ring.size;
+    if (size > capacity)
+        return SIZE_MAX;
+
+    while (true)
+    {
+        if (m_ringUsed == 0)
+            m_ringHead = 0;
+
+        size_t offset  = (m_ringHead + alignment - 1) / alignment * alignment;
+        size_t padding = offset - m_ringHead;
+        // Wrap around, the tail of the ring is lost until this batch retires
+        if (offset + size > capacity)
+        {
+            padding = capacity - m_ringHead;
+            offset  = 0;
+        }
+        if (m_ringUsed + padding + size <= capacity)
+        {
+            m_ringHead = offset + size;
+            m_ringUsed += padding + size;
+            m_batchBytes += padding + size;
+            return offset;
+        }
+
+        // Ring full. Submit what is pending and wait for the oldest batch to release its region
+        if (m_regions.empty())
+            flush();
+        uint64_t            value    = m_regions.front().value;
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType               = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount      = 1;
+        waitInfo.pSemaphores         = &m_timeline;
+        waitInfo.pValues             = &value;
+        VK_CHECK(vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX));
+        retire();
+    }
+}
+
+size_t UploadQueue::stage(const void* data, size_t size, size_t alignment, Buffer*& stagingBuffer) {
+    retire();
+
+    size_t offset = allocate(size, alignment);
+    if (offset != SIZE_MAX)
+    {
+        memcpy(m_ringData + offset, data, size);
+        VK_CHECK(vmaFlushAllocation(m_allocator, m_ring.allocation, offset, size));
+        stagingBuffer = &m_ring;
+        return offset;
+    }
+
+    // Too big for the ring. Use a dedicated staging buffer, released along with the batch
+    RetiredBuffer retired = {};
+    retired.value         = m_submittedValue + 1;
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size               = size;
+    bufferInfo.usage              = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VmaAllocationCreateInfo vmaallocInfo = {};
+    vmaallocInfo.usage                   = VMA_MEMORY_USAGE_CPU_ONLY;
+    VK_CHECK(vmaCreateBuffer(m_allocator, &bufferInfo, &vmaallocInfo, &retired.buffer.handle, &retired.buffer.allocation, nullptr));
+    retired.buffer.device     = m_device;
+    retired.buffer.allocator  = m_allocator;
+    retired.buffer.size       = static_cast<uint32_t>(size);
+    retired.buffer.strideSize = retired.buffer.size;
+    retired.buffer.upload_data(data, size);
+
+    m_retiredBuffers.push_back(retired);
+    stagingBuffer = &m_retiredBuffers.back().buffer;
+    return 0;
+}
+
+VkCommandBuffer UploadQueue::get_command_buffer() {
+    if (m_current.cmd)
+        return m_current.cmd;
+
+    if (!m_freeBatches.empty())
+    {
+        m_current = m_freeBatches.back();
+        m_freeBatches.pop_back();
+        VK_CHECK(vkResetCommandBuffer(m_current.cmd, 0));
+    } else
+    {
+        VkCommandBufferAllocateInfo cmdAllocInfo = Init::command_buffer_allocate_info(m_pool, 1);
+        VK_CHECK(vkAllocateCommandBuffers(m_device, &cmdAllocInfo, &m_current.cmd));
+    }
+    m_current.value = m_submittedValue + 1;
+
+    VkCommandBufferBeginInfo beginInfo = Init::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VK_CHECK(vkBeginCommandBuffer(m_current.cmd, &beginInfo));
+    return m_current.cmd;
+}
+
+void UploadQueue::retire() {
+    uint64_t completed = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(m_device, m_timeline, &completed));
+
+    while (!m_regions.empty() && m_regions.front().value <= completed)
+    {
+        m_ringUsed -= m_regions.front().size;
+        m_regions.pop_front();
+    }
+    while (!m_inFlight.empty() && m_inFlight.front().value <= completed)
+    {
+        m_freeBatches.push_back(m_inFlight.front());
+        m_inFlight.pop_front();
+    }
+    for (auto it = m_retiredBuffers.begin(); it != m_retiredBuffers.end();)
+    {
+        if (it->value <= completed)
+        {
+            it->buffer.cleanup();
+            it = m_retiredBuffers.erase(it);
+        } else
+            it++;
+    }
+}
+
+void UploadQueue::upload_buffer(const void* data, size_t size, std::initializer_list<Buffer*> targets) {
+    PROFILING_EVENT()
+    if (!data || size == 0)
+        return;
+
+    Buffer*         stagingBuffer = nullptr;
+    size_t          offset        = stage(data, size, 16, stagingBuffer);
+    VkCommandBuffer cmd           = get_command_buffer();
+
+    for (Buffer* target : targets)
+    {
+        VkBufferCopy copy = {};
+        copy.srcOffset    = offset;
+        copy.dstOffset    = 0;
+        copy.size         = size;
+        vkCmdCopyBuffer(cmd, stagingBuffer->handle, target->handle, 1, &copy);
+
+        if (dedicated())
+        {
+            // Release to the graphics family. The matching acquire is recorded by record_graphics_work()
+            VkBufferMemoryBarrier barrier = {};
+            barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask         = 0;
+            barrier.srcQueueFamilyIndex   = m_family;
+            barrier.dstQueueFamilyIndex   = m_graphicsFamily;
+            barrier.buffer                = target->handle;
+            barrier.offset                = 0;
+            barrier.size                  = VK_WHOLE_SIZE;
+            vkCmdPipelineBarrier(
+                cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            m_bufferAcquires.push_back(barrier);
+        }
+    }
+}
+
+void UploadQueue::upload_image(Image& img, const void* data, size_t size, size_t texelSize) {
+    PROFILING_EVENT()
+    if (!data || size == 0)
+        return;
+
+    // Buffer to image copies need offsets multiple of the texel size
+    Buffer*         stagingBuffer = nullptr;
+    size_t          offset        = stage(data, size, std::lcm<size_t>(16, std::max<size_t>(texelSize, 1)), stagingBuffer);
+    VkCommandBuffer cmd           = get_command_buffer();
+
+    if (!dedicated())
+    {
+        img.upload_image(cmd, stagingBuffer, offset, size);
+        if (img.mipLevels > 1)
+            img.generate_mipmaps(cmd);
+        return;
+    }
+
+    // Transfer queues can not blit nor sample, so the image is handed over to the graphics family still in transfer layout
+    img.upload_image(cmd, stagingBuffer, offset, size, false);
+
+    VkImageMemoryBarrier barrier            = {};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask                   = 0;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                       = img.mipLevels > 1 ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex             = m_family;
+    barrier.dstQueueFamilyIndex             = m_graphicsFamily;
+    barrier.image                           = img.handle;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = img.mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = img.layers;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    Image target = img;
+    m_graphicsWork.push_back([barrier, target](VkCommandBuffer cmd) mutable {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = target.mipLevels > 1 ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             target.mipLevels > 1 ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+        if (target.mipLevels > 1)
+            target.generate_mipmaps(cmd);
+    });
+}
+
+void UploadQueue::upload_mip_chain(Image& img, const MipChain& chain, size_t blockSize) {
+    PROFILING_EVENT()
+    if (chain.data.empty() || chain.levels.empty())
+        return;
+
+    Buffer*         stagingBuffer = nullptr;
+    size_t          offset        = stage(chain.data.data(), chain.data.size(), std::lcm<size_t>(16, std::max<size_t>(blockSize, 1)), stagingBuffer);
+    VkCommandBuffer cmd           = get_command_buffer();
+
+    if (!dedicated())
+    {
+        img.upload_mip_chain(cmd, stagingBuffer, offset, chain);
+        return;
+    }
+
+    // Every level is already there, the graphics family only has to acquire the image
+    img.upload_mip_chain(cmd, stagingBuffer, offset, chain, false);
+
+    VkImageMemoryBarrier barrier            = {};
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask                   = 0;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex             = m_family;
+    barrier.dstQueueFamilyIndex             = m_graphicsFamily;
+    barrier.image                           = img.handle;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = img.mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = img.layers;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    m_graphicsWork.push_back([barrier](VkCommandBuffer cmd) mutable {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    });
+}
+
+void UploadQueue::enqueue_graphics_work(std::function<void(VkCommandBuffer)>&& work) {
+    if (dedicated())
+    {
+        m_graphicsWork.push_back(std::move(work));
+        return;
+    }
+
+    VkCommandBuffer cmd     = get_command_buffer();
+    VkMemoryBarrier barrier = {};
+    barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    work(cmd);
+}
+
+void UploadQueue::flush() {
+    if (!m_current.cmd)
+        return;
+    PROFILING_EVENT()
+
+    VK_CHECK(vkEndCommandBuffer(m_current.cmd));
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount     = 1;
+    timelineInfo.pSignalSemaphoreValues        = &m_current.value;
+
+    VkSubmitInfo submit         = Init::submit_info(&m_current.cmd);
+    submit.pNext                = &timelineInfo;
+    submit.signalSemaphoreCount = 1;
+    submit.pSignalSemaphores    = &m_timeline;
+    VK_CHECK(vkQueueSubmit(m_queue, 1, &submit, VK_NULL_HANDLE));
+
+    m_regions.push_back({m_batchBytes, m_current.value});
+    m_inFlight.push_back(m_current);
+    m_submittedValue = m_current.value;
+    m_batchBytes     = 0;
+    m_current        = {};
+}
+
+void UploadQueue::record_graphics_work(VkCommandBuffer cmd) {
+    // Releases must be submitted before their acquires
+    flush();
+    if (!m_bufferAcquires.empty())
+    {
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(m_bufferAcquires.size()),
+                             m_bufferAcquires.data(),
+                             0,
+                             nullptr);
+        m_bufferAcquires.clear();
+    }
+    for (auto& work : m_graphicsWork)
+        work(cmd);
+    m_graphicsWork.clear();
+}
+
+void UploadQueue::wait_idle() {
+    if (m_submittedValue == 0)
+        return;
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType               = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount      = 1;
+    waitInfo.pSemaphores         = &m_timeline;
+    waitInfo.pValues             = &m_submittedValue;
+    VK_CHECK(vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX));
+    retire();
+}
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -5,7 +5,8 @@ VULKAN_ENGINE_NAMESPACE_BEGIN
 
 namespace Graphics {
 #pragma region INSTANCE
-VkInstance Booter::create_instance(const char* appName, const char* engineName, bool validation, std::vector<const char*> validationLayers) {
+VkInstance
+Booter::create_instance(const char* appName, const char* engineName, bool validation, std::vector<const char*> validationLayers, bool headless) {
     if (validation && !Utils::check_validation_layer_suport(validationLayers))
     {
         throw VKFW_Exception(" validation layers requested, but not available!");
@@ -23,7 +24,7 @@ VkInstance Booter::create_instance(const char* appName, const char* engineName,
     createInfo.sType            = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
-    auto extensions                    = get_required_extensions(validation);
+    auto extensions                    = get_required_extensions(validation, headless);
     createInfo.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -51,12 +52,14 @@ VkInstance Booter::create_instance(const char* appName, const char* engineName,
     return instance;
 }
 
-std::vector<const char*> Booter::get_required_extensions(bool validation) {
-    uint32_t     glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+std::vector<const char*> Booter::get_required_extensions(bool validation, bool headless) {
+    std::vector<const char*> extensions;
+    if (!headless)
+    {
+        uint32_t     glfwExtensionCount = 0;
+        const char** glfwExtensions     = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (validation)
     {
@@ -139,6 +142,8 @@ int Booter::rate_device_suitability(VkPhysicalDevice device, VkSurfaceKHR surfac
     bool swapChainAdequate = false;
     if (check_device_extension_support(device, extensions))
     {
+        if (!surface)
+            return score;
         Utils::SwapChainSupportDetails swapChainSupport = Utils::query_swapchain_support(device, surface);
         swapChainAdequate                               = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         if (!swapChainAdequate)
@@ -179,6 +184,8 @@ VkDevice Booter::create_logical_device(std::unordered_map<QueueType, VkQueue>& q
     Utils::QueueFamilyIndices            queueFamilies = Utils::find_queue_families(gpu, surface);
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {queueFamilies.graphicsFamily.value(), queueFamilies.presentFamily.value(), queueFamilies.computeFamily.value()};
+    if (queueFamilies.transferFamily.has_value())
+        uniqueQueueFamilies.insert(queueFamilies.transferFamily.value());
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -199,6 +206,13 @@ VkDevice Booter::create_logical_device(std::unordered_map<QueueType, VkQueue>& q
 
     enabledExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
+    // Core in 1.2. Used to track asynchronous uploads
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
+    timelineSemaphoreFeatures.sType                                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timelineSemaphoreFeatures.timelineSemaphore                         = VK_TRUE;
+    timelineSemaphoreFeatures.pNext                                     = physicalDeviceFeatures2.pNext;
+    physicalDeviceFeatures2.pNext                                       = &timelineSemaphoreFeatures;
+
     VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures = {};
 
     if (Utils::is_device_extension_supported(gpu, "VK_EXT_extended_dynamic_state"))
@@ -236,6 +250,10 @@ VkDevice Booter::create_logical_device(std::unordered_map<QueueType, VkQueue>& q
         physicalDeviceFeatures2.pNext = &extendedDynamicState3Features;
     }
 
+    // No features to enable, the draw calls come with the extension
+    if (Utils::is_device_extension_supported(gpu, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+        enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
     VkPhysicalDeviceRayTracingPipelineFeaturesKHR    rayTracingPipelineFeatures    = {};
     VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures = {};
     VkPhysicalDeviceBufferDeviceAddressFeaturesKHR   bufferDeviceAddressFeatures   = {};
@@ -292,6 +310,16 @@ VkDevice Booter::create_logical_device(std::unordered_map<QueueType, VkQueue>& q
 
         // Finally, attach the descriptorIndexingFeatures to the physicalDeviceFeatures2
         physicalDeviceFeatures2.pNext = &atomicFloatFeatures;
+    } else if (Utils::is_device_extension_supported(gpu, VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME))
+    {
+        // No ray tracing (e.g. software rasterizers). Strand and object tables are still read through device addresses
+        enabledExtensions.push_back(VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME);
+
+        bufferDeviceAddressFeatures.sType               = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR;
+        bufferDeviceAddressFeatures.pNext               = physicalDeviceFeatures2.pNext;
+        bufferDeviceAddressFeatures.bufferDeviceAddress = true;
+
+        physicalDeviceFeatures2.pNext = &bufferDeviceAddressFeatures;
     }
 
     physicalDeviceFeatures2.features = features;
@@ -324,6 +352,10 @@ VkDevice Booter::create_logical_device(std::unordered_map<QueueType, VkQueue>& q
     vkGetDeviceQueue(device, queueFamilies.graphicsFamily.value(), 0, &queues[QueueType::GRAPHIC_QUEUE]);
     vkGetDeviceQueue(device, queueFamilies.presentFamily.value(), 0, &queues[QueueType::PRESENT_QUEUE]);
     vkGetDeviceQueue(device, queueFamilies.computeFamily.value(), 0, &queues[QueueType::COMPUTE_QUEUE]);
+    if (queueFamilies.transferFamily.has_value())
+        vkGetDeviceQueue(device, queueFamilies.transferFamily.value(), 0, &queues[QueueType::TRANSFER_QUEUE]);
+    else
+        queues[QueueType::TRANSFER_QUEUE] = queues[QueueType::GRAPHIC_QUEUE];
 
     return device;
 }
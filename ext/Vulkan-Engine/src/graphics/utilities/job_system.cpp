@@ -0,0 +1,154 @@
+#include <engine/graphics/utilities/job_system.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Graphics {
+
+// Pool and worker the calling thread belongs to, if any
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local uint32_t         currentWorker = 0;
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    workerCount = std::max(1u, workerCount);
+
+    m_queues.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        m_workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+JobSystem& JobSystem::get() {
+    static JobSystem system;
+    return system;
+}
+
+JobHandle JobSystem::submit(std::function<void()>&& job, JobHandle handle) {
+    if (!handle.m_pending)
+        handle.m_pending = std::make_shared<std::atomic<uint32_t>>(0);
+    handle.m_pending->fetch_add(1, std::memory_order_relaxed);
+
+    // Counted before being visible, a worker might pop it right away
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_queued.fetch_add(1, std::memory_order_release);
+    }
+    Job entry = {std::move(job), handle.m_pending};
+    if (currentSystem == this)
+    {
+        WorkQueue&                  queue = *m_queues[currentWorker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_front(std::move(entry));
+    } else
+    {
+        WorkQueue&                  queue = *m_queues[m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(entry));
+    }
+    m_wake.notify_one();
+
+    return handle;
+}
+
+bool JobSystem::pop(Job& job, const std::atomic<uint32_t>* counter) {
+    const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+    const bool     isWorker   = currentSystem == this;
+    const uint32_t home       = isWorker ? currentWorker : 0;
+
+    // Takes the first job of the queue from either end, only those of the given counter if any
+    auto take = [&](WorkQueue& queue, bool front) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        const size_t                count = queue.jobs.size();
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t index = front ? i : count - 1 - i;
+            if (counter && queue.jobs[index].counter.get() != counter)
+                continue;
+            job = std::move(queue.jobs[index]);
+            queue.jobs.erase(queue.jobs.begin() + index);
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    };
+
+    // Newest job of our own queue first, it is the most likely to be hot in cache
+    if (isWorker && take(*m_queues[home], true))
+        return true;
+    // Then steal the oldest one of someone else
+    for (uint32_t i = isWorker ? 1 : 0; i < queueCount; i++)
+        if (take(*m_queues[(home + i) % queueCount], false))
+            return true;
+    return false;
+}
+
+void JobSystem::execute(Job& job) {
+    try
+    {
+        job.function();
+    } catch (const std::exception& e)
+    { LOG_ERROR(std::string("Job failed: ") + e.what()); }
+    job.counter->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::worker_loop(uint32_t index) {
+    currentSystem = this;
+    currentWorker = index;
+    while (true)
+    {
+        Job job;
+        if (pop(job))
+        {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return !m_running || m_queued.load(std::memory_order_acquire) > 0; });
+        if (!m_running)
+            return;
+    }
+}
+
+void JobSystem::wait(const JobHandle& handle) {
+    while (!handle.done())
+    {
+        // Only jobs of the handle, an unrelated one (a whole asset decode) could stall the caller for long
+        Job job;
+        if (pop(job, handle.m_pending.get()))
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::enqueue_main_thread(std::function<void()>&& task) {
+    std::lock_guard<std::mutex> lock(m_mainMutex);
+    m_mainTasks.push_back(std::move(task));
+}
+
+void JobSystem::run_main_thread_tasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_mainMutex);
+        tasks.swap(m_mainTasks);
+    }
+    for (std::function<void()>& task : tasks)
+        task();
+}
+
+} // namespace Graphics
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -49,6 +49,14 @@ VkFormat get(ColorFormatType colorFormatType) {
         return VK_FORMAT_D32_SFLOAT;
     case ColorFormatType::RGB10A2:
         return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+    case ColorFormatType::SRGBA_BC1:
+        return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case ColorFormatType::RGBA_BC1U:
+        return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case ColorFormatType::SRGBA_BC3:
+        return VK_FORMAT_BC3_SRGB_BLOCK;
+    case ColorFormatType::RGBA_BC3U:
+        return VK_FORMAT_BC3_UNORM_BLOCK;
     // case ColorFormatType::RG11B10_UFLOAT:
     //     return VK_FORMAT_R11G11B10_UFLOAT_PACK32;
     default:
@@ -232,6 +240,8 @@ VkPipelineStageFlags get(PipelineStage stageFlags) {
         return VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
     case PipelineStage::STAGE_VERTEX_SHADER:
         return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    case PipelineStage::STAGE_DRAW_INDIRECT:
+        return VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
     default:
         throw std::invalid_argument("VKEngine error: Unknown PipelineStageFlags");
     }
@@ -260,6 +270,8 @@ VkAccessFlags get(AccessFlags accessFlags) {
         return VK_ACCESS_SHADER_WRITE_BIT;
     case AccessFlags::ACCESS_MEMORY_READ:
         return VK_ACCESS_MEMORY_READ_BIT;
+    case AccessFlags::ACCESS_INDIRECT_COMMAND_READ:
+        return VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
     default:
         throw std::invalid_argument("VKEngine error: Unknown AccessFlags");
     }
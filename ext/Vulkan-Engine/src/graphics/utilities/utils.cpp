@@ -1,4 +1,14 @@
 #include <engine/graphics/utilities/utils.h>
+#include <engine/graphics/utilities/job_system.h>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
@@ -21,9 +31,12 @@ Utils::QueueFamilyIndices Utils::find_queue_families(VkPhysicalDevice device, Vk
         {
             indices.graphicsFamily = i;
         }
-        // PRESENT SUPPORT
+        // PRESENT SUPPORT. Without a surface (headless) the graphics queue "presents"
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (surface)
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        else
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
         if (presentSupport)
         {
             indices.presentFamily = i;
@@ -41,6 +54,16 @@ Utils::QueueFamilyIndices Utils::find_queue_families(VkPhysicalDevice device, Vk
 
         i++;
     }
+    // Transfer only families (DMA engines) run copies concurrently with rendering
+    for (i = 0; i < static_cast<int>(queueFamilies.size()); i++)
+    {
+        const VkQueueFlags flags = queueFamilies[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && !(flags & VK_QUEUE_COMPUTE_BIT))
+        {
+            indices.transferFamily = i;
+            break;
+        }
+    }
 
     return indices;
 }
@@ -68,6 +91,103 @@ Utils::SwapChainSupportDetails Utils::query_swapchain_support(VkPhysicalDevice d
     return details;
 }
 
+bool Utils::MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file    = file;
+    m_mapping = mapping;
+    m_data    = static_cast<const uint8_t*>(view);
+    m_size    = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat fileStats;
+    if (fstat(file, &fileStats) != 0 || fileStats.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(fileStats.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED)
+    {
+        ::close(file);
+        return false;
+    }
+    // Loaders walk the arrays front to back
+    madvise(view, static_cast<size_t>(fileStats.st_size), MADV_SEQUENTIAL | MADV_WILLNEED);
+    m_file = file;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileStats.st_size);
+#endif
+    return true;
+}
+void Utils::MappedFile::close() {
+    if (!m_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file    = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+    ::close(m_file);
+    m_file = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void Utils::parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t minBatchSize) {
+    if (count == 0)
+        return;
+    JobSystem&   jobs       = JobSystem::get();
+    const size_t numBatches = std::min<size_t>(jobs.get_worker_count() + 1, (count + minBatchSize - 1) / std::max<size_t>(1, minBatchSize));
+    if (numBatches <= 1)
+    {
+        function(0, count);
+        return;
+    }
+
+    const size_t batchSize = (count + numBatches - 1) / numBatches;
+    JobHandle    handle;
+    for (size_t batch = 1; batch < numBatches; batch++)
+    {
+        const size_t begin = batch * batchSize;
+        const size_t end   = std::min(count, begin + batchSize);
+        if (begin >= end)
+            break;
+        handle = jobs.submit([&function, begin, end]() { function(begin, end); }, handle);
+    }
+    // Calling thread takes the first batch, then helps with the rest
+    function(0, std::min(count, batchSize));
+    jobs.wait(handle);
+}
+
 std::string Utils::trim(const std::string& str) {
     size_t first = str.find_first_not_of(" \t\n\r");
     size_t last  = str.find_last_not_of(" \t\n\r");
@@ -213,6 +333,38 @@ Vec3 Utils::get_tangent_gram_smidt(Vec3& p1, Vec3& p2, Vec3& p3, glm::vec2& uv1,
     // return glm::normalize(tangent);
 }
 
+size_t Utils::get_block_size(ColorFormatType format) {
+    switch (format)
+    {
+    case SR_8:
+    case R_8U:
+        return 1;
+    case SRG_8:
+    case RG_8U:
+    case SR_16F:
+    case DEPTH_16F:
+        return 2;
+    case SRGB_8:
+    case RGB_8U:
+        return 3;
+    case SRGBA_16F:
+    case SRG_32F:
+    case SRGBA_BC1:
+    case RGBA_BC1U:
+        return 8;
+    case SRGB_16F:
+        return 6;
+    case SRGB_32F:
+        return 12;
+    case SRGBA_32F:
+    case SRGBA_BC3:
+    case RGBA_BC3U:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
 uint32_t Utils::murmur_hash3_32(const char* key, size_t len, uint32_t seed) {
     const uint8_t* data    = (const uint8_t*)key;
     const int      nblocks = len / 4;
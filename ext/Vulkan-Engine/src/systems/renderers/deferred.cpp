@@ -10,14 +10,10 @@ void DeferredRenderer::on_before_render(Core::Scene* const scene) {
     {
         if (scene->get_skybox()->update_enviroment())
             static_cast<Core::GeometryPass*>(m_passes[GEOMETRY_PASS])
-                ->set_envmap_descriptor(
-                    Core::ResourceManager::panoramaConverterPass->get_framebuffers()[0].attachmentImages[0],
-                    Core::ResourceManager::irradianceComputePass->get_framebuffers()[0].attachmentImages[0]);
+                ->set_envmap_descriptor(Core::ResourceManager::get_env_cubemap(), Core::ResourceManager::get_irradiance_cubemap());
         if (scene->get_skybox()->update_enviroment())
             static_cast<Core::CompositionPass*>(m_passes[COMPOSITION_PASS])
-                ->set_envmap_descriptor(
-                    Core::ResourceManager::panoramaConverterPass->get_framebuffers()[0].attachmentImages[0],
-                    Core::ResourceManager::irradianceComputePass->get_framebuffers()[0].attachmentImages[0]);
+                ->set_envmap_descriptor(Core::ResourceManager::get_env_cubemap(), Core::ResourceManager::get_irradiance_cubemap());
     }
 }
 
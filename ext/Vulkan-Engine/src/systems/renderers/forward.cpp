@@ -10,8 +10,16 @@ void ForwardRenderer::on_before_render(Core::Scene* const scene) {
     {
         if (scene->get_skybox()->update_enviroment())
             static_cast<Core::ForwardPass*>(m_passes[FORWARD_PASS])
-                ->set_envmap_descriptor(Core::ResourceManager::panoramaConverterPass->get_framebuffers()[0].attachmentImages[0],
-                                        Core::ResourceManager::irradianceComputePass->get_framebuffers()[0].attachmentImages[0]);
+                ->set_envmap_descriptor(Core::ResourceManager::get_env_cubemap(), Core::ResourceManager::get_irradiance_cubemap());
+    }
+
+    // The voxelization pass sizes its brick pool while updating its uniforms
+    const uint32_t hairVolumePool = static_cast<Core::HairVoxelizationPass*>(m_passes[HAIR_VOXELIZATION_PASS])->get_pool_revision();
+    if (hairVolumePool != m_hairVolumePool)
+    {
+        static_cast<Core::ForwardPass*>(m_passes[FORWARD_PASS])
+            ->set_hair_volume_descriptor(Core::ResourceManager::HAIR_PERECEIVED_DENSITY_VOLUME, Core::ResourceManager::HAIR_BRICK_GRID);
+        m_hairVolumePool = hairVolumePool;
     }
 
     m_passes[FORWARD_PASS]->set_attachment_clear_value({m_settings.clearColor.r, m_settings.clearColor.g, m_settings.clearColor.b, m_settings.clearColor.a}, 0);
@@ -39,18 +47,22 @@ void ForwardRenderer::create_passes() {
     const uint32_t SHADOW_RES          = (uint32_t)m_shadowQuality;
     const uint32_t totalImagesInFlight = (uint32_t)m_settings.bufferingType + 1;
 
-    m_passes.resize(7, nullptr);
+    m_passes.resize(8, nullptr);
+    // Strand Culling Pass. Every pass drawing strands consumes its output
+    m_passes[STRAND_CULLING_PASS] = new Core::StrandCullingPass(m_device);
+
     // Shadow Pass
     m_passes[SHADOW_PASS] = new Core::VarianceShadowPass(m_device, {SHADOW_RES, SHADOW_RES}, ENGINE_MAX_LIGHTS, m_settings.depthFormat);
 
     // Hair Related Passes
     m_passes[HAIR_SCATTER_PASS] = new Core::HairScatteringPass(m_device, 128);
-    m_passes[HAIR_VOXELIZATION_PASS] = new Core::HairVoxelizationPass(m_device, 128);
+    m_passes[HAIR_VOXELIZATION_PASS] = new Core::HairVoxelizationPass(m_device, 256);
     //  m_passes[HAIR_VOXELIZATION_PASS] ->set_active(false);
 
     // Forward Pass
     m_passes[FORWARD_PASS] = new Core::ForwardPass(m_device, m_window->get_extent(), SRGBA_32F, m_settings.depthFormat, m_settings.samplesMSAA, false);
     m_passes[FORWARD_PASS]->set_image_dependace_table({{iVec2(SHADOW_PASS, 0), {0}}});
+    set_strand_vertex_pulling(m_strandVertexPulling);
 
     // Bloom Pass
     m_passes[BLOOM_PASS] = new Core::BloomPass(m_device, m_window->get_extent(), Core::ResourceManager::VIGNETTE);
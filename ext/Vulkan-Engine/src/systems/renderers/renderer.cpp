@@ -8,6 +8,12 @@
 
 */
 #include <engine/systems/renderers/renderer.h>
+#include <engine/graphics/utilities/job_system.h>
+#include <engine/tools/writers.h>
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
 
 VULKAN_ENGINE_NAMESPACE_BEGIN
 
@@ -16,6 +22,9 @@ void BaseRenderer::init() {
 
     if (!m_window->initialized())
         m_window->init();
+    // Nothing to draw an overlay on
+    if (m_window->get_windowing_system() == WindowingSystem::HEADLESS)
+        m_settings.enableUI = false;
 
     // Init Vulkan Device
     void* windowHandle{nullptr};
@@ -32,13 +41,7 @@ void BaseRenderer::init() {
     // User defined renderpasses
     create_passes();
     // Init renderpasses
-    for (Core::BasePass* pass : m_passes)
-    {
-        if (pass->is_active())
-        {
-            pass->setup(m_frames);
-        }
-    };
+    setup_passes();
     // Connect renderpasses
     for (Core::BasePass* pass : m_passes)
     {
@@ -107,6 +110,10 @@ void BaseRenderer::create_passes() {
 void BaseRenderer::on_before_render(Core::Scene* const scene) {
     PROFILING_EVENT()
 
+    // Assets finished in the background join the scene here, never while it is being read
+    Graphics::JobSystem::get().run_main_thread_tasks();
+
+    m_frames[m_currentFrame].uniformStats = {};
     Core::ResourceManager::update_global_data(m_device, &m_frames[m_currentFrame], scene, m_window);
     Core::ResourceManager::update_object_data(
         m_device, &m_frames[m_currentFrame], scene, m_window, m_settings.enableRaytracing);
@@ -150,24 +157,67 @@ void BaseRenderer::render(Core::Scene* const scene) {
     } else if (result != RenderResult::SUCCESS && result != RenderResult::SUBOPTIMAL_KHR)
     { throw VKFW_Exception("failed to acquire swap chain image!"); }
 
+    // The fence is signaled, so the timestamps this frame wrote last time are ready
+    Graphics::TimestampPool& timestamps = m_frames[m_currentFrame].timestamps;
+    std::vector<double>      passTimes;
+    if (timestamps.read(passTimes))
+    {
+        m_passTimes.assign(m_passes.size(), 0.0);
+        for (size_t i = 0; i < passTimes.size(); i++)
+            m_passTimes[timestamps.passes[i]] = passTimes[i];
+    }
+
     on_before_render(scene);
 
     m_device->start_frame(m_frames[m_currentFrame]);
+    Graphics::CommandBuffer& cmd = m_frames[m_currentFrame].commandBuffer;
+    timestamps.passes.clear();
+    if (timestamps.handle)
+        cmd.reset_queries(timestamps.handle, 0, timestamps.capacity * 2);
 
     if (scene->get_skybox())
         Core::ResourceManager::generate_skybox_maps(&m_frames[m_currentFrame], scene);
 
-    for (Core::BasePass* pass : m_passes)
+    for (size_t i = 0; i < m_passes.size(); i++)
     {
-        if (pass->is_active())
-            pass->render(m_frames[m_currentFrame], scene, imageIndex);
+        if (!m_passes[i]->is_active())
+            continue;
+        const bool     timed = timestamps.handle && timestamps.passes.size() < timestamps.capacity;
+        const uint32_t pair  = static_cast<uint32_t>(timestamps.passes.size());
+        if (timed)
+        {
+            cmd.write_timestamp(timestamps.handle, pair * 2, STAGE_TOP_OF_PIPE);
+            timestamps.passes.push_back(static_cast<uint32_t>(i));
+        }
+        m_passes[i]->render(m_frames[m_currentFrame], scene, imageIndex);
+        if (timed)
+            cmd.write_timestamp(timestamps.handle, pair * 2 + 1, STAGE_BOTTOM_OF_PIPE);
     }
 
     RenderResult renderResult = m_device->submit_frame(m_frames[m_currentFrame], imageIndex);
+    m_lastImageIndex          = imageIndex;
 
     on_after_render(renderResult, scene);
 }
 
+bool BaseRenderer::capture(const std::string& fileName) {
+    if (!m_initialized)
+        return false;
+
+    m_device->wait();
+    std::vector<uint8_t> pixels;
+    m_device->download_present_image(m_lastImageIndex, pixels);
+
+    const VkFormat format = m_device->get_swapchain().get_image_format();
+    if (format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM)
+    {
+        for (size_t i = 0; i < pixels.size(); i += 4)
+            std::swap(pixels[i], pixels[i + 2]);
+    }
+    const Extent3D extent = m_device->get_swapchain().get_present_images()[m_lastImageIndex].extent;
+    return Tools::Writers::write_image(fileName, extent.width, extent.height, pixels.data());
+}
+
 void BaseRenderer::connect_pass(Core::BasePass* const currentPass) {
     if (currentPass->get_image_dependace_table().empty())
         return;
@@ -187,6 +237,87 @@ void BaseRenderer::connect_pass(Core::BasePass* const currentPass) {
     currentPass->link_previous_images(images);
 }
 
+void BaseRenderer::setup_passes() {
+    typedef std::chrono::high_resolution_clock Clock;
+    struct ShaderJob {
+        Core::BasePass*       pass;
+        Graphics::ShaderPass* shaderPass;
+        double                milliseconds;
+    };
+
+    // Framebuffers and descriptor layouts first. Pipeline layouts depend on the latter, so nothing is built until every pass
+    // has been set up
+    std::vector<ShaderJob>                      jobs;
+    std::unordered_map<Core::BasePass*, double> setupTimes;
+    const auto                                  start = Clock::now();
+    for (Core::BasePass* pass : m_passes)
+    {
+        if (pass->is_active())
+        {
+            const auto passStart = Clock::now();
+            pass->setup(m_frames, false);
+            setupTimes[pass] = std::chrono::duration<double, std::milli>(Clock::now() - passStart).count();
+
+            for (auto pair : pass->get_shaderpasses())
+                jobs.push_back({pass, pair.second, 0.0});
+        }
+    };
+
+    // Shader passes are independent from each other. Workers pull them one at a time, so a few slow passes do not stall
+    // the rest. The pipeline cache is internally synchronized
+    const auto          buildStart = Clock::now();
+    std::atomic<size_t> nextJob{0};
+    std::exception_ptr  error = nullptr;
+    std::mutex          errorMutex;
+    Graphics::Utils::parallel_for(
+        std::min<size_t>(jobs.size(), std::max(1u, std::thread::hardware_concurrency())),
+        [&](size_t, size_t) {
+            for (size_t j = nextJob++; j < jobs.size(); j = nextJob++)
+            {
+                const auto jobStart = Clock::now();
+                try
+                {
+                    jobs[j].pass->build_shader_pass(jobs[j].shaderPass);
+                } catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                jobs[j].milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - jobStart).count();
+            }
+        },
+        1);
+    if (error)
+        std::rethrow_exception(error);
+
+    // Startup report
+    const auto end = Clock::now();
+    for (Core::BasePass* pass : m_passes)
+    {
+        if (!pass->is_active())
+            continue;
+        double   buildTime   = 0.0;
+        uint32_t shaderCount = 0;
+        for (const ShaderJob& job : jobs)
+        {
+            if (job.pass != pass)
+                continue;
+            buildTime += job.milliseconds;
+            shaderCount++;
+        }
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(2) << "[Startup] " << pass->get_name() << ": setup " << setupTimes[pass] << " ms, "
+               << shaderCount << " shader passes built in " << buildTime << " ms (CPU)";
+        LOG_DEBUG(report.str());
+    }
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2) << "[Startup] Passes ready in "
+           << std::chrono::duration<double, std::milli>(end - start).count() << " ms, shaders and pipelines "
+           << std::chrono::duration<double, std::milli>(end - buildStart).count() << " ms";
+    LOG_DEBUG(report.str());
+}
+
 void BaseRenderer::update_passes() {
 
     m_window->update_framebuffer();
@@ -250,7 +381,7 @@ void BaseRenderer::init_resources() {
         const size_t     globalStrideSize = (m_device->pad_uniform_buffer_size(sizeof(Graphics::CameraUniforms)) +
                                          m_device->pad_uniform_buffer_size(sizeof(Graphics::SceneUniforms)));
         Graphics::Buffer globalBuffer     = m_device->create_buffer_VMA(
-            globalStrideSize, BUFFER_USAGE_UNIFORM_BUFFER, VMA_MEMORY_USAGE_CPU_TO_GPU, (uint32_t)globalStrideSize);
+            globalStrideSize, BUFFER_USAGE_UNIFORM_BUFFER, VMA_MEMORY_USAGE_CPU_TO_GPU, (uint32_t)globalStrideSize, true);
         m_frames[i].uniformBuffers.push_back(globalBuffer);
 
         // Object Buffer
@@ -259,8 +390,13 @@ void BaseRenderer::init_resources() {
         Graphics::Buffer objectBuffer     = m_device->create_buffer_VMA(ENGINE_MAX_OBJECTS * objectStrideSize,
                                                                    BUFFER_USAGE_UNIFORM_BUFFER,
                                                                    VMA_MEMORY_USAGE_CPU_TO_GPU,
-                                                                   (uint32_t)objectStrideSize);
+                                                                   (uint32_t)objectStrideSize,
+                                                                   true);
         m_frames[i].uniformBuffers.push_back(objectBuffer);
+        m_frames[i].objectSlots.assign(ENGINE_MAX_OBJECTS, {});
+
+        if (m_settings.enableGPUTimings)
+            m_frames[i].timestamps = m_device->create_timestamp_pool(RENDERER_MAX_TIMED_PASSES);
     }
     Core::ResourceManager::init_basic_resources(m_device);
 }
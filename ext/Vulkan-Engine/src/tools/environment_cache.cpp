@@ -0,0 +1,97 @@
+#include <engine/tools/environment_cache.h>
+
+#include <engine/tools/hair_cache.h>
+#include <filesystem>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Tools {
+
+static std::string cacheDirectory = ENGINE_ENVIRONMENT_CACHE_PATH;
+
+void EnvironmentCache::set_directory(const std::string& directory) {
+    cacheDirectory = directory;
+    if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\')
+        cacheDirectory += '/';
+}
+const std::string& EnvironmentCache::get_directory() {
+    return cacheDirectory;
+}
+
+std::string
+EnvironmentCache::get_cache_path(const std::string& sourceFileName, uint32_t envResolution, uint32_t irradianceResolution, ColorFormatType format) {
+    if (cacheDirectory.empty() || sourceFileName.empty())
+        return "";
+
+    uint64_t sourceSize = 0;
+    uint64_t key        = HairCache::hash_file(sourceFileName, &sourceSize);
+    if (sourceSize == 0)
+        return "";
+    // FNV-1a over the settings
+    for (uint64_t value : {static_cast<uint64_t>(ENVIRONMENT_CACHE_VERSION),
+                           static_cast<uint64_t>(envResolution),
+                           static_cast<uint64_t>(irradianceResolution),
+                           static_cast<uint64_t>(format)})
+    {
+        key ^= value;
+        key *= 0x100000001b3ull;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.env", static_cast<unsigned long long>(key));
+    return cacheDirectory + name;
+}
+
+bool EnvironmentCache::write(const std::string& cacheFileName, const FileHeader& header, const void* envData, const void* irradianceData) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cacheFileName).parent_path(), error);
+
+    // Written through a temporary file so a crash never leaves a truncated entry behind
+    const std::string tmpFileName = cacheFileName + ".tmp";
+    {
+        std::ofstream file(tmpFileName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARN("Could not create environment cache file " + cacheFileName);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(reinterpret_cast<const char*>(envData), header.envSize);
+        file.write(reinterpret_cast<const char*>(irradianceData), header.irradianceSize);
+        if (!file.good())
+            return false;
+    }
+    std::filesystem::rename(tmpFileName, cacheFileName, error);
+    if (error)
+    {
+        std::filesystem::remove(tmpFileName, error);
+        return false;
+    }
+    return true;
+}
+
+bool EnvironmentCache::read(const std::string&           cacheFileName,
+                            const FileHeader&            expected,
+                            Graphics::Utils::MappedFile& file,
+                            const uint8_t*&              envData,
+                            const uint8_t*&              irradianceData) {
+    if (!file.open(cacheFileName) || file.size() < sizeof(FileHeader))
+        return false;
+
+    FileHeader header;
+    memcpy(&header, file.data(), sizeof(FileHeader));
+    if (header.magic != expected.magic || header.version != expected.version || header.format != expected.format ||
+        header.envResolution != expected.envResolution || header.irradianceResolution != expected.irradianceResolution ||
+        header.envSize != expected.envSize || header.irradianceSize != expected.irradianceSize ||
+        file.size() < sizeof(FileHeader) + header.envSize + header.irradianceSize)
+    {
+        file.close();
+        return false;
+    }
+    envData        = file.data() + sizeof(FileHeader);
+    irradianceData = envData + header.envSize;
+    return true;
+}
+
+} // namespace Tools
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -0,0 +1,300 @@
+#include <engine/tools/hair_cache.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Tools {
+
+uint64_t HairCache::hash_file(const std::string& fileName, uint64_t* fileSize) {
+    Graphics::Utils::MappedFile file;
+    if (!file.open(fileName))
+        return 0;
+    if (fileSize)
+        *fileSize = file.size();
+
+    const size_t          CHUNK_SIZE = 1 << 22;
+    const size_t          numChunks  = (file.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<uint32_t> chunkHashes(numChunks);
+    Graphics::Utils::parallel_for(
+        numChunks,
+        [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; chunk++)
+            {
+                const size_t offset = chunk * CHUNK_SIZE;
+                const size_t size   = std::min(CHUNK_SIZE, file.size() - offset);
+                chunkHashes[chunk] =
+                    Graphics::Utils::murmur_hash3_32(reinterpret_cast<const char*>(file.data() + offset), size, static_cast<uint32_t>(chunk));
+            }
+        },
+        1);
+
+    // FNV-1a over the chunk hashes and the file size
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto     mix  = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 0x100000001b3ull;
+        }
+    };
+    mix(file.size());
+    for (uint32_t chunkHash : chunkHashes)
+        mix(chunkHash);
+    return hash;
+}
+
+std::string HairCache::get_cache_path(const std::string& sourceFileName) {
+    size_t dotPosition = sourceFileName.find_last_of(".");
+    if (dotPosition == std::string::npos)
+        return sourceFileName + "." HAIR_CACHE_EXTENSION;
+    return sourceFileName.substr(0, dotPosition + 1) + HAIR_CACHE_EXTENSION;
+}
+
+bool HairCache::write(const std::string& cacheFileName, const Core::GeometricData& data, uint64_t sourceHash, uint64_t sourceSize) {
+    struct SectionSource {
+        SectionType type;
+        uint32_t    elementSize;
+        const void* data;
+        size_t      count;
+    };
+
+    const Graphics::Vertex* vertices = data.vertex_data();
+
+    std::vector<SectionSource> sources = {
+        {SECTION_VERTICES, sizeof(Graphics::Vertex), vertices, data.vertex_count()},
+        {SECTION_INDICES, sizeof(uint32_t), data.index_data(), data.index_count()},
+        {SECTION_STRAND_OFFSETS, sizeof(uint32_t), data.strandOffsets.data(), data.strandOffsets.size()},
+    };
+    // Quantized geometry does not need the full precision positions SSBO
+    std::vector<Vec4> positions;
+    if (data.quantized())
+    {
+        sources.push_back({SECTION_STRAND_VERTICES, sizeof(Graphics::StrandVertex), data.strand_vertex_data(), data.vertex_count()});
+        sources.push_back({SECTION_STRAND_DATA, sizeof(Graphics::StrandData), data.strand_data(), data.strand_count()});
+    } else
+    {
+        positions.resize(data.vertex_count());
+        for (size_t i = 0; i < positions.size(); i++)
+            positions[i] = Vec4(vertices[i].pos, 1.0f);
+        sources.push_back({SECTION_POSITIONS, sizeof(Vec4), positions.data(), positions.size()});
+    }
+    if (!data.strandPermutation.empty())
+        sources.push_back({SECTION_STRAND_ORDER, sizeof(uint32_t), data.strandPermutation.data(), data.strandPermutation.size()});
+    if (!data.voxelData.empty())
+        sources.push_back({SECTION_VOXELS, sizeof(Graphics::Voxel), data.voxelData.data(), data.voxelData.size()});
+    // Level of detail table, flattened
+    std::vector<float>    lodErrors;
+    std::vector<uint32_t> lodPrefixes;
+    std::vector<uint32_t> lodClusters;
+    if (!data.strandLODs.empty())
+    {
+        for (const Core::StrandLOD& lod : data.strandLODs)
+        {
+            lodErrors.push_back(lod.error);
+            lodPrefixes.insert(lodPrefixes.end(), lod.indexPrefix.begin(), lod.indexPrefix.end());
+            lodClusters.push_back(lod.clusterCount);
+        }
+        sources.push_back({SECTION_LOD_INDICES, sizeof(uint32_t), data.lod_index_data(), data.lod_index_count()});
+        sources.push_back({SECTION_LOD_ERRORS, sizeof(float), lodErrors.data(), lodErrors.size()});
+        sources.push_back({SECTION_LOD_PREFIXES, sizeof(uint32_t), lodPrefixes.data(), lodPrefixes.size()});
+        if (!data.strandClusters.empty())
+        {
+            sources.push_back({SECTION_STRAND_CLUSTERS, sizeof(Graphics::StrandCluster), data.strandClusters.data(), data.strandClusters.size()});
+            sources.push_back({SECTION_LOD_CLUSTERS, sizeof(uint32_t), lodClusters.data(), lodClusters.size()});
+        }
+    }
+
+    FileHeader header     = {};
+    memcpy(header.signature, "HAIRC", 5);
+    header.version        = HAIR_CACHE_VERSION;
+    header.sectionCount   = static_cast<uint32_t>(sources.size());
+    header.sourceHash     = sourceHash;
+    header.sourceSize     = sourceSize;
+    header.avgFiberLength = data.avgFiberLength;
+    header.vertexStride   = sizeof(Graphics::Vertex);
+    header.strandTopology = data.strandTopology;
+    header.strandSort     = data.strandSort;
+    for (int i = 0; i < 3; i++)
+    {
+        header.minCoords[i] = data.minCoords[i];
+        header.maxCoords[i] = data.maxCoords[i];
+    }
+
+    auto align = [](uint64_t offset) {
+        return (offset + HAIR_CACHE_SECTION_ALIGNMENT - 1) & ~uint64_t(HAIR_CACHE_SECTION_ALIGNMENT - 1);
+    };
+
+    std::vector<SectionEntry> sections(sources.size());
+    uint64_t                  offset = align(sizeof(FileHeader) + sizeof(SectionEntry) * sections.size());
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        sections[i].type        = sources[i].type;
+        sections[i].elementSize = sources[i].elementSize;
+        sections[i].offset      = offset;
+        sections[i].size        = static_cast<uint64_t>(sources[i].elementSize) * sources[i].count;
+        offset                  = align(offset + sections[i].size);
+    }
+
+    std::ofstream file(cacheFileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        LOG_WARN("Could not create hair cache file " + cacheFileName);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    file.write(reinterpret_cast<const char*>(sections.data()), sizeof(SectionEntry) * sections.size());
+
+    const char padding[HAIR_CACHE_SECTION_ALIGNMENT] = {};
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        file.write(padding, sections[i].offset - static_cast<uint64_t>(file.tellp()));
+        file.write(reinterpret_cast<const char*>(sources[i].data), sections[i].size);
+    }
+    file.write(padding, offset - static_cast<uint64_t>(file.tellp()));
+
+    return file.good();
+}
+
+Core::Geometry* HairCache::load(const std::string& cacheFileName, uint64_t sourceHash) {
+    std::shared_ptr<Graphics::Utils::MappedFile> file = std::make_shared<Graphics::Utils::MappedFile>();
+    if (!file->open(cacheFileName))
+        return nullptr;
+
+    // Validate header
+    if (file->size() < sizeof(FileHeader))
+        return nullptr;
+    FileHeader header;
+    memcpy(&header, file->data(), sizeof(FileHeader));
+    if (strncmp(header.signature, "HAIRC", 5) != 0 || header.version != HAIR_CACHE_VERSION || header.vertexStride != sizeof(Graphics::Vertex) ||
+        header.strandTopology > STRAND_LINE_STRIP || header.strandSort > STRAND_SORT_CENTROID)
+        return nullptr;
+    if (sourceHash != 0 && header.sourceHash != sourceHash)
+    {
+        LOG_DEBUG("Hair cache " + cacheFileName + " is stale");
+        return nullptr;
+    }
+    if (file->size() < sizeof(FileHeader) + sizeof(SectionEntry) * header.sectionCount)
+        return nullptr;
+
+    // Resolve sections
+    const SectionEntry* sections = reinterpret_cast<const SectionEntry*>(file->data() + sizeof(FileHeader));
+    const SectionEntry* table[SECTION_COUNT] = {};
+    for (uint32_t i = 0; i < header.sectionCount; i++)
+    {
+        if (sections[i].type >= SECTION_COUNT || sections[i].offset + sections[i].size > file->size() || sections[i].elementSize == 0)
+            return nullptr;
+        table[sections[i].type] = &sections[i];
+    }
+    if (!table[SECTION_VERTICES] || !table[SECTION_INDICES])
+        return nullptr;
+
+    std::shared_ptr<Core::GeometricView> view = std::make_shared<Core::GeometricView>();
+    view->vertices    = reinterpret_cast<const Graphics::Vertex*>(file->data() + table[SECTION_VERTICES]->offset);
+    view->vertexCount = table[SECTION_VERTICES]->size / sizeof(Graphics::Vertex);
+    view->indices     = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_INDICES]->offset);
+    view->indexCount  = table[SECTION_INDICES]->size / sizeof(uint32_t);
+    if (table[SECTION_POSITIONS] && table[SECTION_POSITIONS]->size == view->vertexCount * sizeof(Vec4))
+        view->positions = reinterpret_cast<const Vec4*>(file->data() + table[SECTION_POSITIONS]->offset);
+    if (table[SECTION_STRAND_VERTICES] && table[SECTION_STRAND_DATA] &&
+        table[SECTION_STRAND_VERTICES]->size == view->vertexCount * sizeof(Graphics::StrandVertex))
+    {
+        view->strandVertices = reinterpret_cast<const Graphics::StrandVertex*>(file->data() + table[SECTION_STRAND_VERTICES]->offset);
+        view->strands        = reinterpret_cast<const Graphics::StrandData*>(file->data() + table[SECTION_STRAND_DATA]->offset);
+        view->strandCount    = table[SECTION_STRAND_DATA]->size / sizeof(Graphics::StrandData);
+    }
+
+    Core::Geometry* g = new Core::Geometry();
+    // Small metadata is copied, the heavy streams stay mapped
+    if (table[SECTION_STRAND_OFFSETS])
+    {
+        const uint32_t* offsets = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_STRAND_OFFSETS]->offset);
+        g->set_strand_offsets(std::vector<uint32_t>(offsets, offsets + table[SECTION_STRAND_OFFSETS]->size / sizeof(uint32_t)));
+    }
+    if (table[SECTION_VOXELS])
+    {
+        const Graphics::Voxel* voxels = reinterpret_cast<const Graphics::Voxel*>(file->data() + table[SECTION_VOXELS]->offset);
+        g->fill_voxel_array(std::vector<Graphics::Voxel>(voxels, voxels + table[SECTION_VOXELS]->size / sizeof(Graphics::Voxel)));
+    }
+    // Level of detail table. Every level prefix has to match the strand count and end within its index stream
+    std::vector<Core::StrandLOD>         lods;
+    std::vector<Graphics::StrandCluster> clusters;
+    if (table[SECTION_LOD_INDICES] && table[SECTION_LOD_ERRORS] && table[SECTION_LOD_PREFIXES] && g->get_properties().strandOffsets.size() >= 2)
+    {
+        const size_t    levelCount  = table[SECTION_LOD_ERRORS]->size / sizeof(float);
+        const size_t    prefixCount = g->get_properties().strandOffsets.size();
+        const float*    errors      = reinterpret_cast<const float*>(file->data() + table[SECTION_LOD_ERRORS]->offset);
+        const uint32_t* prefixes    = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_LOD_PREFIXES]->offset);
+        view->lodIndices            = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_LOD_INDICES]->offset);
+        view->lodIndexCount         = table[SECTION_LOD_INDICES]->size / sizeof(uint32_t);
+        if (table[SECTION_LOD_PREFIXES]->size == levelCount * prefixCount * sizeof(uint32_t))
+        {
+            uint64_t lodIndexEnd = 0;
+            lods.resize(levelCount);
+            for (size_t level = 0; level < levelCount; level++)
+            {
+                lods[level].error = errors[level];
+                lods[level].indexPrefix.assign(prefixes + level * prefixCount, prefixes + (level + 1) * prefixCount);
+                if (level > 0)
+                {
+                    lods[level].firstIndex = static_cast<uint32_t>(lodIndexEnd);
+                    lodIndexEnd += lods[level].indexPrefix.back();
+                }
+            }
+            if (lods.empty() || lods[0].indexPrefix.back() != view->indexCount || lodIndexEnd > view->lodIndexCount)
+                lods.clear();
+        }
+        // Culling clusters. Optional, every one of them has to lie within the stream of its level
+        if (!lods.empty() && table[SECTION_STRAND_CLUSTERS] && table[SECTION_LOD_CLUSTERS] &&
+            table[SECTION_LOD_CLUSTERS]->size == levelCount * sizeof(uint32_t))
+        {
+            const Graphics::StrandCluster* first =
+                reinterpret_cast<const Graphics::StrandCluster*>(file->data() + table[SECTION_STRAND_CLUSTERS]->offset);
+            const uint32_t* counts = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_LOD_CLUSTERS]->offset);
+            clusters.assign(first, first + table[SECTION_STRAND_CLUSTERS]->size / sizeof(Graphics::StrandCluster));
+
+            size_t clusterEnd = 0;
+            for (size_t level = 0; level < levelCount && clusterEnd <= clusters.size(); level++)
+            {
+                lods[level].firstCluster = static_cast<uint32_t>(clusterEnd);
+                lods[level].clusterCount = counts[level];
+                clusterEnd += counts[level];
+
+                const uint64_t levelEnd = uint64_t(lods[level].firstIndex) + lods[level].indexPrefix.back();
+                for (size_t c = lods[level].firstCluster; c < std::min(clusterEnd, clusters.size()); c++)
+                    if (uint64_t(clusters[c].firstIndex) + clusters[c].indexCount > levelEnd)
+                        clusterEnd = SIZE_MAX;
+            }
+            if (clusterEnd != clusters.size())
+            {
+                clusters.clear();
+                for (Core::StrandLOD& lod : lods)
+                    lod.firstCluster = lod.clusterCount = 0;
+            }
+        }
+        if (lods.empty())
+        {
+            view->lodIndices    = nullptr;
+            view->lodIndexCount = 0;
+        }
+    }
+    view->owner = file;
+    g->fill(view,
+            Vec3(header.minCoords[0], header.minCoords[1], header.minCoords[2]),
+            Vec3(header.maxCoords[0], header.maxCoords[1], header.maxCoords[2]));
+    g->set_avg_fiber_length(header.avgFiberLength);
+    g->set_strand_topology(static_cast<StrandTopology>(header.strandTopology));
+    // Source strand of every strand, if they were sorted
+    const size_t strandCount = std::max<size_t>(g->get_properties().strandOffsets.size(), 1) - 1;
+    if (table[SECTION_STRAND_ORDER] && strandCount > 0 && table[SECTION_STRAND_ORDER]->size == strandCount * sizeof(uint32_t))
+    {
+        const uint32_t* order = reinterpret_cast<const uint32_t*>(file->data() + table[SECTION_STRAND_ORDER]->offset);
+        g->set_strand_permutation(std::vector<uint32_t>(order, order + strandCount), static_cast<StrandSortKey>(header.strandSort));
+    } else
+        g->set_strand_permutation({}, static_cast<StrandSortKey>(header.strandSort));
+    g->set_strand_LODs(std::move(lods), {}, std::move(clusters));
+
+    return g;
+}
+
+} // namespace Tools
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -1,6 +1,48 @@
 #include <engine/tools/loaders.h>
 
-void VKFW::Tools::Loaders::load_OBJ(Core::Mesh* const mesh, const std::string fileName, bool importMaterials, bool calculateTangents, bool overrideGeometry) {
+static VKFW::Graphics::Vertex read_OBJ_vertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index) {
+    VKFW::Graphics::Vertex vertex = {};
+
+    // Position and color
+    if (index.vertex_index >= 0)
+    {
+        vertex.pos.x = attrib.vertices[3 * index.vertex_index + 0];
+        vertex.pos.y = attrib.vertices[3 * index.vertex_index + 1];
+        vertex.pos.z = attrib.vertices[3 * index.vertex_index + 2];
+
+        if (!attrib.colors.empty())
+        {
+            vertex.color.r = attrib.colors[3 * index.vertex_index + 0];
+            vertex.color.g = attrib.colors[3 * index.vertex_index + 1];
+            vertex.color.b = attrib.colors[3 * index.vertex_index + 2];
+        }
+    }
+    // Normal
+    if (index.normal_index >= 0)
+    {
+        vertex.normal.x = attrib.normals[3 * index.normal_index + 0];
+        vertex.normal.y = attrib.normals[3 * index.normal_index + 1];
+        vertex.normal.z = attrib.normals[3 * index.normal_index + 2];
+    }
+
+    // Tangent
+    vertex.tangent = {0.0, 0.0, 0.0};
+
+    // UV
+    if (index.texcoord_index >= 0)
+    {
+        vertex.texCoord.x = attrib.texcoords[2 * index.texcoord_index + 0];
+        vertex.texCoord.y = attrib.texcoords[2 * index.texcoord_index + 1];
+    }
+    return vertex;
+}
+
+void VKFW::Tools::Loaders::load_OBJ(Core::Mesh* const mesh,
+                                    const std::string fileName,
+                                    bool              importMaterials,
+                                    bool              calculateTangents,
+                                    bool              overrideGeometry,
+                                    bool              optimizeVertexCache) {
     // std::this_thread::sleep_for(std::chrono::seconds(4)); //Debuging
 
     // Preparing output
@@ -24,105 +66,42 @@ void VKFW::Tools::Loaders::load_OBJ(Core::Mesh* const mesh, const std::string fi
         return;
     }
 
-    size_t shape_id = 0;
-    for (const tinyobj::shape_t& shape : shapes)
-    {
-        std::vector<Graphics::Vertex>                  vertices;
-        std::vector<uint32_t>                          indices;
-        std::unordered_map<Graphics::Vertex, uint32_t> uniqueVertices;
-        if (!shape.mesh.indices.empty())
-        {
-            // IS INDEXED
-            for (const tinyobj::index_t& index : shape.mesh.indices)
-            {
-                Graphics::Vertex vertex = {};
-
-                // Position and color
-                if (index.vertex_index >= 0)
-                {
-                    vertex.pos.x = attrib.vertices[3 * index.vertex_index + 0];
-                    vertex.pos.y = attrib.vertices[3 * index.vertex_index + 1];
-                    vertex.pos.z = attrib.vertices[3 * index.vertex_index + 2];
-
-                    vertex.color.r = attrib.colors[3 + index.vertex_index + 0];
-                    vertex.color.g = attrib.colors[3 + index.vertex_index + 1];
-                    vertex.color.b = attrib.colors[3 + index.vertex_index + 2];
-                }
-                // Normal
-                if (index.normal_index >= 0)
-                {
-                    vertex.normal.x = attrib.normals[3 * index.normal_index + 0];
-                    vertex.normal.y = attrib.normals[3 * index.normal_index + 1];
-                    vertex.normal.z = attrib.normals[3 * index.normal_index + 2];
-                }
-
-                // Tangent
-                vertex.tangent = {0.0, 0.0, 0.0};
-
-                // UV
-                if (index.texcoord_index >= 0)
-                {
-                    vertex.texCoord.x = attrib.texcoords[2 * index.texcoord_index + 0];
-                    vertex.texCoord.y = attrib.texcoords[2 * index.texcoord_index + 1];
-                }
-
-                // Check if the vertex is already in the map
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-
-                indices.push_back(uniqueVertices[vertex]);
-            }
-        } else
-            // NOT INDEXED
-            for (size_t i = 0; i < shape.mesh.num_face_vertices.size(); i++)
+    // Shapes are independent, each one is expanded, welded and post-processed on its own job
+    struct ShapeGeometry {
+        std::vector<Graphics::Vertex> vertices;
+        std::vector<uint32_t>         indices;
+    };
+    std::vector<ShapeGeometry> outputs(shapes.size());
+    Graphics::Utils::parallel_for(
+        shapes.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t shapeId = begin; shapeId < end; shapeId++)
             {
-                for (size_t j = 0; j < shape.mesh.num_face_vertices[i]; j++)
-                {
-                    Graphics::Vertex vertex{};
-                    size_t           vertex_index = shape.mesh.indices[i * shape.mesh.num_face_vertices[i] + j].vertex_index;
-                    // Pos
-                    if (!attrib.vertices.empty())
-                    {
-                        vertex.pos.x = attrib.vertices[3 * vertex_index + 0];
-                        vertex.pos.y = attrib.vertices[3 * vertex_index + 1];
-                        vertex.pos.z = attrib.vertices[3 * vertex_index + 2];
-                    }
-                    // Normals
-                    if (!attrib.normals.empty())
-                    {
-                        vertex.normal.x = attrib.normals[3 * vertex_index + 0];
-                        vertex.normal.y = attrib.normals[3 * vertex_index + 1];
-                        vertex.normal.z = attrib.normals[3 * vertex_index + 2];
-                    }
-                    // Tangents
-
-                    vertex.tangent = {0.0, 0.0, 0.0};
-
-                    // UV
-                    if (!attrib.texcoords.empty())
-                    {
-                        vertex.texCoord.x = attrib.texcoords[2 * vertex_index + 0];
-                        vertex.texCoord.y = attrib.texcoords[2 * vertex_index + 1];
-                    }
-                    // COLORS
-                    if (!attrib.colors.empty())
-                    {
-                        vertex.color.r = attrib.colors[3 * vertex_index + 0];
-                        vertex.color.g = attrib.colors[3 * vertex_index + 1];
-                        vertex.color.b = attrib.colors[3 * vertex_index + 2];
-                    }
-
-                    vertices.push_back(vertex);
-                }
+                const std::vector<tinyobj::index_t>& shapeIndices = shapes[shapeId].mesh.indices;
+                ShapeGeometry&                       output       = outputs[shapeId];
+
+                std::vector<Graphics::Vertex> corners(shapeIndices.size());
+                Graphics::Utils::parallel_for(
+                    corners.size(),
+                    [&](size_t first, size_t last) {
+                        for (size_t i = first; i < last; i++)
+                            corners[i] = read_OBJ_vertex(attrib, shapeIndices[i]);
+                    },
+                    4096);
+
+                weld_vertices(corners, output.vertices, output.indices);
+                if (optimizeVertexCache)
+                    optimize_vertex_cache(output.indices, output.vertices.size());
+                if (calculateTangents)
+                    compute_tangents_gram_smidt(output.vertices, output.indices);
             }
+        },
+        1);
 
-        if (calculateTangents)
-        {
-            compute_tangents_gram_smidt(vertices, indices);
-        }
+    for (ShapeGeometry& output : outputs)
+    {
+        if (output.vertices.empty())
+            continue;
 
         // if (overrideGeometry)
         // {
@@ -135,10 +114,8 @@ void VKFW::Tools::Loaders::load_OBJ(Core::Mesh* const mesh, const std::string fi
         // }
 
         Core::Geometry* g = new Core::Geometry();
-        g->fill(vertices, indices);
+        g->fill(std::move(output.vertices), std::move(output.indices));
         mesh->push_geometry(g);
-
-        shape_id++;
     }
     mesh->set_file_route(fileName);
     return;
@@ -334,19 +311,22 @@ void VKFW::Tools::Loaders::load_PLY(Core::Mesh* const mesh,
             Core::Geometry* oldGeom = mesh->get_geometry();
             if (oldGeom)
             {
-                oldGeom->fill(vertices, indices);
+                oldGeom->fill(std::move(vertices), std::move(indices));
             }
             return;
         }
 
         Core::Geometry* g = new Core::Geometry();
-        g->fill(vertices, indices);
+        g->fill(std::move(vertices), std::move(indices));
         mesh->push_geometry(g);
         mesh->set_file_route(fileName);
     } catch (const std::exception& e)
     { std::cerr << "Caught tinyply exception: " << e.what() << std::endl; }
 }
-void VKFW::Tools::Loaders::load_3D_file(Core::Mesh* const mesh, const std::string fileName, bool asynCall, bool overrideGeometry) {
+typedef std::function<void(VKFW::Core::Mesh* const, bool)> MeshDecoder;
+
+static MeshDecoder get_mesh_decoder(const std::string& fileName) {
+    using namespace VKFW::Tools;
     size_t dotPosition = fileName.find_last_of(".");
 
     if (dotPosition != std::string::npos)
@@ -355,46 +335,107 @@ void VKFW::Tools::Loaders::load_3D_file(Core::Mesh* const mesh, const std::strin
         std::string fileExtension = fileName.substr(dotPosition + 1);
 
         if (fileExtension == OBJ)
-        {
-            if (asynCall)
-            {
-                std::thread loadThread(Loaders::load_OBJ, mesh, fileName, false, true, overrideGeometry);
-                loadThread.detach();
-            } else
+            return [fileName](VKFW::Core::Mesh* const mesh, bool overrideGeometry) {
                 Loaders::load_OBJ(mesh, fileName, false, true, overrideGeometry);
-
-            return;
-        }
+            };
         if (fileExtension == PLY)
-        {
-            if (asynCall)
-            {
-                std::thread loadThread(Loaders::load_PLY, mesh, fileName, true, false, true, overrideGeometry);
-                loadThread.detach();
-            } else
+            return [fileName](VKFW::Core::Mesh* const mesh, bool overrideGeometry) {
                 Loaders::load_PLY(mesh, fileName, true, false, true, overrideGeometry);
+            };
+        if (fileExtension == HAIR)
+            return [fileName](VKFW::Core::Mesh* const mesh, bool overrideGeometry) { Loaders::load_hair(mesh, fileName.c_str()); };
+
+        std::cerr << "Unsupported file format: " << fileExtension << std::endl;
+    } else
+    {
+        std::cerr << "Invalid file name: " << fileName << std::endl;
+    }
+    return {};
+}
 
+static VKFW::Tools::Loaders::AssetHandle
+submit_mesh_load(VKFW::Core::Mesh* const mesh, std::function<void(VKFW::Core::Mesh* const)>&& decode, bool overrideGeometry) {
+    using namespace VKFW;
+    Tools::Loaders::AssetHandle load = std::make_shared<Tools::Loaders::AssetLoad>();
+    load->mesh                       = mesh;
+    load->job = Graphics::JobSystem::get().submit([load, decode = std::move(decode), overrideGeometry]() {
+        load->state = ASSET_DECODING;
+        // Decoded aside, the mesh may be in use by the renderer
+        std::shared_ptr<Core::Mesh> scratch = std::make_shared<Core::Mesh>();
+        // Caught here, the job system would only log it and the load would never leave decoding
+        try
+        {
+            decode(scratch.get());
+        } catch (const std::exception& e)
+        {
+            std::cerr << "Could not decode mesh: " << e.what() << std::endl;
+            load->state = ASSET_FAILED;
             return;
         }
-        if (fileExtension == HAIR)
+        if (scratch->get_num_geometries() == 0)
         {
-            if (asynCall)
+            load->state = ASSET_FAILED;
+            return;
+        }
+
+        Graphics::JobSystem::get().enqueue_main_thread([load, scratch, overrideGeometry]() {
+            Core::Mesh* const mesh = load->mesh;
+            if (overrideGeometry)
             {
-                std::thread loadThread(Loaders::load_hair, mesh, fileName.c_str());
-                loadThread.detach();
+                // Same result as decoding straight into the geometry, which the synchronous override does
+                if (mesh->get_geometry())
+                    mesh->get_geometry()->swap_properties(*scratch->get_geometry());
+                for (Core::Geometry* g : scratch->get_geometries())
+                    delete g;
             } else
-                Loaders::load_hair(mesh, fileName.c_str());
+            {
+                for (Core::Geometry* g : scratch->get_geometries())
+                    mesh->push_geometry(g);
+                mesh->set_file_route(scratch->get_file_route());
+            }
+            load->state = ASSET_READY_FOR_UPLOAD;
+        });
+    });
+    return load;
+}
 
-            return;
-        }
+VKFW::Tools::Loaders::AssetHandle
+VKFW::Tools::Loaders::load_mesh_async(Core::Mesh* const mesh, std::function<void(Core::Mesh* const)>&& decode) {
+    return submit_mesh_load(mesh, std::move(decode), false);
+}
 
-        std::cerr << "Unsupported file format: " << fileExtension << std::endl;
-    } else
+VKFW::Tools::Loaders::AssetHandle
+VKFW::Tools::Loaders::load_3D_file(Core::Mesh* const mesh, const std::string fileName, bool asynCall, bool overrideGeometry) {
+    MeshDecoder decode = get_mesh_decoder(fileName);
+    if (!decode || !asynCall)
     {
-        std::cerr << "Invalid file name: " << fileName << std::endl;
+        AssetHandle load = std::make_shared<AssetLoad>();
+        load->mesh       = mesh;
+        if (decode)
+            decode(mesh, overrideGeometry);
+        load->state = decode ? ASSET_READY_FOR_UPLOAD : ASSET_FAILED;
+        return load;
     }
+    return submit_mesh_load(mesh, [decode](Core::Mesh* const scratch) { decode(scratch, false); }, overrideGeometry);
 }
-void VKFW::Tools::Loaders::load_hair(Core::Mesh* const mesh, const char* fileName) {
+
+VKFW::AssetState VKFW::Tools::Loaders::AssetLoad::get_state() const {
+    const AssetState current = state.load();
+    if (current != ASSET_READY_FOR_UPLOAD)
+        return current;
+    if (mesh)
+    {
+        for (Core::Geometry* g : mesh->get_geometries())
+        {
+            if (!Core::get_VAO(g)->loadedOnGPU)
+                return current;
+        }
+    }
+    if (texture && !texture->loaded_on_GPU())
+        return current;
+    return ASSET_RESIDENT;
+}
+void VKFW::Tools::Loaders::load_hair(Core::Mesh* const mesh, const char* fileName, bool useCache, StrandSortKey sortKey) {
 
 #define HAIR_FILE_SEGMENTS_BIT 1
 #define HAIR_FILE_POINTS_BIT 2
@@ -403,13 +444,6 @@ void VKFW::Tools::Loaders::load_hair(Core::Mesh* const mesh, const char* fileNam
 #define HAIR_FILE_COLORS_BIT 16
 #define HAIR_FILE_INFO_SIZE 88
 
-    unsigned short* segments = nullptr;
-    float*          points;
-    float*          dirs;
-    float*          thickness;
-    float*          transparency;
-    float*          colors;
-
     struct Header {
         char         signature[4]; //!< This should be "HAIR"
         unsigned int hair_count;   //!< number of hair strands
@@ -424,299 +458,299 @@ void VKFW::Tools::Loaders::load_hair(Core::Mesh* const mesh, const char* fileNam
         char info[HAIR_FILE_INFO_SIZE]; //!< information about the file
     };
 
-    Header header;
+    // Try the binary cache first
+    uint64_t    sourceSize = 0;
+    uint64_t    sourceHash = 0;
+    std::string cacheFileName;
+    if (useCache)
+    {
+        sourceHash    = HairCache::hash_file(fileName, &sourceSize);
+        cacheFileName = HairCache::get_cache_path(fileName);
+        if (Core::Geometry* cached = HairCache::load(cacheFileName, sourceHash))
+        {
+            if (cached->get_properties().strandSort == sortKey)
+            {
+                mesh->push_geometry(cached);
+                mesh->set_file_route(std::string(fileName));
+                return;
+            }
+            LOG_DEBUG("Hair cache " + cacheFileName + " was built with another strand order");
+            delete cached;
+        }
+    }
 
-    header.signature[0]   = 'H';
-    header.signature[1]   = 'A';
-    header.signature[2]   = 'I';
-    header.signature[3]   = 'R';
-    header.hair_count     = 0;
-    header.point_count    = 0;
-    header.arrays         = 0; // no arrays
-    header.d_segments     = 0;
-    header.d_thickness    = 1.0f;
-    header.d_transparency = 0.0f;
-    header.d_color[0]     = 1.0f;
-    header.d_color[1]     = 1.0f;
-    header.d_color[2]     = 1.0f;
-    memset(header.info, '\0', HAIR_FILE_INFO_SIZE);
-
-    FILE* fp;
-    fp = fopen(fileName, "rb");
-    if (fp == nullptr)
-        return;
+    Graphics::Utils::ManualTimer parseTimer;
+    parseTimer.start();
 
-    // read the header
-    size_t headread = fread(&header, sizeof(Header), 1, fp);
+    // Map the whole file and view its arrays in place
+    Graphics::Utils::MappedFile file;
+    if (!file.open(fileName))
+    {
+        std::cerr << "Error opening hair file " << fileName << std::endl;
+        return;
+    }
 
     // Check if header is correctly read
-    if (headread < 1)
+    if (file.size() < sizeof(Header))
         return;
+    Header header;
+    memcpy(&header, file.data(), sizeof(Header));
 
     // Check if this is a hair file
     if (strncmp(header.signature, "HAIR", 4) != 0)
         return;
 
-    // Read segments array
-    if (header.arrays & HAIR_FILE_SEGMENTS_BIT)
+    if (!(header.arrays & HAIR_FILE_POINTS_BIT) || header.hair_count == 0)
     {
-        segments         = new unsigned short[header.hair_count];
-        size_t readcount = fread(segments, sizeof(unsigned short), header.hair_count, fp);
-        if (readcount < header.hair_count)
-        {
-            std::cerr << "Error reading segments" << std::endl;
-            return;
-        }
+        std::cerr << "Error reading points" << std::endl;
+        return;
     }
 
-    // Read points array
-    if (header.arrays & HAIR_FILE_POINTS_BIT)
+    // Arrays are stored contiguously after the header. They are not guaranteed to be 4-byte aligned (segments are 16 bit),
+    // so they are always read through memcpy.
+    const uint8_t* cursor      = file.data() + sizeof(Header);
+    const uint8_t* segmentsPtr = nullptr;
+    const uint8_t* pointsPtr   = nullptr;
+    size_t         arraysSize  = 0;
+    if (header.arrays & HAIR_FILE_SEGMENTS_BIT)
     {
-        points           = new float[header.point_count * 3];
-        size_t readcount = fread(points, sizeof(float), header.point_count * 3, fp);
-        if (readcount < header.point_count * 3)
-        {
-            std::cerr << "Error reading points" << std::endl;
-            return;
-        }
+        segmentsPtr = cursor + arraysSize;
+        arraysSize += sizeof(unsigned short) * header.hair_count;
     }
-
-    // Read thickness array
+    pointsPtr = cursor + arraysSize;
+    arraysSize += sizeof(float) * 3 * header.point_count;
+    // Thickness, transparency and colors are not consumed by the renderer, only their presence is validated
     if (header.arrays & HAIR_FILE_THICKNESS_BIT)
+        arraysSize += sizeof(float) * header.point_count;
+    if (header.arrays & HAIR_FILE_TRANSPARENCY_BIT)
+        arraysSize += sizeof(float) * header.point_count;
+    if (header.arrays & HAIR_FILE_COLORS_BIT)
+        arraysSize += sizeof(float) * 3 * header.point_count;
+    if (sizeof(Header) + arraysSize > file.size())
     {
-        thickness        = new float[header.point_count];
-        size_t readcount = fread(thickness, sizeof(float), header.point_count, fp);
-        if (readcount < header.point_count)
-        {
-            std::cerr << "Error reading thickness" << std::endl;
-            return;
-        }
+        std::cerr << "Error reading hair arrays, file is truncated" << std::endl;
+        return;
     }
 
-    // Read thickness array
-    if (header.arrays & HAIR_FILE_TRANSPARENCY_BIT)
+    // Per-strand prefix offsets, computed once. Every later pass indexes strands independently through them.
+    const size_t        hairCount = header.hair_count;
+    std::vector<size_t> pointOffsets(hairCount + 1);
+    std::vector<size_t> segmentOffsets(hairCount + 1);
+    pointOffsets[0]   = 0;
+    segmentOffsets[0] = 0;
+    for (size_t hair = 0; hair < hairCount; hair++)
     {
-        transparency     = new float[header.point_count];
-        size_t readcount = fread(transparency, sizeof(float), header.point_count, fp);
-        if (readcount < header.point_count)
-        {
-            std::cerr << "Error reading alpha" << std::endl;
-            return;
-        }
+        unsigned short segments = static_cast<unsigned short>(header.d_segments);
+        if (segmentsPtr)
+            memcpy(&segments, segmentsPtr + hair * sizeof(unsigned short), sizeof(unsigned short));
+        pointOffsets[hair + 1]   = pointOffsets[hair] + segments + 1;
+        segmentOffsets[hair + 1] = segmentOffsets[hair] + segments;
     }
-
-    // Read colors array
-    if (header.arrays & HAIR_FILE_COLORS_BIT)
+    if (pointOffsets[hairCount] > header.point_count)
     {
-        colors           = new float[header.point_count * 3];
-        size_t readcount = fread(colors, sizeof(float), header.point_count * 3, fp);
-        if (readcount < header.point_count * 3)
-        {
-            std::cerr << "Error reading colors" << std::endl;
-            return;
-        }
+        std::cerr << "Error reading segments, strands reference more points than the file has" << std::endl;
+        return;
     }
 
-    fclose(fp);
-
-    auto computeDirection = [](float* d, float& d0len, float& d1len, float const* p0, float const* p1, float const* p2) {
-        // line from p0 to p1
-        float d0[3];
-        d0[0]         = p1[0] - p0[0];
-        d0[1]         = p1[1] - p0[1];
-        d0[2]         = p1[2] - p0[2];
-        float d0lensq = d0[0] * d0[0] + d0[1] * d0[1] + d0[2] * d0[2];
-        d0len         = (d0lensq > 0) ? (float)sqrt(d0lensq) : 1.0f;
-
-        // line from p1 to p2
-        float d1[3];
-        d1[0]         = p2[0] - p1[0];
-        d1[1]         = p2[1] - p1[1];
-        d1[2]         = p2[2] - p1[2];
-        float d1lensq = d1[0] * d1[0] + d1[1] * d1[1] + d1[2] * d1[2];
-        d1len         = (d1lensq > 0) ? (float)sqrt(d1lensq) : 1.0f;
-
-        // make sure that d0 and d1 has the same length
-        d0[0] *= d1len / d0len;
-        d0[1] *= d1len / d0len;
-        d0[2] *= d1len / d0len;
-
-        // direction at p1
-        d[0]         = d0[0] + d1[0];
-        d[1]         = d0[1] + d1[1];
-        d[2]         = d0[2] + d1[2];
-        float dlensq = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
-        float dlen   = (dlensq > 0) ? (float)sqrt(dlensq) : 1.0f;
-        d[0] /= dlen;
-        d[1] /= dlen;
-        d[2] /= dlen;
-
-        // return d0len;
+    auto readPoint = [pointsPtr](size_t id) {
+        Vec3 p;
+        memcpy(&p[0], pointsPtr + id * 3 * sizeof(float), 3 * sizeof(float));
+        return p;
+    };
+    auto safeLength = [](const Vec3& v) {
+        const float lengthSq = math::dot(v, v);
+        return lengthSq > 0.0f ? std::sqrt(lengthSq) : 1.0f;
     };
 
-    auto fillDirectionArray = [=](float* dir) {
-        if (dir == nullptr || header.point_count <= 0 || points == nullptr)
-            return;
-
-        int p = 0; // point index
-        for (unsigned int i = 0; i < header.hair_count; i++)
-        {
-            int s = (segments) ? segments[i] : header.d_segments;
-            if (s > 1)
-            {
-                // direction at point1
-                float len0, len1;
-                computeDirection(&dir[(p + 1) * 3], len0, len1, &points[p * 3], &points[(p + 1) * 3], &points[(p + 2) * 3]);
-
-                // direction at point0
-                float d0[3];
-                d0[0]          = points[(p + 1) * 3] - dir[(p + 1) * 3] * len0 * 0.3333f - points[p * 3];
-                d0[1]          = points[(p + 1) * 3 + 1] - dir[(p + 1) * 3 + 1] * len0 * 0.3333f - points[p * 3 + 1];
-                d0[2]          = points[(p + 1) * 3 + 2] - dir[(p + 1) * 3 + 2] * len0 * 0.3333f - points[p * 3 + 2];
-                float d0lensq  = d0[0] * d0[0] + d0[1] * d0[1] + d0[2] * d0[2];
-                float d0len    = (d0lensq > 0) ? (float)sqrt(d0lensq) : 1.0f;
-                dir[p * 3]     = d0[0] / d0len;
-                dir[p * 3 + 1] = d0[1] / d0len;
-                dir[p * 3 + 2] = d0[2] / d0len;
-
-                // We computed the first 2 points
-                p += 2;
-
-                // Compute the direction for the rest
-                for (int t = 2; t < s; t++, p++)
-                {
-                    computeDirection(&dir[p * 3], len0, len1, &points[(p - 1) * 3], &points[p * 3], &points[(p + 1) * 3]);
-                }
+    // Pre-sized outputs, each strand writes only its own slice
+    std::vector<Graphics::Vertex> vertices(pointOffsets[hairCount]);
+    std::vector<uint32_t>         indices(segmentOffsets[hairCount] * 2);
+    std::vector<float>            fiberLengths(hairCount, 0.0f);
 
-                // direction at the last point
-                d0[0]          = -points[(p - 1) * 3] + dir[(p - 1) * 3] * len1 * 0.3333f + points[p * 3];
-                d0[1]          = -points[(p - 1) * 3 + 1] + dir[(p - 1) * 3 + 1] * len1 * 0.3333f + points[p * 3 + 1];
-                d0[2]          = -points[(p - 1) * 3 + 2] + dir[(p - 1) * 3 + 2] * len1 * 0.3333f + points[p * 3 + 2];
-                d0lensq        = d0[0] * d0[0] + d0[1] * d0[1] + d0[2] * d0[2];
-                d0len          = (d0lensq > 0) ? (float)sqrt(d0lensq) : 1.0f;
-                dir[p * 3]     = d0[0] / d0len;
-                dir[p * 3 + 1] = d0[1] / d0len;
-                dir[p * 3 + 2] = d0[2] / d0len;
-                p++;
-            } else if (s > 0)
+    // Vertex, tangent, index and fiber length expansion in a single pass over strands
+    Graphics::Utils::parallel_for(
+        hairCount,
+        [&](size_t begin, size_t end) {
+            for (size_t hair = begin; hair < end; hair++)
             {
-                // if it has a single segment
-                float d0[3];
-                d0[0]                = points[(p + 1) * 3] - points[p * 3];
-                d0[1]                = points[(p + 1) * 3 + 1] - points[p * 3 + 1];
-                d0[2]                = points[(p + 1) * 3 + 2] - points[p * 3 + 2];
-                float d0lensq        = d0[0] * d0[0] + d0[1] * d0[1] + d0[2] * d0[2];
-                float d0len          = (d0lensq > 0) ? (float)sqrt(d0lensq) : 1.0f;
-                dir[p * 3]           = d0[0] / d0len;
-                dir[p * 3 + 1]       = d0[1] / d0len;
-                dir[p * 3 + 2]       = d0[2] / d0len;
-                dir[(p + 1) * 3]     = dir[p * 3];
-                dir[(p + 1) * 3 + 1] = dir[p * 3 + 1];
-                dir[(p + 1) * 3 + 2] = dir[p * 3 + 2];
-                p += 2;
-            }
-            //*/
-        }
-    };
+                const size_t first    = pointOffsets[hair];
+                const size_t segments = segmentOffsets[hair + 1] - segmentOffsets[hair];
 
-    dirs = new float[header.point_count * 3];
-    fillDirectionArray(dirs);
-
-    std::vector<Graphics::Vertex> vertices;
-    vertices.reserve(header.point_count * 3);
-    std::vector<uint32_t> indices;
-
-    size_t index   = 0;
-    size_t pointId = 0;
-    for (size_t hair = 0; hair < header.hair_count; hair++) // Hair Fiber
-    {
-        glm::vec3 color        = {((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX};
-        size_t    max_segments = segments ? segments[hair] : header.d_segments;
-        for (size_t i = 0; i < max_segments; i++)
-        {
-            vertices.push_back({{points[pointId], points[pointId + 1], points[pointId + 2]},
-                                {0.0f, 0.0f, 0.0f},
-                                {dirs[pointId], dirs[pointId + 1], dirs[pointId + 2]},
-                                {0.0f, 0.0f},
-                                color});
-            indices.push_back(index);
-            indices.push_back(index + 1);
-            index++;
-            pointId += 3;
-        }
-        vertices.push_back({{points[pointId], points[pointId + 1], points[pointId + 2]},
-                            {0.0f, 0.0f, 0.0f},
-                            {dirs[pointId], dirs[pointId + 1], dirs[pointId + 2]},
-                            {0.0f, 0.0f},
-                            color});
-        pointId += 3;
-        index++;
-    }
+                // Stable per strand random color
+                const uint32_t seed  = Graphics::Utils::murmur_hash3_32(reinterpret_cast<const char*>(&hair), sizeof(hair));
+                const Vec3     color = Vec3((seed & 0xFF), ((seed >> 8) & 0xFF), ((seed >> 16) & 0xFF)) / 255.0f;
 
-    Core::Geometry* g = new Core::Geometry();
-    g->fill(vertices, indices);
-
-     pointId          = 0;
-    float  totalFiberLength = 0.0f;
+                for (size_t i = 0; i <= segments; i++)
+                {
+                    Graphics::Vertex& v = vertices[first + i];
+                    v.pos               = readPoint(first + i);
+                    v.normal            = Vec3(0.0f);
+                    v.texCoord          = Vec2(0.0f);
+                    v.color             = color;
+                    v.tangent           = Vec3(0.0f);
+                }
 
-    for (size_t hair = 0; hair < header.hair_count; hair++)
-    {
-        size_t max_segments = segments ? segments[hair] : header.d_segments;
+                // Tangents, same smoothing scheme as the reference fillDirectionArray
+                if (segments > 1)
+                {
+                    float len0 = 1.0f, len1 = 1.0f;
+                    for (size_t i = 1; i < segments; i++)
+                    {
+                        const Vec3 p0 = vertices[first + i - 1].pos;
+                        const Vec3 p1 = vertices[first + i].pos;
+                        const Vec3 p2 = vertices[first + i + 1].pos;
+                        Vec3       d0 = p1 - p0;
+                        Vec3       d1 = p2 - p1;
+                        len0          = safeLength(d0);
+                        len1          = safeLength(d1);
+                        // make sure that d0 and d1 has the same length
+                        d0 *= len1 / len0;
+                        const Vec3 d                = d0 + d1;
+                        vertices[first + i].tangent = d / safeLength(d);
+                        if (i == 1)
+                        {
+                            // direction at point0
+                            const Vec3 t0           = p1 - vertices[first + 1].tangent * len0 * 0.3333f - p0;
+                            vertices[first].tangent = t0 / safeLength(t0);
+                        }
+                    }
+                    // direction at the last point
+                    const Vec3 tl = vertices[first + segments].pos - vertices[first + segments - 1].pos + vertices[first + segments - 1].tangent * len1 * 0.3333f;
+                    vertices[first + segments].tangent = tl / safeLength(tl);
+                } else if (segments > 0)
+                {
+                    // if it has a single segment
+                    const Vec3 t0               = vertices[first + 1].pos - vertices[first].pos;
+                    vertices[first].tangent     = t0 / safeLength(t0);
+                    vertices[first + 1].tangent = vertices[first].tangent;
+                }
 
-        float hairLength = 0.0f;
+                // Line list indices and fiber length
+                size_t index  = segmentOffsets[hair] * 2;
+                float  length = 0.0f;
+                for (size_t i = 0; i < segments; i++)
+                {
+                    indices[index++] = static_cast<uint32_t>(first + i);
+                    indices[index++] = static_cast<uint32_t>(first + i + 1);
+                    length += math::length(vertices[first + i + 1].pos - vertices[first + i].pos);
+                }
+                fiberLengths[hair] = length;
+            }
+        },
+        256);
 
-        for (size_t i = 0; i < max_segments; i++)
-        {
-            // Read p0 and p1 directly from hair file points
-            glm::vec3 p0(points[pointId + 0], points[pointId + 1], points[pointId + 2]);
-            glm::vec3 p1(points[pointId + 3], points[pointId + 4], points[pointId + 5]);
+    float totalFiberLength = 0.0f;
+    for (float length : fiberLengths)
+        totalFiberLength += length;
 
-            hairLength += glm::length(p1 - p0);
+    std::vector<uint32_t> strandOffsets(pointOffsets.begin(), pointOffsets.end());
 
-            pointId += 3;
-        }
+    Core::Geometry* g = new Core::Geometry();
+    g->fill(std::move(vertices), std::move(indices));
+    g->set_avg_fiber_length(totalFiberLength / hairCount);
+    g->set_strand_offsets(std::move(strandOffsets));
+    g->sort_strands(sortKey);
+    // Done here rather than on upload so the cache stores the compressed streams and levels of detail too
+    g->quantize_strands();
+    g->build_strand_LODs();
 
-        totalFiberLength += hairLength;
+    parseTimer.stop();
+    LOG_DEBUG("Hair " + std::string(fileName) + ": " + std::to_string(file.size() * 1e-3 / parseTimer.get()) + " MB/s");
 
-        // last vertex for this hair
-        pointId += 3;
-    }
-    float avgFiberLength = totalFiberLength / header.hair_count;
-    g->set_avg_fiber_length(avgFiberLength);
+    if (useCache && !HairCache::write(cacheFileName, g->get_properties(), sourceHash, sourceSize))
+        LOG_WARN("Could not write hair cache for " + std::string(fileName));
 
     mesh->push_geometry(g);
     mesh->set_file_route(std::string(fileName));
 }
 
-void VKFW::Tools::Loaders::load_texture(Core::ITexture* const texture, const std::string fileName, TextureFormatType textureFormat, bool asyncCall) {
+// Set automatically teh optimal format for each type.
+// User can override it after, I he need some other more specific format ...
+static VKFW::ColorFormatType get_PNG_format(VKFW::TextureFormatType textureFormat) {
+    using namespace VKFW;
+    switch (textureFormat)
+    {
+    case TEXTURE_FORMAT_TYPE_NORMAL:
+        return RGBA_8U;
+    case TEXTURE_FORMAT_TYPE_HDR:
+        return SRGBA_16F;
+    default:
+        return SRGBA_8;
+    }
+}
+// The texture takes ownership of the decoded texels
+static void set_PNG_cache(VKFW::Core::Texture* const texture, unsigned char* imgCache, int w, int h, VKFW::TextureFormatType textureFormat) {
+    texture->set_image_cache(imgCache, {static_cast<unsigned int>(w), static_cast<unsigned int>(h), 1}, 4);
+    texture->set_format(get_PNG_format(textureFormat));
+}
+static void set_HDRi_cache(VKFW::Core::TextureHDR* const texture, float* HDRcache, int w, int h) {
+    texture->set_image_cache(HDRcache, {static_cast<unsigned int>(w), static_cast<unsigned int>(h), 1}, 4);
+    texture->set_format(VKFW::SRGBA_32F);
+}
+static void set_cooked_cache(VKFW::Core::ITexture* const texture, std::shared_ptr<VKFW::Graphics::MipChain> chain, VKFW::ColorFormatType format) {
+    const VKFW::Extent3D extent = chain->levels[0].extent;
+    texture->set_mip_chain(std::move(chain), extent, 4);
+    texture->set_format(format);
+}
+
+VKFW::Tools::Loaders::AssetHandle
+VKFW::Tools::Loaders::load_texture(Core::ITexture* const texture, const std::string fileName, TextureFormatType textureFormat, bool asyncCall) {
+    AssetHandle load = std::make_shared<AssetLoad>();
+    load->texture    = texture;
+    texture->set_file_route(fileName);
+
     size_t dotPosition = fileName.find_last_of(".");
 
     if (dotPosition != std::string::npos)
     {
 
         std::string fileExtension = fileName.substr(dotPosition + 1);
+        const bool  isHDR         = fileExtension == HDR;
 
-        if (fileExtension == PNG || fileExtension == JPG)
+        if (fileExtension == PNG || fileExtension == JPG || isHDR)
         {
-            if (asyncCall)
+            if (!asyncCall)
             {
-                std::thread loadThread(Loaders::load_PNG, static_cast<Core::Texture*>(texture), fileName, textureFormat);
-                loadThread.detach();
-            } else
-                Loaders::load_PNG(static_cast<Core::Texture*>(texture), fileName, textureFormat);
-
-            return;
-        }
-        if (fileExtension == HDR)
-        {
-            if (asyncCall)
-            {
-                std::thread loadThread(Loaders::load_HDRi, static_cast<Core::TextureHDR*>(texture), fileName);
-                loadThread.detach();
-            } else
-                Loaders::load_HDRi(static_cast<Core::TextureHDR*>(texture), fileName);
+                if (isHDR)
+                    Loaders::load_HDRi(static_cast<Core::TextureHDR*>(texture), fileName);
+                else
+                    Loaders::load_PNG(static_cast<Core::Texture*>(texture), fileName, textureFormat);
+                load->state = texture->loaded_on_CPU() ? ASSET_READY_FOR_UPLOAD : ASSET_FAILED;
+                return load;
+            }
 
-            return;
+            load->job = Graphics::JobSystem::get().submit([load, fileName, textureFormat, isHDR]() {
+                load->state = ASSET_DECODING;
+                // Cooked chains skip decoding and mipmap generation altogether
+                ColorFormatType                     format = isHDR ? SRGBA_32F : get_PNG_format(textureFormat);
+                std::shared_ptr<Graphics::MipChain> chain  = TextureCache::load(fileName, format);
+                if (chain)
+                {
+                    Graphics::JobSystem::get().enqueue_main_thread([load, chain, format]() {
+                        set_cooked_cache(load->texture, chain, format);
+                        load->state = ASSET_READY_FOR_UPLOAD;
+                    });
+                    return;
+                }
+                int   w, h, ch;
+                void* cache = isHDR ? static_cast<void*>(stbi_loadf(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha))
+                                    : static_cast<void*>(stbi_load(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha));
+                if (!cache)
+                {
+                    LOG_DEBUG("Failed to load texture file " + fileName);
+                    load->state = ASSET_FAILED;
+                    return;
+                }
+                // Texture setup is left to the main thread, the renderer checks it every frame
+                Graphics::JobSystem::get().enqueue_main_thread([load, cache, w, h, textureFormat, isHDR]() {
+                    if (isHDR)
+                        set_HDRi_cache(static_cast<Core::TextureHDR*>(load->texture), static_cast<float*>(cache), w, h);
+                    else
+                        set_PNG_cache(static_cast<Core::Texture*>(load->texture), static_cast<unsigned char*>(cache), w, h, textureFormat);
+                    load->state = ASSET_READY_FOR_UPLOAD;
+                });
+            });
+            return load;
         }
 
         std::cerr << "Unsupported file format: " << fileExtension << std::endl;
@@ -724,29 +758,24 @@ void VKFW::Tools::Loaders::load_texture(Core::ITexture* const texture, const std
     {
         std::cerr << "Invalid file name: " << fileName << std::endl;
     }
+    load->state = ASSET_FAILED;
+    return load;
 }
 
 void VKFW::Tools::Loaders::load_PNG(Core::Texture* const texture, const std::string fileName, TextureFormatType textureFormat) {
+    texture->set_file_route(fileName);
+    ColorFormatType format = get_PNG_format(textureFormat);
+    if (std::shared_ptr<Graphics::MipChain> chain = TextureCache::load(fileName, format))
+    {
+        set_cooked_cache(texture, std::move(chain), format);
+        return;
+    }
     int            w, h, ch;
     unsigned char* imgCache = nullptr;
     imgCache                = stbi_load(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha);
     if (imgCache)
     {
-        texture->set_image_cache(imgCache, {static_cast<unsigned int>(w), static_cast<unsigned int>(h), 1}, 4);
-        // Set automatically teh optimal format for each type.
-        // User can override it after, I he need some other more specific format ...
-        switch (textureFormat)
-        {
-        case TEXTURE_FORMAT_TYPE_COLOR:
-            texture->set_format(SRGBA_8);
-            break;
-        case TEXTURE_FORMAT_TYPE_NORMAL:
-            texture->set_format(RGBA_8U);
-            break;
-        case TEXTURE_FORMAT_TYPE_HDR:
-            texture->set_format(SRGBA_16F);
-            break;
-        }
+        set_PNG_cache(texture, imgCache, w, h, textureFormat);
     } else
     {
 #ifndef NDEBUG
@@ -760,13 +789,19 @@ void VKFW::Tools::Loaders::load_PNG(Core::Texture* const texture, const std::str
 }
 
 void VKFW::Tools::Loaders::load_HDRi(Core::TextureHDR* const texture, const std::string fileName) {
+    texture->set_file_route(fileName);
+    ColorFormatType format = SRGBA_32F;
+    if (std::shared_ptr<Graphics::MipChain> chain = TextureCache::load(fileName, format))
+    {
+        set_cooked_cache(texture, std::move(chain), format);
+        return;
+    }
     int    w, h, ch;
     float* HDRcache = nullptr;
     HDRcache        = stbi_loadf(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha);
     if (HDRcache)
     {
-        texture->set_image_cache(HDRcache, {static_cast<unsigned int>(w), static_cast<unsigned int>(h), 1}, 4);
-        texture->set_format(SRGBA_32F);
+        set_HDRi_cache(texture, HDRcache, w, h);
     } else
     {
 #ifndef NDEBUG
@@ -880,3 +915,195 @@ void VKFW::Tools::Loaders::compute_tangents_gram_smidt(std::vector<Graphics::Ver
             vertices[i + 2].tangent += tangent;
         }
 }
+
+// Attributes closer than these steps are welded together
+static const float WELD_POSITION_STEP = 1e-6f;
+static const float WELD_NORMAL_STEP   = 1e-4f;
+static const float WELD_UV_STEP       = 1e-6f;
+static const float WELD_COLOR_STEP    = 1.0f / 1024.0f;
+
+typedef std::array<int64_t, 11> WeldKey;
+
+// Values too large for their step are keyed on their exact bits instead, past 2^62 steps floats are already far more than a
+// step apart. Those keys lie outside the quantized range, so they never meet a quantized one
+static int64_t quantize(float value, float step) {
+    const double q = std::floor(static_cast<double>(value) / static_cast<double>(step) + 0.5);
+    if (std::abs(q) < 4611686018427387904.0) // 2^62
+        return static_cast<int64_t>(q);
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    const int64_t exact = (int64_t(1) << 62) + int64_t(bits & 0x7FFFFFFFu);
+    return (bits & 0x80000000u) ? -exact : exact;
+}
+static WeldKey get_weld_key(const VKFW::Graphics::Vertex& v) {
+    return {quantize(v.pos.x, WELD_POSITION_STEP),
+            quantize(v.pos.y, WELD_POSITION_STEP),
+            quantize(v.pos.z, WELD_POSITION_STEP),
+            quantize(v.normal.x, WELD_NORMAL_STEP),
+            quantize(v.normal.y, WELD_NORMAL_STEP),
+            quantize(v.normal.z, WELD_NORMAL_STEP),
+            quantize(v.texCoord.x, WELD_UV_STEP),
+            quantize(v.texCoord.y, WELD_UV_STEP),
+            quantize(v.color.r, WELD_COLOR_STEP),
+            quantize(v.color.g, WELD_COLOR_STEP),
+            quantize(v.color.b, WELD_COLOR_STEP)};
+}
+
+void VKFW::Tools::Loaders::weld_vertices(const std::vector<Graphics::Vertex>& corners,
+                                         std::vector<Graphics::Vertex>&       vertices,
+                                         std::vector<uint32_t>&               indices) {
+    const size_t cornerCount = corners.size();
+    vertices.clear();
+    indices.resize(cornerCount);
+    if (cornerCount == 0)
+        return;
+
+    // Hash the quantized key of every corner
+    std::vector<WeldKey>                       keys(cornerCount);
+    std::vector<std::pair<uint32_t, uint32_t>> order(cornerCount); // (hash, corner)
+    Graphics::Utils::parallel_for(
+        cornerCount,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                keys[i]  = get_weld_key(corners[i]);
+                order[i] = {Graphics::Utils::murmur_hash3_32(reinterpret_cast<const char*>(keys[i].data()), sizeof(WeldKey)),
+                            static_cast<uint32_t>(i)};
+            }
+        },
+        4096);
+
+    // Equal keys end up next to each other, first corner first. Every corner is mapped to the first corner of its key
+    std::sort(order.begin(), order.end());
+    std::vector<uint32_t> representative(cornerCount);
+    std::vector<uint32_t> runRepresentatives;
+    for (size_t run = 0; run < cornerCount;)
+    {
+        size_t runEnd = run + 1;
+        while (runEnd < cornerCount && order[runEnd].first == order[run].first)
+            runEnd++;
+
+        // Distinct keys sharing a hash are rare, a linear search over the run is enough
+        runRepresentatives.clear();
+        for (size_t i = run; i < runEnd; i++)
+        {
+            const uint32_t corner = order[i].second;
+            uint32_t       match  = corner;
+            for (uint32_t candidate : runRepresentatives)
+            {
+                if (keys[candidate] == keys[corner])
+                {
+                    match = candidate;
+                    break;
+                }
+            }
+            if (match == corner)
+                runRepresentatives.push_back(corner);
+            representative[corner] = match;
+        }
+        run = runEnd;
+    }
+
+    // Single sweep in corner order, vertices keep the order of their first use
+    std::vector<uint32_t> vertexOf(cornerCount);
+    for (size_t i = 0; i < cornerCount; i++)
+    {
+        const uint32_t first = representative[i];
+        if (first == i)
+        {
+            vertexOf[i] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(corners[i]);
+        }
+        indices[i] = vertexOf[first];
+    }
+}
+
+void VKFW::Tools::Loaders::optimize_vertex_cache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+
+    // Vertex to triangle adjacency
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        liveTriangles[indices[i]]++;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+    {
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    // Tipsify (Sander et al. 2007): fan around a vertex, then move to the youngest cached vertex that still has triangles
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool>     emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t time    = cacheSize + 1;
+    size_t   cursor  = 0;
+    int64_t  fanning = 0;
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+        {
+            const uint32_t triangle = adjacency[a];
+            if (emitted[triangle])
+                continue;
+            for (uint32_t k = 0; k < 3; k++)
+            {
+                const uint32_t v = indices[triangle * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[triangle] = true;
+        }
+
+        fanning = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            // Vertices that would leave the cache before their fan is done rank lowest
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanning      = v;
+            }
+        }
+        if (fanning >= 0)
+            continue;
+
+        // Dead end, fall back to recently used vertices and then to input order
+        while (!deadEnd.empty() && fanning < 0)
+        {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0)
+                fanning = v;
+        }
+        while (cursor < vertexCount && fanning < 0)
+        {
+            if (liveTriangles[cursor] > 0)
+                fanning = static_cast<int64_t>(cursor);
+            cursor++;
+        }
+    }
+
+    // Trailing indices of a non triangle list are left untouched
+    std::copy(output.begin(), output.end(), indices.begin());
+}
@@ -1,6 +1,12 @@
 #include <engine/tools/renderer_widget.h>
 VULKAN_ENGINE_NAMESPACE_BEGIN
 namespace Tools {
+// Uniform buffer writes of the last frame
+static void render_uniform_stats(Systems::BaseRenderer* const renderer) {
+    const Graphics::UniformStats stats = renderer->get_uniform_stats();
+    ImGui::Text("Uniform writes: %zu bytes", stats.bytesWritten);
+    ImGui::Text("Objects: %u  Materials: %u  Skipped: %u", stats.objectsWritten, stats.materialsWritten, stats.slotsSkipped);
+}
 void RendererSettingsWidget::render() {
 
     ImGui::SeparatorText("Renderer Settings");
@@ -28,6 +34,8 @@ void RendererSettingsWidget::render() {
     {
         m_renderer->set_clearcolor(glm::vec4(clearColor, 1.0f));
     }
+    ImGui::Separator();
+    render_uniform_stats(m_renderer);
 }
 } // namespace Tools
 void Tools::ForwardRendererWidget::render() {
@@ -89,6 +97,13 @@ void Tools::ForwardRendererWidget::render() {
     {
         m_renderer->set_bloom_strength(bloomIntensity);
     }
+    bool strandPulling = m_renderer->get_strand_vertex_pulling();
+    if (ImGui::Checkbox("Strand Vertex Pulling", &strandPulling))
+    {
+        m_renderer->set_strand_vertex_pulling(strandPulling);
+    }
+    ImGui::Separator();
+    Tools::render_uniform_stats(m_renderer);
 }
 // namespace Tools
 void Tools::DeferredRendererWidget::render() {
@@ -250,6 +265,8 @@ void Tools::DeferredRendererWidget::render() {
             m_renderer->set_SSR_settings(settings_SSR);
         }
     }
+    ImGui::Separator();
+    Tools::render_uniform_stats(m_renderer);
 }
 // namespace Tools
 VULKAN_ENGINE_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,642 @@
+#include <engine/tools/texture_cache.h>
+
+#include <array>
+#include <engine/graphics/utilities/utils.h>
+#include <engine/tools/hair_cache.h>
+#include <filesystem>
+#include <stb_image.h>
+#include <thread>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Tools {
+
+static std::string cacheDirectory = ENGINE_TEXTURE_CACHE_PATH;
+static bool        compression    = false;
+
+void TextureCache::set_directory(const std::string& directory) {
+    cacheDirectory = directory;
+    if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\')
+        cacheDirectory += '/';
+}
+const std::string& TextureCache::get_directory() {
+    return cacheDirectory;
+}
+void TextureCache::set_compression(bool enabled) {
+    compression = enabled;
+}
+bool TextureCache::get_compression() {
+    return compression;
+}
+
+/*
+MIP GENERATION
+*/
+static const size_t LEVEL_ALIGNMENT = 16;
+
+static bool is_compressed(ColorFormatType format) {
+    return format == SRGBA_BC1 || format == RGBA_BC1U || format == SRGBA_BC3 || format == RGBA_BC3U;
+}
+static bool is_sRGB(ColorFormatType format) {
+    return format == SRGBA_8 || format == SRGBA_BC1 || format == SRGBA_BC3;
+}
+static size_t get_level_size(ColorFormatType format, Extent3D extent) {
+    if (is_compressed(format))
+        return ((extent.width + 3) / 4) * ((extent.height + 3) / 4) * Graphics::Utils::get_block_size(format);
+    return static_cast<size_t>(extent.width) * extent.height * Graphics::Utils::get_block_size(format);
+}
+// Level offsets and extents of a full chain, largest level first
+static void layout_chain(Graphics::MipChain& chain, ColorFormatType format, Extent3D extent) {
+    const uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+    chain.levels.resize(levelCount);
+    size_t offset = 0;
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        chain.levels[level].offset = offset;
+        chain.levels[level].extent = {std::max(1u, extent.width >> level), std::max(1u, extent.height >> level), 1};
+        chain.levels[level].size   = get_level_size(format, chain.levels[level].extent);
+        offset += (chain.levels[level].size + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+    }
+    chain.data.resize(offset);
+}
+
+static const float* get_sRGB_to_linear_table() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t;
+        for (int i = 0; i < 256; i++)
+        {
+            const float c = i / 255.0f;
+            t[i]          = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table.data();
+}
+static uint8_t linear_to_sRGB(float c) {
+    // 4096 steps are enough for 8 bit outputs
+    static const std::array<uint8_t, 4097> table = [] {
+        std::array<uint8_t, 4097> t;
+        for (int i = 0; i <= 4096; i++)
+        {
+            const float l = i / 4096.0f;
+            const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            t[i]          = static_cast<uint8_t>(std::clamp(s * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+        return t;
+    }();
+    return table[static_cast<size_t>(std::clamp(c, 0.0f, 1.0f) * 4096.0f)];
+}
+
+// 2x2 box filter, edges clamped for odd sizes. Rows are filtered concurrently
+static void downsample_RGBA8(const uint8_t* src, Extent3D srcExtent, uint8_t* dst, Extent3D dstExtent, bool sRGB) {
+    const float* toLinear = get_sRGB_to_linear_table();
+    Graphics::Utils::parallel_for(
+        dstExtent.height,
+        [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                const uint8_t* row0 = src + std::min<size_t>(2 * y, srcExtent.height - 1) * srcExtent.width * 4;
+                const uint8_t* row1 = src + std::min<size_t>(2 * y + 1, srcExtent.height - 1) * srcExtent.width * 4;
+                uint8_t*       out  = dst + y * dstExtent.width * 4;
+                for (size_t x = 0; x < dstExtent.width; x++)
+                {
+                    const size_t x0 = std::min<size_t>(2 * x, srcExtent.width - 1) * 4;
+                    const size_t x1 = std::min<size_t>(2 * x + 1, srcExtent.width - 1) * 4;
+                    for (size_t c = 0; c < 4; c++)
+                    {
+                        if (sRGB && c < 3)
+                            out[x * 4 + c] =
+                                linear_to_sRGB((toLinear[row0[x0 + c]] + toLinear[row0[x1 + c]] + toLinear[row1[x0 + c]] + toLinear[row1[x1 + c]]) * 0.25f);
+                        else
+                            out[x * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+                    }
+                }
+            }
+        },
+        16);
+}
+static void downsample_RGBA32F(const float* src, Extent3D srcExtent, float* dst, Extent3D dstExtent) {
+    Graphics::Utils::parallel_for(
+        dstExtent.height,
+        [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                const float* row0 = src + std::min<size_t>(2 * y, srcExtent.height - 1) * srcExtent.width * 4;
+                const float* row1 = src + std::min<size_t>(2 * y + 1, srcExtent.height - 1) * srcExtent.width * 4;
+                float*       out  = dst + y * dstExtent.width * 4;
+                for (size_t x = 0; x < dstExtent.width; x++)
+                {
+                    const size_t x0 = std::min<size_t>(2 * x, srcExtent.width - 1) * 4;
+                    const size_t x1 = std::min<size_t>(2 * x + 1, srcExtent.width - 1) * 4;
+                    for (size_t c = 0; c < 4; c++)
+                        out[x * 4 + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) * 0.25f;
+                }
+            }
+        },
+        16);
+}
+
+/*
+BLOCK COMPRESSION
+*/
+static uint16_t pack_565(const uint8_t* c) {
+    return static_cast<uint16_t>(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+static void unpack_565(uint16_t v, uint8_t* c) {
+    c[0] = static_cast<uint8_t>(((v >> 11) & 31) * 255 / 31);
+    c[1] = static_cast<uint8_t>(((v >> 5) & 63) * 255 / 63);
+    c[2] = static_cast<uint8_t>((v & 31) * 255 / 31);
+}
+static void get_color_palette(uint16_t c0, uint16_t c1, bool fourColors, uint8_t palette[4][4]) {
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        if (fourColors)
+        {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c] + 1) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+        } else
+        {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c] + 1) / 2);
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3]                                 = fourColors ? 255 : 0;
+}
+// Bounding box endpoints, slightly inset, and nearest palette entry per texel
+static void encode_color_block(const uint8_t texels[16][4], uint8_t* out) {
+    uint8_t minColor[3] = {255, 255, 255};
+    uint8_t maxColor[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            minColor[c] = std::min(minColor[c], texels[i][c]);
+            maxColor[c] = std::max(maxColor[c], texels[i][c]);
+        }
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        const uint8_t inset = static_cast<uint8_t>((maxColor[c] - minColor[c]) >> 4);
+        minColor[c]         = static_cast<uint8_t>(minColor[c] + inset);
+        maxColor[c]         = static_cast<uint8_t>(maxColor[c] - inset);
+    }
+
+    uint16_t c0 = pack_565(maxColor);
+    uint16_t c1 = pack_565(minColor);
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    uint32_t indices = 0;
+    if (c0 != c1)
+    {
+        uint8_t palette[4][4];
+        get_color_palette(c0, c1, true, palette);
+        for (int i = 0; i < 16; i++)
+        {
+            uint32_t best         = 0;
+            int      bestDistance = INT32_MAX;
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                const int dr       = texels[i][0] - palette[p][0];
+                const int dg       = texels[i][1] - palette[p][1];
+                const int db       = texels[i][2] - palette[p][2];
+                const int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best         = p;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+    }
+    memcpy(out, &c0, 2);
+    memcpy(out + 2, &c1, 2);
+    memcpy(out + 4, &indices, 4);
+}
+static void get_alpha_palette(uint8_t a0, uint8_t a1, uint8_t palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+    } else
+    {
+        for (int i = 1; i < 5; i++)
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+static void encode_alpha_block(const uint8_t texels[16][4], uint8_t* out) {
+    uint8_t a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        a0 = std::max(a0, texels[i][3]);
+        a1 = std::min(a1, texels[i][3]);
+    }
+    uint64_t indices = 0;
+    if (a0 != a1)
+    {
+        uint8_t palette[8];
+        get_alpha_palette(a0, a1, palette);
+        for (int i = 0; i < 16; i++)
+        {
+            uint64_t best         = 0;
+            int      bestDistance = INT32_MAX;
+            for (uint64_t p = 0; p < 8; p++)
+            {
+                const int distance = std::abs(texels[i][3] - palette[p]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best         = p;
+                }
+            }
+            indices |= best << (3 * i);
+        }
+    }
+    out[0] = a0;
+    out[1] = a1;
+    memcpy(out + 2, &indices, 6);
+}
+
+static void encode_level(const uint8_t* src, Extent3D extent, uint8_t* dst, bool withAlpha) {
+    const size_t blocksX   = (extent.width + 3) / 4;
+    const size_t blocksY   = (extent.height + 3) / 4;
+    const size_t blockSize = withAlpha ? 16 : 8;
+    Graphics::Utils::parallel_for(
+        blocksY,
+        [&](size_t begin, size_t end) {
+            uint8_t texels[16][4];
+            for (size_t by = begin; by < end; by++)
+            {
+                for (size_t bx = 0; bx < blocksX; bx++)
+                {
+                    // Edge blocks repeat the last row / column
+                    for (size_t i = 0; i < 16; i++)
+                    {
+                        const size_t x = std::min<size_t>(bx * 4 + i % 4, extent.width - 1);
+                        const size_t y = std::min<size_t>(by * 4 + i / 4, extent.height - 1);
+                        memcpy(texels[i], src + (y * extent.width + x) * 4, 4);
+                    }
+                    uint8_t* out = dst + (by * blocksX + bx) * blockSize;
+                    if (withAlpha)
+                    {
+                        encode_alpha_block(texels, out);
+                        out += 8;
+                    }
+                    encode_color_block(texels, out);
+                }
+            }
+        },
+        4);
+}
+static void decode_level(const uint8_t* src, Extent3D extent, uint8_t* dst, bool withAlpha) {
+    const size_t blocksX   = (extent.width + 3) / 4;
+    const size_t blocksY   = (extent.height + 3) / 4;
+    const size_t blockSize = withAlpha ? 16 : 8;
+    Graphics::Utils::parallel_for(
+        blocksY,
+        [&](size_t begin, size_t end) {
+            for (size_t by = begin; by < end; by++)
+            {
+                for (size_t bx = 0; bx < blocksX; bx++)
+                {
+                    const uint8_t* block = src + (by * blocksX + bx) * blockSize;
+                    uint8_t        alphaPalette[8];
+                    uint64_t       alphaIndices = 0;
+                    if (withAlpha)
+                    {
+                        get_alpha_palette(block[0], block[1], alphaPalette);
+                        memcpy(&alphaIndices, block + 2, 6);
+                        block += 8;
+                    }
+                    uint16_t c0, c1;
+                    uint32_t indices;
+                    memcpy(&c0, block, 2);
+                    memcpy(&c1, block + 2, 2);
+                    memcpy(&indices, block + 4, 4);
+                    uint8_t palette[4][4];
+                    // BC3 color blocks are always in four color mode
+                    get_color_palette(c0, c1, withAlpha || c0 > c1, palette);
+
+                    for (size_t i = 0; i < 16; i++)
+                    {
+                        const size_t x = bx * 4 + i % 4;
+                        const size_t y = by * 4 + i / 4;
+                        if (x >= extent.width || y >= extent.height)
+                            continue;
+                        uint8_t* texel = dst + (y * extent.width + x) * 4;
+                        memcpy(texel, palette[(indices >> (2 * i)) & 3], 4);
+                        if (withAlpha)
+                            texel[3] = alphaPalette[(alphaIndices >> (3 * i)) & 7];
+                    }
+                }
+            }
+        },
+        4);
+}
+
+bool TextureCache::cook(const void* texels, Extent3D extent, ColorFormatType& format, bool compress, Graphics::MipChain& chain) {
+    if (!texels || extent.width == 0 || extent.height == 0 || extent.depth > 1)
+        return false;
+    if (format != SRGBA_8 && format != RGBA_8U && format != SRGBA_32F)
+        return false;
+
+    layout_chain(chain, format, extent);
+    memcpy(chain.data.data(), texels, chain.levels[0].size);
+    for (size_t level = 1; level < chain.levels.size(); level++)
+    {
+        const Graphics::MipLevel& src = chain.levels[level - 1];
+        const Graphics::MipLevel& dst = chain.levels[level];
+        if (format == SRGBA_32F)
+            downsample_RGBA32F(reinterpret_cast<const float*>(chain.data.data() + src.offset),
+                               src.extent,
+                               reinterpret_cast<float*>(chain.data.data() + dst.offset),
+                               dst.extent);
+        else
+            downsample_RGBA8(chain.data.data() + src.offset, src.extent, chain.data.data() + dst.offset, dst.extent, format == SRGBA_8);
+    }
+    if (!compress || format == SRGBA_32F)
+        return true;
+
+    // Alpha only costs the bigger block if it is actually used
+    bool         opaque = true;
+    const size_t count  = static_cast<size_t>(extent.width) * extent.height;
+    for (size_t i = 0; i < count && opaque; i++)
+        opaque = chain.data[i * 4 + 3] == 255;
+
+    const ColorFormatType compressedFormat = opaque ? (format == SRGBA_8 ? SRGBA_BC1 : RGBA_BC1U) : (format == SRGBA_8 ? SRGBA_BC3 : RGBA_BC3U);
+    Graphics::MipChain    compressed;
+    layout_chain(compressed, compressedFormat, extent);
+    for (size_t level = 0; level < chain.levels.size(); level++)
+        encode_level(chain.data.data() + chain.levels[level].offset,
+                     chain.levels[level].extent,
+                     compressed.data.data() + compressed.levels[level].offset,
+                     !opaque);
+
+    chain  = std::move(compressed);
+    format = compressedFormat;
+    return true;
+}
+
+bool TextureCache::decompress(const Graphics::MipChain& chain, ColorFormatType& format, Graphics::MipChain& texels) {
+    if (!is_compressed(format) || chain.levels.empty())
+        return false;
+
+    const bool            withAlpha = format == SRGBA_BC3 || format == RGBA_BC3U;
+    const ColorFormatType outFormat = is_sRGB(format) ? SRGBA_8 : RGBA_8U;
+    layout_chain(texels, outFormat, chain.levels[0].extent);
+    const size_t levelCount = std::min(chain.levels.size(), texels.levels.size());
+    texels.levels.resize(levelCount);
+    for (size_t level = 0; level < levelCount; level++)
+        decode_level(chain.data.data() + chain.levels[level].offset,
+                     chain.levels[level].extent,
+                     texels.data.data() + texels.levels[level].offset,
+                     withAlpha);
+
+    format = outFormat;
+    return true;
+}
+
+/*
+KTX2
+*/
+static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+struct KTX2Header {
+    uint8_t  identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+struct KTX2Level {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// Basic data format descriptor (Khronos Data Format Specification 1.3) of the formats the cooker produces
+static std::vector<uint32_t> build_DFD(ColorFormatType format) {
+    struct Sample {
+        uint32_t bitOffset, bitLength, channel, lower, upper;
+    };
+    // Alpha is never sRGB encoded, sRGB formats flag it as linear
+    const bool          sRGB         = is_sRGB(format);
+    const uint32_t      alphaChannel = 15u | (sRGB ? 0x10u : 0u);
+    uint32_t            colorModel;
+    uint32_t            blockDimensions = 0; // Minus one, one byte per dimension
+    uint32_t            bytesPlane0;
+    std::vector<Sample> samples;
+    switch (format)
+    {
+    case SRGBA_BC1:
+    case RGBA_BC1U:
+        colorModel      = 128; // KHR_DF_MODEL_BC1A
+        blockDimensions = 3 | (3 << 8);
+        bytesPlane0     = 8;
+        samples         = {{0, 64, 1, 0, UINT32_MAX}};
+        break;
+    case SRGBA_BC3:
+    case RGBA_BC3U:
+        colorModel      = 130; // KHR_DF_MODEL_BC3
+        blockDimensions = 3 | (3 << 8);
+        bytesPlane0     = 16;
+        samples         = {{0, 64, alphaChannel, 0, UINT32_MAX}, {64, 64, 0, 0, UINT32_MAX}};
+        break;
+    case SRGBA_32F:
+        colorModel  = 1; // KHR_DF_MODEL_RGBSDA
+        bytesPlane0 = 16;
+        // Signed float samples, bounds are -1.0f and 1.0f
+        samples = {{0, 32, 0 | 0xC0, 0xBF800000, 0x3F800000},
+                   {32, 32, 1 | 0xC0, 0xBF800000, 0x3F800000},
+                   {64, 32, 2 | 0xC0, 0xBF800000, 0x3F800000},
+                   {96, 32, 15 | 0xC0, 0xBF800000, 0x3F800000}};
+        break;
+    default:
+        colorModel  = 1; // KHR_DF_MODEL_RGBSDA
+        bytesPlane0 = 4;
+        samples     = {{0, 8, 0, 0, 255}, {8, 8, 1, 0, 255}, {16, 8, 2, 0, 255}, {24, 8, alphaChannel, 0, 255}};
+        break;
+    }
+
+    const uint32_t        blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);
+    dfd.push_back(0);                     // Khronos vendor, basic descriptor type
+    dfd.push_back(2 | (blockSize << 16)); // Version 1.3
+    dfd.push_back(colorModel | (1 << 8) | ((sRGB ? 2u : 1u) << 16)); // BT.709 primaries, sRGB or linear transfer
+    dfd.push_back(blockDimensions);
+    dfd.push_back(bytesPlane0);
+    dfd.push_back(0);
+    for (const Sample& s : samples)
+    {
+        dfd.push_back(s.bitOffset | ((s.bitLength - 1) << 16) | (s.channel << 24));
+        dfd.push_back(0);
+        dfd.push_back(s.lower);
+        dfd.push_back(s.upper);
+    }
+    return dfd;
+}
+
+bool TextureCache::write_KTX2(const std::string& fileName, ColorFormatType format, const Graphics::MipChain& chain) {
+    if (chain.levels.empty())
+        return false;
+
+    const std::vector<uint32_t> dfd        = build_DFD(format);
+    const uint32_t              levelCount = static_cast<uint32_t>(chain.levels.size());
+
+    KTX2Header header = {};
+    memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat      = static_cast<uint32_t>(format);
+    header.typeSize      = format == SRGBA_32F ? 4 : 1;
+    header.pixelWidth    = chain.levels[0].extent.width;
+    header.pixelHeight   = chain.levels[0].extent.height;
+    header.faceCount     = 1;
+    header.levelCount    = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(KTX2Header) + sizeof(KTX2Level) * levelCount);
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // The specification stores the smallest level first
+    std::vector<KTX2Level> levels(levelCount);
+    size_t                 offset = header.dfdByteOffset + header.dfdByteLength;
+    for (uint32_t level = levelCount; level-- > 0;)
+    {
+        offset                               = (offset + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+        levels[level].byteOffset             = offset;
+        levels[level].byteLength             = chain.levels[level].size;
+        levels[level].uncompressedByteLength = chain.levels[level].size;
+        offset += chain.levels[level].size;
+    }
+
+    std::vector<uint8_t> file(offset, 0);
+    memcpy(file.data(), &header, sizeof(KTX2Header));
+    memcpy(file.data() + sizeof(KTX2Header), levels.data(), sizeof(KTX2Level) * levelCount);
+    memcpy(file.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+    for (uint32_t level = 0; level < levelCount; level++)
+        memcpy(file.data() + levels[level].byteOffset, chain.data.data() + chain.levels[level].offset, chain.levels[level].size);
+
+    // Written through a temporary file so concurrent loads never see partial entries
+    std::stringstream tmpPath;
+    tmpPath << fileName << "." << std::hash<std::thread::id>{}(std::this_thread::get_id()) << ".tmp";
+    {
+        std::ofstream out(tmpPath.str(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(reinterpret_cast<const char*>(file.data()), file.size());
+        if (!out)
+            return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(tmpPath.str(), fileName, error);
+    if (error)
+    {
+        std::filesystem::remove(tmpPath.str(), error);
+        return false;
+    }
+    return true;
+}
+
+bool TextureCache::read_KTX2(const std::string& fileName, ColorFormatType& format, Graphics::MipChain& chain) {
+    Graphics::Utils::MappedFile file;
+    if (!file.open(fileName) || file.size() < sizeof(KTX2Header))
+        return false;
+
+    KTX2Header header;
+    memcpy(&header, file.data(), sizeof(KTX2Header));
+    if (memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0 || header.supercompressionScheme != 0 ||
+        header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.levelCount == 0 ||
+        sizeof(KTX2Header) + sizeof(KTX2Level) * header.levelCount > file.size())
+        return false;
+
+    std::vector<KTX2Level> levels(header.levelCount);
+    memcpy(levels.data(), file.data() + sizeof(KTX2Header), sizeof(KTX2Level) * header.levelCount);
+
+    // Keep the file order, the copy regions point at each level wherever it is
+    size_t first = file.size();
+    for (const KTX2Level& level : levels)
+    {
+        if (level.byteOffset + level.byteLength > file.size() || level.byteOffset % LEVEL_ALIGNMENT != 0)
+            return false;
+        first = std::min<size_t>(first, level.byteOffset);
+    }
+    format = static_cast<ColorFormatType>(header.vkFormat);
+    chain.data.assign(file.data() + first, file.data() + file.size());
+    chain.levels.resize(header.levelCount);
+    for (uint32_t level = 0; level < header.levelCount; level++)
+    {
+        chain.levels[level].offset = levels[level].byteOffset - first;
+        chain.levels[level].size   = levels[level].byteLength;
+        chain.levels[level].extent = {std::max(1u, header.pixelWidth >> level), std::max(1u, header.pixelHeight >> level), 1};
+        if (chain.levels[level].size < get_level_size(format, chain.levels[level].extent))
+            return false;
+    }
+    return true;
+}
+
+std::shared_ptr<Graphics::MipChain> TextureCache::load(const std::string& fileName, ColorFormatType& format) {
+    if (cacheDirectory.empty() || (format != SRGBA_8 && format != RGBA_8U && format != SRGBA_32F))
+        return nullptr;
+
+    uint64_t sourceSize = 0;
+    uint64_t key        = HairCache::hash_file(fileName, &sourceSize);
+    if (key == 0 && sourceSize == 0)
+        return nullptr;
+    // Only LDR color data is compressed, normal maps and such would lose too much
+    const bool compress = compression && format == SRGBA_8;
+    // FNV-1a over the settings
+    for (uint64_t value : {static_cast<uint64_t>(TEXTURE_CACHE_VERSION), static_cast<uint64_t>(format), static_cast<uint64_t>(compress)})
+    {
+        key ^= value;
+        key *= 0x100000001b3ull;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.ktx2", static_cast<unsigned long long>(key));
+    const std::string cachePath = cacheDirectory + name;
+
+    std::shared_ptr<Graphics::MipChain> chain = std::make_shared<Graphics::MipChain>();
+    ColorFormatType                     cachedFormat;
+    if (read_KTX2(cachePath, cachedFormat, *chain))
+    {
+        format = cachedFormat;
+        return chain;
+    }
+
+    // Miss. Decode, cook and store
+    int   w, h, ch;
+    void* texels = format == SRGBA_32F ? static_cast<void*>(stbi_loadf(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha))
+                                       : static_cast<void*>(stbi_load(fileName.c_str(), &w, &h, &ch, STBI_rgb_alpha));
+    if (!texels)
+        return nullptr;
+    const bool cooked = cook(texels, {static_cast<uint32_t>(w), static_cast<uint32_t>(h), 1}, format, compress, *chain);
+    stbi_image_free(texels);
+    if (!cooked)
+        return nullptr;
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    if (error || !write_KTX2(cachePath, format, *chain))
+        LOG_WARN("Could not write texture cache entry for " + fileName);
+    return chain;
+}
+
+} // namespace Tools
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -0,0 +1,116 @@
+#include <engine/tools/volume_cache.h>
+
+#include <engine/tools/hair_cache.h>
+#include <filesystem>
+#include <glm/gtc/packing.hpp>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+namespace Tools {
+
+static std::string cacheDirectory = ENGINE_VOLUME_CACHE_PATH;
+
+void VolumeCache::set_directory(const std::string& directory) {
+    cacheDirectory = directory;
+    if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\')
+        cacheDirectory += '/';
+}
+const std::string& VolumeCache::get_directory() {
+    return cacheDirectory;
+}
+
+std::string VolumeCache::get_cache_path(const std::vector<std::string>& sources, const std::vector<uint64_t>& parameters) {
+    if (cacheDirectory.empty())
+        return "";
+
+    // FNV-1a over the source hashes and the parameters
+    uint64_t key = 0xcbf29ce484222325ull;
+    auto     mix = [&key](uint64_t value) {
+        key ^= value;
+        key *= 0x100000001b3ull;
+    };
+    mix(VOLUME_CACHE_VERSION);
+    for (const std::string& source : sources)
+    {
+        uint64_t sourceSize = 0;
+        uint64_t sourceHash = HairCache::hash_file(source, &sourceSize);
+        if (sourceSize == 0)
+            return "";
+        mix(sourceHash);
+    }
+    for (uint64_t parameter : parameters)
+        mix(parameter);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.vol", static_cast<unsigned long long>(key));
+    return cacheDirectory + name;
+}
+
+void VolumeCache::to_half(const float* src, size_t count, std::vector<uint16_t>& dst) {
+    dst.resize(count);
+    Graphics::Utils::parallel_for(
+        count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+                dst[i] = static_cast<uint16_t>(math::packHalf1x16(src[i]));
+        },
+        1 << 16);
+}
+
+bool VolumeCache::write(const std::string& cacheFileName, ColorFormatType format, Extent3D extent, const void* data, size_t size) {
+    FileHeader header = {};
+    header.format     = format;
+    header.width      = extent.width;
+    header.height     = extent.height;
+    header.depth      = extent.depth;
+    header.dataSize   = size;
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cacheFileName).parent_path(), error);
+
+    // Written through a temporary file so a crash never leaves a truncated entry behind
+    const std::string tmpFileName = cacheFileName + ".tmp";
+    {
+        std::ofstream file(tmpFileName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARN("Could not create volume cache file " + cacheFileName);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(reinterpret_cast<const char*>(data), size);
+        if (!file.good())
+            return false;
+    }
+    std::filesystem::rename(tmpFileName, cacheFileName, error);
+    if (error)
+    {
+        std::filesystem::remove(tmpFileName, error);
+        return false;
+    }
+    return true;
+}
+
+bool VolumeCache::read(const std::string& cacheFileName, Graphics::Utils::MappedFile& file, ColorFormatType& format, Extent3D& extent, const uint8_t*& data) {
+    if (cacheFileName.empty() || !file.open(cacheFileName) || file.size() < sizeof(FileHeader))
+        return false;
+
+    FileHeader header;
+    memcpy(&header, file.data(), sizeof(FileHeader));
+    const uint64_t expectedSize =
+        uint64_t(header.width) * header.height * header.depth * Graphics::Utils::get_block_size(static_cast<ColorFormatType>(header.format));
+    if (header.magic != VOLUME_CACHE_MAGIC || header.version != VOLUME_CACHE_VERSION || header.dataSize != expectedSize ||
+        file.size() < sizeof(FileHeader) + header.dataSize)
+    {
+        file.close();
+        return false;
+    }
+    format = static_cast<ColorFormatType>(header.format);
+    extent = {header.width, header.height, header.depth};
+    data   = file.data() + sizeof(FileHeader);
+    return true;
+}
+
+} // namespace Tools
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -241,6 +241,18 @@ void SceneExplorerWidget::render() {
             m_scene->set_fog_intensity(fogDensity);
         }
     }
+    ImGui::SeparatorText("Strand Picking");
+    ImGui::Checkbox("Ctrl + Click Picks Strands", &m_strandPicking);
+    if (m_strandPicking)
+    {
+        pick_strand();
+        if (m_pickedStrand.valid() && m_selectedObject)
+            ImGui::Text("%s: strand %u (source %u), segment %u",
+                        m_selectedObject->get_name().c_str(),
+                        m_pickedStrand.strand,
+                        m_pickedSourceStrand,
+                        m_pickedStrand.segment);
+    }
     ImGui::SeparatorText("Accel. Structures");
     if (ImGui::Button("Update"))
     {
@@ -262,12 +274,7 @@ void SceneExplorerWidget::displayObject(Object3D* const obj, int& counter) {
     {
         // node->selected = ImGui::IsItemClicked();
         if (ImGui::IsItemClicked())
-        {
-            if (m_selectedObject)
-                m_selectedObject->set_selected(false);
-            m_selectedObject = obj;
-            obj->set_selected(true);
-        }
+            select(obj);
     };
 
     ImGui::TableNextColumn();
@@ -284,6 +291,63 @@ void SceneExplorerWidget::displayObject(Object3D* const obj, int& counter) {
         displayObject(child, counter);
     ImGui::Unindent();
 }
+void SceneExplorerWidget::select(Object3D* const obj) {
+    if (m_selectedObject)
+        m_selectedObject->set_selected(false);
+    m_selectedObject = obj;
+    obj->set_selected(true);
+}
+void SceneExplorerWidget::pick_strand() {
+    ImGuiIO& io     = ImGui::GetIO();
+    Camera*  camera = m_scene->get_active_camera();
+    if (!camera || io.WantCaptureMouse || !io.KeyCtrl || !ImGui::IsMouseClicked(ImGuiMouseButton_Left) || io.DisplaySize.y <= 0.0f)
+        return;
+
+    // Projection already flips Y for Vulkan, so normalized device coordinates follow the screen
+    const Vec2 ndc         = Vec2(io.MousePos.x / io.DisplaySize.x, io.MousePos.y / io.DisplaySize.y) * 2.0f - 1.0f;
+    const Mat4 invViewProj = math::inverse(camera->get_projection() * camera->get_view());
+    const Vec4 nearPoint   = invViewProj * Vec4(ndc, 0.0f, 1.0f);
+    const Vec4 farPoint    = invViewProj * Vec4(ndc, 1.0f, 1.0f);
+    const Vec3 origin      = Vec3(nearPoint) / nearPoint.w;
+    const Vec3 direction   = math::normalize(Vec3(farPoint) / farPoint.w - origin);
+    // Strands within a few pixels of the cursor count as hit
+    const float pixelAngle = 2.0f * std::tan(math::radians(camera->get_field_of_view()) * 0.5f) / io.DisplaySize.y;
+
+    float     closest        = FLT_MAX;
+    Mesh*     picked         = nullptr;
+    Geometry* pickedGeometry = nullptr;
+    StrandHit pickedHit;
+    for (Mesh* mesh : m_scene->get_meshes())
+    {
+        if (!mesh->is_active())
+            continue;
+        const Mat4  invModel    = math::inverse(mesh->get_model_matrix());
+        const Vec3  localOrigin = Vec3(invModel * Vec4(origin, 1.0f));
+        const Vec3  localDir    = Vec3(invModel * Vec4(direction, 0.0f));
+        const float localScale  = math::length(localDir); // Object units per world unit
+        const float radius      = 3.0f * pixelAngle * math::length(mesh->get_position() - origin) * localScale;
+        for (Geometry* g : mesh->get_geometries())
+        {
+            if (!g || g->get_properties().strandOffsets.empty())
+                continue;
+            const StrandBVH* bvh = g->get_strand_BVH() ? g->get_strand_BVH() : g->build_strand_BVH();
+            if (!bvh)
+                continue;
+            const StrandHit hit = bvh->intersect(localOrigin, localDir, radius);
+            if (hit.valid() && hit.t / localScale < closest)
+            {
+                closest        = hit.t / localScale;
+                picked         = mesh;
+                pickedGeometry = g;
+                pickedHit      = hit;
+            }
+        }
+    }
+    m_pickedStrand       = pickedHit;
+    m_pickedSourceStrand = pickedGeometry && pickedHit.strand != UINT32_MAX ? pickedGeometry->get_properties().source_strand(pickedHit.strand) : UINT32_MAX;
+    if (picked)
+        select(picked);
+}
 void Profiler::render() {
     ImGui::Text(" %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 }
@@ -397,6 +461,31 @@ void ObjectExplorerWidget::render() {
 
         ImGui::EndTable();
 
+        for (size_t i = 0; i < model->get_num_geometries(); i++)
+        {
+            Geometry* g = model->get_geometry(i);
+            if (!g->has_strand_LODs())
+                continue;
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::SeparatorText("Strand LOD");
+
+            const StrandLODSelection& stats       = g->get_strand_LOD_stats();
+            const size_t              strandCount = g->get_properties().strandLODs[0].indexPrefix.size() - 1;
+            ImGui::Text("Level %u (%.4f error), %.0f px", stats.level, g->get_properties().strandLODs[stats.level].error, stats.pixels);
+            ImGui::Text("Strands %u / %zu, width x%.2f", stats.strandCount, strandCount, stats.widthScale);
+            ImGui::Text("Indices %u / %u (%s)",
+                        stats.indexCount,
+                        get_VAO(g)->indexCount,
+                        g->get_properties().strandTopology == STRAND_LINE_STRIP ? "line strips" : "line lists");
+
+            StrandLODSettings& settings = g->get_strand_LOD_settings();
+            ImGui::Checkbox("Enabled", &settings.enabled);
+            ImGui::DragFloat("Strands per pixel", &settings.strandsPerPixel, 0.01f, 0.0f, 16.0f);
+            ImGui::DragFloat("Min strand fraction", &settings.minStrandFraction, 0.005f, 0.01f, 1.0f);
+            ImGui::DragFloat("Max pixel error", &settings.maxPixelError, 0.05f, 0.0f, 8.0f);
+            ImGui::PopID();
+        }
+
         ImGui::SeparatorText("Material");
         ImGui::BeginTable("Mesh Details", 1, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_NoBordersInBody);
         ImGui::TableSetupColumn("Material", ImGuiTableColumnFlags_NoHide);
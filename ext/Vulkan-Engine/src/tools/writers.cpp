@@ -0,0 +1,116 @@
+#include <engine/tools/writers.h>
+#include <stb_image_write.h>
+
+VULKAN_ENGINE_NAMESPACE_BEGIN
+
+static void write_attribute(std::ofstream& file, const char* name, const char* type, const void* value, int32_t size) {
+    file.write(name, strlen(name) + 1);
+    file.write(type, strlen(type) + 1);
+    file.write(reinterpret_cast<const char*>(&size), sizeof(int32_t));
+    file.write(static_cast<const char*>(value), size);
+}
+
+bool Tools::Writers::write_PNG(const std::string fileName, uint32_t width, uint32_t height, const uint8_t* rgba) {
+    if (!stbi_write_png(fileName.c_str(), width, height, 4, rgba, width * 4))
+    {
+        LOG_ERROR("Could not write " + fileName);
+        return false;
+    }
+    return true;
+}
+
+bool Tools::Writers::write_EXR(const std::string fileName, uint32_t width, uint32_t height, const float* rgba) {
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        LOG_ERROR("Could not write " + fileName);
+        return false;
+    }
+
+    // Header. Channels must be listed alphabetically, which is also the order they are stored in each scanline
+    const uint8_t magic[] = {0x76, 0x2f, 0x31, 0x01};
+    const int32_t version = 2; // Single part scanline file
+    file.write(reinterpret_cast<const char*>(magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&version), sizeof(int32_t));
+
+    const char        channelNames[]  = {'A', 'B', 'G', 'R'};
+    const uint32_t    channelOffset[] = {3, 2, 1, 0};
+    std::vector<char> channels;
+    for (char name : channelNames)
+    {
+        const int32_t pixelType   = 2; // FLOAT
+        const int32_t sampling[2] = {1, 1};
+        channels.push_back(name);
+        channels.push_back('\0');
+        channels.insert(channels.end(), reinterpret_cast<const char*>(&pixelType), reinterpret_cast<const char*>(&pixelType) + 4);
+        channels.insert(channels.end(), 4, '\0'); // pLinear + reserved
+        channels.insert(channels.end(), reinterpret_cast<const char*>(sampling), reinterpret_cast<const char*>(sampling) + 8);
+    }
+    channels.push_back('\0');
+
+    const uint8_t noCompression = 0;
+    const uint8_t increasingY   = 0;
+    const int32_t window[4]     = {0, 0, static_cast<int32_t>(width) - 1, static_cast<int32_t>(height) - 1};
+    const float   aspectRatio   = 1.0f;
+    const float   center[2]     = {0.0f, 0.0f};
+    write_attribute(file, "channels", "chlist", channels.data(), static_cast<int32_t>(channels.size()));
+    write_attribute(file, "compression", "compression", &noCompression, 1);
+    write_attribute(file, "dataWindow", "box2i", window, sizeof(window));
+    write_attribute(file, "displayWindow", "box2i", window, sizeof(window));
+    write_attribute(file, "lineOrder", "lineOrder", &increasingY, 1);
+    write_attribute(file, "pixelAspectRatio", "float", &aspectRatio, sizeof(float));
+    write_attribute(file, "screenWindowCenter", "v2f", center, sizeof(center));
+    write_attribute(file, "screenWindowWidth", "float", &aspectRatio, sizeof(float));
+    file.put('\0');
+
+    // Offset table, then one chunk per scanline
+    const int32_t  lineSize   = static_cast<int32_t>(width * 4 * sizeof(float));
+    const uint64_t tableStart = static_cast<uint64_t>(file.tellp());
+    const uint64_t chunkSize  = 2 * sizeof(int32_t) + lineSize;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint64_t offset = tableStart + height * sizeof(uint64_t) + y * chunkSize;
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t));
+    }
+    std::vector<float> line(width * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const int32_t lineY = static_cast<int32_t>(y);
+        file.write(reinterpret_cast<const char*>(&lineY), sizeof(int32_t));
+        file.write(reinterpret_cast<const char*>(&lineSize), sizeof(int32_t));
+        for (uint32_t c = 0; c < 4; c++)
+            for (uint32_t x = 0; x < width; x++)
+                line[c * width + x] = rgba[(static_cast<size_t>(y) * width + x) * 4 + channelOffset[c]];
+        file.write(reinterpret_cast<const char*>(line.data()), lineSize);
+    }
+
+    if (!file)
+    {
+        LOG_ERROR("Could not write " + fileName);
+        return false;
+    }
+    return true;
+}
+
+bool Tools::Writers::write_image(const std::string fileName, uint32_t width, uint32_t height, const uint8_t* rgba) {
+    const size_t dot       = fileName.find_last_of('.');
+    std::string  extension = dot == std::string::npos ? "" : fileName.substr(dot + 1);
+    for (char& c : extension)
+        c = static_cast<char>(tolower(c));
+    if (extension != "exr")
+        return write_PNG(fileName, width, height, rgba);
+
+    // sRGB to linear. Alpha is stored linearly already
+    float table[256];
+    for (int i = 0; i < 256; i++)
+    {
+        const float c = i / 255.0f;
+        table[i]      = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+    std::vector<float> linear(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < linear.size(); i++)
+        linear[i] = (i % 4 == 3) ? rgba[i] / 255.0f : table[rgba[i]];
+    return write_EXR(fileName, width, height, linear.data());
+}
+
+VULKAN_ENGINE_NAMESPACE_END
@@ -4,6 +4,19 @@
 // #define USE_NEURAL_MODELS
 
 void HairViewer::init(Systems::RendererSettings settings) {
+    if (m_headless.enabled)
+    {
+        settings.enableUI = false;
+        animateLight      = false;
+
+        m_window = new WindowHeadless("Hair Viewer", m_headless.width, m_headless.height);
+        m_window->init();
+        m_renderer = new Systems::ForwardRenderer(m_window, ShadowResolution::HIGH, settings);
+
+        setup();
+        return;
+    }
+
     m_window = new WindowGLFW("Hair Viewer", 1024, 1024);
 
     m_window->init();
@@ -22,9 +35,15 @@ void HairViewer::init(Systems::RendererSettings settings) {
     // m_renderer->set_gui_overlay(m_interface.overlay);
 }
 
-void HairViewer::run(Systems::RendererSettings settings) {
+void HairViewer::run(Systems::RendererSettings settings, HeadlessSettings headless) {
 
+    m_headless = headless;
     init(settings);
+    if (m_headless.enabled)
+    {
+        render_offline();
+        return;
+    }
     while (!m_window->get_window_should_close())
     {
 
@@ -42,15 +61,16 @@ void HairViewer::setup() {
     const std::string ENGINE_MESH_PATH(ENGINE_RESOURCES_PATH "meshes/");
 
     camera = new Camera();
-    camera->set_position(Vec3(0.0f, 0.0f, -16.0f));
+    camera->set_position(m_headless.cameraPosition);
     camera->set_far(100.0f);
     camera->set_near(0.1f);
-    camera->set_field_of_view(40.0f);
+    camera->set_field_of_view(m_headless.fov);
+    camera->set_projection(m_window->get_extent().width, m_window->get_extent().height);
 
     m_scene = new Scene(camera);
 
     PointLight* light = new PointLight();
-    light->set_position({-1.3f, 8.0f, -5.8f});
+    light->set_position(m_headless.lightPosition);
     light->set_shadow_fov(120.0f);
     light->set_intensity(1.0f);
     light->set_shadow_bias(0.0002f);
@@ -87,7 +107,7 @@ void HairViewer::setup() {
     //    {9, 6, 3}
 #else
     Mesh* hair = new Mesh();
-    Tools::Loaders::load_3D_file(hair, MESH_PATH + "curly.hair", false);
+    Tools::Loaders::load_3D_file(hair, m_headless.hairFile.empty() ? MESH_PATH + "curly.hair" : m_headless.hairFile, false);
     hair->set_scale(0.053f);
     hair->set_rotation({90.0, 180.0f, 0.0f});
     // HairDisneyMaterial* hmat = new HairDisneyMaterial();
@@ -148,7 +168,8 @@ void HairViewer::setup() {
 
     m_scene->enable_fog(false);
 
-    m_controller = new Tools::Controller(camera, m_window, ControllerMovementType::ORBITAL);
+    if (!m_headless.enabled)
+        m_controller = new Tools::Controller(camera, m_window, ControllerMovementType::ORBITAL);
 }
 
 void HairViewer::update() {
@@ -181,6 +202,20 @@ void HairViewer::tick() {
     m_interface.overlay->render();
     m_renderer->render(m_scene);
 }
+void HairViewer::render_offline() {
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < std::max(m_headless.frames, 1u); i++)
+        m_renderer->render(m_scene);
+
+    if (m_renderer->capture(m_headless.output))
+        std::cout << "Saved " << m_headless.output << " ("
+                  << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() << " ms)"
+                  << std::endl;
+    else
+        std::cerr << "Could not save " << m_headless.output << std::endl;
+
+    m_renderer->shutdown(m_scene);
+}
 void HairViewer::load_neural_avatar(const char* hairFile,
                                     const char* headFile,
                                     const char* objName,
@@ -189,9 +224,9 @@ void HairViewer::load_neural_avatar(const char* hairFile,
                                     float       rotation,
                                     bool        active) {
 
-    Mesh*       hair = new Mesh();
-    std::thread loadThread1(hair_loaders::load_neural_hair, hair, hairFile, nullptr, true, false, false, false);
-    loadThread1.detach();
+    Mesh* hair = new Mesh();
+    Tools::Loaders::load_mesh_async(
+        hair, [hairFile](Mesh* const scratch) { hair_loaders::load_neural_hair(scratch, hairFile, nullptr, true, false, false, false); });
 
     HairEpicMaterial* hmat = new HairEpicMaterial();
     hair->push_material(hmat);
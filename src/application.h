@@ -14,6 +14,21 @@ USING_VULKAN_ENGINE_NAMESPACE
 
 using namespace Core;
 
+/*
+Scene description and output of a batch (headless) render. Every frame is rendered offscreen and the last one is saved.
+*/
+struct HeadlessSettings {
+    bool        enabled{false};
+    std::string output{"render.png"}; // .png or .exr
+    uint32_t    width{1024};
+    uint32_t    height{1024};
+    uint32_t    frames{4};  // Rendered before saving, lets pending uploads land
+    std::string hairFile{}; // Defaults to the curly groom
+    Vec3        cameraPosition{0.0f, 0.0f, -16.0f};
+    float       fov{40.0f};
+    Vec3        lightPosition{-1.3f, 8.0f, -5.8f};
+};
+
 class HairViewer
 {
 
@@ -25,6 +40,8 @@ class HairViewer
     Camera*                camera;
     Tools::Controller*     m_controller;
 
+    HeadlessSettings m_headless{};
+
     bool animateLight{true};
 
     struct Time {
@@ -37,7 +54,7 @@ class HairViewer
   public:
     void init(Systems::RendererSettings settings);
 
-    void run(Systems::RendererSettings settings);
+    void run(Systems::RendererSettings settings, HeadlessSettings headless = {});
 
   private:
     void load_neural_avatar(const char* hairFile,
@@ -52,6 +69,8 @@ class HairViewer
 
     void tick();
 
+    void render_offline();
+
     void update();
 
 #pragma region Input Management
@@ -1,15 +1,70 @@
 #include "hair_loader.h"
 
+// Count and id properties may come with any integer type
+static uint32_t read_PLY_uint(const tinyply::PlyData& data, size_t i) {
+    const uint8_t* bytes = data.buffer.get_const();
+    switch (data.t)
+    {
+    case tinyply::Type::INT8:
+        return static_cast<uint32_t>(reinterpret_cast<const int8_t*>(bytes)[i]);
+    case tinyply::Type::UINT8:
+        return reinterpret_cast<const uint8_t*>(bytes)[i];
+    case tinyply::Type::INT16:
+        return static_cast<uint32_t>(reinterpret_cast<const int16_t*>(bytes)[i]);
+    case tinyply::Type::UINT16:
+        return reinterpret_cast<const uint16_t*>(bytes)[i];
+    case tinyply::Type::INT32:
+        return static_cast<uint32_t>(reinterpret_cast<const int32_t*>(bytes)[i]);
+    case tinyply::Type::UINT32:
+        return reinterpret_cast<const uint32_t*>(bytes)[i];
+    case tinyply::Type::FLOAT32:
+        return static_cast<uint32_t>(reinterpret_cast<const float*>(bytes)[i]);
+    case tinyply::Type::FLOAT64:
+        return static_cast<uint32_t>(reinterpret_cast<const double*>(bytes)[i]);
+    default:
+        return 0;
+    }
+}
+
 void hair_loaders::load_neural_hair(Core::Mesh* const mesh,
                                     const char*       fileName,
                                     Core::Mesh* const skullMesh,
                                     bool              preload,
                                     bool              verbose,
                                     bool              calculateTangents,
-                                    bool              saveOutput) {
+                                    bool              saveOutput,
+                                    bool              useCache,
+                                    StrandSortKey     sortKey) {
     std::unique_ptr<std::istream> file_stream;
     std::vector<uint8_t>          byte_buffer;
     std::string                   filePath = fileName;
+
+    // Try the binary cache first
+    uint64_t    sourceSize    = 0;
+    uint64_t    sourceHash    = 0;
+    std::string cacheFileName = Tools::HairCache::get_cache_path(filePath);
+    if (useCache)
+    {
+        sourceHash = Tools::HairCache::hash_file(filePath, &sourceSize);
+        Core::Geometry* cached = Tools::HairCache::load(cacheFileName, sourceHash);
+        if (cached && cached->get_properties().strandSort != sortKey)
+        {
+            if (verbose)
+                std::cout << "\tCache " << cacheFileName << " was built with another strand order" << std::endl;
+            delete cached;
+            cached = nullptr;
+        }
+        if (cached)
+        {
+            if (verbose)
+                std::cout << "\tLoaded from cache " << cacheFileName << std::endl;
+            cached->create_voxel_AS(true);
+            mesh->push_geometry(cached);
+            mesh->setup_volume();
+            return;
+        }
+    }
+
     try
     {
         if (preload)
@@ -52,7 +107,7 @@ void hair_loaders::load_neural_hair(Core::Mesh* const mesh,
                 }
             }
         }
-        std::shared_ptr<tinyply::PlyData> positions, normals, colors, texcoords, faces, tripstrip;
+        std::shared_ptr<tinyply::PlyData> positions, normals, strandSizes, strandIds;
 
         // // The header information can be used to programmatically extract properties on elements
         // // known to exist in the header prior to reading the data. For brevity of this sample, properties
@@ -78,79 +133,156 @@ void hair_loaders::load_neural_hair(Core::Mesh* const mesh,
                 std::cerr << "tinyply exception: " << e.what() << std::endl;
         }
 
+        // Strand boundaries, either as a per strand point count or as a per vertex strand id
+        bool sizesAreSegments = false;
+        for (const tinyply::PlyElement& e : file.get_elements())
+        {
+            for (const tinyply::PlyProperty& p : e.properties)
+            {
+                if (p.isList)
+                    continue;
+                const bool isStrandElement = e.name == "strand" || e.name == "curve" || e.name == "hair";
+                if (!strandSizes && isStrandElement &&
+                    (p.name == "vertex_count" || p.name == "num_vertices" || p.name == "point_count" || p.name == "nv" ||
+                     p.name == "segments"))
+                {
+                    strandSizes      = file.request_properties_from_element(e.name, {p.name});
+                    sizesAreSegments = p.name == "segments";
+                }
+                if (!strandIds && e.name == "vertex" && (p.name == "strand_id" || p.name == "curve_id" || p.name == "hair_id"))
+                    strandIds = file.request_properties_from_element(e.name, {p.name});
+            }
+        }
+
         Graphics::Utils::ManualTimer readTimer;
         readTimer.start();
         file.read(*file_stream);
         readTimer.stop();
 
-        if (verbose)
-        {
-            const float parsingTime = static_cast<float>(readTimer.get()) / 1000.f;
-            std::cout << "\tparsing " << size_mb << "mb in " << parsingTime << " seconds [" << (size_mb / parsingTime)
-                      << " MBps]" << std::endl;
+        if (!positions || positions->count < 2)
+            throw std::runtime_error("no strand points in " + filePath);
+        const size_t pointCount = positions->count;
 
-            if (positions)
-                std::cout << "\tRead " << positions->count << " total vertices " << std::endl;
-            if (normals)
-                std::cout << "\tRead " << normals->count << " total vertex normals " << std::endl;
+        // Per strand prefix offsets, same metadata the .hair loader produces
+        Graphics::Utils::ManualTimer convertTimer;
+        convertTimer.start();
+        std::vector<uint32_t> strandOffsets = {0};
+        if (strandSizes)
+        {
+            for (size_t i = 0; i < strandSizes->count; i++)
+            {
+                const size_t size = read_PLY_uint(*strandSizes, i) + (sizesAreSegments ? 1 : 0);
+                if (size > 0)
+                    strandOffsets.push_back(static_cast<uint32_t>(strandOffsets.back() + size));
+            }
+            if (strandOffsets.back() != pointCount)
+            {
+                std::cerr << "Strand sizes cover " << strandOffsets.back() << " of " << pointCount
+                          << " points, falling back to fixed length strands" << std::endl;
+                strandOffsets = {0};
+            }
+        } else if (strandIds)
+        {
+            for (size_t i = 1; i < pointCount; i++)
+            {
+                if (read_PLY_uint(*strandIds, i) != read_PLY_uint(*strandIds, i - 1))
+                    strandOffsets.push_back(static_cast<uint32_t>(i));
+            }
+            strandOffsets.push_back(static_cast<uint32_t>(pointCount));
+        }
+        if (strandOffsets.size() < 2)
+        {
+            for (size_t i = NEURAL_HAIR_STRAND_POINTS; i < pointCount; i += NEURAL_HAIR_STRAND_POINTS)
+                strandOffsets.push_back(static_cast<uint32_t>(i));
+            strandOffsets.push_back(static_cast<uint32_t>(pointCount));
         }
+        const size_t strandCount = strandOffsets.size() - 1;
 
-        std::vector<Graphics::Vertex> vertices;
-        std::vector<Graphics::Voxel>  voxels;
-        vertices.reserve(positions->count);
-        voxels.reserve(positions->count);
-        std::vector<unsigned int> indices;
-        // std::vector<unsigned int> rootsIndices;
+        const float* posData  = reinterpret_cast<const float*>(positions->buffer.get());
+        const float* normData = normals ? reinterpret_cast<const float*>(normals->buffer.get()) : nullptr;
 
-        if (positions)
-        {
-            // rootsIndices.push_back(0); // First index is certainly a root
-            const float* posData  = reinterpret_cast<const float*>(positions->buffer.get());
-            const float* normData = reinterpret_cast<const float*>(normals->buffer.get());
-            glm::vec3    color = {((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX};
-            for (size_t i = 0; i < positions->count - 1; i++)
-            {
-                float     x   = posData[i * 3];
-                float     y   = posData[i * 3 + 1];
-                float     z   = posData[i * 3 + 2];
-                glm::vec3 pos = {x, y, z};
-
-                float     nx     = normData[i * 3];
-                float     ny     = normData[i * 3 + 1];
-                float     nz     = normData[i * 3 + 2];
-                glm::vec3 normal = {nx, ny, nz};
-
-                // Generate hair tangents
-                float     nextX   = posData[(i + 1) * 3];
-                float     nextY   = posData[(i + 1) * 3 + 1];
-                float     nextZ   = posData[(i + 1) * 3 + 2];
-                glm::vec3 nextPos = {nextX, nextY, nextZ};
-                glm::vec3 tangent = glm::normalize(nextPos - pos);
-
-                vertices.push_back({pos, normal, tangent, {0.0f, 0.0f}, color});
-                if (i == positions->count - 2)
-                    vertices.push_back({nextPos, normal, tangent, {0.0f, 0.0f}, color});
-                if (voxels.size() < 800)
-                    voxels.push_back({pos, 0.01f});
-
-                // Change STRAND
-                if ((i + 1) % 100 != 0)
-                {
+        // Pre-sized outputs, each strand writes only its own slice. Strands are never empty, so strand s starts its
+        // segments at strandOffsets[s] - s
+        std::vector<Graphics::Vertex> vertices(pointCount);
+        std::vector<uint32_t>         indices((pointCount - strandCount) * 2);
+        std::vector<Graphics::Voxel>  voxels(strandCount);
+        std::vector<float>            fiberLengths(strandCount, 0.0f);
 
-                    indices.push_back(i);
-                    indices.push_back(i + 1);
-                } else
+        Graphics::Utils::parallel_for(
+            strandCount,
+            [&](size_t begin, size_t end) {
+                for (size_t strand = begin; strand < end; strand++)
                 {
-                    // voxels.push_back(Graphics::Voxel(pos, 0.05f));
-                    vertices.back().tangent = Vec3(0.0);
-                    color = {((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX, ((float)rand()) / RAND_MAX};
+                    const size_t first = strandOffsets[strand];
+                    const size_t last  = strandOffsets[strand + 1];
+
+                    // Stable per strand random color
+                    const uint32_t seed  = Graphics::Utils::murmur_hash3_32(reinterpret_cast<const char*>(&strand), sizeof(strand));
+                    const Vec3     color = Vec3((seed & 0xFF), ((seed >> 8) & 0xFF), ((seed >> 16) & 0xFF)) / 255.0f;
+
+                    Vec3   minCoord = Vec3(INFINITY);
+                    Vec3   maxCoord = Vec3(-INFINITY);
+                    size_t index    = (first - strand) * 2;
+                    float  length   = 0.0f;
+                    for (size_t i = first; i < last; i++)
+                    {
+                        Graphics::Vertex& v = vertices[i];
+                        v.pos               = Vec3(posData[i * 3], posData[i * 3 + 1], posData[i * 3 + 2]);
+                        v.normal            = normData ? Vec3(normData[i * 3], normData[i * 3 + 1], normData[i * 3 + 2]) : Vec3(0.0f);
+                        v.texCoord          = Vec2(0.0f);
+                        v.color             = color;
+                        // Forward differences, the last point of a strand is marked with a null tangent
+                        v.tangent = Vec3(0.0f);
+                        if (i + 1 < last)
+                        {
+                            const Vec3  next          = Vec3(posData[(i + 1) * 3], posData[(i + 1) * 3 + 1], posData[(i + 1) * 3 + 2]);
+                            const Vec3  d             = next - v.pos;
+                            const float segmentLength = math::length(d);
+                            if (segmentLength > 0.0f)
+                                v.tangent = d / segmentLength;
+                            length += segmentLength;
+                            indices[index++] = static_cast<uint32_t>(i);
+                            indices[index++] = static_cast<uint32_t>(i + 1);
+                        }
+                        minCoord = math::min(minCoord, v.pos);
+                        maxCoord = math::max(maxCoord, v.pos);
+                    }
+                    // One box per strand for the procedural acceleration structure
+                    voxels[strand].minCoord = minCoord - NEURAL_HAIR_STRAND_RADIUS;
+                    voxels[strand].maxCoord = maxCoord + NEURAL_HAIR_STRAND_RADIUS;
+                    fiberLengths[strand]    = length;
                 }
-            }
+            },
+            256);
+
+        float totalFiberLength = 0.0f;
+        for (float length : fiberLengths)
+            totalFiberLength += length;
+        convertTimer.stop();
+
+        const float parsingTime    = static_cast<float>(readTimer.get()) / 1000.f;
+        const float conversionTime = static_cast<float>(convertTimer.get()) / 1000.f;
+        if (verbose)
+        {
+            std::cout << "\tparsing " << size_mb << "mb in " << parsingTime << " seconds [" << (size_mb / parsingTime)
+                      << " MBps]" << std::endl;
+            std::cout << "\tconverting " << strandCount << " strands in " << conversionTime << " seconds" << std::endl;
+            std::cout << "\tRead " << pointCount << " total vertices " << std::endl;
+            if (normals)
+                std::cout << "\tRead " << normals->count << " total vertex normals " << std::endl;
         }
-      
+        LOG_DEBUG("Neural hair " + filePath + ": " + std::to_string(size_mb / (parsingTime + conversionTime)) + " MB/s");
+
         Core::Geometry* g = new Core::Geometry();
-        g->fill(vertices, indices);
-        g->fill_voxel_array(voxels);
+        g->fill(std::move(vertices), std::move(indices));
+        g->fill_voxel_array(std::move(voxels));
+        g->set_avg_fiber_length(totalFiberLength / strandCount);
+        g->set_strand_offsets(std::move(strandOffsets));
+        g->sort_strands(sortKey);
+        g->quantize_strands();
+        g->build_strand_LODs();
+        if (useCache && !Tools::HairCache::write(cacheFileName, g->get_properties(), sourceHash, sourceSize))
+            std::cerr << "Could not write hair cache " << cacheFileName << std::endl;
         g->create_voxel_AS(true);
         mesh->push_geometry(g);
         mesh->setup_volume();
@@ -7,13 +7,26 @@
 USING_VULKAN_ENGINE_NAMESPACE
 
 namespace hair_loaders {
+
+// Strand length assumed when the file carries no strand boundaries
+#define NEURAL_HAIR_STRAND_POINTS 100
+// Padding of the per strand boxes of the procedural acceleration structure
+#define NEURAL_HAIR_STRAND_RADIUS 0.01f
+
+/*
+Loads a neural reconstruction PLY. Strand boundaries are read from a strand element (vertex_count, num_vertices, point_count,
+nv or segments property) or from a per vertex strand_id, falling back to NEURAL_HAIR_STRAND_POINTS points per strand.
+Strands are optionally reordered along a Morton curve, see Core::Geometry::sort_strands().
+*/
 void load_neural_hair(Core::Mesh* const mesh,
                       const char*       fileName,
                       Core::Mesh* const skullMesh,
                       bool              preload           = true,
                       bool              verbose           = false,
                       bool              calculateTangents = false,
-                      bool              saveOutput        = false);
+                      bool              saveOutput        = false,
+                      bool              useCache          = true,
+                      StrandSortKey     sortKey           = STRAND_SORT_NONE);
 }
 
 #endif
\ No newline at end of file
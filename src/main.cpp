@@ -1,11 +1,17 @@
 #include "application.h"
+#include <cstdio>
 #include <iostream>
 
+static bool parse_vec3(const char* arg, Vec3& v) {
+    return std::sscanf(arg, "%f,%f,%f", &v.x, &v.y, &v.z) == 3;
+}
+
 int main(int argc, char* argv[]) {
 
     HairViewer app;
     try
     {
+        HeadlessSettings          headless{};
         Systems::RendererSettings settings{};
         settings.samplesMSAA = MSAASamples::x8;
         settings.clearColor  = Vec4(0.02, 0.02, 0.02, 1.0);
@@ -86,11 +92,72 @@ int main(int argc, char* argv[]) {
                     settings.enableUI = false;
                 i++;
                 continue;
+            } else if (token == "-headless")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "\"-headless\" argument expects an output image file:" << std::endl;
+                    std::cerr << "[<file>.png]" << std::endl;
+                    std::cerr << "[<file>.exr]" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                headless.enabled = true;
+                headless.output  = argv[i + 1];
+                i++;
+                continue;
+            } else if (token == "-size")
+            {
+                if (i + 1 >= argc || std::sscanf(argv[i + 1], "%ux%u", &headless.width, &headless.height) != 2 || headless.width == 0 ||
+                    headless.height == 0)
+                {
+                    std::cerr << "\"-size\" argument expects an image size: [<width>x<height>]" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                i++;
+                continue;
+            } else if (token == "-frames")
+            {
+                if (i + 1 >= argc || std::sscanf(argv[i + 1], "%u", &headless.frames) != 1)
+                {
+                    std::cerr << "\"-frames\" argument expects the number of frames rendered before saving" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                i++;
+                continue;
+            } else if (token == "-hair")
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "\"-hair\" argument expects a hair file: [.hair] [.ply]" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                headless.hairFile = argv[i + 1];
+                i++;
+                continue;
+            } else if (token == "-camera" || token == "-light")
+            {
+                Vec3& position = token == "-camera" ? headless.cameraPosition : headless.lightPosition;
+                if (i + 1 >= argc || !parse_vec3(argv[i + 1], position))
+                {
+                    std::cerr << "\"" << token << "\" argument expects a position: [<x>,<y>,<z>]" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                i++;
+                continue;
+            } else if (token == "-fov")
+            {
+                if (i + 1 >= argc || std::sscanf(argv[i + 1], "%f", &headless.fov) != 1)
+                {
+                    std::cerr << "\"-fov\" argument expects a vertical field of view in degrees" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                i++;
+                continue;
             }
             continue;
         }
 
-        app.run(settings);
+        app.run(settings, headless);
     } catch (const std::exception& e)
     {
         std::cerr << e.what() << std::endl;
@@ -0,0 +1,92 @@
+#include "../src/hair_loader.h"
+#include <algorithm>
+#include <iostream>
+
+// Segments of a strand index stream. Every strip strand holds two indices more than segments, its first one and the restart
+static size_t segment_count(const uint32_t* indices, size_t count, StrandTopology topology) {
+    if (topology == STRAND_LINE_LIST)
+        return count / 2;
+    return count - 2 * std::count(indices, indices + count, STRAND_RESTART_INDEX);
+}
+
+/*
+Offline converter. Parses .hair and neural .ply files and writes their .hairc cache next to them, so the viewer never has
+to go through the slow parsing path. Reports the GPU memory of every groom against the former layout, line lists with the
+level 0 indices uploaded twice (index buffer and index SSBO).
+*/
+int main(int argc, char* argv[]) {
+
+    if (argc < 2)
+    {
+        std::cerr << "Usage: HairCacheConverter <file.hair | file.ply> [...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int failed = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string fileName(argv[i]);
+        std::string extension = fileName.substr(fileName.find_last_of(".") + 1);
+
+        uint64_t sourceSize = 0;
+        uint64_t sourceHash = Tools::HairCache::hash_file(fileName, &sourceSize);
+        if (sourceHash == 0)
+        {
+            std::cerr << "Could not open " << fileName << std::endl;
+            failed++;
+            continue;
+        }
+
+        Graphics::Utils::ManualTimer timer;
+        timer.start();
+
+        Core::Mesh* mesh = new Core::Mesh();
+        if (extension == HAIR)
+            Tools::Loaders::load_hair(mesh, fileName.c_str(), false);
+        else if (extension == PLY)
+            hair_loaders::load_neural_hair(mesh, fileName.c_str(), nullptr, true, false, false, false, false);
+        else
+        {
+            std::cerr << "Unsupported file format: " << extension << std::endl;
+            delete mesh;
+            failed++;
+            continue;
+        }
+
+        Core::Geometry*   g             = mesh->get_geometry();
+        const std::string cacheFileName = Tools::HairCache::get_cache_path(fileName);
+        if (g && !g->get_properties().quantized())
+            g->quantize_strands();
+        if (g && !g->has_strand_LODs())
+            g->build_strand_LODs();
+        if (!g || !g->get_properties().loaded || !Tools::HairCache::write(cacheFileName, g->get_properties(), sourceHash, sourceSize))
+        {
+            std::cerr << "Could not convert " << fileName << std::endl;
+            delete g;
+            delete mesh;
+            failed++;
+            continue;
+        }
+        timer.stop();
+
+        const Core::GeometricData& gd          = g->get_properties();
+        const size_t               strandCount = gd.strandOffsets.empty() ? 0 : gd.strandOffsets.size() - 1;
+        std::cout << fileName << " -> " << cacheFileName << " (" << gd.vertex_count() << " vertices, " << strandCount << " strands) in "
+                  << timer.get() << " ms" << std::endl;
+
+        const size_t levelSegments = segment_count(gd.index_data(), gd.index_count(), gd.strandTopology);
+        const size_t lodSegments   = segment_count(gd.lod_index_data(), gd.lod_index_count(), gd.strandTopology);
+        const size_t indexBytes    = (gd.index_count() + gd.lod_index_count()) * sizeof(uint32_t);
+        const size_t formerBytes   = (levelSegments * 4 + lodSegments * 2) * sizeof(uint32_t);
+        const size_t streamBytes   = gd.vertex_count() * sizeof(Graphics::StrandVertex) + gd.strand_count() * sizeof(Graphics::StrandData) +
+                                   gd.strandClusters.size() * sizeof(Graphics::StrandCluster);
+        const double MB            = 1.0 / (1024.0 * 1024.0);
+        std::cout << "  GPU memory " << (streamBytes + formerBytes) * MB << " MB -> " << (streamBytes + indexBytes) * MB << " MB, indices "
+                  << formerBytes * MB << " MB -> " << indexBytes * MB << " MB ("
+                  << (gd.strandTopology == STRAND_LINE_STRIP ? "line strips" : "line lists") << ")" << std::endl;
+        delete g;
+        delete mesh;
+    }
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
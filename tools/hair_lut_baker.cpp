@@ -0,0 +1,67 @@
+#include <engine/core.h>
+#include <engine/systems.h>
+#include <iostream>
+
+USING_VULKAN_ENGINE_NAMESPACE
+
+/*
+Offline baker. Runs the hair scattering LUT integration and decodes the far field and GI lookup volumes once on an offscreen
+device, filling the volume cache. Environment maps given as arguments get their cubemap and irradiance cached as well, so
+the viewer starts without running any of those passes.
+*/
+int main(int argc, char* argv[]) {
+
+    Core::WindowHeadless*  window   = nullptr;
+    Systems::BaseRenderer* renderer = nullptr;
+    Core::Scene*           scene    = nullptr;
+    try
+    {
+        Systems::RendererSettings settings{};
+        settings.enableUI = false;
+
+        window = new Core::WindowHeadless("Hair LUT Baker", 64, 64);
+        window->init();
+        renderer = new Systems::ForwardRenderer(window, ShadowResolution::LOW, settings);
+        scene    = new Core::Scene(new Core::Camera());
+
+        Graphics::Utils::ManualTimer timer;
+        timer.start();
+        // The integration runs in the first frame, its read back and storage at the start of the next one
+        renderer->render(scene);
+        renderer->render(scene);
+        timer.stop();
+        std::cout << "Hair LUTs baked into " << Tools::VolumeCache::get_directory() << " in " << timer.get() << " ms" << std::endl;
+
+        int failed = 0;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string fileName(argv[i]);
+            timer.start();
+
+            Core::TextureHDR* envMap = new Core::TextureHDR();
+            Tools::Loaders::load_HDRi(envMap, fileName);
+            if (!envMap->loaded_on_CPU())
+            {
+                std::cerr << "Could not load " << fileName << std::endl;
+                delete envMap;
+                failed++;
+                continue;
+            }
+            if (!scene->get_skybox())
+                scene->set_skybox(new Core::Skybox(envMap));
+            else
+                scene->get_skybox()->set_enviroment_map(envMap);
+            renderer->render(scene);
+            renderer->render(scene);
+            timer.stop();
+            std::cout << fileName << " -> " << Tools::EnvironmentCache::get_directory() << " in " << timer.get() << " ms" << std::endl;
+        }
+
+        renderer->shutdown(scene);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
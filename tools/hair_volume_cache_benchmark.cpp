@@ -0,0 +1,138 @@
+#include <engine/core.h>
+#include <engine/systems.h>
+#include <engine/tools/loaders.h>
+#include <iostream>
+
+USING_VULKAN_ENGINE_NAMESPACE
+
+#define WARMUP_FRAMES 32
+#define TIMED_FRAMES 256
+
+struct VolumeTimes {
+    double   voxelization = 0.0; // Mean GPU time of the pass
+    uint32_t rebuilt      = 0;   // Volumes voxelized over the timed frames
+    uint32_t bricks       = 0;   // Asked for by the last rebuild read back
+    uint32_t capacity     = 0;   // Of the brick pool
+};
+
+// The groom spins in front of the camera, which should not need its volume to be voxelized again
+static VolumeTimes measure(Systems::BaseRenderer* renderer, Core::Scene* scene, Core::Mesh* mesh, bool cache) {
+    const std::vector<Core::BasePass*> passes           = renderer->get_render_passes();
+    size_t                             voxelizationPass = SIZE_MAX;
+    Core::HairVoxelizationPass*        pass             = nullptr;
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        if (passes[i]->get_name() == "HAIR VOXELIZATION")
+        {
+            voxelizationPass = i;
+            pass             = dynamic_cast<Core::HairVoxelizationPass*>(passes[i]);
+        }
+    }
+    if (!pass)
+        return {};
+    pass->cache_volumes(cache);
+
+    VolumeTimes times = {};
+    for (uint32_t i = 0; i < WARMUP_FRAMES + TIMED_FRAMES; i++)
+    {
+        const float angle = 360.0f * float(i) / float(WARMUP_FRAMES + TIMED_FRAMES);
+        mesh->set_rotation({90.0f, 180.0f + angle, 0.0f});
+
+        renderer->render(scene);
+        if (i < WARMUP_FRAMES)
+            continue;
+        // Uploads and frames in flight settle during the warm up
+        const std::vector<double>& passTimes = renderer->get_pass_GPU_times();
+        if (voxelizationPass < passTimes.size())
+            times.voxelization += passTimes[voxelizationPass] / TIMED_FRAMES;
+        times.rebuilt += pass->get_rebuilt_volumes();
+    }
+    times.bricks   = pass->get_requested_bricks();
+    times.capacity = pass->get_brick_capacity();
+    pass->cache_volumes(true);
+    return times;
+}
+
+/*
+Renders every groom given as argument (the bundled .hair grooms by default) offscreen while it spins, voxelizing its density
+volume every frame and caching it in object space. Reports the mean GPU time of the hair voxelization pass of each, the
+time the cache saves per frame and the bricks its sparse volume takes.
+*/
+int main(int argc, char* argv[]) {
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+        files.push_back(argv[i]);
+    if (files.empty())
+        for (const char* name : {"curly", "natural", "straight", "wavy"})
+            files.push_back(std::string(RESOURCES_PATH) + "models/" + name + ".hair");
+
+    Core::WindowHeadless*  window   = nullptr;
+    Systems::BaseRenderer* renderer = nullptr;
+    Core::Scene*           scene    = nullptr;
+    try
+    {
+        Systems::RendererSettings settings{};
+        settings.samplesMSAA      = MSAASamples::x4;
+        settings.enableUI         = false;
+        settings.enableGPUTimings = true;
+
+        window = new Core::WindowHeadless("Hair Volume Cache Benchmark", 1280, 720);
+        window->init();
+        renderer = new Systems::ForwardRenderer(window, ShadowResolution::MEDIUM, settings);
+
+        // Same framing as the viewer defaults
+        Core::Camera* camera = new Core::Camera();
+        camera->set_position({0.0f, 0.0f, -16.0f});
+        camera->set_far(100.0f);
+        camera->set_near(0.1f);
+        camera->set_field_of_view(40.0f);
+        camera->set_projection(window->get_extent().width, window->get_extent().height);
+        scene = new Core::Scene(camera);
+
+        Core::PointLight* light = new Core::PointLight();
+        light->set_position({-1.3f, 8.0f, -5.8f});
+        light->set_shadow_fov(120.0f);
+        light->set_shadow_bias(0.0002f);
+        light->set_shadow_near(0.1f);
+        light->set_area_of_effect(30.0f);
+        scene->add(light);
+
+        int failed = 0;
+        for (const std::string& fileName : files)
+        {
+            Core::Mesh* mesh = new Core::Mesh();
+            Tools::Loaders::load_hair(mesh, fileName.c_str());
+            if (!mesh->get_geometry() || !mesh->get_geometry()->get_properties().loaded)
+            {
+                delete mesh;
+                std::cerr << "Could not load " << fileName << std::endl;
+                failed++;
+                continue;
+            }
+            Core::HairEpicMaterial* material = new Core::HairEpicMaterial();
+            material->set_thickness(0.0025f);
+            mesh->push_material(material);
+            mesh->set_scale(0.053f);
+            scene->add(mesh);
+
+            const VolumeTimes rebuilt = measure(renderer, scene, mesh, false);
+            const VolumeTimes cached  = measure(renderer, scene, mesh, true);
+
+            std::cout << fileName << std::endl;
+            std::cout << "  every frame: voxelization " << rebuilt.voxelization << " ms, " << rebuilt.rebuilt << " rebuilds" << std::endl;
+            std::cout << "  cached: voxelization " << cached.voxelization << " ms, " << cached.rebuilt << " rebuilds" << std::endl;
+            std::cout << "  saved " << rebuilt.voxelization - cached.voxelization << " ms per frame" << std::endl;
+            std::cout << "  bricks: " << rebuilt.bricks << " asked for, " << rebuilt.capacity << " in the pool" << std::endl;
+
+            mesh->set_active(false);
+        }
+
+        renderer->shutdown(scene);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <engine/core.h>
+#include <engine/graphics/utilities/job_system.h>
+#include <engine/tools/loaders.h>
+#include <iostream>
+#include <random>
+
+USING_VULKAN_ENGINE_NAMESPACE
+
+#define QUERY_COUNT 200000
+
+// Runs QUERY_COUNT queries, split over the job system if parallel
+static double queries_per_second(const std::function<void(size_t, size_t)>& query, bool parallel) {
+    Graphics::Utils::ManualTimer timer;
+    timer.start();
+    if (parallel)
+        Graphics::Utils::parallel_for(QUERY_COUNT, query, 1024);
+    else
+        query(0, QUERY_COUNT);
+    timer.stop();
+    return QUERY_COUNT / std::max(timer.get() * 0.001, 1e-9);
+}
+
+/*
+Builds the strand segment BVH of every groom given as argument (the bundled .hair grooms by default) and reports build and
+refit times and the throughput of ray, nearest strand and box queries, single threaded and on the job system.
+*/
+int main(int argc, char* argv[]) {
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+        files.push_back(argv[i]);
+    if (files.empty())
+        for (const char* name : {"curly", "natural", "straight", "wavy"})
+            files.push_back(std::string(RESOURCES_PATH) + "models/" + name + ".hair");
+
+    try
+    {
+        std::cout << "Job system workers: " << Graphics::JobSystem::get().get_worker_count() + 1 << std::endl;
+
+        int failed = 0;
+        for (const std::string& fileName : files)
+        {
+            Core::Mesh* mesh = new Core::Mesh();
+            Tools::Loaders::load_hair(mesh, fileName.c_str());
+            Core::Geometry* g = mesh->get_geometry();
+            if (!g || !g->get_properties().loaded)
+            {
+                std::cerr << "Could not load " << fileName << std::endl;
+                delete mesh;
+                failed++;
+                continue;
+            }
+
+            Graphics::Utils::ManualTimer timer;
+            timer.start();
+            const Core::StrandBVH* bvh = g->build_strand_BVH();
+            timer.stop();
+            const double buildTime = timer.get();
+            if (!bvh || bvh->empty())
+            {
+                std::cerr << "Could not build the BVH of " << fileName << std::endl;
+                delete mesh;
+                failed++;
+                continue;
+            }
+            timer.start();
+            g->refit_strand_BVH();
+            timer.stop();
+            const double refitTime = timer.get();
+
+            // Queries spread over the groom bounds, rays shot from a sphere around them towards points inside
+            const Vec3  minCoords = bvh->get_min();
+            const Vec3  maxCoords = bvh->get_max();
+            const Vec3  center    = (minCoords + maxCoords) * 0.5f;
+            const float radius    = math::length(maxCoords - minCoords) * 0.5f;
+            const float thickness = radius * 0.001f;
+            const float boxSize   = radius * 0.02f;
+
+            std::mt19937                          rng(1234);
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            std::vector<Vec3>                     points(QUERY_COUNT), origins(QUERY_COUNT);
+            for (size_t i = 0; i < QUERY_COUNT; i++)
+            {
+                points[i]            = minCoords + (maxCoords - minCoords) * Vec3(unit(rng), unit(rng), unit(rng));
+                const float cosTheta = unit(rng) * 2.0f - 1.0f;
+                const float phi      = unit(rng) * 6.2831853f;
+                const float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+                origins[i]           = center + Vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta) * radius * 2.0f;
+            }
+
+            std::atomic<size_t> rayHits{0};
+            auto                rays = [&](size_t begin, size_t end) {
+                size_t hits = 0;
+                for (size_t i = begin; i < end; i++)
+                    hits += bvh->intersect(origins[i], points[i] - origins[i], thickness).valid();
+                rayHits += hits;
+            };
+            auto nearest = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    bvh->nearest(points[i]);
+            };
+            std::atomic<size_t> boxSegments{0};
+            auto                boxes = [&](size_t begin, size_t end) {
+                std::vector<uint32_t> segments;
+                for (size_t i = begin; i < end; i++)
+                {
+                    segments.clear();
+                    bvh->query(points[i] - Vec3(boxSize), points[i] + Vec3(boxSize), thickness, segments);
+                    boxSegments += segments.size();
+                }
+            };
+
+            const double raysST    = queries_per_second(rays, false);
+            const size_t hitCount  = rayHits.exchange(0);
+            const double raysMT    = queries_per_second(rays, true);
+            const double nearestST = queries_per_second(nearest, false);
+            const double nearestMT = queries_per_second(nearest, true);
+            const double boxesST   = queries_per_second(boxes, false);
+            const size_t boxCount  = boxSegments.exchange(0);
+            const double boxesMT   = queries_per_second(boxes, true);
+
+            std::cout << fileName << std::endl;
+            std::cout << "  segments " << bvh->get_segment_count() << ", nodes " << bvh->get_node_count() << ", "
+                      << bvh->get_memory_size() / (1024.0 * 1024.0) << " MB" << std::endl;
+            std::cout << "  build " << buildTime << " ms, refit " << refitTime << " ms" << std::endl;
+            std::cout << "  ray     " << raysST << " q/s (" << raysMT << " q/s parallel), hit rate " << double(hitCount) / QUERY_COUNT << std::endl;
+            std::cout << "  nearest " << nearestST << " q/s (" << nearestMT << " q/s parallel)" << std::endl;
+            std::cout << "  box     " << boxesST << " q/s (" << boxesMT << " q/s parallel), " << double(boxCount) / QUERY_COUNT
+                      << " segments per box" << std::endl;
+
+            delete g;
+            delete mesh;
+        }
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,169 @@
+#include <engine/core.h>
+#include <engine/systems.h>
+#include <engine/tools/loaders.h>
+#include <iostream>
+
+USING_VULKAN_ENGINE_NAMESPACE
+
+#define WARMUP_FRAMES 32
+#define TIMED_FRAMES 256
+
+static const char* SORT_NAMES[] = {"file order", "root Morton", "centroid Morton"};
+
+struct PassTimes {
+    double voxelization = 0.0;
+    double forward      = 0.0;
+};
+
+// Mean GPU time of the voxelization and forward passes, with only the given mesh active
+static PassTimes measure(Systems::BaseRenderer* renderer, Core::Scene* scene, Core::Mesh* mesh) {
+    for (Core::Mesh* m : scene->get_meshes())
+        if (m->get_geometry() && !m->get_geometry()->get_properties().strandOffsets.empty())
+            m->set_active(m == mesh);
+
+    size_t voxelizationPass = SIZE_MAX, forwardPass = SIZE_MAX;
+    Core::HairVoxelizationPass*        pass   = nullptr;
+    const std::vector<Core::BasePass*> passes = renderer->get_render_passes();
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        if (passes[i]->get_name() == "HAIR VOXELIZATION")
+        {
+            voxelizationPass = i;
+            pass             = dynamic_cast<Core::HairVoxelizationPass*>(passes[i]);
+        }
+        if (passes[i]->get_name() == "FORWARD")
+            forwardPass = i;
+    }
+    // Cached volumes would leave nothing to voxelize after the first frame
+    if (pass)
+        pass->cache_volumes(false);
+
+    // Uploads and frames in flight settle during the warm up
+    for (uint32_t i = 0; i < WARMUP_FRAMES; i++)
+        renderer->render(scene);
+    PassTimes times = {};
+    for (uint32_t i = 0; i < TIMED_FRAMES; i++)
+    {
+        renderer->render(scene);
+        const std::vector<double>& passTimes = renderer->get_pass_GPU_times();
+        if (voxelizationPass < passTimes.size())
+            times.voxelization += passTimes[voxelizationPass] / TIMED_FRAMES;
+        if (forwardPass < passTimes.size())
+            times.forward += passTimes[forwardPass] / TIMED_FRAMES;
+    }
+    if (pass)
+        pass->cache_volumes(true);
+    return times;
+}
+
+/*
+Renders every groom given as argument (the bundled .hair grooms by default) offscreen, in file order and sorted by the Morton
+code of the strand roots and centroids, and reports the mean GPU time of the hair voxelization and forward passes of each.
+*/
+int main(int argc, char* argv[]) {
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+        files.push_back(argv[i]);
+    if (files.empty())
+        for (const char* name : {"curly", "natural", "straight", "wavy"})
+            files.push_back(std::string(RESOURCES_PATH) + "models/" + name + ".hair");
+
+    Core::WindowHeadless*  window   = nullptr;
+    Systems::BaseRenderer* renderer = nullptr;
+    Core::Scene*           scene    = nullptr;
+    try
+    {
+        Systems::RendererSettings settings{};
+        settings.samplesMSAA      = MSAASamples::x4;
+        settings.enableUI         = false;
+        settings.enableGPUTimings = true;
+
+        window = new Core::WindowHeadless("Strand Sort Benchmark", 1280, 720);
+        window->init();
+        renderer = new Systems::ForwardRenderer(window, ShadowResolution::MEDIUM, settings);
+
+        // Same framing as the viewer defaults
+        Core::Camera* camera = new Core::Camera();
+        camera->set_position({0.0f, 0.0f, -16.0f});
+        camera->set_far(100.0f);
+        camera->set_near(0.1f);
+        camera->set_field_of_view(40.0f);
+        camera->set_projection(window->get_extent().width, window->get_extent().height);
+        scene = new Core::Scene(camera);
+
+        Core::PointLight* light = new Core::PointLight();
+        light->set_position({-1.3f, 8.0f, -5.8f});
+        light->set_shadow_fov(120.0f);
+        light->set_shadow_bias(0.0002f);
+        light->set_shadow_near(0.1f);
+        light->set_area_of_effect(30.0f);
+        scene->add(light);
+
+        int failed = 0;
+        for (const std::string& fileName : files)
+        {
+            Core::Mesh* meshes[3]    = {};
+            double      loadTimes[3] = {};
+            for (int key = STRAND_SORT_NONE; key <= STRAND_SORT_CENTROID; key++)
+            {
+                Graphics::Utils::ManualTimer timer;
+                timer.start();
+                Core::Mesh* mesh = new Core::Mesh();
+                // The cache holds a single order, it would be rebuilt on every run
+                Tools::Loaders::load_hair(mesh, fileName.c_str(), false, static_cast<StrandSortKey>(key));
+                timer.stop();
+                if (!mesh->get_geometry() || !mesh->get_geometry()->get_properties().loaded)
+                {
+                    delete mesh;
+                    break;
+                }
+                loadTimes[key] = timer.get();
+
+                Core::HairEpicMaterial* material = new Core::HairEpicMaterial();
+                material->set_thickness(0.0025f);
+                mesh->push_material(material);
+                mesh->set_scale(0.053f);
+                mesh->set_rotation({90.0, 180.0f, 0.0f});
+                scene->add(mesh);
+                meshes[key] = mesh;
+            }
+            if (!meshes[STRAND_SORT_CENTROID])
+            {
+                for (Core::Mesh* mesh : meshes)
+                    if (mesh)
+                        mesh->set_active(false);
+                std::cerr << "Could not load " << fileName << std::endl;
+                failed++;
+                continue;
+            }
+
+            std::cout << fileName << std::endl;
+            std::cout << "  strands " << meshes[0]->get_geometry()->get_properties().strandOffsets.size() - 1 << ", "
+                      << TIMED_FRAMES << " frames" << std::endl;
+            PassTimes reference = {};
+            for (int key = STRAND_SORT_NONE; key <= STRAND_SORT_CENTROID; key++)
+            {
+                const PassTimes times = measure(renderer, scene, meshes[key]);
+                if (key == STRAND_SORT_NONE)
+                    reference = times;
+                std::cout << "  " << SORT_NAMES[key] << ": load " << loadTimes[key] << " ms, voxelization " << times.voxelization << " ms";
+                if (key != STRAND_SORT_NONE && times.voxelization > 0.0)
+                    std::cout << " (x" << reference.voxelization / times.voxelization << ")";
+                std::cout << ", forward " << times.forward << " ms";
+                if (key != STRAND_SORT_NONE && times.forward > 0.0)
+                    std::cout << " (x" << reference.forward / times.forward << ")";
+                std::cout << std::endl;
+            }
+            for (Core::Mesh* mesh : meshes)
+                mesh->set_active(false);
+        }
+
+        renderer->shutdown(scene);
+        return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}